@@ -0,0 +1,61 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Host build of the IOS-PAD driver modules.
+// This replaces the IOS, BTA and SMD functions the drivers call with a single threaded environment,
+// everything which would go to the controller or to padscore is handed to the callbacks below.
+
+enum {
+    // BTA_HhSendData, sent on the interrupt channel
+    HOST_OUTPUT_DATA,
+    // bta_hh_snd_write_dev with HID_TRANS_SET_REPORT, param is the report type
+    HOST_OUTPUT_SET_REPORT,
+    // bta_hh_snd_write_dev with HID_TRANS_GET_REPORT, param is the report type and the data is the report id,
+    // nothing answers these on the host
+    HOST_OUTPUT_GET_REPORT,
+};
+
+// a report which a driver sent to the controller
+typedef void (*HostOutputCallback)(uint8_t handle, uint8_t kind, uint8_t param, const uint8_t* data, uint16_t len);
+
+// a report which the drivers sent to padscore
+typedef void (*HostInputCallback)(uint8_t handle, const uint8_t* data, uint16_t len);
+
+void Host_SetCallbacks(HostOutputCallback output, HostInputCallback input);
+
+// the value IOS_GetUpTime64 returns, in microseconds
+void Host_SetTime(uint64_t time);
+
+// queues a wiimote output report from padscore, these are handled by the next processSmdMessages call
+int Host_QueueSmdOutput(uint8_t handle, const void* report, uint16_t len);
+
+// sets the report descriptor which initController hands to the generic driver, this is not copied
+void Host_SetDescriptor(uint8_t handle, const uint8_t* descriptor, uint16_t len);
+
+// amount of IOS heap allocations which haven't been freed yet
+uint32_t Host_GetAllocationCount(void);
+
+// Entry points of the IOS-PAD modules which are called from hooks and don't have a header
+
+void processSmdMessages(void);
+
+void bta_hh_co_data(uint8_t dev_handle, uint8_t *p_rpt, uint16_t len, uint8_t mode,
+                    uint8_t sub_class, uint8_t ctry_code, uint8_t* peer_addr, uint8_t app_id);
@@ -0,0 +1,255 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "host.h"
+
+#include <main.h>
+#include <bta/bta_hh.h>
+#include <stack/sdp.h>
+
+// GKI pool 3 buffers are large enough for any report the drivers send
+#define HOST_POOL_BUFFER_SIZE 0x400
+
+#define HOST_SMD_QUEUE_SIZE 32
+
+// the smd error for an empty queue, processSmdMessages stops on this
+#define HOST_SMD_EMPTY (-0xc0005)
+
+uint32_t isSmdReady = 1;
+uint32_t smdIopIndex = 0;
+uint8_t local_device_bdaddr[6] = { 0 };
+
+// wiimoteCryptoInit rejects these zeroed key tables, so the crypto state stays all zero
+// and wiimoteEncrypt leaves the extension data as is
+uint8_t __ans_tbl[16][6];
+uint8_t __sboxes[10][256];
+
+static tBTA_HH_CB hostHhCb;
+tBTA_HH_CB* bta_hh_cb = &hostHhCb;
+
+static HostOutputCallback outputCallback = NULL;
+static HostInputCallback inputCallback = NULL;
+
+static uint64_t hostTime = 0;
+
+static SMDOutputMessage smdQueue[HOST_SMD_QUEUE_SIZE];
+static uint32_t smdQueueRead = 0;
+static uint32_t smdQueueWrite = 0;
+
+static uint32_t numAllocations = 0;
+
+void Host_SetCallbacks(HostOutputCallback output, HostInputCallback input)
+{
+    outputCallback = output;
+    inputCallback = input;
+}
+
+void Host_SetTime(uint64_t time)
+{
+    hostTime = time;
+}
+
+int Host_QueueSmdOutput(uint8_t handle, const void* report, uint16_t len)
+{
+    if (len > sizeof(WMReport) || smdQueueWrite - smdQueueRead >= HOST_SMD_QUEUE_SIZE) {
+        return -1;
+    }
+
+    SMDOutputMessage* msg = &smdQueue[smdQueueWrite++ % HOST_SMD_QUEUE_SIZE];
+    memset(msg, 0, sizeof(*msg));
+    msg->length = len;
+    msg->dev_handle = handle;
+    memcpy(msg->report.data, report, len);
+    return 0;
+}
+
+void Host_SetDescriptor(uint8_t handle, const uint8_t* descriptor, uint16_t len)
+{
+    hostHhCb.cb_index[handle] = handle;
+    hostHhCb.kdev[handle].dscp_info.dsc_list = (uint8_t*) descriptor;
+    hostHhCb.kdev[handle].dscp_info.dl_len = len;
+}
+
+uint32_t Host_GetAllocationCount(void)
+{
+    return numAllocations;
+}
+
+int IOS_CreateThread(int (*fun)(void* arg), void* arg, void* stack_top, uint32_t stacksize, int priority, uint32_t flags)
+{
+    // the report thread is driven by calling updateControllers directly
+    return 1;
+}
+
+int IOS_JoinThread(int threadid, uint32_t *returned_value)
+{
+    return 0;
+}
+
+int IOS_StartThread(int threadid)
+{
+    return 0;
+}
+
+int IOS_GetThreadPriority(int threadid)
+{
+    return 0;
+}
+
+int IOS_CreateMessageQueue(uint32_t *ptr, uint32_t n_msgs)
+{
+    return 1;
+}
+
+int IOS_DestroyMessageQueue(int queueid)
+{
+    return 0;
+}
+
+int IOS_ReceiveMessage(int queueid, uint32_t *message, uint32_t flags)
+{
+    return 0;
+}
+
+int IOS_CreateTimer(int time_us, int repeat_time_us, int queueid, uint32_t message)
+{
+    return 1;
+}
+
+int IOS_DestroyTimer(int timerid)
+{
+    return 0;
+}
+
+int IOS_GetUpTime64(uint64_t* outTime)
+{
+    *outTime = hostTime;
+    return 0;
+}
+
+// everything runs on one thread, so semaphores never need to block
+int IOS_CreateSemaphore(int32_t maxCount, int32_t initialCount)
+{
+    return 1;
+}
+
+int IOS_WaitSemaphore(int id, uint32_t tryWait)
+{
+    return 0;
+}
+
+int IOS_SignalSemaphore(int id)
+{
+    return 0;
+}
+
+int IOS_DestroySemaphore(int id)
+{
+    return 0;
+}
+
+void* IOS_Alloc(uint32_t heap, uint32_t size)
+{
+    void* ptr = malloc(size);
+    if (ptr) {
+        numAllocations++;
+    }
+
+    return ptr;
+}
+
+void* IOS_AllocAligned(uint32_t heap, uint32_t size, uint32_t alignment)
+{
+    void* ptr = aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+    if (ptr) {
+        numAllocations++;
+    }
+
+    return ptr;
+}
+
+void IOS_Free(uint32_t heap, void* ptr)
+{
+    if (ptr) {
+        numAllocations--;
+    }
+
+    free(ptr);
+}
+
+void* GKI_getpoolbuf(uint8_t pool_id)
+{
+    return malloc(HOST_POOL_BUFFER_SIZE);
+}
+
+static void sendOutput(uint8_t handle, uint8_t kind, uint8_t param, BT_HDR* p_buf)
+{
+    if (outputCallback) {
+        outputCallback(handle, kind, param, (const uint8_t*) (p_buf + 1) + p_buf->offset, p_buf->len);
+    }
+
+    free(p_buf);
+}
+
+void BTA_HhSendData(uint8_t dev_handle, uint8_t* dev_bda, BT_HDR *p_buf)
+{
+    sendOutput(dev_handle, HOST_OUTPUT_DATA, 0, p_buf);
+}
+
+void bta_hh_snd_write_dev(uint8_t dev_handle, uint8_t t_type, uint8_t param, uint16_t data, uint8_t rpt_id, BT_HDR *p_data)
+{
+    // get report requests don't carry any data, pass on the report id instead
+    if (t_type == HID_TRANS_GET_REPORT) {
+        if (outputCallback) {
+            outputCallback(dev_handle, HOST_OUTPUT_GET_REPORT, param, &rpt_id, sizeof(rpt_id));
+        }
+        return;
+    }
+
+    sendOutput(dev_handle, HOST_OUTPUT_SET_REPORT, param, p_data);
+}
+
+int smdIopSendMessage(int idx, void* ptr, uint32_t size)
+{
+    SMDInputMessage* msg = (SMDInputMessage*) ptr;
+    if (inputCallback) {
+        inputCallback(msg->dev_handle, msg->data, msg->length);
+    }
+
+    return 0;
+}
+
+int smdIopReceive(int idx, void* ptr)
+{
+    if (smdQueueRead == smdQueueWrite) {
+        return HOST_SMD_EMPTY;
+    }
+
+    memcpy(ptr, &smdQueue[smdQueueRead++ % HOST_SMD_QUEUE_SIZE], sizeof(SMDOutputMessage));
+    return 0;
+}
+
+// there is no SDP database on the host, so DI records never have a vid and pid
+tSDP_DISC_REC* SDP_FindServiceUUIDInDb(tSDP_DISCOVERY_DB* p_db, tBT_UUID* p_uuid, tSDP_DISC_REC* p_start_rec)
+{
+    return NULL;
+}
+
+tSDP_DISC_ATTR* SDP_FindAttributeInRec(tSDP_DISC_REC* p_rec, uint16_t attr_id)
+{
+    return NULL;
+}
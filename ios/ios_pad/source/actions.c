@@ -0,0 +1,221 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "actions.h"
+#include "utils.h"
+
+// The report thread ticks every 10ms
+#define TICKS_PER_SECOND 100
+
+static void schedule(ActionState* state, uint8_t slot, uint32_t delay)
+{
+    ActiveAction* active = &state->active[slot];
+
+    // delays longer than the wheel wait for additional turns
+    active->rounds = (delay - 1) / ACTION_WHEEL_SIZE;
+    active->bucket = (state->tick + delay) & (ACTION_WHEEL_SIZE - 1);
+    active->next = state->wheel[active->bucket];
+    state->wheel[active->bucket] = slot + 1;
+}
+
+static void unschedule(ActionState* state, uint8_t slot)
+{
+    uint8_t* link = &state->wheel[state->active[slot].bucket];
+    while (*link) {
+        if (*link == slot + 1) {
+            *link = state->active[slot].next;
+            break;
+        }
+
+        link = &state->active[*link - 1].next;
+    }
+}
+
+static int findSlot(ActionState* state, uint8_t action)
+{
+    for (int i = 0; i < ACTION_MAX_ACTIVE; i++) {
+        if (state->active[i].action == action) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static void start(ActionState* state, uint8_t index)
+{
+    const BloopairActionEntry* a = &state->config->actions[index];
+
+    // already running
+    if (findSlot(state, index + 1) >= 0) {
+        return;
+    }
+
+    int slot = findSlot(state, 0);
+    if (slot < 0) {
+        return;
+    }
+
+    ActiveAction* active = &state->active[slot];
+    active->action = index + 1;
+    active->step = 1;
+
+    if (a->type == BLOOPAIR_ACTION_TURBO) {
+        active->buttons = a->buttons;
+        schedule(state, slot, MAX(TICKS_PER_SECOND / 2 / a->param, 1));
+    } else {
+        active->buttons = a[1].buttons;
+        schedule(state, slot, a[1].param);
+    }
+}
+
+static void stop(ActionState* state, uint8_t index)
+{
+    int slot = findSlot(state, index + 1);
+    if (slot < 0) {
+        return;
+    }
+
+    unschedule(state, slot);
+    state->active[slot].action = 0;
+}
+
+static void fire(ActionState* state, uint8_t slot)
+{
+    ActiveAction* active = &state->active[slot];
+    const BloopairActionEntry* a = &state->config->actions[active->action - 1];
+
+    if (a->type == BLOOPAIR_ACTION_TURBO) {
+        active->buttons = active->buttons ? 0 : a->buttons;
+        schedule(state, slot, MAX(TICKS_PER_SECOND / 2 / a->param, 1));
+        return;
+    }
+
+    // move on to the next step of the sequence
+    if (++active->step > a->param) {
+        active->action = 0;
+        return;
+    }
+
+    active->buttons = a[active->step].buttons;
+    schedule(state, slot, a[active->step].param);
+}
+
+static void advance(ActionState* state)
+{
+    state->tick = (state->tick + 1) & (ACTION_WHEEL_SIZE - 1);
+
+    // take the whole bucket, slots which are due again get queued anew
+    uint8_t next = state->wheel[state->tick];
+    state->wheel[state->tick] = 0;
+
+    while (next) {
+        uint8_t slot = next - 1;
+        ActiveAction* active = &state->active[slot];
+        next = active->next;
+
+        if (active->rounds) {
+            active->rounds--;
+            active->next = state->wheel[state->tick];
+            state->wheel[state->tick] = slot + 1;
+        } else {
+            fire(state, slot);
+        }
+    }
+}
+
+static void handleTriggers(ActionState* state, uint32_t buttons)
+{
+    const ActionConfiguration* config = state->config;
+
+    state->chordButtons = 0;
+    state->heldSuppress = 0;
+
+    for (uint8_t i = 0; i < config->num; i++) {
+        const BloopairActionEntry* a = &config->actions[i];
+        int held = (buttons & a->trigger) == a->trigger;
+        int wasHeld = (state->lastButtons & a->trigger) == a->trigger;
+
+        switch (a->type) {
+        case BLOOPAIR_ACTION_TURBO:
+            if (held && !wasHeld) {
+                start(state, i);
+            } else if (!held && wasHeld) {
+                stop(state, i);
+            }
+            break;
+        case BLOOPAIR_ACTION_TOGGLE:
+            if (held && !wasHeld) {
+                state->toggled ^= a->buttons;
+            }
+
+            if (held) {
+                state->heldSuppress |= a->trigger;
+            }
+            break;
+        case BLOOPAIR_ACTION_CHORD:
+            if (held) {
+                state->chordButtons |= a->buttons;
+                state->heldSuppress |= a->trigger;
+            }
+            break;
+        case BLOOPAIR_ACTION_SEQUENCE:
+            if (held && !wasHeld) {
+                start(state, i);
+            }
+
+            // skip over the steps
+            i += a->param;
+            break;
+        }
+    }
+}
+
+void Actions_Apply(ActionState* state, const ActionConfiguration* config, uint32_t* buttons, uint8_t ticks)
+{
+    if (state->config != config) {
+        memset(state, 0, sizeof(*state));
+        state->config = config;
+    }
+
+    if (!config) {
+        return;
+    }
+
+    uint32_t in = *buttons;
+    if ((in ^ state->lastButtons) & config->triggerMask) {
+        handleTriggers(state, in);
+    }
+    state->lastButtons = in;
+
+    while (ticks--) {
+        advance(state);
+    }
+
+    // triggers of running actions aren't passed through
+    uint32_t suppress = state->heldSuppress;
+    uint32_t out = state->toggled | state->chordButtons;
+    for (int i = 0; i < ACTION_MAX_ACTIVE; i++) {
+        ActiveAction* active = &state->active[i];
+        if (active->action) {
+            suppress |= config->actions[active->action - 1].trigger;
+            out |= active->buttons;
+        }
+    }
+
+    *buttons = (in & ~suppress) | out;
+}
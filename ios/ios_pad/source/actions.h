@@ -0,0 +1,62 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <imports.h>
+#include "configuration.h"
+
+// Actions (turbo, toggle, chord and sequences) run on the mapped buttons in the report thread.
+// Actions are only looked at when one of their triggers changes, everything which runs over time
+// is queued on a timer wheel, so each tick only costs as much as the currently active actions.
+
+// Amount of turbo / sequence actions which can run at the same time
+#define ACTION_MAX_ACTIVE   8
+// Timer wheel size in ticks, must be a power of two
+#define ACTION_WHEEL_SIZE   32
+
+typedef struct {
+    // index of the action + 1, 0 if this slot is unused
+    uint8_t action;
+    // current step of a sequence
+    uint8_t step;
+    // full turns of the wheel left before this slot is due
+    uint8_t rounds;
+    // wheel bucket this slot is queued in
+    uint8_t bucket;
+    // next slot in the same bucket + 1, 0 for the last one
+    uint8_t next;
+    // buttons currently pressed by this slot
+    uint32_t buttons;
+} ActiveAction;
+
+typedef struct {
+    // the configuration this state belongs to, the state is reset if it changes
+    const ActionConfiguration* config;
+    uint32_t lastButtons;
+    uint32_t toggled;
+    uint32_t chordButtons;
+    // triggers of chords and toggles which are fully held, these aren't passed through
+    uint32_t heldSuppress;
+    uint8_t tick;
+    // first slot + 1 of each wheel bucket
+    uint8_t wheel[ACTION_WHEEL_SIZE];
+    ActiveAction active[ACTION_MAX_ACTIVE];
+} ActionState;
+
+// Applies the actions to the mapped buttons, ticks is the amount of report thread ticks since the last call
+void Actions_Apply(ActionState* state, const ActionConfiguration* config, uint32_t* buttons, uint8_t ticks);
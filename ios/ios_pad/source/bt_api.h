@@ -41,6 +41,7 @@ extern uint16_t sdp_db_size;
 /* BTA HID Host callback events */
 #define BTA_HH_OPEN_EVT         2       /* connection opened */
 #define BTA_HH_CLOSE_EVT        3       /* connection closed */
+#define BTA_HH_GET_RPT_EVT      4       /* Get_report response */
 #define BTA_HH_GET_DSCP_EVT     10      /* Get report descripotor */
 #define BTA_HH_ADD_DEV_EVT      11      /* Add Device callback */
 #define BTA_HH_VC_UNPLUG_EVT    13      /* virtually unplugged */
@@ -59,6 +60,21 @@ typedef struct
     uint8_t  handle;     /* device handle            */
 } tBTA_HH_CBDATA;
 
+#define BTA_HH_OK 0
+
+/* callback event data for BTA_HH_GET_RPT_EVT */
+typedef struct
+{
+    uint8_t  status;     /* handshake status         */
+    uint8_t  handle;     /* device handle            */
+    union
+    {
+        uint8_t  proto_mode;
+        BT_HDR*  p_rpt_data; /* GET_REPORT data, starting with the report id */
+        uint8_t  idle_rate;
+    } rsp_data;
+} tBTA_HH_HSDATA;
+
 #define BTA_HH_MAX_RPT_CHARS 10
 
 #define BTA_HH_MAX_KNOWN 0x10
@@ -231,6 +247,7 @@ enum
     BTA_HH_RPTT_FEATURE     /* feature report   */
 };
 
+#define HID_TRANS_GET_REPORT    (4)
 #define HID_TRANS_SET_REPORT    (5)
 
 /*
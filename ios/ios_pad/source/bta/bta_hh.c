@@ -18,32 +18,38 @@
 #include "bta_hh.h"
 #include <controllers.h>
 #include <info_store.h>
+#include <trace.h>
+#include <capture.h>
 
 tBTA_HH_CB* bta_hh_cb = (tBTA_HH_CB*) 0x1214d718;
 
 void (*const real_bta_hh_event)(uint8_t event, void *p_data) = (void*) 0x11f405ac;
 void bta_hh_event(uint8_t event, void *p_data)
 {
-    DEBUG_PRINT("bta_hh_event called %u %p\n", event, p_data);
+    TRACE(BLOOPAIR_TRACE_EVENT_HH_EVENT, BTA_HH_INVALID_HANDLE, event, (uintptr_t) p_data);
 
     switch (event) {
     case BTA_HH_OPEN_EVT: {
         tBTA_HH_CONN* conn_data = (tBTA_HH_CONN*) p_data;
-        DEBUG_PRINT("open event for handle %u\n", conn_data->handle);
 
         // initialize the controller
         if (conn_data->handle != BTA_HH_INVALID_HANDLE) {
-            if (initController(conn_data->bda, conn_data->handle) != 0) {
+            int res = initController(conn_data->bda, conn_data->handle);
+            TRACE(BLOOPAIR_TRACE_EVENT_HH_OPEN, conn_data->handle, conn_data->status, res);
+            if (res != 0) {
                 // close connection on failure
                 BTA_HhClose(conn_data->handle);
                 return;
             }
+
+            CAPTURE_CONNECT(conn_data->handle);
         }
         break;
     }
     case BTA_HH_CLOSE_EVT: {
         tBTA_HH_CBDATA* cb_data = (tBTA_HH_CBDATA*) p_data;
-        DEBUG_PRINT("close event handle %u status %x\n", cb_data->handle, cb_data->status);
+        TRACE(BLOOPAIR_TRACE_EVENT_HH_CLOSE, cb_data->handle, cb_data->status, 0);
+        CAPTURE(cb_data->handle, BLOOPAIR_CAPTURE_TYPE_DISCONNECT, NULL, 0);
 
         // deinit the controller if it was initialized
         if (cb_data->handle != BTA_HH_INVALID_HANDLE) {
@@ -60,10 +66,26 @@ void bta_hh_event(uint8_t event, void *p_data)
         }
         break;
     }
+    case BTA_HH_GET_RPT_EVT: {
+        tBTA_HH_HSDATA* hs_data = (tBTA_HH_HSDATA*) p_data;
+
+        // reports requested by the drivers are handled here and don't need to go any further
+        if (hs_data->handle < BTA_HH_MAX_KNOWN) {
+            Controller* controller = &controllers[hs_data->handle];
+            if (controller->isInitialized && controller->getReportResponse) {
+                BT_HDR* p_buf = hs_data->rsp_data.p_rpt_data;
+                if (hs_data->status == BTA_HH_OK && p_buf) {
+                    controller->getReportResponse(controller, (uint8_t*) (p_buf + 1) + p_buf->offset, p_buf->len);
+                }
+                return;
+            }
+        }
+        break;
+    }
     // TODO can this be removed?
     case BTA_HH_VC_UNPLUG_EVT: {
         tBTA_HH_CBDATA* cb_data = (tBTA_HH_CBDATA*) p_data;
-        DEBUG_PRINT("vc unplug %u\n", cb_data->handle);
+        TRACE(BLOOPAIR_TRACE_EVENT_HH_VC_UNPLUG, cb_data->handle, 0, 0);
 
         // disconnect virtually unplugged devices
         if (cb_data->handle != BTA_HH_INVALID_HANDLE) {
@@ -19,6 +19,7 @@
 #include "bt_api.h"
 #include <controllers.h>
 #include <info_store.h>
+#include <device_registry.h>
 
 void bta_hh_sm_execute(tBTA_HH_DEV_CB *p_cb, uint16_t event, void * p_data);
 void bta_hh_start_sdp(tBTA_HH_DEV_CB *p_cb, void *p_data);
@@ -49,13 +50,7 @@ void name_read_cback(tBTM_REMOTE_DEV_NAME* name)
         info = store_allocate_device_info(bta_hh_cb->p_cur->addr);
     }
 
-    if (isOfficialName((const char*) name->remote_bd_name)) {
-        info->magic = MAGIC_OFFICIAL;
-    } else if (isSwitchControllerName((const char*) name->remote_bd_name)) {
-        info->magic = MAGIC_SWITCH;
-    } else {
-        info->magic = MAGIC_BLOOPAIR;
-    }
+    info->magic = DeviceRegistry_GetMagicForName((const char*) name->remote_bd_name);
 
     // continue with getting the sdp record
     if (HID_HostGetSDPRecord(bta_hh_cb->p_cur->addr, bta_hh_cb->p_disc_db, sdp_db_size, bta_hh_sdp_cback) != 0) {
@@ -106,7 +101,7 @@ void name_read_cback_open(tBTM_REMOTE_DEV_NAME* name)
             info = store_allocate_device_info(bta_hh_cb->p_cur->addr);
         }
 
-        if (isOfficialName((const char*) name->remote_bd_name)) {
+        if (DeviceRegistry_GetMagicForName((const char*) name->remote_bd_name) == MAGIC_OFFICIAL) {
             info->magic = MAGIC_OFFICIAL;
         } else {
             info->magic = MAGIC_BLOOPAIR;
@@ -17,6 +17,8 @@
 
 #include <imports.h>
 #include "controllers.h"
+#include "device_registry.h"
+#include "info_store.h"
 
 #define PRO_CONTROLLER_NAME "Nintendo RVL-CNT-01-UC"
 
@@ -28,7 +30,7 @@ void bta_search_callback(uint8_t event, void *p_data)
     switch (event) {
     case BTA_DM_DISC_RES_EVT: {
         tBTA_DM_DISC_RES* res = (tBTA_DM_DISC_RES*) p_data;
-        if (res->result == 0 && !isOfficialName((const char*) res->bd_name)) {
+        if (res->result == 0 && DeviceRegistry_GetMagicForName((const char*) res->bd_name) != MAGIC_OFFICIAL) {
             DEBUG_PRINT("%s is non official, replacing name...\n", res->bd_name);
             // replace device name
             memcpy(res->bd_name, PRO_CONTROLLER_NAME, sizeof(PRO_CONTROLLER_NAME));
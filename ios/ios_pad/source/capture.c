@@ -0,0 +1,166 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "capture.h"
+#include "controllers.h"
+
+#ifdef BLOOPAIR_CAPTURE
+
+uint8_t* captureBuffer = NULL;
+
+// Both of these only ever increase, the buffer offset is the lower bits
+static uint32_t captureWritePos = 0;
+static uint32_t captureReadPos = 0;
+static uint32_t captureLost = 0;
+
+// Records can come from the bt thread and the report thread, the reader is the ipc thread
+static int captureSemaphore = -1;
+
+static void captureWrite(const void* data, uint32_t size)
+{
+    uint32_t offset = captureWritePos & (CAPTURE_BUFFER_SIZE - 1);
+    uint32_t first = CAPTURE_BUFFER_SIZE - offset;
+    if (first > size) {
+        first = size;
+    }
+
+    memcpy(captureBuffer + offset, data, first);
+    memcpy(captureBuffer, (const uint8_t*) data + first, size - first);
+    captureWritePos += size;
+}
+
+static void captureRecordLocked(uint8_t handle, uint8_t type, const void* data, uint16_t len)
+{
+    if (CAPTURE_BUFFER_SIZE - (captureWritePos - captureReadPos) < sizeof(BloopairCaptureRecordHeader) + len) {
+        captureLost++;
+        return;
+    }
+
+    uint64_t time;
+    IOS_GetUpTime64(&time);
+
+    BloopairCaptureRecordHeader header;
+    header.timestamp = (uint32_t) time;
+    header.handle = handle;
+    header.type = type;
+    header.length = len;
+
+    captureWrite(&header, sizeof(header));
+    captureWrite(data, len);
+}
+
+static void captureConnectLocked(uint8_t handle)
+{
+    Controller* controller = &controllers[handle];
+
+    BloopairCaptureConnectInfo info;
+    info.controllerType = controller->type;
+    info.reserved = 0;
+    info.vendor_id = controller->vendor_id;
+    info.product_id = controller->product_id;
+    memcpy(info.bd_address, controller->bda, 6);
+
+    captureRecordLocked(handle, BLOOPAIR_CAPTURE_TYPE_CONNECT, &info, sizeof(info));
+}
+
+void captureRecord(uint8_t handle, uint8_t type, const void* data, uint16_t len)
+{
+    IOS_WaitSemaphore(captureSemaphore, 0);
+
+    // capture might've been stopped while we were waiting
+    if (captureBuffer) {
+        captureRecordLocked(handle, type, data, len);
+    }
+
+    IOS_SignalSemaphore(captureSemaphore);
+}
+
+void captureConnect(uint8_t handle)
+{
+    IOS_WaitSemaphore(captureSemaphore, 0);
+
+    if (captureBuffer) {
+        captureConnectLocked(handle);
+    }
+
+    IOS_SignalSemaphore(captureSemaphore);
+}
+
+int captureRead(uint32_t enable, BloopairCaptureData* out, uint32_t maxSize)
+{
+    if (captureSemaphore < 0) {
+        captureSemaphore = IOS_CreateSemaphore(1, 1);
+        if (captureSemaphore < 0) {
+            return -22;
+        }
+    }
+
+    IOS_WaitSemaphore(captureSemaphore, 0);
+
+    if (enable && !captureBuffer) {
+        captureBuffer = IOS_Alloc(LOCAL_PROCESS_HEAP_ID, CAPTURE_BUFFER_SIZE);
+        if (!captureBuffer) {
+            IOS_SignalSemaphore(captureSemaphore);
+            return -22;
+        }
+
+        captureWritePos = 0;
+        captureReadPos = 0;
+        captureLost = 0;
+
+        // Let the capture know about controllers which are already connected
+        for (int i = 0; i < BTA_HH_MAX_KNOWN; i++) {
+            if (controllers[i].isInitialized) {
+                captureConnectLocked(i);
+            }
+        }
+    }
+
+    uint32_t size = 0;
+    if (captureBuffer) {
+        size = captureWritePos - captureReadPos;
+        if (size > maxSize) {
+            size = maxSize;
+        }
+
+        uint32_t offset = captureReadPos & (CAPTURE_BUFFER_SIZE - 1);
+        uint32_t first = CAPTURE_BUFFER_SIZE - offset;
+        if (first > size) {
+            first = size;
+        }
+
+        memcpy(out->data, captureBuffer + offset, first);
+        memcpy(out->data + first, captureBuffer, size - first);
+        captureReadPos += size;
+    }
+
+    out->numLost = captureLost;
+    out->size = size;
+    captureLost = 0;
+
+    // Stop capturing, anything which hasn't been drained yet is discarded
+    if (!enable && captureBuffer) {
+        IOS_Free(LOCAL_PROCESS_HEAP_ID, captureBuffer);
+        captureBuffer = NULL;
+    }
+
+    IOS_SignalSemaphore(captureSemaphore);
+
+    return sizeof(BloopairCaptureData) + size;
+}
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <imports.h>
+#include <bloopair/capture.h>
+
+#ifdef BLOOPAIR_CAPTURE
+
+// Must be a power of two, only allocated while capturing
+#define CAPTURE_BUFFER_SIZE 0x4000
+
+extern uint8_t* captureBuffer;
+
+void captureRecord(uint8_t handle, uint8_t type, const void* data, uint16_t len);
+
+void captureConnect(uint8_t handle);
+
+// Starts / stops capturing and drains up to maxSize bytes into out, returns the amount of bytes written
+int captureRead(uint32_t enable, BloopairCaptureData* out, uint32_t maxSize);
+
+#define CAPTURE(handle, type, data, len) \
+    do { \
+        if (captureBuffer) { \
+            captureRecord(handle, type, data, len); \
+        } \
+    } while (0)
+
+#define CAPTURE_CONNECT(handle) \
+    do { \
+        if (captureBuffer) { \
+            captureConnect(handle); \
+        } \
+    } while (0)
+
+#else
+
+#define CAPTURE(handle, type, data, len)
+#define CAPTURE_CONNECT(handle)
+
+#endif
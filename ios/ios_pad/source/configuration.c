@@ -17,6 +17,7 @@
 #include "configuration.h"
 #include "imports.h"
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 
 void controllerModuleInit_switch(void);
@@ -24,15 +25,27 @@ void controllerModuleInit_xbox_one(void);
 void controllerModuleInit_dualsense(void);
 void controllerModuleInit_dualshock4(void);
 void controllerModuleInit_dualshock3(void);
+void controllerModuleInit_generic(void);
 
 static int configuration_initialized = 0;
 
 static ConfigurationEntry* first_fallback_entry = NULL;
-static ConfigurationEntry* first_controller_type_entry = NULL;
-static ConfigurationEntry* first_bda_entry = NULL;
+
+// The global profile holds the configurations which aren't tied to a title
+static ConfigurationProfile global_profile = { 0 };
+static ConfigurationProfile* first_title_profile = NULL;
+
+// Profile modified by the apply functions of the ipc
+static ConfigurationProfile* edit_profile = &global_profile;
+// Title profile which is layered over the global one, NULL if the running title has none
+static ConfigurationProfile* active_profile = NULL;
+
+volatile uint32_t configurationGeneration = 0;
 
 static const BloopairCommonConfiguration default_common_configuration = {
     .stickAsButtonDeadzone = 500,
+    .triggerThreshold = 256,
+    .triggerHysteresis = 64,
 };
 
 int Configuration_Init(void)
@@ -47,6 +60,7 @@ int Configuration_Init(void)
     controllerModuleInit_dualsense();
     controllerModuleInit_dualshock4();
     controllerModuleInit_dualshock3();
+    controllerModuleInit_generic();
 
     return 0;
 }
@@ -99,20 +113,38 @@ ConfigurationEntry* Configuration_GetFallback(BloopairControllerType type, uint8
     return entry;
 }
 
-ConfigurationEntry* Configuration_GetForControllerType(BloopairControllerType type, uint8_t allocateIfMissing)
+static ConfigurationEntry* _Configuration_FindForControllerType(ConfigurationProfile* profile, BloopairControllerType type)
 {
     ConfigurationEntry* entry;
-
-    // Search for a matching entry
-    for (entry = first_controller_type_entry; entry; entry = entry->next) {
+    for (entry = profile->first_controller_type_entry; entry; entry = entry->next) {
         if (entry->filter.type == type) {
             break;
         }
     }
 
+    return entry;
+}
+
+static ConfigurationEntry* _Configuration_FindForBDA(ConfigurationProfile* profile, uint8_t* bda)
+{
+    ConfigurationEntry* entry;
+    for (entry = profile->first_bda_entry; entry; entry = entry->next) {
+        if (memcmp(entry->filter.bda, bda, sizeof(entry->filter.bda)) == 0) {
+            break;
+        }
+    }
+
+    return entry;
+}
+
+ConfigurationEntry* Configuration_GetForControllerType(BloopairControllerType type, uint8_t allocateIfMissing)
+{
+    // Search for a matching entry
+    ConfigurationEntry* entry = _Configuration_FindForControllerType(edit_profile, type);
+
     // Allocate a new one if it doesn't exist
     if (!entry && allocateIfMissing) {
-        entry = _Configuration_AddNew(&first_controller_type_entry);
+        entry = _Configuration_AddNew(&edit_profile->first_controller_type_entry);
         if (entry) {
             entry->filter.type = type;
         }
@@ -123,18 +155,12 @@ ConfigurationEntry* Configuration_GetForControllerType(BloopairControllerType ty
 
 ConfigurationEntry* Configuration_GetForBDA(uint8_t* bda, uint8_t allocateIfMissing)
 {
-    ConfigurationEntry* entry;
-
     // Search for a matching entry
-    for (entry = first_bda_entry; entry; entry = entry->next) {
-        if (memcmp(entry->filter.bda, bda, sizeof(entry->filter.bda)) == 0) {
-            break;
-        }
-    }
+    ConfigurationEntry* entry = _Configuration_FindForBDA(edit_profile, bda);
 
     // Allocate a new one if it doesn't exist
     if (!entry && allocateIfMissing) {
-        entry = _Configuration_AddNew(&first_bda_entry);
+        entry = _Configuration_AddNew(&edit_profile->first_bda_entry);
         if (entry) {
             memcpy(entry->filter.bda, bda, sizeof(entry->filter.bda));
         }
@@ -143,21 +169,94 @@ ConfigurationEntry* Configuration_GetForBDA(uint8_t* bda, uint8_t allocateIfMiss
     return entry;
 }
 
-BloopairCommonConfiguration* Configuration_GetCommon(BloopairControllerType type, uint8_t* bda)
+static ConfigurationProfile* _Configuration_FindProfile(uint64_t titleId)
+{
+    ConfigurationProfile* profile;
+    for (profile = first_title_profile; profile; profile = profile->next) {
+        if (profile->titleId == titleId) {
+            break;
+        }
+    }
+
+    return profile;
+}
+
+int Configuration_SetEditProfile(uint64_t titleId)
 {
+    if (titleId == 0) {
+        edit_profile = &global_profile;
+        return 0;
+    }
+
+    ConfigurationProfile* profile = _Configuration_FindProfile(titleId);
+    if (!profile) {
+        profile = IOS_Alloc(LOCAL_PROCESS_HEAP_ID, sizeof(*profile));
+        if (!profile) {
+            return -1;
+        }
+
+        memset(profile, 0, sizeof(*profile));
+        profile->titleId = titleId;
+
+        profile->next = first_title_profile;
+        first_title_profile = profile;
+    }
+
+    edit_profile = profile;
+    return 0;
+}
+
+int Configuration_SelectProfile(uint64_t titleId)
+{
+    ConfigurationProfile* profile = titleId ? _Configuration_FindProfile(titleId) : NULL;
+
+    // Nothing to do if the title uses the same configuration as the last one
+    if (profile == active_profile) {
+        return profile != NULL;
+    }
+
+    active_profile = profile;
+
+    // Let the report thread pick up the new configuration for every controller
+    configurationGeneration++;
+
+    return profile != NULL;
+}
+
+// Looks up the entry with the field at fieldOffset set, the title profile takes priority over the global one
+static ConfigurationEntry* _Configuration_Resolve(BloopairControllerType type, uint8_t* bda, size_t fieldOffset)
+{
+    ConfigurationProfile* profiles[] = { active_profile, &global_profile };
     ConfigurationEntry* entry;
 
-    // First see if we have a BDA config override
-    if (bda) {
-        entry = Configuration_GetForBDA(bda, 0);
-        if (entry && entry->common) {
-            return entry->common;
+    for (int i = 0; i < 2; i++) {
+        ConfigurationProfile* profile = profiles[i];
+        if (!profile) {
+            continue;
+        }
+
+        // First see if we have a BDA config override
+        if (bda) {
+            entry = _Configuration_FindForBDA(profile, bda);
+            if (entry && *(void**) ((uint8_t*) entry + fieldOffset)) {
+                return entry;
+            }
+        }
+
+        // Next see if there's an override for this controller type
+        entry = _Configuration_FindForControllerType(profile, type);
+        if (entry && *(void**) ((uint8_t*) entry + fieldOffset)) {
+            return entry;
         }
     }
 
-    // Next see if there's an override for this controller type
-    entry = Configuration_GetForControllerType(type, 0);
-    if (entry && entry->common) {
+    return NULL;
+}
+
+BloopairCommonConfiguration* Configuration_GetCommon(BloopairControllerType type, uint8_t* bda)
+{
+    ConfigurationEntry* entry = _Configuration_Resolve(type, bda, offsetof(ConfigurationEntry, common));
+    if (entry) {
         return entry->common;
     }
 
@@ -174,19 +273,8 @@ BloopairCommonConfiguration* Configuration_GetCommon(BloopairControllerType type
 
 MappingConfiguration* Configuration_GetMapping(BloopairControllerType type, uint8_t* bda)
 {
-    ConfigurationEntry* entry;
-
-    if (bda) { 
-        // First see if we have a BDA config override
-        entry = Configuration_GetForBDA(bda, 0);
-        if (entry && entry->mapping) {
-            return entry->mapping;
-        }
-    }
-
-    // Next see if there's an override for this controller type
-    entry = Configuration_GetForControllerType(type, 0);
-    if (entry && entry->mapping) {
+    ConfigurationEntry* entry = _Configuration_Resolve(type, bda, offsetof(ConfigurationEntry, mapping));
+    if (entry) {
         return entry->mapping;
     }
 
@@ -199,22 +287,22 @@ MappingConfiguration* Configuration_GetMapping(BloopairControllerType type, uint
     return NULL;
 }
 
-void* Configuration_GetCustom(BloopairControllerType type, uint8_t* bda, uint32_t* outSize)
+ActionConfiguration* Configuration_GetActions(BloopairControllerType type, uint8_t* bda)
 {
-    ConfigurationEntry* entry;
-
-    if (bda) {
-        // First see if we have a BDA config override
-        entry = Configuration_GetForBDA(bda, 0);
-        if (entry && entry->custom) {
-            *outSize = entry->customSize;
-            return entry->custom;
-        }
+    // There are no default actions
+    ConfigurationEntry* entry = _Configuration_Resolve(type, bda, offsetof(ConfigurationEntry, actions));
+    if (entry) {
+        return entry->actions;
     }
 
-    // Next see if there's an override for this controller type
-    entry = Configuration_GetForControllerType(type, 0);
-    if (entry && entry->custom) {
+    return NULL;
+}
+
+void* Configuration_GetCustom(BloopairControllerType type, uint8_t* bda, uint32_t* outSize)
+{
+    ConfigurationEntry* entry = _Configuration_Resolve(type, bda, offsetof(ConfigurationEntry, custom));
+    if (entry) {
+        *outSize = entry->customSize;
         return entry->custom;
     }
 
@@ -228,7 +316,7 @@ void* Configuration_GetCustom(BloopairControllerType type, uint8_t* bda, uint32_
     return NULL;
 }
 
-int Configuration_GetAll(BloopairControllerType type, uint8_t* bda, BloopairCommonConfiguration** outCommon, MappingConfiguration** outMapping, void** outCustom, uint32_t* outCustomSize)
+int Configuration_GetAll(BloopairControllerType type, uint8_t* bda, BloopairCommonConfiguration** outCommon, MappingConfiguration** outMapping, void** outCustom, uint32_t* outCustomSize, ActionConfiguration** outActions)
 {
     // TODO this can be improved further so we don't have to iterate over the configuration multiple times
 
@@ -252,6 +340,76 @@ int Configuration_GetAll(BloopairControllerType type, uint8_t* bda, BloopairComm
     *outMapping = mapping;
     *outCustom = custom;
     *outCustomSize = customSize;
+    *outActions = Configuration_GetActions(type, bda);
+    return 0;
+}
+
+static int isAnalogMappingEntry(const BloopairMappingEntry* e)
+{
+    return (e->from >= BLOOPAIR_PRO_ANALOG_MIN && e->from < BLOOPAIR_PRO_BUTTON_MAX) ||
+        (e->to >= BLOOPAIR_PRO_ANALOG_MIN && e->to < BLOOPAIR_PRO_BUTTON_MAX);
+}
+
+void Configuration_CompileMapping(MappingConfiguration* mapping)
+{
+    // Move all analog trigger entries to the end, keeping the order of the others
+    uint8_t numBasic = 0;
+    for (uint8_t i = 0; i < mapping->num; i++) {
+        BloopairMappingEntry e = mapping->mappings[i];
+        if (isAnalogMappingEntry(&e)) {
+            continue;
+        }
+
+        for (uint8_t j = i; j > numBasic; j--) {
+            mapping->mappings[j] = mapping->mappings[j - 1];
+        }
+        mapping->mappings[numBasic++] = e;
+    }
+
+    mapping->numAnalog = mapping->num - numBasic;
+}
+
+int Configuration_CompileActions(ActionConfiguration* actions)
+{
+    actions->triggerMask = 0;
+
+    for (uint8_t i = 0; i < actions->num; i++) {
+        BloopairActionEntry* a = &actions->actions[i];
+        if (a->type > BLOOPAIR_ACTION_SEQUENCE) {
+            // steps are only valid as part of a sequence
+            return -1;
+        }
+
+        // an action without a trigger would always run
+        if (!a->trigger) {
+            return -1;
+        }
+
+        if (a->type == BLOOPAIR_ACTION_TURBO && !a->param) {
+            a->param = 10;
+        } else if (a->type == BLOOPAIR_ACTION_SEQUENCE) {
+            if (!a->param || a->param >= actions->num - i) {
+                return -1;
+            }
+
+            for (uint8_t j = 1; j <= a->param; j++) {
+                BloopairActionEntry* step = &a[j];
+                if (step->type != BLOOPAIR_ACTION_SEQUENCE_STEP) {
+                    return -1;
+                }
+
+                if (!step->param) {
+                    step->param = 1;
+                }
+            }
+
+            // skip over the steps
+            i += a->param;
+        }
+
+        actions->triggerMask |= a->trigger;
+    }
+
     return 0;
 }
 
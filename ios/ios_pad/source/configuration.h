@@ -21,9 +21,18 @@
 
 typedef struct {
     uint8_t num;
+    // analog trigger entries are at the end of the mappings, so they cost nothing if there are none
+    uint8_t numAnalog;
     BloopairMappingEntry mappings[];
 } MappingConfiguration;
 
+typedef struct {
+    uint8_t num;
+    // triggers of all actions, input which doesn't change any of these doesn't need to look at the actions
+    uint32_t triggerMask;
+    BloopairActionEntry actions[];
+} ActionConfiguration;
+
 typedef struct ConfigurationEntry {
     struct ConfigurationEntry* next;
 
@@ -34,26 +43,55 @@ typedef struct ConfigurationEntry {
 
     BloopairCommonConfiguration* common;
     MappingConfiguration* mapping;
+    ActionConfiguration* actions;
     void* custom;
     uint32_t customSize;
 } ConfigurationEntry;
 
+// A set of configurations, title profiles are layered over the global one while their title is running
+typedef struct ConfigurationProfile {
+    struct ConfigurationProfile* next;
+
+    uint64_t titleId;
+
+    ConfigurationEntry* first_controller_type_entry;
+    ConfigurationEntry* first_bda_entry;
+} ConfigurationProfile;
+
+// Increased every time the active profile changes, controllers compare this to know if they need to look up their configuration again
+extern volatile uint32_t configurationGeneration;
+
 int Configuration_Init(void);
 
 void Configuration_Deinit(void);
 
 ConfigurationEntry* Configuration_GetFallback(BloopairControllerType type, uint8_t allocateIfMissing);
 
+// The entries for controller types and BDAs are taken from the profile selected by Configuration_SetEditProfile
 ConfigurationEntry* Configuration_GetForControllerType(BloopairControllerType type, uint8_t allocateIfMissing);
 
 ConfigurationEntry* Configuration_GetForBDA(uint8_t* bda, uint8_t allocateIfMissing);
 
+// Selects the profile which is modified by the configuration ipc, 0 for the global profile, returns 0 on success
+int Configuration_SetEditProfile(uint64_t titleId);
+
+// Layers the profile of the title over the global one, returns 1 if the title has a profile
+int Configuration_SelectProfile(uint64_t titleId);
+
 BloopairCommonConfiguration* Configuration_GetCommon(BloopairControllerType type, uint8_t* bda);
 
 MappingConfiguration* Configuration_GetMapping(BloopairControllerType type, uint8_t* bda);
 
+ActionConfiguration* Configuration_GetActions(BloopairControllerType type, uint8_t* bda);
+
 void* Configuration_GetCustom(BloopairControllerType type, uint8_t* bda, uint32_t* outSize);
 
-int Configuration_GetAll(BloopairControllerType type, uint8_t* bda, BloopairCommonConfiguration** outCommon, MappingConfiguration** outMapping, void** outCustom, uint32_t* outCustomSize);
+int Configuration_GetAll(BloopairControllerType type, uint8_t* bda, BloopairCommonConfiguration** outCommon, MappingConfiguration** outMapping, void** outCustom, uint32_t* outCustomSize, ActionConfiguration** outActions);
+
+// Prepares a mapping received from the loader for mapping input
+void Configuration_CompileMapping(MappingConfiguration* mapping);
+
+// Validates actions received from the loader and prepares them for the report thread, returns 0 on success
+int Configuration_CompileActions(ActionConfiguration* actions);
 
 void Configuration_SetFallback(BloopairControllerType type, const BloopairCommonConfiguration* common, const MappingConfiguration* mapping, const void* custom, uint32_t customSize);
@@ -18,6 +18,8 @@
 #include "controllers.h"
 #include "utils.h"
 #include "info_store.h"
+#include "device_registry.h"
+#include "controllers/joycon_combiner.h"
 
 #define WPAD_PRO_AXIS_BASE            0x800
 #define WPAD_PRO_AXIS_NORMALIZE_VALUE 1140
@@ -34,6 +36,96 @@ static void* report_thread_stack_base;
 static int report_thread_id;
 static uint8_t report_thread_running = 0;
 
+// The raw report is accumulated on the bt thread and read on the ipc thread
+static int rawReportSemaphore = -1;
+
+static void resolveControllerQuirks(Controller* controller, const BloopairCommonConfiguration* common)
+{
+    // Configuration for the bda or controller type can add quirks and override the hint
+    uint32_t reportInterval = controller->deviceReportInterval;
+    if (common->reportInterval) {
+        reportInterval = common->reportInterval;
+    }
+
+    controller->quirks = controller->deviceQuirks | common->quirks;
+    controller->reportInterval = reportInterval / (REPORT_INTERVAL / 1000);
+}
+
+// Quirks which are handled the same way for all drivers
+static void applyControllerQuirks(Controller* controller)
+{
+    if (controller->quirks & BLOOPAIR_QUIRK_NO_RUMBLE) {
+        controller->rumble = NULL;
+    }
+
+    if (controller->quirks & BLOOPAIR_QUIRK_NO_LED) {
+        controller->setPlayerLed = NULL;
+    }
+}
+
+static void refreshConfiguration(Controller* controller)
+{
+    controller->configurationGeneration = configurationGeneration;
+
+    // The primary half of a combined controller only uses configurations for the combined type
+    uint8_t* bda = controller->isCombinedPrimary ? NULL : controller->bda;
+
+    // Resolve everything first, so the controller never mixes configurations of different profiles
+    BloopairCommonConfiguration* common;
+    MappingConfiguration* mapping;
+    void* custom;
+    uint32_t customSize;
+    ActionConfiguration* actions;
+    if (Configuration_GetAll(controller->type, bda, &common, &mapping, &custom, &customSize, &actions) != 0) {
+        return;
+    }
+
+    controller->commonConfig = common;
+    controller->mapping = mapping;
+    controller->customConfig = custom;
+    controller->customConfigSize = customSize;
+    controller->actions = actions;
+
+    // Driver callbacks which a quirk removed only come back after a reconnect
+    resolveControllerQuirks(controller, common);
+    applyControllerQuirks(controller);
+}
+
+void updateControllers(void)
+{
+    JoyconCombiner_Update();
+
+    for (uint32_t i = 0; i < BTA_HH_MAX_KNOWN; i++) {
+        Controller* controller = &controllers[i];
+        // make sure the controller is initialized
+        if (controller->isInitialized) {
+            // pick up the configuration of a newly selected profile, once the driver has looked up the first one
+            if (controller->configurationGeneration != configurationGeneration && controller->isReady && controller->mapping) {
+                refreshConfiguration(controller);
+            }
+
+            // update the controller
+            if (controller->update) {
+                controller->update(controller);
+            }
+
+            // make sure the controller has the reporting mode set and is ready to send data
+            // the secondary half of a combined controller is sent by its primary half
+            if ((controller->dataReportingMode == WM_REPORT_ID_EXTENSION_DATA_REPORT ||
+                (controller->motionPlusMode && controller->dataReportingMode == WM_REPORT_ID_CORE_ACCEL_EXTENSION_REPORT)) &&
+                controller->isReady && (!controller->combinedPartner || controller->isCombinedPrimary)) {
+                // controllers with a lower report rate don't need their state sent every interval
+                if (++controller->reportTick >= controller->reportInterval) {
+                    controller->reportTick = 0;
+
+                    // send the current state
+                    sendControllerInput(controller);
+                }
+            }
+        }
+    }
+}
+
 static int reportThread(void* arg)
 {
     // create a message queue and timer
@@ -46,23 +138,7 @@ static int reportThread(void* arg)
         uint32_t message;
         IOS_ReceiveMessage(queue_id, &message, 0);
 
-        for (uint32_t i = 0; i < BTA_HH_MAX_KNOWN; i++) {
-            Controller* controller = &controllers[i];
-            // make sure the controller is initialized
-            if (controller->isInitialized) {
-                // update the controller
-                if (controller->update) {
-                    controller->update(controller);
-                }
-
-                // make sure the controller has the reporting mode set and is ready to send data
-                if (controller->dataReportingMode == WM_REPORT_ID_EXTENSION_DATA_REPORT && 
-                    controller->isReady) {
-                    // send the current state
-                    sendControllerInput(controller);
-                }
-            }
-        }
+        updateControllers();
     }
 
     IOS_DestroyTimer(timer_id);
@@ -97,33 +173,50 @@ void deinitReportThread(void)
     IOS_Free(LOCAL_PROCESS_HEAP_ID, report_thread_stack_base);
 }
 
-#define COMPARE_NAME(x) (strncmp(name, x, sizeof(x) - 1) == 0)
-int isOfficialName(const char* name)
+void controllerInit_switch(Controller* controller);
+void controllerInit_xbox_one(Controller* controller);
+void controllerInit_dualsense(Controller* controller);
+void controllerInit_dualshock4(Controller* controller);
+void controllerInit_dualshock3(Controller* controller);
+int controllerInit_generic(Controller* controller, const uint8_t* descriptor, uint16_t descriptor_len);
+
+static int isSwitchControllerType(uint8_t type)
 {
-    return COMPARE_NAME("Nintendo RVL-CNT") || // wii remote / pro controller
-           COMPARE_NAME("Nintendo RVL-WBC"); // balance board
+    return type >= BLOOPAIR_CONTROLLER_SWITCH_GENERIC && type <= BLOOPAIR_CONTROLLER_SWITCH_N64;
 }
 
-int isSwitchControllerName(const char* name)
+static void initControllerQuirks(Controller* controller, const BloopairDeviceEntry* entry, uint32_t defaultQuirks, uint8_t type)
 {
-    return COMPARE_NAME("NintendoGamepad") ||
-           COMPARE_NAME("Joy-Con") ||
-           COMPARE_NAME("Pro Controller") ||
-           COMPARE_NAME("Lic Pro Controller") ||
-           COMPARE_NAME("NES Controller") ||
-           COMPARE_NAME("HVC Controller") ||
-           COMPARE_NAME("SNES Controller") ||
-           COMPARE_NAME("N64 Controller") ||
-           COMPARE_NAME("MD/Gen Control Pad") ||
-           COMPARE_NAME("Lic2 Pro Controller");
+    controller->deviceQuirks = entry ? entry->quirks : defaultQuirks;
+    controller->deviceReportInterval = entry ? entry->reportInterval : 0;
+
+    resolveControllerQuirks(controller, Configuration_GetCommon(type, controller->bda));
 }
-#undef COMPARE_NAME
 
-void controllerInit_switch(Controller* controller);
-void controllerInit_xbox_one(Controller* controller);
-void controllerInit_dualsense(Controller* controller);
-void controllerInit_dualshock4(Controller* controller);
-void controllerInit_dualshock3(Controller* controller);
+static int initControllerForType(Controller* controller, uint8_t type)
+{
+    if (isSwitchControllerType(type)) {
+        controllerInit_switch(controller);
+        return 0;
+    }
+
+    switch (type) {
+    case BLOOPAIR_CONTROLLER_XBOX_ONE:
+        controllerInit_xbox_one(controller);
+        return 0;
+    case BLOOPAIR_CONTROLLER_DUALSENSE:
+        controllerInit_dualsense(controller);
+        return 0;
+    case BLOOPAIR_CONTROLLER_DUALSHOCK4:
+        controllerInit_dualshock4(controller);
+        return 0;
+    case BLOOPAIR_CONTROLLER_DUALSHOCK3:
+        controllerInit_dualshock3(controller);
+        return 0;
+    }
+
+    return -1;
+}
 
 int initController(uint8_t* bda, uint8_t handle)
 {
@@ -146,6 +239,11 @@ int initController(uint8_t* bda, uint8_t handle)
     // Make sure the config is initialized at this point
     Configuration_Init();
 
+    // controllers are only initialized on the bt thread, so this can't race
+    if (rawReportSemaphore < 0) {
+        rawReportSemaphore = IOS_CreateSemaphore(1, 1);
+    }
+
     Controller* controller = &controllers[handle];
 
     // if this controller was already initialized, deinitialize it first
@@ -162,6 +260,9 @@ int initController(uint8_t* bda, uint8_t handle)
     memcpy(controller->bda, bda, 6);
     controller->isInitialized = 1;
 
+    // the driver looks up the configuration of the currently selected profile
+    controller->configurationGeneration = configurationGeneration;
+
     controller->vendor_id = vendor_id;
     controller->product_id = product_id;
 
@@ -169,42 +270,38 @@ int initController(uint8_t* bda, uint8_t handle)
         controller->type = BLOOPAIR_CONTROLLER_OFFICIAL;
         return 0;
     } else if (magic == MAGIC_BLOOPAIR) {
-        if ((vendor_id == 0x057e && product_id == 0x2006) || // joycon l
-            (vendor_id == 0x057e && product_id == 0x2007) || // joycon r
-            (vendor_id == 0x057e && product_id == 0x2009) || // switch pro controller
-            (vendor_id == 0x057e && product_id == 0x2017) || // snes controller
-            (vendor_id == 0x057e && product_id == 0x2019) || // n64 controller
-            (vendor_id == 0x057e && product_id == 0x201a)) { // genesis/megadrive controller
+        BloopairDeviceEntry entry;
+        int known = DeviceRegistry_Find(vendor_id, product_id, &entry) == 0;
+        if (known && entry.controllerType != BLOOPAIR_CONTROLLER_GENERIC_HID) {
+            if (isSwitchControllerType(entry.controllerType)) {
+                // switch controllers paired with older bloopair version won't use MAGIC_SWITCH yet
+                info->magic = MAGIC_SWITCH;
+            }
 
-            // switch controllers paired with older bloopair version won't use MAGIC_SWITCH yet
-            info->magic = MAGIC_SWITCH;
+            initControllerQuirks(controller, &entry, 0, entry.controllerType);
+            if (initControllerForType(controller, entry.controllerType) == 0) {
+                applyControllerQuirks(controller);
+                return 0;
+            }
+        }
 
-            controllerInit_switch(controller);
-            return 0;
-        } else if ((vendor_id == 0x045e && product_id == 0x02e0) || // xbox one s controller
-                   (vendor_id == 0x045e && product_id == 0x02fd) || // xbox one s controller
-                   (vendor_id == 0x045e && product_id == 0x0b00) || // xbox one elite controller
-                   (vendor_id == 0x045e && product_id == 0x0b05) || // xbox one elite controller
-                   (vendor_id == 0x045e && product_id == 0x0b0a)) { // xbox one adaptive controller
-            controllerInit_xbox_one(controller);
-            return 0;
-        } else if ((vendor_id == 0x054c && product_id == 0x0ce6) || // dualsense
-                   (vendor_id == 0x054c && product_id == 0x0df2)) { // dualsense edge
-            controllerInit_dualsense(controller);
-            return 0;
-        } else if ((vendor_id == 0x054c && product_id == 0x05c4) || // dualshock 4 v1
-                   (vendor_id == 0x054c && product_id == 0x09cc) || // dualshock 4 v2
-                   (vendor_id == 0x0f0d && product_id == 0x00f6) || // hori onyx
-                   (vendor_id == 0x1532 && product_id == 0x100a) || // razer raiju tournament
-                   (vendor_id == 0x146b && product_id == 0x0d01)) { // nacon ps4
-            controllerInit_dualshock4(controller);
-            return 0;
-        } else if (vendor_id == 0x054c && product_id == 0x0268) { // dualshock 3
-            controllerInit_dualshock3(controller);
+        // try to drive unknown devices using their report descriptor
+        tBTA_HH_DEV_CB* dev_cb = &bta_hh_cb->kdev[bta_hh_cb->cb_index[handle]];
+        initControllerQuirks(controller, known ? &entry : NULL, 0, BLOOPAIR_CONTROLLER_GENERIC_HID);
+        if (dev_cb->dscp_info.dl_len > 0 &&
+            controllerInit_generic(controller, dev_cb->dscp_info.dsc_list, dev_cb->dscp_info.dl_len) == 0) {
+            applyControllerQuirks(controller);
             return 0;
         }
     } else if (magic == MAGIC_SWITCH) {
+        // switch controllers which aren't in the registry are third-party controllers identified by their name,
+        // those keep dropping the first report like official controllers do
+        BloopairDeviceEntry entry;
+        int known = DeviceRegistry_Find(vendor_id, product_id, &entry) == 0;
+        initControllerQuirks(controller, known ? &entry : NULL,
+            BLOOPAIR_QUIRK_DROP_FIRST_REPORT, BLOOPAIR_CONTROLLER_SWITCH_GENERIC);
         controllerInit_switch(controller);
+        applyControllerQuirks(controller);
         return 0;
     }
 
@@ -214,32 +311,280 @@ int initController(uint8_t* bda, uint8_t handle)
     return -1;
 }
 
-void sendControllerInput(Controller* controller)
+// Wii remote core buttons, as they appear in the big endian core button field
+static const struct {
+    uint16_t core;
+    uint32_t pro;
+} core_button_map[] = {
+    { 0x0100, BTN(BLOOPAIR_PRO_BUTTON_LEFT) },
+    { 0x0200, BTN(BLOOPAIR_PRO_BUTTON_RIGHT) },
+    { 0x0400, BTN(BLOOPAIR_PRO_BUTTON_DOWN) },
+    { 0x0800, BTN(BLOOPAIR_PRO_BUTTON_UP) },
+    { 0x1000, BTN(BLOOPAIR_PRO_BUTTON_PLUS) },
+    { 0x0001, BTN(BLOOPAIR_PRO_BUTTON_Y) }, // 2
+    { 0x0002, BTN(BLOOPAIR_PRO_BUTTON_X) }, // 1
+    { 0x0004, BTN(BLOOPAIR_PRO_BUTTON_B) | BTN(BLOOPAIR_PRO_TRIGGER_ZR) },
+    { 0x0008, BTN(BLOOPAIR_PRO_BUTTON_A) },
+    { 0x0010, BTN(BLOOPAIR_PRO_BUTTON_MINUS) },
+    { 0x0080, BTN(BLOOPAIR_PRO_BUTTON_HOME) },
+};
+
+static void sendProInput(Controller* controller, BloopairReportBuffer* repBuf, uint8_t battery, uint8_t isCharging)
 {
-    // map the raw controller input to the wii u pro mapping
-    BloopairReportBuffer repBuf;
-    mapControllerInput(controller, &controller->reportBuffer, &repBuf);
-
     WPADProReport report;
     memset(&report, 0, sizeof(report));
 
     report.report_id = WM_REPORT_ID_EXTENSION_DATA_REPORT;
-    report.data.left_stick_x = bswap16(repBuf.left_stick_x + WPAD_PRO_AXIS_BASE);
-    report.data.right_stick_x = bswap16(repBuf.right_stick_x + WPAD_PRO_AXIS_BASE);
-    report.data.left_stick_y = bswap16(WPAD_PRO_AXIS_BASE - repBuf.left_stick_y);
-    report.data.right_stick_y = bswap16(WPAD_PRO_AXIS_BASE - repBuf.right_stick_y);
+    report.data.left_stick_x = bswap16(repBuf->left_stick_x + WPAD_PRO_AXIS_BASE);
+    report.data.right_stick_x = bswap16(repBuf->right_stick_x + WPAD_PRO_AXIS_BASE);
+    report.data.left_stick_y = bswap16(WPAD_PRO_AXIS_BASE - repBuf->left_stick_y);
+    report.data.right_stick_y = bswap16(WPAD_PRO_AXIS_BASE - repBuf->right_stick_y);
 
     // These bits are all low-active
-    report.data.buttons = ~repBuf.buttons & 0xffff;
-    report.data.stick_buttons = ~(repBuf.buttons >> 16) & 0x3;
-    report.data.usb_connected = report.data.charging = !controller->isCharging;
+    report.data.buttons = ~repBuf->buttons & 0xffff;
+    report.data.stick_buttons = ~(repBuf->buttons >> 16) & 0x3;
+    report.data.usb_connected = report.data.charging = !isCharging;
 
-    report.data.battery = controller->battery;
+    report.data.battery = battery;
 
     wiimoteEncrypt(&controller->cryptoState, &report.data, &report.data, 0, sizeof(report.data));
     sendInputData(controller->handle, &report, sizeof(report));
 }
 
+// Classic Controller buttons in the passthrough layout of extension bytes 4 and 5, up and left are in bytes 0 and 1
+static const struct {
+    uint16_t classic;
+    uint32_t pro;
+} classic_button_map[] = {
+    { 0x8000, BTN(BLOOPAIR_PRO_BUTTON_RIGHT) },
+    { 0x4000, BTN(BLOOPAIR_PRO_BUTTON_DOWN) },
+    { 0x2000, BTN(BLOOPAIR_PRO_TRIGGER_L) },
+    { 0x1000, BTN(BLOOPAIR_PRO_BUTTON_MINUS) },
+    { 0x0800, BTN(BLOOPAIR_PRO_BUTTON_HOME) },
+    { 0x0400, BTN(BLOOPAIR_PRO_BUTTON_PLUS) },
+    { 0x0200, BTN(BLOOPAIR_PRO_TRIGGER_R) },
+    { 0x0080, BTN(BLOOPAIR_PRO_TRIGGER_ZL) },
+    { 0x0040, BTN(BLOOPAIR_PRO_BUTTON_B) },
+    { 0x0020, BTN(BLOOPAIR_PRO_BUTTON_Y) },
+    { 0x0010, BTN(BLOOPAIR_PRO_BUTTON_A) },
+    { 0x0008, BTN(BLOOPAIR_PRO_BUTTON_X) },
+    { 0x0004, BTN(BLOOPAIR_PRO_TRIGGER_ZR) },
+};
+
+static uint8_t classicStickAxis(int16_t value, uint8_t bits)
+{
+    int32_t center = 1 << (bits - 1);
+    return CLAMP(center + value * (center - 1) / WPAD_PRO_AXIS_NORMALIZE_VALUE, 0, (1 << bits) - 1);
+}
+
+static uint8_t classicTrigger(uint16_t value, uint8_t pressed)
+{
+    // controllers without analog triggers only have the button
+    if (value == 0 && pressed) {
+        return 0x1f;
+    }
+
+    return value * 0x1f / BLOOPAIR_TRIGGER_MAX;
+}
+
+// Converts the pro controller state to the 6 bytes of Classic Controller data in MotionPlus passthrough mode.
+// This layout drops the lowest bit of the left stick and has no room for the stick buttons.
+static void proToClassicPassthrough(BloopairReportBuffer* repBuf, uint8_t* out)
+{
+    uint8_t lx = classicStickAxis(repBuf->left_stick_x, 6);
+    uint8_t ly = classicStickAxis(-repBuf->left_stick_y, 6);
+    uint8_t rx = classicStickAxis(repBuf->right_stick_x, 5);
+    uint8_t ry = classicStickAxis(-repBuf->right_stick_y, 5);
+    uint8_t lt = classicTrigger(repBuf->left_trigger, !!(repBuf->buttons & BTN(BLOOPAIR_PRO_TRIGGER_L)));
+    uint8_t rt = classicTrigger(repBuf->right_trigger, !!(repBuf->buttons & BTN(BLOOPAIR_PRO_TRIGGER_R)));
+
+    // The buttons are low-active, the lowest byte 5 bits mark this as extension data
+    uint16_t buttons = 0xfffc;
+    for (uint32_t i = 0; i < ARRAY_SIZE(classic_button_map); i++) {
+        if (repBuf->buttons & classic_button_map[i].pro) {
+            buttons &= ~classic_button_map[i].classic;
+        }
+    }
+
+    out[0] = ((rx >> 3) << 6) | (lx & 0x3e) | !(repBuf->buttons & BTN(BLOOPAIR_PRO_BUTTON_UP));
+    out[1] = (((rx >> 1) & 0x3) << 6) | (ly & 0x3e) | !(repBuf->buttons & BTN(BLOOPAIR_PRO_BUTTON_LEFT));
+    out[2] = ((rx & 0x1) << 7) | ((lt >> 3) << 5) | ry;
+    out[3] = ((lt & 0x7) << 5) | rt;
+    out[4] = buttons >> 8;
+    out[5] = buttons & 0xff;
+}
+
+static void sendMotionPlusInput(Controller* controller, BloopairReportBuffer* repBuf)
+{
+    WPADMotionPlusReport report;
+    memset(&report, 0, sizeof(report));
+
+    report.report_id = WM_REPORT_ID_CORE_ACCEL_EXTENSION_REPORT;
+
+    // Without passthrough the extension slot is taken, so buttons can only be sent as core buttons.
+    // With passthrough they're sent as Classic Controller buttons, which shouldn't show up twice.
+    uint16_t buttons = 0;
+    if (controller->motionPlusMode != MPLS_MODE_CLASSIC_PASSTHROUGH) {
+        for (uint32_t i = 0; i < ARRAY_SIZE(core_button_map); i++) {
+            if (repBuf->buttons & core_button_map[i].pro) {
+                buttons |= core_button_map[i].core;
+            }
+        }
+    }
+
+    uint16_t accel[3];
+    motionToCoreAccel(&controller->motion, accel);
+    report.accel[0] = accel[0] >> 2;
+    report.accel[1] = accel[1] >> 2;
+    report.accel[2] = accel[2] >> 2;
+    buttons |= (accel[0] & 0x3) << 13;
+    buttons |= ((accel[1] >> 1) & 0x1) << 5;
+    buttons |= ((accel[2] >> 1) & 0x1) << 6;
+    report.core_buttons = buttons;
+
+    if (controller->motionPlusMode == MPLS_MODE_CLASSIC_PASSTHROUGH) {
+        // every other report carries the sticks and buttons as a Classic Controller connected to the MotionPlus
+        controller->motionPlusExtensionFrame = !controller->motionPlusExtensionFrame;
+        if (controller->motionPlusExtensionFrame) {
+            proToClassicPassthrough(repBuf, report.extension);
+        } else {
+            motionToMotionPlus(&controller->motion, report.extension);
+            // the extension is always connected to the passthrough port
+            report.extension[5] |= 0x1;
+        }
+    } else {
+        motionToMotionPlus(&controller->motion, report.extension);
+    }
+
+    // MotionPlus and passthrough data isn't encrypted
+    sendInputData(controller->handle, &report, sizeof(report));
+}
+
+static int16_t extremeAxis(int16_t a, int16_t b)
+{
+    return ABS(b) > ABS(a) ? b : a;
+}
+
+void accumulateRawReport(Controller* controller)
+{
+    // only do the work while someone reads it, a reader which just started might miss this one report
+    if (!controller->rawAccumulate) {
+        return;
+    }
+
+    BloopairReportBuffer* rep = &controller->reportBuffer;
+    BloopairReportBuffer* acc = &controller->rawAccumulated;
+
+    IOS_WaitSemaphore(rawReportSemaphore, 0);
+
+    // keep every button which was pressed and the largest stick and trigger values
+    acc->buttons |= rep->buttons;
+    acc->left_stick_x = extremeAxis(acc->left_stick_x, rep->left_stick_x);
+    acc->left_stick_y = extremeAxis(acc->left_stick_y, rep->left_stick_y);
+    acc->right_stick_x = extremeAxis(acc->right_stick_x, rep->right_stick_x);
+    acc->right_stick_y = extremeAxis(acc->right_stick_y, rep->right_stick_y);
+    acc->left_trigger = MAX(acc->left_trigger, rep->left_trigger);
+    acc->right_trigger = MAX(acc->right_trigger, rep->right_trigger);
+
+    // the report buffer belongs to the bt thread, the reader only ever looks at this copy
+    controller->rawLatest = *rep;
+
+    IOS_SignalSemaphore(rawReportSemaphore);
+}
+
+void readAccumulatedRawReport(Controller* controller, uint8_t enable, BloopairReportBuffer* out)
+{
+    IOS_WaitSemaphore(rawReportSemaphore, 0);
+
+    if (!controller->rawAccumulate) {
+        // nothing was accumulated yet, so start out with the current report like BLOOPAIR_FUNC_READ_RAW_REPORT
+        controller->rawLatest = controller->reportBuffer;
+        controller->rawAccumulated = controller->rawLatest;
+    }
+
+    *out = controller->rawAccumulated;
+
+    // the next read starts out with the current state
+    controller->rawAccumulated = controller->rawLatest;
+    controller->rawAccumulate = enable;
+
+    IOS_SignalSemaphore(rawReportSemaphore);
+}
+
+void recordControllerReport(Controller* controller)
+{
+    controller->stats.numReceived++;
+
+    // latency is measured from the first report which arrived since the last send
+    if (!controller->stats.pendingTime) {
+        IOS_GetUpTime64(&controller->stats.pendingTime);
+    }
+}
+
+void recordControllerSent(Controller* controller)
+{
+    ControllerStatistics* stats = &controller->stats;
+    stats->numSent++;
+
+    // the primary half of a combined controller also sends the input of the other half
+    uint64_t pendingTime = stats->pendingTime;
+    Controller* partner = JoyconCombiner_GetPartner(controller);
+    if (partner && partner->stats.pendingTime) {
+        if (!pendingTime || partner->stats.pendingTime < pendingTime) {
+            pendingTime = partner->stats.pendingTime;
+        }
+        partner->stats.pendingTime = 0;
+    }
+
+    if (!pendingTime) {
+        return;
+    }
+    stats->pendingTime = 0;
+
+    uint64_t now;
+    IOS_GetUpTime64(&now);
+
+    uint32_t latency = (uint32_t) (now - pendingTime);
+    stats->latencyTotal += latency;
+    stats->latencyCount++;
+    stats->latencyMax = MAX(stats->latencyMax, latency);
+}
+
+void sendControllerInput(Controller* controller)
+{
+    BloopairReportBuffer* input = &controller->reportBuffer;
+    uint8_t battery = controller->battery;
+    uint8_t isCharging = controller->isCharging;
+
+    // merge the input of both halves for combined controllers
+    BloopairReportBuffer combined;
+    Controller* partner = JoyconCombiner_GetPartner(controller);
+    if (partner) {
+        JoyconCombiner_MergeInput(controller, partner, &combined);
+        input = &combined;
+
+        battery = MIN(battery, partner->battery);
+        isCharging = isCharging && partner->isCharging;
+    }
+
+    // map the raw controller input to the wii u pro mapping
+    BloopairReportBuffer repBuf;
+    mapControllerInput(controller, input, &repBuf);
+
+    // actions work on the mapped buttons and run every interval the report is sent
+    if (controller->actions) {
+        Actions_Apply(&controller->actionState, controller->actions, &repBuf.buttons, MAX(controller->reportInterval, 1));
+    }
+
+    if (controller->dataReportingMode == WM_REPORT_ID_CORE_ACCEL_EXTENSION_REPORT) {
+        sendMotionPlusInput(controller, &repBuf);
+    } else {
+        sendProInput(controller, &repBuf, battery, isCharging);
+    }
+
+    recordControllerSent(controller);
+}
+
 static int16_t getStickAxis(BloopairReportBuffer* in, uint8_t from)
 {
     int16_t axis = 0;
@@ -308,6 +653,71 @@ static void setStickAxis(BloopairReportBuffer* out, uint8_t to, int16_t value)
 #undef SET_STICK
 }
 
+static int isTriggerPressed(Controller* controller, uint8_t latch, uint16_t value)
+{
+    const BloopairCommonConfiguration* common = controller->commonConfig;
+
+    // A pressed trigger needs to be released a bit further, so it doesn't flicker around the threshold
+    if (controller->triggerLatch & latch) {
+        if ((int32_t) value < (int32_t) common->triggerThreshold - common->triggerHysteresis) {
+            controller->triggerLatch &= ~latch;
+        }
+    } else if (value >= common->triggerThreshold) {
+        controller->triggerLatch |= latch;
+    }
+
+    return !!(controller->triggerLatch & latch);
+}
+
+static void setTrigger(BloopairReportBuffer* out, uint8_t to, uint16_t value)
+{
+    if (to == BLOOPAIR_PRO_ANALOG_TRIGGER_L) {
+        out->left_trigger = MAX(out->left_trigger, value);
+    } else {
+        out->right_trigger = MAX(out->right_trigger, value);
+    }
+}
+
+static void mapAnalogInput(Controller* controller, BloopairReportBuffer* in, BloopairReportBuffer* out, const BloopairMappingEntry* entries, uint8_t num)
+{
+    // evaluate each input trigger once, no matter how many buttons it's mapped to
+    uint8_t pressedL = isTriggerPressed(controller, CONTROLLER_TRIGGER_LATCH_IN_L, in->left_trigger);
+    uint8_t pressedR = isTriggerPressed(controller, CONTROLLER_TRIGGER_LATCH_IN_R, in->right_trigger);
+
+    for (uint8_t i = 0; i < num; i++) {
+        const BloopairMappingEntry* e = &entries[i];
+        if (e->from >= BLOOPAIR_PRO_ANALOG_MIN) {
+            uint16_t value = (e->from == BLOOPAIR_PRO_ANALOG_TRIGGER_L) ? in->left_trigger : in->right_trigger;
+            if (e->to >= BLOOPAIR_PRO_ANALOG_MIN) {
+                // map trigger to trigger
+                setTrigger(out, e->to, value);
+            } else if (e->to >= BLOOPAIR_PRO_STICK_MIN) {
+                // map trigger to stick
+                setStickAxis(out, e->to, value * WPAD_PRO_AXIS_NORMALIZE_VALUE / BLOOPAIR_TRIGGER_MAX);
+            } else {
+                // map trigger to button
+                if ((e->from == BLOOPAIR_PRO_ANALOG_TRIGGER_L) ? pressedL : pressedR) {
+                    out->buttons |= BTN(e->to);
+                }
+            }
+        } else if (e->from >= BLOOPAIR_PRO_STICK_MIN) {
+            // map stick to trigger
+            setTrigger(out, e->to, getStickAxis(in, e->from) * BLOOPAIR_TRIGGER_MAX / WPAD_PRO_AXIS_NORMALIZE_VALUE);
+        } else if (in->buttons & BTN(e->from)) {
+            // map button to trigger
+            setTrigger(out, e->to, BLOOPAIR_TRIGGER_MAX);
+        }
+    }
+
+    // the pro controller only has digital triggers
+    if (isTriggerPressed(controller, CONTROLLER_TRIGGER_LATCH_OUT_L, out->left_trigger)) {
+        out->buttons |= BTN(BLOOPAIR_PRO_TRIGGER_ZL);
+    }
+    if (isTriggerPressed(controller, CONTROLLER_TRIGGER_LATCH_OUT_R, out->right_trigger)) {
+        out->buttons |= BTN(BLOOPAIR_PRO_TRIGGER_ZR);
+    }
+}
+
 void mapControllerInput(Controller* controller, BloopairReportBuffer* in, BloopairReportBuffer* out)
 {
     memset(out, 0, sizeof(*out));
@@ -318,7 +728,8 @@ void mapControllerInput(Controller* controller, BloopairReportBuffer* in, Bloopa
         return;
     }
 
-    for (uint8_t i = 0; i < mapping->num; i++) {
+    uint8_t numBasic = mapping->num - mapping->numAnalog;
+    for (uint8_t i = 0; i < numBasic; i++) {
         const BloopairMappingEntry* e = &mapping->mappings[i];
         if (e->from >= BLOOPAIR_PRO_STICK_MIN) {
             if (e->to >= BLOOPAIR_PRO_STICK_MIN) {
@@ -342,6 +753,10 @@ void mapControllerInput(Controller* controller, BloopairReportBuffer* in, Bloopa
             }
         }
     }
+
+    if (mapping->numAnalog) {
+        mapAnalogInput(controller, in, out, &mapping->mappings[numBasic], mapping->numAnalog);
+    }
 }
 
 uint8_t ledMaskToPlayerNum(uint8_t mask)
@@ -368,3 +783,8 @@ int16_t remapStickAxis(int32_t val, int32_t valMin, int32_t valMax)
 {
     return (int16_t) SCALE(val, valMin, valMax, -WPAD_PRO_AXIS_NORMALIZE_VALUE, WPAD_PRO_AXIS_NORMALIZE_VALUE);
 }
+
+uint16_t scaleTriggerAxis(uint32_t val, uint32_t range)
+{
+    return (uint16_t) (MIN(val, range - 1) * BLOOPAIR_TRIGGER_MAX / (range - 1));
+}
@@ -22,7 +22,10 @@
 #include "bta/bta_hh.h"
 #include "wiimote_crypto.h"
 #include "configuration.h"
+#include "motion.h"
+#include "actions.h"
 #include <bloopair/controllers/common.h>
+#include <bloopair/devices.h>
 
 // Information about button bits and the report can be found here:
 // - <https://github.com/devkitPro/wut/blob/master/include/padscore/wpad.h>
@@ -45,6 +48,38 @@ typedef struct PACKED {
 } WPADProReport;
 CHECK_SIZE(WPADProReport, 22);
 
+typedef struct PACKED {
+    uint8_t report_id;
+    // the lower bits of the accelerometer are stored in unused button bits
+    uint16_t core_buttons;
+    uint8_t accel[3];
+    uint8_t extension[16];
+} WPADMotionPlusReport;
+CHECK_SIZE(WPADMotionPlusReport, 22);
+
+enum {
+    CONTROLLER_TRIGGER_LATCH_IN_L   = 1 << 0,
+    CONTROLLER_TRIGGER_LATCH_IN_R   = 1 << 1,
+    CONTROLLER_TRIGGER_LATCH_OUT_L  = 1 << 2,
+    CONTROLLER_TRIGGER_LATCH_OUT_R  = 1 << 3,
+};
+
+// input statistics which can be read with BLOOPAIR_FUNC_GET_CONTROLLER_STATISTICS
+// these are updated from both the hid and the report thread without locking, they are only informational
+typedef struct {
+    uint32_t numReceived;
+    uint32_t numSent;
+    // uptime of the oldest received report which hasn't been sent yet, 0 if there is none
+    uint64_t pendingTime;
+    uint32_t latencyTotal;
+    uint32_t latencyCount;
+    uint32_t latencyMax;
+} ControllerStatistics;
+
+// MotionPlus modes which can be activated, the mode also ends up in the extension id
+#define MPLS_MODE_ONLY                  0x04
+#define MPLS_MODE_CLASSIC_PASSTHROUGH   0x07
+
 typedef struct Controller Controller;
 
 typedef void (*ControllerDeinitFn)(Controller* controller);
@@ -76,6 +111,8 @@ struct Controller {
     ControllerDeinitFn deinit;
     // called when hid data is received
     ControllerDataFn data;
+    // called with the response to a getReport request
+    ControllerDataFn getReportResponse;
     // called to set the player led
     ControllerSetPlayerLedFn setPlayerLed;
     // called when rumble state changes
@@ -90,8 +127,17 @@ struct Controller {
     uint8_t isCharging;
     // report data for continuous reports
     BloopairReportBuffer reportBuffer;
+    // set while a reader accumulates the raw reports over IPC, nothing is accumulated otherwise
+    uint8_t rawAccumulate;
+    // everything reported since the accumulated raw report was last read, so short presses aren't missed,
+    // and the newest report the next read starts out with, both guarded by rawReportSemaphore
+    BloopairReportBuffer rawAccumulated;
+    BloopairReportBuffer rawLatest;
     // controller mapping
     MappingConfiguration* mapping;
+    // turbo, toggle, chord and sequence actions, NULL if there are none
+    ActionConfiguration* actions;
+    ActionState actionState;
     // data that can be allocated for a controller feature
     void* additionalData;
     // Common configuration
@@ -100,6 +146,30 @@ struct Controller {
     void* customConfig;
     // size of custom config for IPC passing
     uint32_t customConfigSize;
+    // value of configurationGeneration when the configuration was looked up
+    uint32_t configurationGeneration;
+    // BLOOPAIR_QUIRK_* flags from the device registry and configuration
+    uint32_t quirks;
+    // quirks and report interval hint of the device itself, the configuration is added on top of these
+    uint32_t deviceQuirks;
+    uint32_t deviceReportInterval;
+    // amount of report intervals between sending reports, based on the report rate hint
+    uint8_t reportInterval;
+    uint8_t reportTick;
+    // the other half if this controller is combined with another one
+    Controller* combinedPartner;
+    // the primary half sends the reports for both halves
+    uint8_t isCombinedPrimary;
+    // does the controller fill in motion data
+    uint8_t hasMotion;
+    ControllerMotion motion;
+    // MotionPlus mode activated by padscore, 0 while MotionPlus is inactive
+    uint8_t motionPlusMode;
+    // the passthrough mode alternates between MotionPlus and extension data
+    uint8_t motionPlusExtensionFrame;
+    // CONTROLLER_TRIGGER_LATCH_* bits for analog triggers which are currently pressed
+    uint8_t triggerLatch;
+    ControllerStatistics stats;
 };
 
 extern Controller controllers[BTA_HH_MAX_KNOWN];
@@ -108,14 +178,25 @@ void initReportThread(void);
 
 void deinitReportThread(void);
 
-int isOfficialName(const char* name);
-
-int isSwitchControllerName(const char* name);
+// runs one report interval for all controllers, called by the report thread
+void updateControllers(void);
 
 int initController(uint8_t* bda, uint8_t handle);
 
 void sendControllerInput(Controller* controller);
 
+// merge the current report buffer into the accumulated raw report while a reader accumulates it, called after every hid report
+void accumulateRawReport(Controller* controller);
+
+// read the raw report accumulated since the last read and reset it, enable starts or stops accumulating
+void readAccumulatedRawReport(Controller* controller, uint8_t enable, BloopairReportBuffer* out);
+
+// record a hid report received from the controller for the statistics
+void recordControllerReport(Controller* controller);
+
+// record input sent to padscore for the statistics
+void recordControllerSent(Controller* controller);
+
 void mapControllerInput(Controller* controller, BloopairReportBuffer* in, BloopairReportBuffer* out);
 
 uint8_t ledMaskToPlayerNum(uint8_t mask);
@@ -123,3 +204,5 @@ uint8_t ledMaskToPlayerNum(uint8_t mask);
 int16_t scaleStickAxis(uint32_t val, uint32_t range);
 
 int16_t remapStickAxis(int32_t val, int32_t valMin, int32_t valMax);
+
+uint16_t scaleTriggerAxis(uint32_t val, uint32_t range);
@@ -148,6 +148,50 @@ void controllerSetLed_dualsense(Controller* controller, uint8_t led)
     sendRumbleLedState(controller);
 }
 
+static void controllerMotion_dualsense(Controller* controller, DualsenseInputReport* inRep)
+{
+    DualsenseData* ds_data = (DualsenseData*) controller->additionalData;
+
+    int16_t gyro[3];
+    int16_t accel[3];
+    for (int i = 0; i < 3; i++) {
+        gyro[i] = (int16_t) bswap16(inRep->gyro[i]);
+        accel[i] = (int16_t) bswap16(inRep->accel[i]);
+    }
+
+    calibrateMotion(&controller->motion, &ds_data->motion_calib, gyro, accel);
+}
+
+static void controllerGetReportResponse_dualsense(Controller* controller, uint8_t* buf, uint16_t len)
+{
+    DualsenseData* ds_data = (DualsenseData*) controller->additionalData;
+
+    if (buf[0] != DUALSENSE_CALIBRATION_REPORT_ID || len < sizeof(DualsenseCalibrationReport)) {
+        return;
+    }
+
+    DualsenseCalibrationReport* calRep = (DualsenseCalibrationReport*) buf;
+
+    // seed and verify crc
+    uint8_t seed = DUALSENSE_FEATURE_REPORT_SEED;
+    uint32_t crc = crc32(0xffffffff, &seed, sizeof(seed));
+    crc = crc32(crc, calRep, sizeof(*calRep) - 4);
+    if (calRep->crc != bswap32(~crc)) {
+        DEBUG_PRINT("dualsense calibration crc mismatch\n");
+        return;
+    }
+
+    // axes with unusable values keep the nominal resolution
+    int32_t speedPlus = (int16_t) bswap16(calRep->gyro_speed_plus);
+    int32_t speedMinus = (int16_t) bswap16(calRep->gyro_speed_minus);
+    for (int i = 0; i < 3; i++) {
+        setGyroAxisCalibration(&ds_data->motion_calib.gyro[i], (int16_t) bswap16(calRep->gyro_bias[i]),
+            (int16_t) bswap16(calRep->gyro[i][0]), (int16_t) bswap16(calRep->gyro[i][1]), speedPlus, speedMinus);
+        setAccelAxisCalibration(&ds_data->motion_calib.accel[i],
+            (int16_t) bswap16(calRep->accel[i][0]), (int16_t) bswap16(calRep->accel[i][1]));
+    }
+}
+
 void controllerData_dualsense(Controller* controller, uint8_t* buf, uint16_t len)
 {
     if (buf[0] == DUALSENSE_INPUT_REPORT_ID) {
@@ -158,6 +202,8 @@ void controllerData_dualsense(Controller* controller, uint8_t* buf, uint16_t len
         rep->left_stick_y = scaleStickAxis(inRep->left_stick_y, 256);
         rep->right_stick_x = scaleStickAxis(inRep->right_stick_x, 256);
         rep->right_stick_y = scaleStickAxis(inRep->right_stick_y, 256);
+        rep->left_trigger = scaleTriggerAxis(inRep->left_trigger, 256);
+        rep->right_trigger = scaleTriggerAxis(inRep->right_trigger, 256);
 
         rep->buttons = 0;
 
@@ -194,6 +240,8 @@ void controllerData_dualsense(Controller* controller, uint8_t* buf, uint16_t len
             rep->buttons |= BTN(DUALSENSE_BUTTON_MUTE);
         if (inRep->buttons.touchpad)
             rep->buttons |= BTN(DUALSENSE_BUTTON_TOUCHPAD);
+
+        controllerMotion_dualsense(controller, inRep);
         
         switch (inRep->battery_status) {
         case 0: // discharging
@@ -224,6 +272,7 @@ void controllerDeinit_dualsense(Controller* controller)
 void controllerInit_dualsense(Controller* controller)
 {
     controller->data = controllerData_dualsense;
+    controller->getReportResponse = controllerGetReportResponse_dualsense;
     controller->setPlayerLed = controllerSetLed_dualsense;
     controller->rumble = controllerRumble_dualsense;
     controller->deinit = controllerDeinit_dualsense;
@@ -231,14 +280,20 @@ void controllerInit_dualsense(Controller* controller)
 
     controller->battery = 4;
     controller->isCharging = 0;
+    controller->hasMotion = 1;
 
     controller->additionalData = IOS_Alloc(LOCAL_PROCESS_HEAP_ID, sizeof(DualsenseData));
     memset(controller->additionalData, 0, sizeof(DualsenseData));
+    setNominalMotionCalibration(&((DualsenseData*) controller->additionalData)->motion_calib,
+        DUALSENSE_GYRO_RES_PER_DPS, DUALSENSE_ACCEL_RES_PER_G);
 
     controller->type = BLOOPAIR_CONTROLLER_DUALSENSE;
     Configuration_GetAll(controller->type, controller->bda,
         &controller->commonConfig, &controller->mapping,
-        &controller->customConfig, &controller->customConfigSize);
+        &controller->customConfig, &controller->customConfigSize, &controller->actions);
+
+    // the nominal resolution is used until the calibration arrives
+    getReport(controller->handle, BTA_HH_RPTT_FEATURE, DUALSENSE_CALIBRATION_REPORT_ID);
 }
 
 void controllerModuleInit_dualsense(void)
@@ -25,6 +25,7 @@ typedef struct {
     uint8_t led_color[3];
     uint8_t rumble;
     uint8_t output_seq;
+    MotionCalibration motion_calib;
 } DualsenseData;
 
 #define DUALSENSE_INPUT_REPORT_ID 0x31
@@ -41,7 +42,7 @@ typedef struct PACKED {
     uint8_t right_trigger;
     uint8_t seq_number;
 
-    struct {
+    struct PACKED {
         uint8_t triangle : 1;
         uint8_t circle : 1;
         uint8_t cross : 1;
@@ -81,6 +82,30 @@ typedef struct PACKED {
 } DualsenseInputReport;
 CHECK_SIZE(DualsenseInputReport, 0x4e);
 
+// Nominal resolution of the motion sensors, used until the calibration has been read
+#define DUALSENSE_GYRO_RES_PER_DPS 16
+#define DUALSENSE_ACCEL_RES_PER_G   8192
+
+#define DUALSENSE_CALIBRATION_REPORT_ID 0x05
+
+// All values are little endian, the motion axes are in the same order as in the input report
+typedef struct PACKED {
+    uint8_t report_id;
+    uint16_t gyro_bias[3];
+    // the value at the positive and the negative speed for pitch, yaw and roll
+    uint16_t gyro[3][2];
+    uint16_t gyro_speed_plus;
+    uint16_t gyro_speed_minus;
+    // the value at +1G and -1G for x, y and z
+    uint16_t accel[3][2];
+    uint8_t unk[2];
+
+    uint32_t crc;
+} DualsenseCalibrationReport;
+CHECK_SIZE(DualsenseCalibrationReport, 0x29);
+
+#define DUALSENSE_FEATURE_REPORT_SEED 0xa3
+
 #define DUALSENSE_OUTPUT_REPORT_ID 0x31
 
 #define DUALSENSE_OUTPUT_REPORT_TAG     0x10
@@ -118,6 +118,8 @@ void controllerData_dualshock3(Controller* controller, uint8_t* buf, uint16_t le
         rep->left_stick_y = scaleStickAxis(inRep->left_stick_y, 256);
         rep->right_stick_x = scaleStickAxis(inRep->right_stick_x, 256);
         rep->right_stick_y = scaleStickAxis(inRep->right_stick_y, 256);
+        rep->left_trigger = scaleTriggerAxis(inRep->l2, 256);
+        rep->right_trigger = scaleTriggerAxis(inRep->r2, 256);
 
         rep->buttons = 0;
 
@@ -187,7 +189,7 @@ void controllerInit_dualshock3(Controller* controller)
     controller->type = BLOOPAIR_CONTROLLER_DUALSHOCK3;
     Configuration_GetAll(controller->type, controller->bda,
         &controller->commonConfig, &controller->mapping,
-        &controller->customConfig, &controller->customConfigSize);
+        &controller->customConfig, &controller->customConfigSize, &controller->actions);
 
     // enable the controller so it sends reports
     setReport(controller->handle, BTA_HH_RPTT_FEATURE, enable_payload, sizeof(enable_payload));
@@ -33,7 +33,7 @@ typedef struct PACKED {
     uint8_t report_id;
     uint8_t unk;
 
-    struct {
+    struct PACKED {
         uint8_t left : 1;
         uint8_t down : 1;
         uint8_t right : 1;
@@ -167,6 +167,50 @@ static void controllerButtons_dualshock4(BloopairReportBuffer* rep, Dualshock4Bu
         rep->buttons |= BTN(DUALSHOCK4_BUTTON_PS_HOME);
 }
 
+static void controllerMotion_dualshock4(Controller* controller, Dualshock4InputReport* inRep)
+{
+    Dualshock4Data* ds_data = (Dualshock4Data*) controller->additionalData;
+
+    int16_t gyro[3];
+    int16_t accel[3];
+    for (int i = 0; i < 3; i++) {
+        gyro[i] = (int16_t) bswap16(inRep->gyro[i]);
+        accel[i] = (int16_t) bswap16(inRep->accel[i]);
+    }
+
+    calibrateMotion(&controller->motion, &ds_data->motion_calib, gyro, accel);
+}
+
+static void controllerGetReportResponse_dualshock4(Controller* controller, uint8_t* buf, uint16_t len)
+{
+    Dualshock4Data* ds_data = (Dualshock4Data*) controller->additionalData;
+
+    if (buf[0] != DUALSHOCK4_CALIBRATION_REPORT_ID || len < sizeof(Dualshock4CalibrationReport)) {
+        return;
+    }
+
+    Dualshock4CalibrationReport* calRep = (Dualshock4CalibrationReport*) buf;
+
+    // seed and verify crc
+    uint8_t seed = DUALSHOCK4_FEATURE_REPORT_SEED;
+    uint32_t crc = crc32(0xffffffff, &seed, sizeof(seed));
+    crc = crc32(crc, calRep, sizeof(*calRep) - 4);
+    if (calRep->crc != bswap32(~crc)) {
+        DEBUG_PRINT("dualshock4 calibration crc mismatch\n");
+        return;
+    }
+
+    // axes with unusable values keep the nominal resolution
+    int32_t speedPlus = (int16_t) bswap16(calRep->gyro_speed_plus);
+    int32_t speedMinus = (int16_t) bswap16(calRep->gyro_speed_minus);
+    for (int i = 0; i < 3; i++) {
+        setGyroAxisCalibration(&ds_data->motion_calib.gyro[i], (int16_t) bswap16(calRep->gyro_bias[i]),
+            (int16_t) bswap16(calRep->gyro_plus[i]), (int16_t) bswap16(calRep->gyro_minus[i]), speedPlus, speedMinus);
+        setAccelAxisCalibration(&ds_data->motion_calib.accel[i],
+            (int16_t) bswap16(calRep->accel[i][0]), (int16_t) bswap16(calRep->accel[i][1]));
+    }
+}
+
 void controllerData_dualshock4(Controller* controller, uint8_t* buf, uint16_t len)
 {
     if (buf[0] == DUALSHOCK4_BASIC_INPUT_REPORT_ID) {
@@ -177,6 +221,8 @@ void controllerData_dualshock4(Controller* controller, uint8_t* buf, uint16_t le
         rep->left_stick_y = scaleStickAxis(inRep->left_stick_y, 256);
         rep->right_stick_x = scaleStickAxis(inRep->right_stick_x, 256);
         rep->right_stick_y = scaleStickAxis(inRep->right_stick_y, 256);
+        rep->left_trigger = scaleTriggerAxis(inRep->left_trigger, 256);
+        rep->right_trigger = scaleTriggerAxis(inRep->right_trigger, 256);
 
         controllerButtons_dualshock4(rep, &inRep->buttons);
 
@@ -191,12 +237,16 @@ void controllerData_dualshock4(Controller* controller, uint8_t* buf, uint16_t le
         rep->left_stick_y = scaleStickAxis(inRep->left_stick_y, 256);
         rep->right_stick_x = scaleStickAxis(inRep->right_stick_x, 256);
         rep->right_stick_y = scaleStickAxis(inRep->right_stick_y, 256);
+        rep->left_trigger = scaleTriggerAxis(inRep->left_trigger, 256);
+        rep->right_trigger = scaleTriggerAxis(inRep->right_trigger, 256);
 
         controllerButtons_dualshock4(rep, &inRep->buttons);
 
         controller->battery = CLAMP(inRep->battery_level >> 1, 0, 4);
         controller->isCharging = inRep->cable && inRep->battery_level <= 10;
 
+        controllerMotion_dualshock4(controller, inRep);
+
         if (!controller->isReady) {
             controller->isReady = 1;
         }
@@ -211,6 +261,7 @@ void controllerDeinit_dualshock4(Controller* controller)
 void controllerInit_dualshock4(Controller* controller)
 {
     controller->data = controllerData_dualshock4;
+    controller->getReportResponse = controllerGetReportResponse_dualshock4;
     controller->setPlayerLed = controllerSetLed_dualshock4;
     controller->rumble = controllerRumble_dualshock4;
     controller->deinit = controllerDeinit_dualshock4;
@@ -218,14 +269,20 @@ void controllerInit_dualshock4(Controller* controller)
 
     controller->battery = 4;
     controller->isCharging = 0;
+    controller->hasMotion = 1;
 
     controller->additionalData = IOS_Alloc(LOCAL_PROCESS_HEAP_ID, sizeof(Dualshock4Data));
     memset(controller->additionalData, 0, sizeof(Dualshock4Data));
+    setNominalMotionCalibration(&((Dualshock4Data*) controller->additionalData)->motion_calib,
+        DUALSHOCK4_GYRO_RES_PER_DPS, DUALSHOCK4_ACCEL_RES_PER_G);
 
     controller->type = BLOOPAIR_CONTROLLER_DUALSHOCK4;
     Configuration_GetAll(controller->type, controller->bda,
         &controller->commonConfig, &controller->mapping,
-        &controller->customConfig, &controller->customConfigSize);
+        &controller->customConfig, &controller->customConfigSize, &controller->actions);
+
+    // the nominal resolution is used until the calibration arrives
+    getReport(controller->handle, BTA_HH_RPTT_FEATURE, DUALSHOCK4_CALIBRATION_REPORT_ID);
 }
 
 void controllerModuleInit_dualshock4(void)
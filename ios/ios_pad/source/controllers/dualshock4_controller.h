@@ -24,12 +24,13 @@
 typedef struct {
     uint8_t led_color[3];
     uint8_t rumble;
+    MotionCalibration motion_calib;
 } Dualshock4Data;
 
 #define DUALSHOCK4_BASIC_INPUT_REPORT_ID 0x01
 #define DUALSHOCK4_INPUT_REPORT_ID 0x11
 
-typedef struct {
+typedef struct PACKED {
     uint8_t triangle : 1;
     uint8_t circle : 1;
     uint8_t cross : 1;
@@ -101,6 +102,31 @@ typedef struct PACKED {
 } Dualshock4InputReport;
 CHECK_SIZE(Dualshock4InputReport, 0x4e);
 
+// Nominal resolution of the motion sensors, used until the calibration has been read
+#define DUALSHOCK4_GYRO_RES_PER_DPS 16
+#define DUALSHOCK4_ACCEL_RES_PER_G   8192
+
+#define DUALSHOCK4_CALIBRATION_REPORT_ID 0x05
+
+// All values are little endian, the motion axes are in the same order as in the input report
+typedef struct PACKED {
+    uint8_t report_id;
+    uint16_t gyro_bias[3];
+    // all pitch, yaw and roll values at the positive speed, then all at the negative one
+    uint16_t gyro_plus[3];
+    uint16_t gyro_minus[3];
+    uint16_t gyro_speed_plus;
+    uint16_t gyro_speed_minus;
+    // the value at +1G and -1G for x, y and z
+    uint16_t accel[3][2];
+    uint8_t unk[2];
+
+    uint32_t crc;
+} Dualshock4CalibrationReport;
+CHECK_SIZE(Dualshock4CalibrationReport, 0x29);
+
+#define DUALSHOCK4_FEATURE_REPORT_SEED 0xa3
+
 #define DUALSHOCK4_OUTPUT_REPORT_ID 0x11
 
 #define DUALSHOCK4_OUTPUT_REPORT_SEED 0xa2
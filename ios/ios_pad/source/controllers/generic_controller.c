@@ -0,0 +1,486 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "generic_controller.h"
+#include <bloopair/controllers/generic_controller.h>
+
+// HID item types
+#define ITEM_TYPE_MAIN                  0
+#define ITEM_TYPE_GLOBAL                1
+#define ITEM_TYPE_LOCAL                 2
+
+// HID main item tags
+#define ITEM_TAG_MAIN_INPUT             0x8
+#define ITEM_TAG_MAIN_OUTPUT            0x9
+#define ITEM_TAG_MAIN_COLLECTION        0xa
+#define ITEM_TAG_MAIN_FEATURE           0xb
+#define ITEM_TAG_MAIN_END_COLLECTION    0xc
+
+// HID global item tags
+#define ITEM_TAG_GLOBAL_USAGE_PAGE      0x0
+#define ITEM_TAG_GLOBAL_LOGICAL_MIN     0x1
+#define ITEM_TAG_GLOBAL_LOGICAL_MAX     0x2
+#define ITEM_TAG_GLOBAL_REPORT_SIZE     0x7
+#define ITEM_TAG_GLOBAL_REPORT_ID       0x8
+#define ITEM_TAG_GLOBAL_REPORT_COUNT    0x9
+
+// HID local item tags
+#define ITEM_TAG_LOCAL_USAGE            0x0
+#define ITEM_TAG_LOCAL_USAGE_MIN        0x1
+#define ITEM_TAG_LOCAL_USAGE_MAX        0x2
+
+#define ITEM_LONG                       0xfe
+
+#define MAIN_FLAG_CONSTANT              (1 << 0)
+#define MAIN_FLAG_VARIABLE              (1 << 1)
+
+#define COLLECTION_APPLICATION          0x01
+
+#define USAGE_PAGE_GENERIC_DESKTOP      0x01
+#define USAGE_PAGE_BUTTON               0x09
+
+#define USAGE(page, id) (((uint32_t) (page) << 16) | (id))
+
+#define MAX_LOCAL_USAGES 16
+
+static const MappingConfiguration default_generic_mapping = {
+    .num = 25,
+    .mappings = {
+        { BLOOPAIR_PRO_STICK_L_UP,      BLOOPAIR_PRO_STICK_L_UP, },
+        { BLOOPAIR_PRO_STICK_L_DOWN,    BLOOPAIR_PRO_STICK_L_DOWN, },
+        { BLOOPAIR_PRO_STICK_L_LEFT,    BLOOPAIR_PRO_STICK_L_LEFT, },
+        { BLOOPAIR_PRO_STICK_L_RIGHT,   BLOOPAIR_PRO_STICK_L_RIGHT, },
+
+        { BLOOPAIR_PRO_STICK_R_UP,      BLOOPAIR_PRO_STICK_R_UP, },
+        { BLOOPAIR_PRO_STICK_R_DOWN,    BLOOPAIR_PRO_STICK_R_DOWN, },
+        { BLOOPAIR_PRO_STICK_R_LEFT,    BLOOPAIR_PRO_STICK_R_LEFT, },
+        { BLOOPAIR_PRO_STICK_R_RIGHT,   BLOOPAIR_PRO_STICK_R_RIGHT, },
+
+        { GENERIC_BUTTON_1,             BLOOPAIR_PRO_BUTTON_B, },
+        { GENERIC_BUTTON_2,             BLOOPAIR_PRO_BUTTON_A, },
+        { GENERIC_BUTTON_3,             BLOOPAIR_PRO_BUTTON_Y, },
+        { GENERIC_BUTTON_4,             BLOOPAIR_PRO_BUTTON_X, },
+
+        { GENERIC_BUTTON_5,             BLOOPAIR_PRO_TRIGGER_L, },
+        { GENERIC_BUTTON_6,             BLOOPAIR_PRO_TRIGGER_R, },
+        { GENERIC_BUTTON_7,             BLOOPAIR_PRO_TRIGGER_ZL, },
+        { GENERIC_BUTTON_8,             BLOOPAIR_PRO_TRIGGER_ZR, },
+
+        { GENERIC_BUTTON_9,             BLOOPAIR_PRO_BUTTON_MINUS, },
+        { GENERIC_BUTTON_10,            BLOOPAIR_PRO_BUTTON_PLUS, },
+        { GENERIC_BUTTON_11,            BLOOPAIR_PRO_BUTTON_STICK_L, },
+        { GENERIC_BUTTON_12,            BLOOPAIR_PRO_BUTTON_STICK_R, },
+        { GENERIC_BUTTON_13,            BLOOPAIR_PRO_BUTTON_HOME, },
+
+        { GENERIC_BUTTON_UP,            BLOOPAIR_PRO_BUTTON_UP, },
+        { GENERIC_BUTTON_DOWN,          BLOOPAIR_PRO_BUTTON_DOWN, },
+        { GENERIC_BUTTON_LEFT,          BLOOPAIR_PRO_BUTTON_LEFT, },
+        { GENERIC_BUTTON_RIGHT,         BLOOPAIR_PRO_BUTTON_RIGHT, },
+    },
+};
+
+#define DPAD_MASK (BTN(GENERIC_BUTTON_UP) | BTN(GENERIC_BUTTON_RIGHT) | BTN(GENERIC_BUTTON_DOWN) | BTN(GENERIC_BUTTON_LEFT))
+
+static const uint32_t dpad_map[8] = {
+    BTN(GENERIC_BUTTON_UP),
+    BTN(GENERIC_BUTTON_UP)    | BTN(GENERIC_BUTTON_RIGHT),
+    BTN(GENERIC_BUTTON_RIGHT),
+    BTN(GENERIC_BUTTON_RIGHT) | BTN(GENERIC_BUTTON_DOWN),
+    BTN(GENERIC_BUTTON_DOWN),
+    BTN(GENERIC_BUTTON_DOWN)  | BTN(GENERIC_BUTTON_LEFT),
+    BTN(GENERIC_BUTTON_LEFT),
+    BTN(GENERIC_BUTTON_LEFT)  | BTN(GENERIC_BUTTON_UP),
+};
+
+typedef struct {
+    uint8_t id;
+    uint16_t bits;
+} ReportOffset;
+
+static uint8_t getTargetForUsage(uint32_t usage)
+{
+    uint16_t page = usage >> 16;
+    uint16_t id = usage & 0xffff;
+
+    if (page == USAGE_PAGE_BUTTON) {
+        if (id >= 1 && id <= 16) {
+            return GENERIC_BUTTON_1 + id - 1;
+        }
+    } else if (page == USAGE_PAGE_GENERIC_DESKTOP) {
+        switch (id) {
+        case 0x30: // X
+            return GENERIC_TARGET_LEFT_STICK_X;
+        case 0x31: // Y
+            return GENERIC_TARGET_LEFT_STICK_Y;
+        // Pads either use Z / Rz or Rx / Ry for the right stick
+        case 0x32: // Z
+        case 0x33: // Rx
+            return GENERIC_TARGET_RIGHT_STICK_X;
+        case 0x34: // Ry
+        case 0x35: // Rz
+            return GENERIC_TARGET_RIGHT_STICK_Y;
+        case 0x39: // Hat switch
+            return GENERIC_TARGET_HAT;
+        }
+    }
+
+    return 0xff;
+}
+
+static uint32_t getItemData(const uint8_t* data, uint8_t size)
+{
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < size; i++) {
+        value |= (uint32_t) data[i] << (i * 8);
+    }
+
+    return value;
+}
+
+static int32_t signExtend(uint32_t value, uint8_t bits)
+{
+    if (bits > 0 && bits < 32 && (value & (1u << (bits - 1)))) {
+        value |= ~0u << bits;
+    }
+
+    return (int32_t) value;
+}
+
+// Compiles the report descriptor into a list of fields which can be extracted from the input reports
+static int compileDescriptor(GenericData* gdata, const uint8_t* desc, uint16_t len)
+{
+    ReportOffset reports[GENERIC_MAX_REPORTS];
+    uint8_t num_reports = 0;
+
+    // global state
+    uint16_t usage_page = 0;
+    uint32_t logical_min = 0;
+    uint32_t logical_max = 0;
+    uint8_t logical_min_size = 0;
+    uint8_t logical_max_size = 0;
+    uint32_t report_size = 0;
+    uint32_t report_count = 0;
+    uint8_t report_id = 0;
+
+    // local state
+    uint32_t usages[MAX_LOCAL_USAGES];
+    uint8_t num_usages = 0;
+    uint32_t usage_min = 0;
+    uint32_t usage_max = 0;
+    uint8_t has_usage_range = 0;
+
+    // collection state, only fields inside of a joystick or gamepad application collection are used
+    uint8_t collection_depth = 0;
+    uint8_t in_gamepad = 0;
+
+    // targets which have already been claimed by a field
+    uint32_t assigned = 0;
+
+    memset(gdata, 0, sizeof(*gdata));
+
+    const uint8_t* end = desc + len;
+    while (desc < end) {
+        uint8_t prefix = *desc++;
+
+        if (prefix == ITEM_LONG) {
+            if (desc >= end) {
+                return -1;
+            }
+
+            desc += desc[0] + 2;
+            continue;
+        }
+
+        uint8_t size = prefix & 0x3;
+        if (size == 3) {
+            size = 4;
+        }
+        uint8_t type = (prefix >> 2) & 0x3;
+        uint8_t tag = prefix >> 4;
+
+        if (desc + size > end) {
+            return -1;
+        }
+
+        uint32_t data = getItemData(desc, size);
+        desc += size;
+
+        if (type == ITEM_TYPE_GLOBAL) {
+            switch (tag) {
+            case ITEM_TAG_GLOBAL_USAGE_PAGE:
+                usage_page = data;
+                break;
+            case ITEM_TAG_GLOBAL_LOGICAL_MIN:
+                logical_min = data;
+                logical_min_size = size;
+                break;
+            case ITEM_TAG_GLOBAL_LOGICAL_MAX:
+                logical_max = data;
+                logical_max_size = size;
+                break;
+            case ITEM_TAG_GLOBAL_REPORT_SIZE:
+                report_size = data;
+                break;
+            case ITEM_TAG_GLOBAL_REPORT_ID:
+                report_id = data;
+                gdata->has_report_ids = 1;
+                break;
+            case ITEM_TAG_GLOBAL_REPORT_COUNT:
+                report_count = data;
+                break;
+            }
+        } else if (type == ITEM_TYPE_LOCAL) {
+            // usages without a page use the page which is active at the main item
+            switch (tag) {
+            case ITEM_TAG_LOCAL_USAGE:
+                if (num_usages < MAX_LOCAL_USAGES) {
+                    usages[num_usages++] = data;
+                }
+                break;
+            case ITEM_TAG_LOCAL_USAGE_MIN:
+                usage_min = data;
+                has_usage_range = 1;
+                break;
+            case ITEM_TAG_LOCAL_USAGE_MAX:
+                usage_max = data;
+                has_usage_range = 1;
+                break;
+            }
+        } else if (type == ITEM_TYPE_MAIN) {
+            switch (tag) {
+            case ITEM_TAG_MAIN_COLLECTION:
+                if (collection_depth++ == 0 && data == COLLECTION_APPLICATION && num_usages > 0) {
+                    uint32_t usage = usages[0];
+                    if (!(usage >> 16)) {
+                        usage = USAGE(usage_page, usage);
+                    }
+
+                    in_gamepad = usage == USAGE(USAGE_PAGE_GENERIC_DESKTOP, 0x04) || // Joystick
+                                 usage == USAGE(USAGE_PAGE_GENERIC_DESKTOP, 0x05);   // Gamepad
+                }
+                break;
+            case ITEM_TAG_MAIN_END_COLLECTION:
+                if (collection_depth > 0 && --collection_depth == 0) {
+                    in_gamepad = 0;
+                }
+                break;
+            case ITEM_TAG_MAIN_INPUT: {
+                // find the current offset for this report
+                ReportOffset* report = NULL;
+                for (uint8_t i = 0; i < num_reports; i++) {
+                    if (reports[i].id == report_id) {
+                        report = &reports[i];
+                        break;
+                    }
+                }
+
+                if (!report) {
+                    if (num_reports >= GENERIC_MAX_REPORTS) {
+                        return -1;
+                    }
+
+                    report = &reports[num_reports++];
+                    report->id = report_id;
+                    // the report id is part of the report data
+                    report->bits = report_id ? 8 : 0;
+                }
+
+                if (report->bits + report_size * report_count > 0xffff) {
+                    return -1;
+                }
+
+                // constant and array fields are just padding for us
+                if (in_gamepad && !(data & MAIN_FLAG_CONSTANT) && (data & MAIN_FLAG_VARIABLE) &&
+                    report_size > 0 && report_size <= 32) {
+                    // logical values are signed, but a lot of descriptors encode unsigned maximums without the extra byte
+                    int32_t min = signExtend(logical_min, logical_min_size * 8);
+                    int32_t max = signExtend(logical_max, logical_max_size * 8);
+                    if (min >= 0 && max < 0) {
+                        max = (int32_t) logical_max;
+                    }
+
+                    for (uint32_t i = 0; i < report_count; i++) {
+                        uint32_t usage;
+                        if (has_usage_range) {
+                            usage = usage_min + i;
+                            if (usage > usage_max) {
+                                break;
+                            }
+                        } else if (num_usages > 0) {
+                            usage = usages[(i < num_usages) ? i : (num_usages - 1)];
+                        } else {
+                            break;
+                        }
+
+                        if (!(usage >> 16)) {
+                            usage = USAGE(usage_page, usage);
+                        }
+
+                        uint8_t target = getTargetForUsage(usage);
+                        if (target == 0xff || (assigned & (1u << target)) || min >= max) {
+                            continue;
+                        }
+
+                        if (gdata->num_fields >= GENERIC_MAX_FIELDS) {
+                            break;
+                        }
+
+                        GenericField* field = &gdata->fields[gdata->num_fields++];
+                        field->report_id = report_id;
+                        field->target = target;
+                        field->size = report_size;
+                        field->is_signed = min < 0;
+                        field->offset = report->bits + i * report_size;
+                        field->logical_min = min;
+                        field->logical_max = max;
+
+                        assigned |= 1u << target;
+                    }
+                }
+
+                report->bits += report_size * report_count;
+                break;
+            }
+            }
+
+            // local items only apply to the next main item
+            num_usages = 0;
+            usage_min = usage_max = 0;
+            has_usage_range = 0;
+        }
+    }
+
+    return gdata->num_fields > 0 ? 0 : -1;
+}
+
+static int32_t extractField(const uint8_t* buf, const GenericField* field)
+{
+    // HID reports are little endian
+    const uint8_t* p = buf + (field->offset >> 3);
+    uint8_t shift = field->offset & 7;
+    uint8_t num_bytes = (shift + field->size + 7) >> 3;
+
+    uint64_t raw = 0;
+    for (uint8_t i = 0; i < num_bytes; i++) {
+        raw |= (uint64_t) p[i] << (i * 8);
+    }
+
+    uint32_t value = (uint32_t) (raw >> shift);
+    if (field->size < 32) {
+        value &= (1u << field->size) - 1;
+    }
+
+    return field->is_signed ? signExtend(value, field->size) : (int32_t) value;
+}
+
+void controllerData_generic(Controller* controller, uint8_t* buf, uint16_t len)
+{
+    GenericData* gdata = (GenericData*) controller->additionalData;
+    BloopairReportBuffer* rep = &controller->reportBuffer;
+
+    uint8_t report_id = gdata->has_report_ids ? buf[0] : 0;
+    uint32_t report_bits = (uint32_t) len * 8;
+    uint8_t handled = 0;
+
+    for (uint8_t i = 0; i < gdata->num_fields; i++) {
+        const GenericField* field = &gdata->fields[i];
+        if (field->report_id != report_id || field->offset + field->size > report_bits) {
+            continue;
+        }
+
+        int32_t value = extractField(buf, field);
+        handled = 1;
+
+        switch (field->target) {
+        case GENERIC_TARGET_HAT:
+            // out of range values mean the hat is centered
+            rep->buttons &= ~DPAD_MASK;
+            value -= field->logical_min;
+            if (value >= 0 && value < 8) {
+                rep->buttons |= dpad_map[value];
+            }
+            break;
+        case GENERIC_TARGET_LEFT_STICK_X:
+            rep->left_stick_x = remapStickAxis(value, field->logical_min, field->logical_max);
+            break;
+        case GENERIC_TARGET_LEFT_STICK_Y:
+            rep->left_stick_y = remapStickAxis(value, field->logical_min, field->logical_max);
+            break;
+        case GENERIC_TARGET_RIGHT_STICK_X:
+            rep->right_stick_x = remapStickAxis(value, field->logical_min, field->logical_max);
+            break;
+        case GENERIC_TARGET_RIGHT_STICK_Y:
+            rep->right_stick_y = remapStickAxis(value, field->logical_min, field->logical_max);
+            break;
+        default:
+            if (value) {
+                rep->buttons |= BTN(field->target);
+            } else {
+                rep->buttons &= ~BTN(field->target);
+            }
+            break;
+        }
+    }
+
+    if (handled && !controller->isReady) {
+        controller->isReady = 1;
+    }
+}
+
+void controllerDeinit_generic(Controller* controller)
+{
+    IOS_Free(LOCAL_PROCESS_HEAP_ID, controller->additionalData);
+}
+
+int controllerInit_generic(Controller* controller, const uint8_t* descriptor, uint16_t descriptor_len)
+{
+    GenericData* gdata = IOS_Alloc(LOCAL_PROCESS_HEAP_ID, sizeof(GenericData));
+    if (!gdata) {
+        return -1;
+    }
+
+    if (compileDescriptor(gdata, descriptor, descriptor_len) != 0) {
+        DEBUG_PRINT("generic: no usable fields in descriptor\n");
+        IOS_Free(LOCAL_PROCESS_HEAP_ID, gdata);
+        return -1;
+    }
+
+    DEBUG_PRINT("generic: compiled %u fields\n", gdata->num_fields);
+
+    controller->data = controllerData_generic;
+    controller->setPlayerLed = NULL;
+    controller->rumble = NULL;
+    controller->deinit = controllerDeinit_generic;
+    controller->update = NULL;
+
+    controller->battery = 4;
+    controller->isCharging = 0;
+
+    controller->additionalData = gdata;
+
+    controller->type = BLOOPAIR_CONTROLLER_GENERIC_HID;
+    Configuration_GetAll(controller->type, controller->bda,
+        &controller->commonConfig, &controller->mapping,
+        &controller->customConfig, &controller->customConfigSize, &controller->actions);
+
+    return 0;
+}
+
+void controllerModuleInit_generic(void)
+{
+    Configuration_SetFallback(BLOOPAIR_CONTROLLER_GENERIC_HID, NULL, &default_generic_mapping, NULL, 0);
+}
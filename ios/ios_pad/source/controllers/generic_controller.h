@@ -0,0 +1,56 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <controllers.h>
+
+// Info about report descriptors can be found here:
+// - <https://www.usb.org/document-library/device-class-definition-hid-111>
+// - <https://www.usb.org/document-library/hid-usage-tables-14>
+
+// Maximum amount of fields extracted from the reports of a single controller
+#define GENERIC_MAX_FIELDS 24
+
+// Maximum amount of input reports tracked while compiling the descriptor
+#define GENERIC_MAX_REPORTS 8
+
+enum {
+    // 0x00 - 0x0f are GENERIC_BUTTON_1 - GENERIC_BUTTON_16
+    GENERIC_TARGET_HAT              = 0x10,
+    GENERIC_TARGET_LEFT_STICK_X,
+    GENERIC_TARGET_LEFT_STICK_Y,
+    GENERIC_TARGET_RIGHT_STICK_X,
+    GENERIC_TARGET_RIGHT_STICK_Y,
+};
+
+// A single value extracted from an input report
+typedef struct {
+    uint8_t report_id;
+    uint8_t target;
+    // size of the value in bits
+    uint8_t size;
+    uint8_t is_signed;
+    // offset of the value in bits, including the report id
+    uint16_t offset;
+    int32_t logical_min;
+    int32_t logical_max;
+} GenericField;
+
+typedef struct {
+    uint8_t has_report_ids;
+    uint8_t num_fields;
+    GenericField fields[GENERIC_MAX_FIELDS];
+} GenericData;
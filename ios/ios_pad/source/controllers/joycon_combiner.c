@@ -0,0 +1,156 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "joycon_combiner.h"
+#include "switch_controller.h"
+#include <bloopair/controllers/switch_controller.h>
+#include <utils.h>
+
+// Holding SL and SR on both Joy-Cons at the same time combines them
+#define JOYCON_LEFT_COMBINE_BUTTONS     (BTN(SWITCH_TRIGGER_SL_L) | BTN(SWITCH_TRIGGER_SR_L))
+#define JOYCON_RIGHT_COMBINE_BUTTONS    (BTN(SWITCH_TRIGGER_SL_R) | BTN(SWITCH_TRIGGER_SR_R))
+
+static int isUnboundJoycon(Controller* controller, BloopairControllerType type)
+{
+    return controller->isInitialized && controller->isReady &&
+        controller->type == type && !controller->combinedPartner;
+}
+
+static int isHoldingButtons(Controller* controller, uint32_t buttons)
+{
+    return (controller->reportBuffer.buttons & buttons) == buttons;
+}
+
+static int isPinnedTo(Controller* controller, Controller* other)
+{
+    SwitchConfiguration* config = (SwitchConfiguration*) controller->customConfig;
+    if (!config || controller->customConfigSize < sizeof(SwitchConfiguration)) {
+        return 0;
+    }
+
+    return memcmp(config->combineWith, other->bda, 6) == 0;
+}
+
+static void refreshPlayerLed(Controller* controller)
+{
+    SwitchData* sdata = (SwitchData*) controller->additionalData;
+    if (controller->setPlayerLed) {
+        controller->setPlayerLed(controller, sdata->led);
+    }
+}
+
+static void bind(Controller* left, Controller* right)
+{
+    DEBUG_PRINT("combining joy-cons %u and %u\n", left->handle, right->handle);
+
+    // The right half stops sending reports as soon as it knows about its partner
+    right->isCombinedPrimary = 0;
+    right->combinedPartner = left;
+
+    // Configurations for the bda are meant for the single Joy-Con, so only use the ones for the combined type
+    left->type = BLOOPAIR_CONTROLLER_SWITCH_JOYCON_DUAL;
+    Configuration_GetAll(left->type, NULL,
+        &left->commonConfig, &left->mapping,
+        &left->customConfig, &left->customConfigSize, &left->actions);
+
+    // The link only becomes mutual once everything else is in place
+    left->isCombinedPrimary = 1;
+    COMPILER_BARRIER();
+    left->combinedPartner = right;
+
+    // Both halves show the player led of the combined controller
+    refreshPlayerLed(right);
+}
+
+static void split(Controller* controller)
+{
+    DEBUG_PRINT("splitting joy-con %u\n", controller->handle);
+
+    uint8_t wasPrimary = controller->isCombinedPrimary;
+
+    // The other readers stop using the link as soon as it isn't mutual anymore
+    controller->combinedPartner = NULL;
+    COMPILER_BARRIER();
+    controller->isCombinedPrimary = 0;
+
+    // The remaining half continues as a single Joy-Con
+    if (wasPrimary) {
+        controller->type = BLOOPAIR_CONTROLLER_SWITCH_JOYCON_LEFT;
+        Configuration_GetAll(controller->type, controller->bda,
+            &controller->commonConfig, &controller->mapping,
+            &controller->customConfig, &controller->customConfigSize, &controller->actions);
+    }
+
+    refreshPlayerLed(controller);
+}
+
+Controller* JoyconCombiner_GetPartner(Controller* controller)
+{
+    Controller* partner = controller->combinedPartner;
+    if (!partner || !partner->isInitialized || partner->combinedPartner != controller) {
+        return NULL;
+    }
+
+    return partner;
+}
+
+void JoyconCombiner_Update(void)
+{
+    // A disconnecting half only clears its slot, the remaining half is split here,
+    // so the report thread is the only one changing the links, type and configuration of a bound controller
+    for (int i = 0; i < BTA_HH_MAX_KNOWN; i++) {
+        Controller* controller = &controllers[i];
+        if (controller->isInitialized && controller->combinedPartner && !JoyconCombiner_GetPartner(controller)) {
+            split(controller);
+        }
+    }
+
+    for (int i = 0; i < BTA_HH_MAX_KNOWN; i++) {
+        Controller* left = &controllers[i];
+        if (!isUnboundJoycon(left, BLOOPAIR_CONTROLLER_SWITCH_JOYCON_LEFT)) {
+            continue;
+        }
+
+        for (int j = 0; j < BTA_HH_MAX_KNOWN; j++) {
+            Controller* right = &controllers[j];
+            if (!isUnboundJoycon(right, BLOOPAIR_CONTROLLER_SWITCH_JOYCON_RIGHT)) {
+                continue;
+            }
+
+            if (isPinnedTo(left, right) || isPinnedTo(right, left) ||
+                (isHoldingButtons(left, JOYCON_LEFT_COMBINE_BUTTONS) && isHoldingButtons(right, JOYCON_RIGHT_COMBINE_BUTTONS))) {
+                bind(left, right);
+                break;
+            }
+        }
+    }
+}
+
+void JoyconCombiner_MergeInput(Controller* primary, Controller* secondary, BloopairReportBuffer* out)
+{
+    BloopairReportBuffer* left = &primary->reportBuffer;
+    BloopairReportBuffer* right = &secondary->reportBuffer;
+
+    // Each half only reports its own buttons and stick, so they can just be put together
+    out->buttons = left->buttons | right->buttons;
+    out->left_stick_x = left->left_stick_x;
+    out->left_stick_y = left->left_stick_y;
+    out->right_stick_x = right->right_stick_x;
+    out->right_stick_y = right->right_stick_y;
+    out->left_trigger = left->left_trigger;
+    out->right_trigger = right->right_trigger;
+}
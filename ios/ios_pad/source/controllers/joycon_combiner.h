@@ -0,0 +1,37 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <controllers.h>
+
+// Combines a left and a right Joy-Con into a single controller.
+// The left Joy-Con becomes the primary half which sends the reports for both halves,
+// the right Joy-Con stops sending reports until the two are split again.
+// The right Joy-Con keeps its own WPAD channel, since it only exists as long as its HID connection is open
+// and that connection carries its input. Padscore still lists that channel, it just never gets any reports.
+// Binding and splitting only happen on the report thread, the data callbacks of both halves stay untouched.
+
+// Combines Joy-Cons and splits the ones whose partner disconnected, called from the report thread
+void JoyconCombiner_Update(void);
+
+// Returns the other half of a combined controller, or NULL if the link is no longer mutual.
+// The departing half of a pair is only split on the next update, so this never returns a disconnected controller.
+Controller* JoyconCombiner_GetPartner(Controller* controller);
+
+// Merges the input of both halves of a combined controller
+void JoyconCombiner_MergeInput(Controller* primary, Controller* secondary, BloopairReportBuffer* out);
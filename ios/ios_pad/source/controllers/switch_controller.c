@@ -16,11 +16,17 @@
  */
 
 #include "switch_controller.h"
+#include "joycon_combiner.h"
 #include <bloopair/controllers/switch_controller.h>
+#include <trace.h>
 
 // Joystick center for basic reports
 #define BASIC_JOYSTICK_CENTER              0x8000
 
+// Initial extents for basic reports (32767 * 0.8f)
+// Note that these values shouldn't be too small, otherwise the resting values get scaled by a big factor, messing with the initial calibration
+#define BASIC_INITIAL_EXTENT               26214
+
 // Normalize value for switch -> wii u range
 #define AXIS_NORMALIZE_VALUE               1140
 
@@ -253,7 +259,7 @@ static void finalizeStickCalibration(SwitchStickCalibration* calibration)
     calibration->min = calibration->center - calibration->min;
 }
 
-static void parseLeftRawStickCalibration(SwitchData* sdata, SwitchRawStickCalibrationLeft* raw)
+static void parseLeftRawStickCalibration(SwitchData* sdata, const SwitchRawStickCalibrationLeft* raw)
 {
     sdata->left_calib_x.center = SWITCH_AXIS_X(raw->center);
     sdata->left_calib_x.max = SWITCH_AXIS_X(raw->max);
@@ -266,7 +272,7 @@ static void parseLeftRawStickCalibration(SwitchData* sdata, SwitchRawStickCalibr
     finalizeStickCalibration(&sdata->left_calib_y);
 }
 
-static void parseRightRawStickCalibration(SwitchData* sdata, SwitchRawStickCalibrationRight* raw)
+static void parseRightRawStickCalibration(SwitchData* sdata, const SwitchRawStickCalibrationRight* raw)
 {
     sdata->right_calib_x.center = SWITCH_AXIS_X(raw->center);
     sdata->right_calib_x.max = SWITCH_AXIS_X(raw->max);
@@ -308,7 +314,22 @@ static int16_t remapBasicStickAxis(SwitchStickExtent* extent, uint16_t rawValue)
     return remapStickAxis(value, extent->min, extent->max);
 }
 
-static void sendCommand(Controller* controller, SwitchCommandRequest* req, uint32_t req_data_size)
+// Responses arrive on the bt thread while the report thread sends commands again and the led and rumble requests
+// from padscore, this serializes the pending commands and the packet counter of all switch controllers
+static int commandSemaphore = -1;
+
+static void lockCommands(void)
+{
+    IOS_WaitSemaphore(commandSemaphore, 0);
+}
+
+static void unlockCommands(void)
+{
+    IOS_SignalSemaphore(commandSemaphore);
+}
+
+// must be called with the commands locked
+static uint8_t transmitCommand(Controller* controller, uint8_t command, const uint8_t* data, uint32_t data_size)
 {
     SwitchData* sdata = (SwitchData*) controller->additionalData;
 
@@ -317,10 +338,140 @@ static void sendCommand(Controller* controller, SwitchCommandRequest* req, uint3
     rep.output.report_id = SWITCH_COMMAND_OUTPUT_REPORT_ID;
     rep.output.counter = (sdata->report_count++) & 0xf;
 
-    rep.request.command = req->command;
-    memcpy(rep.request.data, req->data, req_data_size);
+    rep.request.command = command;
+    memcpy(rep.request.data, data, data_size);
+
+    sendOutputData(controller->handle, &rep, sizeof(rep.output) + sizeof(rep.request.command) + data_size);
+
+    return rep.output.counter;
+}
+
+static SwitchPendingCommand* findCommand(SwitchPendingCommand* commands, uint32_t num, uint8_t command, const uint8_t* data)
+{
+    for (uint32_t i = 0; i < num; i++) {
+        SwitchPendingCommand* pending = &commands[i];
+        if (pending->command != command) {
+            continue;
+        }
+
+        // multiple SPI reads can be in flight, these are told apart by their address
+        if (command == SWITCH_COMMAND_SPI_FLASH_READ && memcmp(pending->data, data, 4) != 0) {
+            continue;
+        }
+
+        return pending;
+    }
+
+    return NULL;
+}
+
+static SwitchPendingCommand* findPendingCommand(SwitchData* sdata, uint8_t command, const uint8_t* data)
+{
+    return findCommand(sdata->pending, SWITCH_MAX_PENDING_COMMANDS, command, data);
+}
+
+// must be called with the commands locked
+static void startCommand(Controller* controller, SwitchPendingCommand* pending, const SwitchPendingCommand* cmd)
+{
+    pending->command = cmd->command;
+    pending->timeout = SWITCH_COMMAND_TIMEOUT;
+    pending->retries = SWITCH_COMMAND_RETRIES;
+    pending->data_size = cmd->data_size;
+    memcpy(pending->data, cmd->data, cmd->data_size);
+
+    pending->counter = transmitCommand(controller, pending->command, pending->data, pending->data_size);
+}
+
+// Moves queued commands to free pending slots, must be called with the commands locked
+static void sendQueuedCommands(Controller* controller)
+{
+    SwitchData* sdata = (SwitchData*) controller->additionalData;
+
+    while (sdata->num_queued > 0) {
+        SwitchPendingCommand* pending = findPendingCommand(sdata, 0, NULL);
+        if (!pending) {
+            return;
+        }
+
+        startCommand(controller, pending, &sdata->queued[0]);
 
-    sendOutputData(controller->handle, &rep, sizeof(rep.output) + sizeof(rep.request.command) + req_data_size);
+        sdata->num_queued--;
+        memmove(&sdata->queued[0], &sdata->queued[1], sdata->num_queued * sizeof(SwitchPendingCommand));
+    }
+}
+
+static void commandFailed(Controller* controller, uint8_t command, const uint8_t* data);
+
+// Sends a subcommand without waiting for the previous ones to be acknowledged,
+// it's sent again if there is no response in time
+static void sendCommand(Controller* controller, SwitchCommandRequest* req, uint32_t req_data_size)
+{
+    SwitchData* sdata = (SwitchData*) controller->additionalData;
+
+    SwitchPendingCommand cmd = { 0 };
+    if (req_data_size > sizeof(cmd.data)) {
+        // commands with longer arguments can't be tracked, none of the ones we use have those
+        lockCommands();
+        transmitCommand(controller, req->command, req->data, req_data_size);
+        unlockCommands();
+        return;
+    }
+
+    cmd.command = req->command;
+    cmd.data_size = req_data_size;
+    memcpy(cmd.data, req->data, req_data_size);
+
+    lockCommands();
+
+    // a newer request replaces a pending or queued one for the same command
+    SwitchPendingCommand* pending = findPendingCommand(sdata, cmd.command, cmd.data);
+    if (!pending && sdata->num_queued == 0) {
+        pending = findPendingCommand(sdata, 0, NULL);
+    }
+
+    if (pending) {
+        startCommand(controller, pending, &cmd);
+        unlockCommands();
+        return;
+    }
+
+    // wait for a free slot, queued commands keep their order
+    SwitchPendingCommand* queued = findCommand(sdata->queued, sdata->num_queued, cmd.command, cmd.data);
+    if (!queued && sdata->num_queued < SWITCH_MAX_QUEUED_COMMANDS) {
+        queued = &sdata->queued[sdata->num_queued++];
+    }
+
+    if (queued) {
+        *queued = cmd;
+        unlockCommands();
+        return;
+    }
+
+    unlockCommands();
+
+    // there are only a few different commands, so this means the controller stopped responding entirely
+    TRACE(BLOOPAIR_TRACE_EVENT_SWITCH_SUBCMD_TIMEOUT, controller->handle, cmd.command, 0xff);
+    commandFailed(controller, cmd.command, cmd.data);
+}
+
+// returns 0 if the response doesn't belong to a command we're waiting for
+static int completeCommand(Controller* controller, SwitchCommandResponse* resp)
+{
+    SwitchData* sdata = (SwitchData*) controller->additionalData;
+
+    lockCommands();
+
+    SwitchPendingCommand* pending = findPendingCommand(sdata, resp->command, (const uint8_t*) &resp->spi_flash_read);
+    if (!pending) {
+        unlockCommands();
+        return 0;
+    }
+
+    pending->command = 0;
+    sendQueuedCommands(controller);
+
+    unlockCommands();
+    return 1;
 }
 
 static void requestDeviceInfo(Controller* controller)
@@ -362,12 +513,28 @@ static void setVibration(Controller* controller, uint8_t enabled)
     sendCommand(controller, &req, sizeof(req.vibration_enabled));
 }
 
+static void setImu(Controller* controller, uint8_t enabled)
+{
+    SwitchCommandRequest req;
+    req.command = SWITCH_COMMAND_ENABLE_IMU;
+
+    req.imu_enabled = enabled;
+
+    sendCommand(controller, &req, sizeof(req.imu_enabled));
+}
+
 static void setPlayerLeds(Controller* controller)
 {
     SwitchData* sdata = (SwitchData*) controller->additionalData;
 
     uint8_t led = sdata->led;
 
+    // the secondary half of a combined controller shows the player of the primary half
+    Controller* partner = JoyconCombiner_GetPartner(controller);
+    if (partner && !controller->isCombinedPrimary) {
+        led = ((SwitchData*) partner->additionalData)->led;
+    }
+
     // if this is the right joycon swap led order
     if (sdata->device == SWITCH_DEVICE_JOYCON_RIGHT || sdata->device == SWITCH_DEVICE_TP_JOYCON_RIGHT) {
         led = ((led & 1) << 3) | ((led & 2) << 1) | ((led & 4) >> 1) | ((led & 8) >> 3);
@@ -381,7 +548,7 @@ static void setPlayerLeds(Controller* controller)
     sendCommand(controller, &req, sizeof(req.leds));
 }
 
-void controllerRumble_switch(Controller* controller, uint8_t rumble)
+static void sendRumble(Controller* controller, uint8_t rumble)
 {
     SwitchData* sdata = (SwitchData*) controller->additionalData;
     if (sdata->device == SWITCH_DEVICE_UNKNOWN) {
@@ -390,7 +557,10 @@ void controllerRumble_switch(Controller* controller, uint8_t rumble)
 
     SwitchOutputReport rep;
     rep.report_id = SWITCH_OUTPUT_REPORT_ID;
+
+    lockCommands();
     rep.counter = (sdata->report_count++) & 0xf;
+    unlockCommands();
 
     if (rumble) {
         rep.left_motor[0] = (RUMBLE_HIGH_FREQUENCY >> 8) & 0xff;
@@ -417,6 +587,23 @@ void controllerRumble_switch(Controller* controller, uint8_t rumble)
     sendOutputData(controller->handle, &rep, sizeof(rep));
 }
 
+void controllerRumble_switch(Controller* controller, uint8_t rumble)
+{
+    Controller* partner = JoyconCombiner_GetPartner(controller);
+    if (partner) {
+        // the secondary half of a combined controller rumbles together with the primary half
+        if (!controller->isCombinedPrimary) {
+            return;
+        }
+
+        if (partner->rumble) {
+            sendRumble(partner, rumble);
+        }
+    }
+
+    sendRumble(controller, rumble);
+}
+
 void controllerSetLed_switch(Controller* controller, uint8_t led)
 {
     SwitchData* sdata = (SwitchData*) controller->additionalData;
@@ -428,6 +615,12 @@ void controllerSetLed_switch(Controller* controller, uint8_t led)
     if (sdata->device != SWITCH_DEVICE_UNKNOWN) {
         setPlayerLeds(controller);
     }
+
+    // keep the player led of the other half in sync
+    Controller* partner = JoyconCombiner_GetPartner(controller);
+    if (partner && controller->isCombinedPrimary && partner->setPlayerLed) {
+        setPlayerLeds(partner);
+    }
 }
 
 static int switchConfigCalibrationEnabled(Controller* controller)
@@ -440,93 +633,274 @@ static int switchConfigCalibrationEnabled(Controller* controller)
     return !config->disableCalibration;
 }
 
+static uint32_t switchDeviceQuirks(uint8_t device)
+{
+    switch (device) {
+    case SWITCH_DEVICE_JOYCON_LEFT:
+    case SWITCH_DEVICE_JOYCON_RIGHT:
+    case SWITCH_DEVICE_PRO:
+    case SWITCH_DEVICE_N64:
+        return 0;
+    }
+
+    // Calibration and full reports cause issues for some third-party controllers,
+    // the remaining devices don't have any sticks which would need calibration
+    return BLOOPAIR_QUIRK_FORCE_BASIC_REPORT;
+}
+
+static void setDefaultStickCalibration(SwitchStickCalibration* calibration)
+{
+    calibration->center = calibration->max = calibration->min = 0xfff;
+    finalizeStickCalibration(calibration);
+}
+
+static void setDefaultImuCalibration(SwitchImuCalibration* calibration)
+{
+    for (int i = 0; i < 3; i++) {
+        calibration->accel_offset[i] = 0;
+        calibration->accel_range[i] = SWITCH_DEFAULT_ACCEL_SCALE;
+        calibration->gyro_offset[i] = 0;
+        calibration->gyro_range[i] = SWITCH_DEFAULT_GYRO_SCALE;
+    }
+}
+
+static void parseRawImuCalibration(SwitchImuCalibration* calibration, const SwitchRawImuCalibration* raw)
+{
+    for (int i = 0; i < 3; i++) {
+        calibration->accel_offset[i] = (int16_t) bswap16(raw->accel_offset[i]);
+        calibration->accel_range[i] = (int16_t) bswap16(raw->accel_scale[i]) - calibration->accel_offset[i];
+        calibration->gyro_offset[i] = (int16_t) bswap16(raw->gyro_offset[i]);
+        calibration->gyro_range[i] = (int16_t) bswap16(raw->gyro_scale[i]) - calibration->gyro_offset[i];
+
+        // Unprogrammed flash reads as 0xff, keep the defaults for anything unusable
+        if (calibration->accel_range[i] <= 0) {
+            calibration->accel_offset[i] = 0;
+            calibration->accel_range[i] = SWITCH_DEFAULT_ACCEL_SCALE;
+        }
+        if (calibration->gyro_range[i] <= 0) {
+            calibration->gyro_offset[i] = 0;
+            calibration->gyro_range[i] = SWITCH_DEFAULT_GYRO_SCALE;
+        }
+    }
+}
+
+static int switchDeviceHasImu(uint8_t device)
+{
+    return device == SWITCH_DEVICE_JOYCON_LEFT || device == SWITCH_DEVICE_JOYCON_RIGHT || device == SWITCH_DEVICE_PRO;
+}
+
+static void setDeviceType(Controller* controller, uint8_t device)
+{
+    SwitchData* sdata = (SwitchData*) controller->additionalData;
+
+    sdata->device = device;
+    TRACE(BLOOPAIR_TRACE_EVENT_SWITCH_DEVICE_TYPE, controller->handle, sdata->device, 0);
+
+    // Get the configuration again, now that we have the actual device type
+    controller->type = switchDeviceToControllerType(sdata->device);
+    Configuration_GetAll(controller->type, controller->bda,
+        &controller->commonConfig, &controller->mapping,
+        &controller->customConfig, &controller->customConfigSize, &controller->actions);
+
+    // the report mode is picked once, so these stay when the configuration is refreshed
+    controller->deviceQuirks |= switchDeviceQuirks(sdata->device);
+    if (!switchConfigCalibrationEnabled(controller)) {
+        controller->deviceQuirks |= BLOOPAIR_QUIRK_FORCE_BASIC_REPORT;
+    }
+    controller->quirks |= controller->deviceQuirks;
+}
+
+static void applyRawCalibration(Controller* controller, const SwitchCalibrationCache* raw)
+{
+    SwitchData* sdata = (SwitchData*) controller->additionalData;
+
+    parseLeftRawStickCalibration(sdata, &raw->left_calibration);
+    parseRightRawStickCalibration(sdata, &raw->right_calibration);
+    sdata->has_left_calib = sdata->has_right_calib = 1;
+}
+
+// try to restore the device type and calibration from the last connection
+static int loadCachedCalibration(Controller* controller)
+{
+    StoredInfo* info = store_get_device_info(controller->bda);
+    if (!info) {
+        return 0;
+    }
+
+    const SwitchCalibrationCache* cache = (const SwitchCalibrationCache*) store_get_cache(info);
+    if (!cache || cache->device == SWITCH_DEVICE_UNKNOWN) {
+        return 0;
+    }
+
+    setDeviceType(controller, cache->device);
+
+    // Devices which don't use calibration still get to skip the device info request
+    if (!(controller->quirks & (BLOOPAIR_QUIRK_FORCE_BASIC_REPORT | BLOOPAIR_QUIRK_SKIP_CALIBRATION))) {
+        applyRawCalibration(controller, cache);
+    }
+
+    return 1;
+}
+
+// called once both raw calibrations have been read from the controller
+static void finishCalibration(Controller* controller)
+{
+    SwitchData* sdata = (SwitchData*) controller->additionalData;
+
+    applyRawCalibration(controller, &sdata->raw_calib);
+
+    StoredInfo* info = store_get_device_info(controller->bda);
+    if (info) {
+        sdata->raw_calib.device = sdata->device;
+        store_set_cache(info, &sdata->raw_calib, sizeof(sdata->raw_calib));
+    }
+
+    if (sdata->revalidating) {
+        // full reports are already enabled
+        sdata->revalidating = 0;
+    } else {
+        // we can now enable full reports
+        setInputReportMode(controller, SWITCH_INPUT_REPORT_ID);
+    }
+}
+
+// last step of the initialization, either start reading calibration or finish up
+static void startCalibration(Controller* controller)
+{
+    SwitchData* sdata = (SwitchData*) controller->additionalData;
+
+    if (controller->quirks & BLOOPAIR_QUIRK_FORCE_BASIC_REPORT) {
+        // Don't need to wait for calibration, controller is ready now
+        controller->isReady = 1;
+    } else if (controller->quirks & BLOOPAIR_QUIRK_SKIP_CALIBRATION) {
+        setDefaultStickCalibration(&sdata->left_calib_x);
+        setDefaultStickCalibration(&sdata->left_calib_y);
+        setDefaultStickCalibration(&sdata->right_calib_x);
+        setDefaultStickCalibration(&sdata->right_calib_y);
+        sdata->has_left_calib = sdata->has_right_calib = 1;
+
+        setInputReportMode(controller, SWITCH_INPUT_REPORT_ID);
+    } else {
+        // Read the user and factory calibration at once, the user calibration takes priority
+        sdata->raw_calib_mask = 0;
+        readSpiFlash(controller, SWITCH_USER_CALIBRATION_ADDRESS, sizeof(SwitchRawUserStickCalibration));
+        readSpiFlash(controller, SWITCH_FACTORY_CALIBRATION_ADDRESS, sizeof(SwitchRawFactoryStickCalibration));
+    }
+}
+
+// set the leds, enable rumble and the imu and start the calibration, these don't depend on each other
+static void continueInitialization(Controller* controller)
+{
+    SwitchData* sdata = (SwitchData*) controller->additionalData;
+
+    // imu samples are only part of full reports
+    if (!(controller->quirks & BLOOPAIR_QUIRK_FORCE_BASIC_REPORT) && switchDeviceHasImu(sdata->device)) {
+        setImu(controller, 1);
+        readSpiFlash(controller, SWITCH_IMU_CALIBRATION_ADDRESS, sizeof(SwitchRawImuCalibration));
+    }
+
+    if (!(controller->quirks & BLOOPAIR_QUIRK_NO_LED)) {
+        setPlayerLeds(controller);
+    }
+
+    if (!(controller->quirks & BLOOPAIR_QUIRK_NO_RUMBLE)) {
+        setVibration(controller, 1);
+    }
+
+    startCalibration(controller);
+}
+
+static void commandFailed(Controller* controller, uint8_t command, const uint8_t* data)
+{
+    SwitchData* sdata = (SwitchData*) controller->additionalData;
+
+    // the controller works fine without leds, rumble or motion
+    if (command == SWITCH_COMMAND_SET_PLAYER_LEDS || command == SWITCH_COMMAND_ENABLE_VIBRATION ||
+        command == SWITCH_COMMAND_ENABLE_IMU) {
+        return;
+    }
+
+    // the imu calibration falls back to the defaults
+    if (command == SWITCH_COMMAND_SPI_FLASH_READ &&
+        (data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24)) == SWITCH_IMU_CALIBRATION_ADDRESS) {
+        return;
+    }
+
+    // if we failed during one of the stages, just fall back to simple input
+    controller->isReady = 1;
+    sdata->revalidating = 0;
+}
+
 static void handle_command_response(Controller* controller, SwitchCommandResponse* resp)
 {
     SwitchData* sdata = (SwitchData*) controller->additionalData;
 
-    DEBUG_PRINT("subcmd respone 0x%x\n", resp->command);
+    TRACE(BLOOPAIR_TRACE_EVENT_SWITCH_SUBCMD_RESPONSE, controller->handle, resp->command, resp->ack);
+
+    // ignore duplicate responses for commands which were sent again
+    if (!completeCommand(controller, resp)) {
+        return;
+    }
 
     if ((resp->ack & 0x80) == 0) {
-        DEBUG_PRINT("switch subcmd 0x%x failed\n", resp->command);
-        // if we failed during one of the stages, just fall back to simple input
-        controller->isReady = 1;
+        TRACE(BLOOPAIR_TRACE_EVENT_SWITCH_SUBCMD_FAILED, controller->handle, resp->command, resp->ack);
+        commandFailed(controller, resp->command, (const uint8_t*) &resp->spi_flash_read);
         return;
     }
 
     if (resp->command == SWITCH_COMMAND_REQUEST_DEVICE_INFO) {
-        sdata->device = resp->device_info.device_type;
-        DEBUG_PRINT("device type 0x%x\n", sdata->device);
-
-        // Get the configuration again, now that we have the actual device type
-        controller->type = switchDeviceToControllerType(sdata->device);
-        Configuration_GetAll(controller->type, controller->bda,
-            &controller->commonConfig, &controller->mapping,
-            &controller->customConfig, &controller->customConfigSize);
+        setDeviceType(controller, resp->device_info.device_type);
 
         // set the leds now that we know the device type
-        setPlayerLeds(controller);
-    } else if (resp->command == SWITCH_COMMAND_SET_PLAYER_LEDS) {
-        // Early return for controllers that are already initialized
-        if(controller->isReady) {
-            return;
-        }
-        // enable rumble
-        setVibration(controller, 1);
-    } else if (resp->command == SWITCH_COMMAND_ENABLE_VIBRATION) {
-        /* Calibration causes issues for some third-party controllers */
-        if ((sdata->device == SWITCH_DEVICE_JOYCON_LEFT || /*sdata->device == SWITCH_DEVICE_TP_JOYCON_LEFT ||*/
-             sdata->device == SWITCH_DEVICE_JOYCON_RIGHT || /*sdata->device == SWITCH_DEVICE_TP_JOYCON_RIGHT ||*/
-             sdata->device == SWITCH_DEVICE_PRO || /*sdata->device == SWITCH_DEVICE_TP_PRO ||*/
-             sdata->device == SWITCH_DEVICE_N64) && switchConfigCalibrationEnabled(controller)) {
-            // Start by reading the user calibration
-            readSpiFlash(controller, SWITCH_USER_CALIBRATION_ADDRESS, sizeof(SwitchRawUserStickCalibration));
-        } else {
-            // Don't need to wait for calibration, controller is ready now
-            controller->isReady = 1;
-        }
+        continueInitialization(controller);
+    } else if (resp->command == SWITCH_COMMAND_ENABLE_IMU) {
+        // imu samples will be part of the next full reports
+        controller->hasMotion = 1;
     } else if (resp->command == SWITCH_COMMAND_SPI_FLASH_READ) {
         uint32_t address = bswap32(resp->spi_flash_read.address);
+        TRACE(BLOOPAIR_TRACE_EVENT_SWITCH_SPI_READ, controller->handle, resp->spi_flash_read.size, address);
 
         switch (address) {
         case SWITCH_USER_CALIBRATION_ADDRESS: {
             SwitchRawUserStickCalibration* calibration = (SwitchRawUserStickCalibration*) resp->spi_flash_read.data;
 
             if (calibration->left_magic == SWITCH_USER_CALIBRATION_MAGIC) {
-                parseLeftRawStickCalibration(sdata, &calibration->left_calibration);
-                sdata->has_left_calib = 1;
+                sdata->raw_calib.left_calibration = calibration->left_calibration;
+                sdata->raw_calib_mask |= SWITCH_RAW_CALIB_USER_LEFT;
             }
             if (calibration->right_magic == SWITCH_USER_CALIBRATION_MAGIC) {
-                parseRightRawStickCalibration(sdata, &calibration->right_calibration);
-                sdata->has_right_calib = 1;
+                sdata->raw_calib.right_calibration = calibration->right_calibration;
+                sdata->raw_calib_mask |= SWITCH_RAW_CALIB_USER_RIGHT;
             }
 
-            // Check if we have both calibrations already or if we need to read factory calibrations
-            if (sdata->has_left_calib && sdata->has_right_calib) {
-                setInputReportMode(controller, SWITCH_INPUT_REPORT_ID);
-            } else {
-                readSpiFlash(controller, SWITCH_FACTORY_CALIBRATION_ADDRESS, sizeof(SwitchRawFactoryStickCalibration));
-            }
+            sdata->raw_calib_mask |= SWITCH_RAW_CALIB_USER_DONE;
             break;
         }
+        case SWITCH_IMU_CALIBRATION_ADDRESS:
+            // not part of the stick calibration, so there is nothing to wait for
+            parseRawImuCalibration(&sdata->imu_calib, (const SwitchRawImuCalibration*) resp->spi_flash_read.data);
+            return;
         case SWITCH_FACTORY_CALIBRATION_ADDRESS: {
             SwitchRawFactoryStickCalibration* calibration = (SwitchRawFactoryStickCalibration*) resp->spi_flash_read.data;
-            
-            if (!sdata->has_left_calib) {
-                parseLeftRawStickCalibration(sdata, &calibration->left_calibration);
-                sdata->has_left_calib = 1;
+
+            if (!(sdata->raw_calib_mask & SWITCH_RAW_CALIB_USER_LEFT)) {
+                sdata->raw_calib.left_calibration = calibration->left_calibration;
             }
-            if (!sdata->has_right_calib) {
-                parseRightRawStickCalibration(sdata, &calibration->right_calibration);
-                sdata->has_right_calib = 1;
+            if (!(sdata->raw_calib_mask & SWITCH_RAW_CALIB_USER_RIGHT)) {
+                sdata->raw_calib.right_calibration = calibration->right_calibration;
             }
 
-            // we can now enable full reports
-            setInputReportMode(controller, SWITCH_INPUT_REPORT_ID);
+            sdata->raw_calib_mask |= SWITCH_RAW_CALIB_FACTORY_DONE;
             break;
         }
         default:
             DEBUG_PRINT("switch: unknown SPI read from %lx size %d\n", address, resp->spi_flash_read.size);
-            break;
+            return;
+        }
+
+        // Wait until both calibrations have been read
+        if ((sdata->raw_calib_mask & SWITCH_RAW_CALIB_USER_DONE) && (sdata->raw_calib_mask & SWITCH_RAW_CALIB_FACTORY_DONE)) {
+            finishCalibration(controller);
         }
     }
 }
@@ -602,12 +976,55 @@ static void handle_input_report(Controller* controller, SwitchInputReport* inRep
     }
 }
 
+static int16_t calibrateImuAxis(int32_t sum, int16_t offset, int32_t range, int32_t resolution)
+{
+    // The sum of all samples is scaled at once, which averages them without losing precision
+    return scaleMotionValue(sum - offset * SWITCH_IMU_SAMPLE_COUNT, resolution, range * SWITCH_IMU_SAMPLE_COUNT);
+}
+
+static void handle_imu_samples(Controller* controller, SwitchImuSample* samples)
+{
+    SwitchData* sdata = (SwitchData*) controller->additionalData;
+    SwitchImuCalibration* calib = &sdata->imu_calib;
+
+    int32_t accel[3] = { 0 };
+    int32_t gyro[3] = { 0 };
+    for (int i = 0; i < SWITCH_IMU_SAMPLE_COUNT; i++) {
+        for (int j = 0; j < 3; j++) {
+            accel[j] += (int16_t) bswap16(samples[i].accel[j]);
+            gyro[j] += (int16_t) bswap16(samples[i].gyro[j]);
+        }
+    }
+
+    for (int i = 0; i < 3; i++) {
+        accel[i] = calibrateImuAxis(accel[i], calib->accel_offset[i], calib->accel_range[i], MOTION_ACCEL_RES_PER_G);
+        gyro[i] = calibrateImuAxis(gyro[i], calib->gyro_offset[i], calib->gyro_range[i], MOTION_GYRO_RES_PER_DPS * SWITCH_GYRO_SCALE_DPS);
+    }
+
+    // The imu x axis points away from the player, y to the left and z up.
+    // The imu of the right Joy-Con is mounted the other way around.
+    if (sdata->device == SWITCH_DEVICE_JOYCON_RIGHT) {
+        accel[1] = -accel[1];
+        accel[2] = -accel[2];
+        gyro[1] = -gyro[1];
+        gyro[2] = -gyro[2];
+    }
+
+    ControllerMotion* motion = &controller->motion;
+    motion->accel[0] = -accel[1];
+    motion->accel[1] = accel[2];
+    motion->accel[2] = -accel[0];
+    motion->gyro[0] = -gyro[1];
+    motion->gyro[1] = gyro[2];
+    motion->gyro[2] = -gyro[0];
+}
+
 static void handle_basic_input_report(Controller* controller, SwitchBasicInputReport* inRep)
 {
     SwitchData* sdata = (SwitchData*) controller->additionalData; 
     BloopairReportBuffer* rep = &controller->reportBuffer;
 
-    // the pro controller sends weird stick data in the first report
+    // some controllers send weird stick data in the first report
     // which completely messes with the start calibration, so we drop that report
     if (sdata->first_report) {
         sdata->first_report = 0;
@@ -671,13 +1088,56 @@ void controllerData_switch(Controller* controller, uint8_t* buf, uint16_t len)
         handle_command_response(controller, &rep->response);
     } else if (buf[0] == SWITCH_INPUT_REPORT_ID) {
         handle_input_report(controller, (SwitchInputReport*) buf);
+
+        if (controller->hasMotion && len >= sizeof(SwitchFullInputReport)) {
+            handle_imu_samples(controller, ((SwitchFullInputReport*) buf)->imu);
+        }
     } else if (buf[0] == SWITCH_BASIC_INPUT_REPORT_ID) {
         handle_basic_input_report(controller, (SwitchBasicInputReport*) buf);
     }
 }
 
+void controllerUpdate_switch(Controller* controller)
+{
+    SwitchData* sdata = (SwitchData*) controller->additionalData;
+
+    // failures are handled after unlocking, since handling them can send new commands
+    SwitchPendingCommand failed[SWITCH_MAX_PENDING_COMMANDS];
+    uint32_t num_failed = 0;
+
+    lockCommands();
+
+    for (int i = 0; i < SWITCH_MAX_PENDING_COMMANDS; i++) {
+        SwitchPendingCommand* pending = &sdata->pending[i];
+        if (!pending->command || --pending->timeout != 0) {
+            continue;
+        }
+
+        if (pending->retries == 0) {
+            TRACE(BLOOPAIR_TRACE_EVENT_SWITCH_SUBCMD_TIMEOUT, controller->handle, pending->command, pending->counter);
+            failed[num_failed++] = *pending;
+            pending->command = 0;
+            continue;
+        }
+
+        TRACE(BLOOPAIR_TRACE_EVENT_SWITCH_SUBCMD_RETRY, controller->handle, pending->command, pending->counter);
+        pending->retries--;
+        pending->timeout = SWITCH_COMMAND_TIMEOUT;
+        pending->counter = transmitCommand(controller, pending->command, pending->data, pending->data_size);
+    }
+
+    sendQueuedCommands(controller);
+
+    unlockCommands();
+
+    for (uint32_t i = 0; i < num_failed; i++) {
+        commandFailed(controller, failed[i].command, failed[i].data);
+    }
+}
+
 void controllerDeinit_switch(Controller* controller)
 {
+    // a combined partner stops using this half once it isn't initialized anymore and is split on the next update
     IOS_Free(LOCAL_PROCESS_HEAP_ID, controller->additionalData);
 }
 
@@ -687,19 +1147,24 @@ void controllerInit_switch(Controller* controller)
     controller->setPlayerLed = controllerSetLed_switch;
     controller->rumble = controllerRumble_switch;
     controller->deinit = controllerDeinit_switch;
-    controller->update = NULL;
+    controller->update = controllerUpdate_switch;
 
     controller->battery = 4;
     controller->isCharging = 0;
 
+    // controllers are only initialized on the bt thread, so this can't race
+    if (commandSemaphore < 0) {
+        commandSemaphore = IOS_CreateSemaphore(1, 1);
+    }
+
     SwitchData* sdata = (SwitchData*) IOS_Alloc(LOCAL_PROCESS_HEAP_ID, sizeof(SwitchData));
     memset(sdata, 0, sizeof(SwitchData));
-    sdata->first_report = 1;
- 
+    setDefaultImuCalibration(&sdata->imu_calib);
+    sdata->first_report = !!(controller->quirks & BLOOPAIR_QUIRK_DROP_FIRST_REPORT);
+
     // Initial basic extents (start with the partial stick range, which gets dynamically extended)
-    // Note that these values shouldn't be too small, otherwise the resting values get scaled by a big factor, messing with the initial calibration
-    sdata->left_extent_x.max = sdata->right_extent_x.max = sdata->left_extent_y.max = sdata->right_extent_y.max = 26214; // 32767 * 0.8f;
-    sdata->left_extent_x.min = sdata->right_extent_x.min = sdata->left_extent_y.min = sdata->right_extent_y.min = -26214; //-32768 * 0.8f;
+    sdata->left_extent_x.max = sdata->right_extent_x.max = sdata->left_extent_y.max = sdata->right_extent_y.max = BASIC_INITIAL_EXTENT;
+    sdata->left_extent_x.min = sdata->right_extent_x.min = sdata->left_extent_y.min = sdata->right_extent_y.min = -BASIC_INITIAL_EXTENT;
 
     controller->additionalData = sdata;
 
@@ -707,7 +1172,18 @@ void controllerInit_switch(Controller* controller)
     controller->type = BLOOPAIR_CONTROLLER_SWITCH_GENERIC;
     Configuration_GetAll(controller->type, controller->bda,
         &controller->commonConfig, &controller->mapping,
-        &controller->customConfig, &controller->customConfigSize);
+        &controller->customConfig, &controller->customConfigSize, &controller->actions);
+
+    if (loadCachedCalibration(controller)) {
+        if (sdata->has_left_calib && sdata->has_right_calib) {
+            // Enable full reports right away and read the calibration again in the background
+            sdata->revalidating = 1;
+            setInputReportMode(controller, SWITCH_INPUT_REPORT_ID);
+        }
+
+        continueInitialization(controller);
+        return;
+    }
 
     // start controller initialization by requesting device info
     requestDeviceInfo(controller);
@@ -719,6 +1195,8 @@ void controllerModuleInit_switch(void)
     Configuration_SetFallback(BLOOPAIR_CONTROLLER_SWITCH_GENERIC, NULL, &default_generic_mapping, &default_switch_configuration, sizeof(default_switch_configuration));
     Configuration_SetFallback(BLOOPAIR_CONTROLLER_SWITCH_JOYCON_LEFT, NULL, &default_joycon_left_mapping, &default_switch_configuration, sizeof(default_switch_configuration));
     Configuration_SetFallback(BLOOPAIR_CONTROLLER_SWITCH_JOYCON_RIGHT, NULL, &default_joycon_right_mapping, &default_switch_configuration, sizeof(default_switch_configuration));
+    // combined joy-cons report the same buttons as a pro controller
+    Configuration_SetFallback(BLOOPAIR_CONTROLLER_SWITCH_JOYCON_DUAL, NULL, &default_pro_controller_mapping, &default_switch_configuration, sizeof(default_switch_configuration));
     Configuration_SetFallback(BLOOPAIR_CONTROLLER_SWITCH_PRO, NULL, &default_pro_controller_mapping, &default_switch_configuration, sizeof(default_switch_configuration));
     Configuration_SetFallback(BLOOPAIR_CONTROLLER_SWITCH_N64, NULL, &default_n64_mapping, &default_switch_configuration, sizeof(default_switch_configuration));
 }
@@ -16,6 +16,7 @@
  */
 
 #include <controllers.h>
+#include <info_store.h>
 
 // Information about the reports can be found here:
 // - <https://github.com/torvalds/linux/blob/master/drivers/hid/hid-nintendo.c>
@@ -34,32 +35,12 @@ typedef struct {
     int16_t min;
 } SwitchStickExtent;
 
-typedef struct {
-    uint8_t first_report;
-    uint8_t report_count;
-    uint8_t device;
-    uint8_t led;
-
-    // Calibration for full reports
-    uint8_t has_left_calib;
-    SwitchStickCalibration left_calib_x;
-    SwitchStickCalibration left_calib_y;
-    uint8_t has_right_calib;
-    SwitchStickCalibration right_calib_x;
-    SwitchStickCalibration right_calib_y;
-
-    // Extents for basic reports
-    SwitchStickExtent left_extent_x;
-    SwitchStickExtent right_extent_x;
-    SwitchStickExtent left_extent_y;
-    SwitchStickExtent right_extent_y;
-} SwitchData;
-
 enum {
     SWITCH_COMMAND_REQUEST_DEVICE_INFO   = 0x02,
     SWITCH_COMMAND_SET_INPUT_REPORT_MODE = 0x03,
     SWITCH_COMMAND_SPI_FLASH_READ        = 0x10,
     SWITCH_COMMAND_SET_PLAYER_LEDS       = 0x30,
+    SWITCH_COMMAND_ENABLE_IMU            = 0x40,
     SWITCH_COMMAND_ENABLE_VIBRATION      = 0x48,
 };
 
@@ -91,6 +72,8 @@ typedef uint8_t SwitchAxis[3];
 
 #define SWITCH_USER_CALIBRATION_MAGIC           0xb2a1
 
+#define SWITCH_IMU_CALIBRATION_ADDRESS          0x6020
+
 typedef struct PACKED {
     SwitchAxis max;
     SwitchAxis center;
@@ -119,9 +102,102 @@ typedef struct PACKED {
 } SwitchRawFactoryStickCalibration;
 CHECK_SIZE(SwitchRawFactoryStickCalibration, 0x12);
 
+// All values are little endian
+typedef struct PACKED {
+    int16_t accel_offset[3];
+    int16_t accel_scale[3];
+    int16_t gyro_offset[3];
+    int16_t gyro_scale[3];
+} SwitchRawImuCalibration;
+CHECK_SIZE(SwitchRawImuCalibration, 0x18);
+
+// Used until the calibration has been read (scale is the raw value for 1G and 936 dps)
+#define SWITCH_DEFAULT_ACCEL_SCALE  16384
+#define SWITCH_DEFAULT_GYRO_SCALE   13371
+#define SWITCH_GYRO_SCALE_DPS       936
+
+typedef struct {
+    int16_t accel_offset[3];
+    int32_t accel_range[3];
+    int16_t gyro_offset[3];
+    int32_t gyro_range[3];
+} SwitchImuCalibration;
+
+// Stored per device, so reconnecting doesn't need to wait for the SPI flash reads
+typedef struct PACKED {
+    uint8_t device;
+    SwitchRawStickCalibrationLeft left_calibration;
+    SwitchRawStickCalibrationRight right_calibration;
+} SwitchCalibrationCache;
+CHECK_SIZE(SwitchCalibrationCache, STORED_INFO_CACHE_SIZE);
+
+enum {
+    SWITCH_RAW_CALIB_USER_LEFT      = 1 << 0,
+    SWITCH_RAW_CALIB_USER_RIGHT     = 1 << 1,
+    SWITCH_RAW_CALIB_USER_DONE      = 1 << 2,
+    SWITCH_RAW_CALIB_FACTORY_DONE   = 1 << 3,
+};
+
+// Amount of subcommands which can be waiting for a response at once
+#define SWITCH_MAX_PENDING_COMMANDS 8
+
+// Amount of subcommands which can wait for a free pending slot before being sent
+#define SWITCH_MAX_QUEUED_COMMANDS 8
+
+// Timeout in report thread ticks (10ms) before a subcommand is sent again
+#define SWITCH_COMMAND_TIMEOUT 25
+#define SWITCH_COMMAND_RETRIES 3
+
+typedef struct {
+    // 0 if this slot is unused
+    uint8_t command;
+    // packet counter the command was last sent with
+    uint8_t counter;
+    uint8_t timeout;
+    uint8_t retries;
+    uint8_t data_size;
+    uint8_t data[5];
+} SwitchPendingCommand;
+
+typedef struct {
+    uint8_t first_report;
+    uint8_t report_count;
+    uint8_t device;
+    uint8_t led;
+
+    // Calibration for full reports
+    uint8_t has_left_calib;
+    SwitchStickCalibration left_calib_x;
+    SwitchStickCalibration left_calib_y;
+    uint8_t has_right_calib;
+    SwitchStickCalibration right_calib_x;
+    SwitchStickCalibration right_calib_y;
+
+    // Set while the cached calibration is in use and being read again from the controller
+    uint8_t revalidating;
+    // Raw calibration read from the controller so far
+    uint8_t raw_calib_mask;
+    SwitchCalibrationCache raw_calib;
+
+    // Calibration for the IMU samples in full reports
+    SwitchImuCalibration imu_calib;
+
+    // Subcommands which haven't been acknowledged yet
+    SwitchPendingCommand pending[SWITCH_MAX_PENDING_COMMANDS];
+    // Subcommands which are sent in order once a pending slot is free
+    SwitchPendingCommand queued[SWITCH_MAX_QUEUED_COMMANDS];
+    uint8_t num_queued;
+
+    // Extents for basic reports
+    SwitchStickExtent left_extent_x;
+    SwitchStickExtent right_extent_x;
+    SwitchStickExtent left_extent_y;
+    SwitchStickExtent right_extent_y;
+} SwitchData;
+
 typedef struct PACKED {
     uint8_t command;
-    union {
+    union PACKED {
         uint8_t data[0x26];
 
         uint8_t report_mode;
@@ -134,6 +210,8 @@ typedef struct PACKED {
         uint8_t leds;
 
         uint8_t vibration_enabled;
+
+        uint8_t imu_enabled;
     };
 } SwitchCommandRequest;
 
@@ -141,7 +219,7 @@ typedef struct PACKED {
     uint8_t ack;
     uint8_t command;
 
-    union {
+    union PACKED {
         struct PACKED {
             uint16_t fw_version;
             uint8_t device_type;
@@ -169,7 +247,7 @@ typedef struct PACKED {
     uint8_t battery_charging : 1;
     uint8_t connection_status : 4;
 
-    struct {
+    struct PACKED {
         uint8_t zr : 1;
         uint8_t r : 1;
         uint8_t sl_r : 1;
@@ -204,6 +282,21 @@ typedef struct PACKED {
 } SwitchInputReport;
 CHECK_SIZE(SwitchInputReport, 0xd);
 
+// The IMU is sampled every 5ms, so each full report contains 3 samples
+#define SWITCH_IMU_SAMPLE_COUNT 3
+
+typedef struct PACKED {
+    int16_t accel[3];
+    int16_t gyro[3];
+} SwitchImuSample;
+CHECK_SIZE(SwitchImuSample, 0xc);
+
+typedef struct PACKED {
+    SwitchInputReport input;
+    SwitchImuSample imu[SWITCH_IMU_SAMPLE_COUNT];
+} SwitchFullInputReport;
+CHECK_SIZE(SwitchFullInputReport, 0x31);
+
 #define SWITCH_COMMAND_INPUT_REPORT_ID 0x21
 
 typedef struct PACKED {
@@ -233,7 +326,7 @@ typedef struct PACKED {
 typedef struct PACKED {
     uint8_t report_id;
 
-    struct {
+    struct PACKED {
         uint8_t zr : 1;
         uint8_t zl : 1;
         uint8_t r : 1;
@@ -79,6 +79,8 @@ void controllerData_xbox_one(Controller* controller, uint8_t* buf, uint16_t len)
         rep->left_stick_y = scaleStickAxis(bswap16(inRep->left_stick_y), 65536);
         rep->right_stick_x = scaleStickAxis(bswap16(inRep->right_stick_x), 65536);
         rep->right_stick_y = scaleStickAxis(bswap16(inRep->right_stick_y), 65536);
+        rep->left_trigger = scaleTriggerAxis(bswap16(inRep->left_trigger), 1024);
+        rep->right_trigger = scaleTriggerAxis(bswap16(inRep->right_trigger), 1024);
 
         // clear all buttons besides the xb button
         rep->buttons &= BTN(XBOX_ONE_BUTTON_XBOX);
@@ -194,7 +196,7 @@ void controllerInit_xbox_one(Controller* controller)
     controller->type = BLOOPAIR_CONTROLLER_XBOX_ONE;
     Configuration_GetAll(controller->type, controller->bda,
         &controller->commonConfig, &controller->mapping,
-        &controller->customConfig, &controller->customConfigSize);
+        &controller->customConfig, &controller->customConfigSize, &controller->actions);
 }
 
 void controllerModuleInit_xbox_one(void)
@@ -49,8 +49,8 @@ typedef struct PACKED {
         uint8_t : 4;
         uint8_t dpad : 4;
 
-        union {
-            struct {
+        union PACKED {
+            struct PACKED {
                 uint8_t rb : 1;
                 uint8_t lb : 1;
                 uint8_t : 1;
@@ -70,7 +70,7 @@ typedef struct PACKED {
                 uint8_t : 7;
                 uint8_t view : 1;
             };
-            struct {
+            struct PACKED {
                 uint8_t menu : 1;
                 uint8_t view : 1;
                 uint8_t rb : 1;
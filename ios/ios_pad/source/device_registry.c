@@ -0,0 +1,199 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "device_registry.h"
+#include "info_store.h"
+#include <bloopair/controllers/common.h>
+
+#define DEVICE(vid, pid, type, q) { .vendor_id = vid, .product_id = pid, .controllerType = type, .quirks = q }
+
+// The pro controller sends weird stick data in the first basic report
+#define SWITCH_QUIRKS BLOOPAIR_QUIRK_DROP_FIRST_REPORT
+
+// Must be sorted by vendor and product id
+static const BloopairDeviceEntry builtin_devices[] = {
+    DEVICE(0x045e, 0x02e0, BLOOPAIR_CONTROLLER_XBOX_ONE, 0),                    // xbox one s controller
+    DEVICE(0x045e, 0x02fd, BLOOPAIR_CONTROLLER_XBOX_ONE, 0),                    // xbox one s controller
+    DEVICE(0x045e, 0x0b00, BLOOPAIR_CONTROLLER_XBOX_ONE, 0),                    // xbox one elite controller
+    DEVICE(0x045e, 0x0b05, BLOOPAIR_CONTROLLER_XBOX_ONE, 0),                    // xbox one elite controller
+    DEVICE(0x045e, 0x0b0a, BLOOPAIR_CONTROLLER_XBOX_ONE, 0),                    // xbox one adaptive controller
+    DEVICE(0x054c, 0x0268, BLOOPAIR_CONTROLLER_DUALSHOCK3, 0),                  // dualshock 3
+    DEVICE(0x054c, 0x05c4, BLOOPAIR_CONTROLLER_DUALSHOCK4, 0),                  // dualshock 4 v1
+    DEVICE(0x054c, 0x09cc, BLOOPAIR_CONTROLLER_DUALSHOCK4, 0),                  // dualshock 4 v2
+    DEVICE(0x054c, 0x0ce6, BLOOPAIR_CONTROLLER_DUALSENSE, 0),                   // dualsense
+    DEVICE(0x054c, 0x0df2, BLOOPAIR_CONTROLLER_DUALSENSE, 0),                   // dualsense edge
+    DEVICE(0x057e, 0x2006, BLOOPAIR_CONTROLLER_SWITCH_GENERIC, SWITCH_QUIRKS),  // joycon l
+    DEVICE(0x057e, 0x2007, BLOOPAIR_CONTROLLER_SWITCH_GENERIC, SWITCH_QUIRKS),  // joycon r
+    DEVICE(0x057e, 0x2009, BLOOPAIR_CONTROLLER_SWITCH_GENERIC, SWITCH_QUIRKS),  // switch pro controller
+    DEVICE(0x057e, 0x2017, BLOOPAIR_CONTROLLER_SWITCH_GENERIC, SWITCH_QUIRKS),  // snes controller
+    DEVICE(0x057e, 0x2019, BLOOPAIR_CONTROLLER_SWITCH_GENERIC, SWITCH_QUIRKS),  // n64 controller
+    DEVICE(0x057e, 0x201a, BLOOPAIR_CONTROLLER_SWITCH_GENERIC, SWITCH_QUIRKS),  // genesis/megadrive controller
+    DEVICE(0x0f0d, 0x00f6, BLOOPAIR_CONTROLLER_DUALSHOCK4, 0),                  // hori onyx
+    DEVICE(0x146b, 0x0d01, BLOOPAIR_CONTROLLER_DUALSHOCK4, 0),                  // nacon ps4
+    DEVICE(0x1532, 0x100a, BLOOPAIR_CONTROLLER_DUALSHOCK4, 0),                  // razer raiju tournament
+};
+
+typedef struct {
+    const char* prefix;
+    uint8_t length;
+    uint8_t magic;
+} DeviceName;
+
+#define NAME(prefix, magic) { prefix, sizeof(prefix) - 1, magic }
+
+// Must be sorted and no prefix may be the start of another prefix
+static const DeviceName builtin_names[] = {
+    NAME("HVC Controller",      MAGIC_SWITCH),
+    NAME("Joy-Con",             MAGIC_SWITCH),
+    NAME("Lic Pro Controller",  MAGIC_SWITCH),
+    NAME("Lic2 Pro Controller", MAGIC_SWITCH),
+    NAME("MD/Gen Control Pad",  MAGIC_SWITCH),
+    NAME("N64 Controller",      MAGIC_SWITCH),
+    NAME("NES Controller",      MAGIC_SWITCH),
+    NAME("Nintendo RVL-CNT",    MAGIC_OFFICIAL), // wii remote / pro controller
+    NAME("Nintendo RVL-WBC",    MAGIC_OFFICIAL), // balance board
+    NAME("NintendoGamepad",     MAGIC_SWITCH),
+    NAME("Pro Controller",      MAGIC_SWITCH),
+    NAME("SNES Controller",     MAGIC_SWITCH),
+};
+
+typedef struct {
+    uint32_t num;
+    BloopairDeviceEntry entries[DEVICE_REGISTRY_MAX_EXTRA_ENTRIES];
+} DeviceTable;
+
+// Entries added at runtime, also sorted by vendor and product id.
+// Adding fills the table which isn't in use and then publishes it by bumping the generation,
+// the lowest bit of which selects the table. Lookups run on other threads and retry if the generation
+// changed while they were reading, since the table they read from might have been refilled in the meantime.
+static DeviceTable extra_tables[2];
+static volatile uint32_t extra_generation = 0;
+
+#define DEVICE_KEY(vid, pid) (((uint32_t) (vid) << 16) | (pid))
+
+static const BloopairDeviceEntry* findInTable(const BloopairDeviceEntry* table, uint32_t num, uint32_t key)
+{
+    uint32_t low = 0;
+    uint32_t high = num;
+    while (low < high) {
+        uint32_t mid = (low + high) / 2;
+        uint32_t midKey = DEVICE_KEY(table[mid].vendor_id, table[mid].product_id);
+        if (midKey == key) {
+            return &table[mid];
+        } else if (midKey < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return NULL;
+}
+
+int DeviceRegistry_Find(uint16_t vendor_id, uint16_t product_id, BloopairDeviceEntry* outEntry)
+{
+    uint32_t key = DEVICE_KEY(vendor_id, product_id);
+
+    uint32_t generation;
+    const BloopairDeviceEntry* entry;
+    do {
+        generation = extra_generation;
+        COMPILER_BARRIER();
+
+        const DeviceTable* table = &extra_tables[generation & 1];
+        entry = findInTable(table->entries, MIN(table->num, DEVICE_REGISTRY_MAX_EXTRA_ENTRIES), key);
+        if (entry) {
+            *outEntry = *entry;
+        }
+
+        COMPILER_BARRIER();
+    } while (generation != extra_generation);
+
+    if (entry) {
+        return 0;
+    }
+
+    entry = findInTable(builtin_devices, ARRAY_SIZE(builtin_devices), key);
+    if (entry) {
+        *outEntry = *entry;
+        return 0;
+    }
+
+    return -1;
+}
+
+uint8_t DeviceRegistry_GetMagicForName(const char* name)
+{
+    uint32_t low = 0;
+    uint32_t high = ARRAY_SIZE(builtin_names);
+    while (low < high) {
+        uint32_t mid = (low + high) / 2;
+        int res = strncmp(name, builtin_names[mid].prefix, builtin_names[mid].length);
+        if (res == 0) {
+            return builtin_names[mid].magic;
+        } else if (res > 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return MAGIC_BLOOPAIR;
+}
+
+int DeviceRegistry_Add(const BloopairDeviceEntry* entries, uint32_t numEntries)
+{
+    // only the IPC thread adds entries, so the table which isn't in use is ours until the generation is bumped
+    uint32_t generation = extra_generation;
+    const DeviceTable* current = &extra_tables[generation & 1];
+    DeviceTable* next = &extra_tables[(generation + 1) & 1];
+
+    next->num = current->num;
+    memcpy(next->entries, current->entries, current->num * sizeof(BloopairDeviceEntry));
+
+    for (uint32_t i = 0; i < numEntries; i++) {
+        const BloopairDeviceEntry* entry = &entries[i];
+        uint32_t key = DEVICE_KEY(entry->vendor_id, entry->product_id);
+
+        // find the insert position
+        uint32_t pos = 0;
+        while (pos < next->num && DEVICE_KEY(next->entries[pos].vendor_id, next->entries[pos].product_id) < key) {
+            pos++;
+        }
+
+        // replace existing entries for the same device
+        if (pos < next->num && DEVICE_KEY(next->entries[pos].vendor_id, next->entries[pos].product_id) == key) {
+            next->entries[pos] = *entry;
+            continue;
+        }
+
+        // nothing is published if the entries don't fit
+        if (next->num >= DEVICE_REGISTRY_MAX_EXTRA_ENTRIES) {
+            return -1;
+        }
+
+        for (uint32_t j = next->num; j > pos; j--) {
+            next->entries[j] = next->entries[j - 1];
+        }
+        next->entries[pos] = *entry;
+        next->num++;
+    }
+
+    // the swap also keeps the compiler from moving the table writes past the publish
+    atomicSwap(&extra_generation, generation + 1);
+    return 0;
+}
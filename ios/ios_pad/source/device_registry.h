@@ -0,0 +1,35 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <imports.h>
+#include <bloopair/devices.h>
+
+// Maximum amount of entries which can be added at runtime
+#define DEVICE_REGISTRY_MAX_EXTRA_ENTRIES 16
+
+// Copies the registry entry for the device to outEntry, returns -1 if the device is unknown.
+// Entries are copied since adding entries can overwrite them while the caller still uses them.
+int DeviceRegistry_Find(uint16_t vendor_id, uint16_t product_id, BloopairDeviceEntry* outEntry);
+
+// Returns the MAGIC_* value for a device with the specified bluetooth name
+uint8_t DeviceRegistry_GetMagicForName(const char* name);
+
+// Adds entries to the registry, entries added at runtime take priority over the builtin ones.
+// Either all entries are added or none, only call this from one thread at a time.
+int DeviceRegistry_Add(const BloopairDeviceEntry* entries, uint32_t numEntries);
@@ -24,6 +24,17 @@ static StoredInfo stored_infos[BTA_HH_MAX_KNOWN] = { 0 };
 
 static int devInfo_read = 0;
 
+static uint16_t cacheCrc(const uint8_t* cache)
+{
+    return crc32(0, cache, STORED_INFO_CACHE_SIZE) & 0xffff;
+}
+
+// the cache overlaps with the end of the name, so only use it for short names
+static int entryHasCacheSpace(BT_DevInfo_Entry* entry)
+{
+    return strnlen((const char*) entry->name, sizeof(entry->name)) < sizeof(entry->name);
+}
+
 void store_read_device_info(void)
 {
     // we only need to do this once, after that bloopair keeps track of device info
@@ -49,6 +60,11 @@ void store_read_device_info(void)
             info->magic = entry->magic;
             info->vendor_id = entry->vendor_id;
             info->product_id = entry->product_id;
+
+            if (entryHasCacheSpace(entry) && entry->cache_crc == cacheCrc(entry->cache)) {
+                memcpy(info->cache, entry->cache, sizeof(info->cache));
+                info->has_cache = 1;
+            }
         }
     }
 }
@@ -98,6 +114,11 @@ int writeDevInfo_hook(void* callback)
         entry->magic = info->magic;
         entry->vendor_id = info->vendor_id;
         entry->product_id = info->product_id;
+
+        if (info->has_cache && entryHasCacheSpace(entry)) {
+            memcpy(entry->cache, info->cache, sizeof(entry->cache));
+            entry->cache_crc = cacheCrc(entry->cache);
+        }
     }
 
     return real_writeDevInfo(callback);
@@ -135,3 +156,19 @@ void store_read_DI_record(uint8_t* bda, tSDP_DISCOVERY_DB* db)
     info->vendor_id = vendor_id;
     info->product_id = product_id;
 }
+
+const void* store_get_cache(StoredInfo* info)
+{
+    return info->has_cache ? info->cache : NULL;
+}
+
+void store_set_cache(StoredInfo* info, const void* data, uint32_t size)
+{
+    if (size > sizeof(info->cache)) {
+        return;
+    }
+
+    memset(info->cache, 0, sizeof(info->cache));
+    memcpy(info->cache, data, size);
+    info->has_cache = 1;
+}
@@ -28,6 +28,9 @@ enum {
     MAGIC_UNKNOWN  = 0xFF,
 };
 
+// Size of the data drivers can cache per device
+#define STORED_INFO_CACHE_SIZE 19
+
 typedef struct PACKED {
     BD_ADDR address;
     //uint8_t name[64];
@@ -38,8 +41,12 @@ typedef struct PACKED {
     that way we don't have to create a custom userconfig entry and don't leave back
     any traces on the console
 */
-    uint8_t name[56];
-    uint8_t reserved[3];
+    uint8_t name[36];
+    // driver cache, only stored if the name doesn't use these bytes
+    uint8_t cache[STORED_INFO_CACHE_SIZE];
+    // lower 16 bits of the crc32 of the cache, names which happen to end in a matching value are unlikely
+    uint16_t cache_crc;
+    uint8_t reserved[2];
     uint8_t magic;
     uint16_t vendor_id;
     uint16_t product_id;
@@ -67,6 +74,8 @@ typedef struct {
     BD_ADDR address;
     uint16_t vendor_id;
     uint16_t product_id;
+    uint8_t has_cache;
+    uint8_t cache[STORED_INFO_CACHE_SIZE];
 } StoredInfo;
 
 // read the device info and add it to the store
@@ -80,3 +89,9 @@ StoredInfo* store_allocate_device_info(uint8_t* address);
 
 // read and store info from the DI record for the specified device
 void store_read_DI_record(uint8_t* bda, tSDP_DISCOVERY_DB* db);
+
+// get the cached driver data for this device or NULL if nothing is cached
+const void* store_get_cache(StoredInfo* info);
+
+// update the cached driver data, this gets written to the device info the next time it's saved
+void store_set_cache(StoredInfo* info, const void* data, uint32_t size);
@@ -18,6 +18,9 @@
 #include "ipc.h"
 #include "info_store.h"
 #include "controllers.h"
+#include "trace.h"
+#include "capture.h"
+#include "device_registry.h"
 #include <bloopair/ipc.h>
 
 static int bloopairFunc(BtrmRequest* request, BtrmResponse* response)
@@ -28,7 +31,7 @@ static int bloopairFunc(BtrmRequest* request, BtrmResponse* response)
     switch (request->func) {
     case BLOOPAIR_FUNC_GET_VERSION:
         DEBUG_PRINT("BLOOPAIR_FUNC_GET_VERSION\n");
-        return BLOOPAIR_VERSION(1, 0, 3);
+        return BLOOPAIR_VERSION(1, 1, 0);
 
     case BLOOPAIR_FUNC_READ_CONSOLE_BDADDR: {
         DEBUG_PRINT("BLOOPAIR_FUNC_READ_CONSOLE_BDADDR\n");
@@ -59,6 +62,7 @@ static int bloopairFunc(BtrmRequest* request, BtrmResponse* response)
         info->magic = MAGIC_BLOOPAIR;
         info->product_id = data->product_id;
         info->vendor_id = data->vendor_id;
+        info->has_cache = 0;
         
         return 0;
     }
@@ -113,6 +117,23 @@ static int bloopairFunc(BtrmRequest* request, BtrmResponse* response)
         return sizeof(controller->reportBuffer);
     }
 
+    case BLOOPAIR_FUNC_READ_ACCUMULATED_RAW_REPORT: {
+        // no debug print here, this gets polled
+        BloopairAccumulatedReportRequestData* req = (BloopairAccumulatedReportRequestData*) request->data;
+        if (req->handle >= BTA_HH_MAX_KNOWN) {
+            return -4;
+        }
+
+        Controller* controller = &controllers[req->handle];
+        if (!controller->isInitialized) {
+            return -4;
+        }
+
+        readAccumulatedRawReport(controller, req->enable, (BloopairReportBuffer*) response->data);
+
+        return sizeof(BloopairReportBuffer);
+    }
+
     case BLOOPAIR_FUNC_APPLY_CONTROLLER_CONFIG: {
         DEBUG_PRINT("BLOOPAIR_FUNC_APPLY_CONTROLLER_CONFIG\n");
         BloopairApplyControllerConfigurationData* data = (BloopairApplyControllerConfigurationData*) request->data;
@@ -187,12 +208,59 @@ static int bloopairFunc(BtrmRequest* request, BtrmResponse* response)
 
             mapping->num = data->dataSize / sizeof(BloopairMappingEntry);
             memcpy(mapping->mappings, data->data, data->dataSize);
+            Configuration_CompileMapping(mapping);
             entry->mapping = mapping;
         }
 
         return 0;
     }
 
+    case BLOOPAIR_FUNC_APPLY_CONTROLLER_ACTIONS: {
+        DEBUG_PRINT("BLOOPAIR_FUNC_APPLY_CONTROLLER_ACTIONS\n");
+
+        BloopairApplyControllerConfigurationData* data = (BloopairApplyControllerConfigurationData*) request->data;
+        if (data->dataSize % sizeof(BloopairActionEntry) != 0 || data->dataSize > BLOOPAIR_MAX_ACTIONS * sizeof(BloopairActionEntry)) {
+            return -4;
+        }
+
+        ConfigurationEntry* entry;
+        if (data->controllerType != BLOOPAIR_CONTROLLER_INVALID) {
+            entry = Configuration_GetForControllerType(data->controllerType, 1);
+        } else {
+            // use bda
+            entry = Configuration_GetForBDA(data->bd_address, 1);
+        }
+
+        if (!entry) {
+            return -4;
+        }
+
+        // If we already have an entry in here free it
+        if (entry->actions) {
+            IOS_Free(LOCAL_PROCESS_HEAP_ID, entry->actions);
+            entry->actions = NULL;
+        }
+
+        if (data->dataSize != 0) {
+            // Allocate new actions
+            ActionConfiguration* actions = IOS_Alloc(LOCAL_PROCESS_HEAP_ID, sizeof(ActionConfiguration) + data->dataSize);
+            if (!actions) {
+                return -22;
+            }
+
+            actions->num = data->dataSize / sizeof(BloopairActionEntry);
+            memcpy(actions->actions, data->data, data->dataSize);
+            if (Configuration_CompileActions(actions) != 0) {
+                IOS_Free(LOCAL_PROCESS_HEAP_ID, actions);
+                return -4;
+            }
+
+            entry->actions = actions;
+        }
+
+        return 0;
+    }
+
     case BLOOPAIR_FUNC_APPLY_CUSTOM_CONFIGURATION: {
         DEBUG_PRINT("BLOOPAIR_FUNC_APPLY_CUSTOM_CONFIGURATION\n");
 
@@ -291,6 +359,28 @@ static int bloopairFunc(BtrmRequest* request, BtrmResponse* response)
         return mapping->num;
     }
 
+    case BLOOPAIR_FUNC_GET_CONTROLLER_ACTIONS: {
+        DEBUG_PRINT("BLOOPAIR_FUNC_GET_CONTROLLER_ACTIONS\n");
+
+        BloopairControllerRequestData* data = (BloopairControllerRequestData*) request->data;
+        if (data->handle >= BTA_HH_MAX_KNOWN) {
+            return -4;
+        }
+
+        Controller* controller = &controllers[data->handle];
+        if (!controller->isInitialized) {
+            return -4;
+        }
+
+        ActionConfiguration* actions = controller->actions;
+        if (!actions) {
+            return 0;
+        }
+
+        memcpy(response->data, actions->actions, actions->num * sizeof(BloopairActionEntry));
+        return actions->num;
+    }
+
     case BLOOPAIR_FUNC_GET_CUSTOM_CONFIGURATION: {
         DEBUG_PRINT("BLOOPAIR_FUNC_GET_CUSTOM_CONFIGURATION\n");
 
@@ -327,6 +417,94 @@ static int bloopairFunc(BtrmRequest* request, BtrmResponse* response)
         return customSize;
     }
 
+    case BLOOPAIR_FUNC_GET_CONTROLLER_STATISTICS: {
+        // no debug print here, this gets polled
+        BloopairControllerRequestData* req = (BloopairControllerRequestData*) request->data;
+        BloopairControllerStatisticsData* resp = (BloopairControllerStatisticsData*) response->data;
+        if (req->handle >= BTA_HH_MAX_KNOWN) {
+            return -4;
+        }
+
+        Controller* controller = &controllers[req->handle];
+        if (!controller->isInitialized) {
+            return -4;
+        }
+
+        ControllerStatistics* stats = &controller->stats;
+        IOS_GetUpTime64(&resp->uptime);
+        resp->numReceived = stats->numReceived;
+        resp->numSent = stats->numSent;
+        resp->latencyTotal = stats->latencyTotal;
+        resp->latencyCount = stats->latencyCount;
+        resp->latencyMax = stats->latencyMax;
+
+        // the maximum is only meaningful for the time between two reads
+        stats->latencyMax = 0;
+
+        return sizeof(*resp);
+    }
+
+    case BLOOPAIR_FUNC_READ_TRACE: {
+        // no debug print here, this gets polled
+#ifdef BLOOPAIR_TRACE
+        BloopairTraceRequestData* data = (BloopairTraceRequestData*) request->data;
+        if (data->maxRecords > BLOOPAIR_TRACE_MAX_RECORDS_PER_READ) {
+            return -4;
+        }
+
+        return traceRead(data->enableMask, (BloopairTraceData*) response->data, data->maxRecords);
+#else
+        return -4;
+#endif
+    }
+
+    case BLOOPAIR_FUNC_READ_CAPTURE: {
+        // no debug print here, this gets polled
+#ifdef BLOOPAIR_CAPTURE
+        BloopairCaptureRequestData* data = (BloopairCaptureRequestData*) request->data;
+        if (data->maxSize > BLOOPAIR_CAPTURE_MAX_READ_SIZE) {
+            return -4;
+        }
+
+        return captureRead(data->enable, (BloopairCaptureData*) response->data, data->maxSize);
+#else
+        return -4;
+#endif
+    }
+
+    case BLOOPAIR_FUNC_SET_CONFIGURATION_PROFILE: {
+        DEBUG_PRINT("BLOOPAIR_FUNC_SET_CONFIGURATION_PROFILE\n");
+
+        BloopairProfileData* data = (BloopairProfileData*) request->data;
+        if (Configuration_SetEditProfile(data->titleId) != 0) {
+            return -22;
+        }
+
+        return 0;
+    }
+
+    case BLOOPAIR_FUNC_SELECT_PROFILE: {
+        DEBUG_PRINT("BLOOPAIR_FUNC_SELECT_PROFILE\n");
+
+        BloopairProfileData* data = (BloopairProfileData*) request->data;
+        return Configuration_SelectProfile(data->titleId);
+    }
+
+    case BLOOPAIR_FUNC_ADD_DEVICE_ENTRIES: {
+        DEBUG_PRINT("BLOOPAIR_FUNC_ADD_DEVICE_ENTRIES\n");
+
+        BloopairAddDeviceEntriesData* data = (BloopairAddDeviceEntriesData*) request->data;
+        if (data->numEntries > BLOOPAIR_MAX_DEVICE_ENTRIES_PER_REQUEST) {
+            return -4;
+        }
+
+        if (DeviceRegistry_Add(data->entries, data->numEntries) != 0) {
+            return -22;
+        }
+
+        return 0;
+    }
+
     }
 
     return -4;
@@ -19,11 +19,16 @@
 #include "wiimote_crypto.h"
 #include "controllers.h"
 #include "utils.h"
+#include "trace.h"
+#include "capture.h"
 
 #define HH_SEND_DATA_OFFSET 0x29
 
 static const uint8_t wiiu_pro_controller_id[] = { 0x00, 0x00, 0xa4, 0x20, 0x01, 0x20 };
 
+// Id of an inactive MotionPlus, once activated it moves to the extension registers
+static const uint8_t mpls_inactive_id[] = { 0x00, 0x00, 0xa6, 0x20, 0x00, 0x05 };
+
 // Motion Plus configuration dumped from a pro controller, unsure what for
 static const uint8_t wiiu_pro_controller_mpls_config[] = {
     0xff, 0xff, 0xff, 0x00, 0xff, 0xff, 0x01, 0x00, 0x00, 0x20,
@@ -60,6 +65,8 @@ void sendOutputData(uint8_t dev_handle, const void* data, uint16_t len)
         return;
     }
 
+    CAPTURE(dev_handle, BLOOPAIR_CAPTURE_TYPE_OUTPUT, data, len);
+
     p_buf->len = len;
     p_buf->offset = HH_SEND_DATA_OFFSET;
     memcpy(((uint8_t*) p_buf) + sizeof(BT_HDR) + HH_SEND_DATA_OFFSET, data, p_buf->len);
@@ -79,6 +86,11 @@ void setReport(uint8_t dev_handle, uint8_t type, const void* data, uint16_t len)
     bta_hh_snd_write_dev(dev_handle, HID_TRANS_SET_REPORT, type, 0, 0, p_buf);
 }
 
+void getReport(uint8_t dev_handle, uint8_t type, uint8_t report_id)
+{
+    bta_hh_snd_write_dev(dev_handle, HID_TRANS_GET_REPORT, type, 0, report_id, NULL);
+}
+
 static void sendAcknowledgeReport(uint8_t dev_handle, uint8_t report, uint8_t result)
 {
     WMAcknowledgeReport ack;
@@ -146,7 +158,23 @@ static void writeMemory(uint8_t dev_handle, uint32_t address, uint8_t* data, uin
     case 0x04a20001:
         sendAcknowledgeReport(dev_handle, WM_REPORT_ID_MEMORY_WRITE, len == 1 ? 0 : 7);
         return;
+    case 0x04a600fe: // activate mpls
+        // The sticks and buttons are passed through as a Classic Controller,
+        // there's no Nunchuk for the Nunchuk passthrough mode (0x05)
+        if (len == 1 && (data[0] == MPLS_MODE_ONLY || data[0] == MPLS_MODE_CLASSIC_PASSTHROUGH) && controller->hasMotion) {
+            DEBUG_PRINT("mpls activated mode %x\n", data[0]);
+            controller->motionPlusMode = data[0];
+            controller->motionPlusExtensionFrame = 0;
+            sendAcknowledgeReport(dev_handle, WM_REPORT_ID_MEMORY_WRITE, 0);
+            return;
+        }
+        break;
     case 0x04a400f0: // init extension
+        // this also deactivates mpls again
+        controller->motionPlusMode = 0;
+        sendAcknowledgeReport(dev_handle, WM_REPORT_ID_MEMORY_WRITE, 0);
+        return;
+    case 0x04a600f0: // init mpls
     case 0x04a400fb: // init extension 2
     case 0x04b00000:
     case 0x04b0001a:
@@ -172,10 +200,26 @@ static void readMemory(uint8_t dev_handle, uint32_t address, uint16_t len)
     switch (address) {
     case 0x04a400fa: // extension
         if (len == 6) {
+            if (controller->motionPlusMode) {
+                uint8_t id[6];
+                memcpy(id, mpls_inactive_id, sizeof(id));
+                id[2] = 0xa4;
+                id[4] = controller->motionPlusMode;
+                sendReadResponse(dev_handle, 0, address, id, sizeof(id));
+                return;
+            }
+
             sendReadResponse(dev_handle, 0, address, wiiu_pro_controller_id, sizeof(wiiu_pro_controller_id));
             return;
         }
         break;
+    case 0x04a600fa: // mpls
+        // only controllers with motion data have a MotionPlus
+        if (len == 6 && controller->hasMotion) {
+            sendReadResponse(dev_handle, 0, address, mpls_inactive_id, sizeof(mpls_inactive_id));
+            return;
+        }
+        break;
     case 0x04a600f0: // mpls config
         if (len == 16) {
             sendReadResponse(dev_handle, 0, address, wiiu_pro_controller_mpls_config, sizeof(wiiu_pro_controller_mpls_config));
@@ -214,7 +258,7 @@ void processSmdMessages(void)
     SMDOutputMessage msg;
     while (smdIopReceive(smdIopIndex, &msg) != -0xc0005) {
         WMReport* report = &msg.report;
-        DEBUG_PRINT("output request for handle %u size %u, cmd: 0x%X\n", msg.dev_handle, msg.length, report->report_id);
+        TRACE(BLOOPAIR_TRACE_EVENT_SMD_OUTPUT, msg.dev_handle, msg.length, report->report_id);
 
         Controller* controller = &controllers[msg.dev_handle];
         if (!controller->isInitialized) {
@@ -299,8 +343,8 @@ void processSmdMessages(void)
                     status.flags |= 0x8;
                 }
                 status.unused = 0;
-                // TODO
-                status.battery_level = 0xff;
+                // with MotionPlus active the battery isn't part of the extension data anymore
+                status.battery_level = controller->motionPlusMode ? controller->battery * 0xff / 4 : 0xff;
                 sendInputData(msg.dev_handle, &status, sizeof(status));
                 break;
             }
@@ -334,14 +378,19 @@ void bta_hh_co_data(uint8_t dev_handle, uint8_t *p_rpt, uint16_t len, uint8_t mo
         return;
     }
 
+    CAPTURE(dev_handle, BLOOPAIR_CAPTURE_TYPE_INPUT, p_rpt, len);
+
     Controller* controller = &controllers[dev_handle];
     if (!controller->isInitialized) {
         return;
     }
 
+    recordControllerReport(controller);
+
     if (controller->type == BLOOPAIR_CONTROLLER_OFFICIAL) {
         // we can just pass received data from official controllers to padscore
         sendInputData(dev_handle, p_rpt, len);
+        recordControllerSent(controller);
 #ifdef TESTING
         if (p_rpt[0] == WM_REPORT_ID_STATUS) {
             dumpHex(p_rpt, len);
@@ -357,6 +406,7 @@ void bta_hh_co_data(uint8_t dev_handle, uint8_t *p_rpt, uint16_t len, uint8_t mo
         // pass received data to the controller
         if (controller->data) {
             controller->data(controller, p_rpt, len);
+            accumulateRawReport(controller);
         }
     }
 }
@@ -40,6 +40,7 @@ enum {
     WM_REPORT_ID_MEMORY_DATA    = 0x21,
     WM_REPORT_ID_ACKNOWLEDGE    = 0x22,
 
+    WM_REPORT_ID_CORE_ACCEL_EXTENSION_REPORT = 0x35,
     WM_REPORT_ID_EXTENSION_DATA_REPORT = 0x3d,
 };
 
@@ -132,7 +133,7 @@ typedef struct PACKED {
 } WMAcknowledgeReport;
 CHECK_SIZE(WMAcknowledgeReport, 5);
 
-typedef union {
+typedef union PACKED {
     uint8_t report_id;
     WMRumbleReport rumble;
     WMLEDReport led;
@@ -173,3 +174,6 @@ void sendInputData(uint8_t dev_handle, const void* data, uint16_t len);
 void sendOutputData(uint8_t dev_handle, const void* data, uint16_t len);
 
 void setReport(uint8_t dev_handle, uint8_t type, const void* data, uint16_t len);
+
+// the response is passed to the getReportResponse function of the controller
+void getReport(uint8_t dev_handle, uint8_t type, uint8_t report_id);
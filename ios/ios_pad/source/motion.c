@@ -0,0 +1,140 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "motion.h"
+#include "utils.h"
+
+// Information about the MotionPlus data format can be found here:
+// - <https://wiibrew.org/wiki/Wiimote/Extension_Controllers/Wii_Motion_Plus>
+
+// MotionPlus values are 14-bit with 8192 at rest
+#define MPLS_ZERO_VALUE     8192
+#define MPLS_MAX_VALUE      16383
+
+// Full scale of the slow and fast mode in degrees per second
+#define MPLS_SLOW_MAX_DPS   440
+#define MPLS_FAST_MAX_DPS   2000
+
+// The wii remote accelerometer reports 10-bit values with 512 at rest and ~104 units per G
+#define CORE_ACCEL_ZERO_VALUE   512
+#define CORE_ACCEL_RES_PER_G    104
+#define CORE_ACCEL_MAX_VALUE    1023
+
+int16_t scaleMotionValue(int32_t value, int32_t numerator, int32_t denominator)
+{
+    if (denominator == 0) {
+        return 0;
+    }
+
+    int64_t scaled = ((int64_t) value * numerator) / denominator;
+    return CLAMP(scaled, -0x8000, 0x7fff);
+}
+
+void setNominalMotionCalibration(MotionCalibration* calibration, int32_t gyroResPerDps, int32_t accelResPerG)
+{
+    for (int i = 0; i < 3; i++) {
+        calibration->gyro[i].bias = 0;
+        calibration->gyro[i].numerator = MOTION_GYRO_RES_PER_DPS;
+        calibration->gyro[i].denominator = gyroResPerDps;
+        calibration->accel[i].bias = 0;
+        calibration->accel[i].numerator = MOTION_ACCEL_RES_PER_G;
+        calibration->accel[i].denominator = accelResPerG;
+    }
+}
+
+int setGyroAxisCalibration(MotionAxisCalibration* axis, int16_t bias, int16_t plus, int16_t minus, int32_t speedPlus, int32_t speedMinus)
+{
+    int32_t range = ABS(plus - bias) + ABS(minus - bias);
+    int32_t speed = speedPlus + speedMinus;
+    if (range == 0 || speed <= 0) {
+        return 0;
+    }
+
+    // The reported values already have the bias removed, it's only needed to measure the range
+    axis->bias = 0;
+    axis->numerator = speed * MOTION_GYRO_RES_PER_DPS;
+    axis->denominator = range;
+    return 1;
+}
+
+int setAccelAxisCalibration(MotionAxisCalibration* axis, int16_t plus, int16_t minus)
+{
+    int32_t range = plus - minus;
+    if (range <= 0) {
+        return 0;
+    }
+
+    axis->bias = plus - range / 2;
+    axis->numerator = 2 * MOTION_ACCEL_RES_PER_G;
+    axis->denominator = range;
+    return 1;
+}
+
+void calibrateMotion(ControllerMotion* motion, const MotionCalibration* calibration, const int16_t* gyro, const int16_t* accel)
+{
+    for (int i = 0; i < 3; i++) {
+        const MotionAxisCalibration* g = &calibration->gyro[i];
+        const MotionAxisCalibration* a = &calibration->accel[i];
+        motion->gyro[i] = scaleMotionValue(gyro[i] - g->bias, g->numerator, g->denominator);
+        motion->accel[i] = scaleMotionValue(accel[i] - a->bias, a->numerator, a->denominator);
+    }
+}
+
+static uint16_t encodeMotionPlusAxis(int16_t gyro, uint8_t* slow)
+{
+    int32_t value = gyro;
+
+    // Use slow mode for everything fitting into its range for the better resolution
+    if (value > -MPLS_SLOW_MAX_DPS * MOTION_GYRO_RES_PER_DPS && value < MPLS_SLOW_MAX_DPS * MOTION_GYRO_RES_PER_DPS) {
+        *slow = 1;
+        value = value * MPLS_ZERO_VALUE / (MPLS_SLOW_MAX_DPS * MOTION_GYRO_RES_PER_DPS);
+    } else {
+        *slow = 0;
+        value = value * MPLS_ZERO_VALUE / (MPLS_FAST_MAX_DPS * MOTION_GYRO_RES_PER_DPS);
+    }
+
+    return CLAMP(MPLS_ZERO_VALUE + value, 0, MPLS_MAX_VALUE);
+}
+
+void motionToMotionPlus(const ControllerMotion* motion, uint8_t* out)
+{
+    uint8_t yawSlow, rollSlow, pitchSlow;
+    uint16_t yaw = encodeMotionPlusAxis(motion->gyro[1], &yawSlow);
+    uint16_t roll = encodeMotionPlusAxis(motion->gyro[2], &rollSlow);
+    uint16_t pitch = encodeMotionPlusAxis(motion->gyro[0], &pitchSlow);
+
+    out[0] = yaw & 0xff;
+    out[1] = ((yaw >> 8) << 2) | (yawSlow << 1) | pitchSlow;
+    out[2] = roll & 0xff;
+    out[3] = ((roll >> 8) << 2) | (rollSlow << 1);
+    out[4] = pitch & 0xff;
+    // bit 1 marks this as MotionPlus data, bit 0 would be an extension connected to the passthrough port
+    out[5] = ((pitch >> 8) << 2) | 0x2;
+}
+
+static uint16_t encodeCoreAccelAxis(int32_t accel)
+{
+    return CLAMP(CORE_ACCEL_ZERO_VALUE + accel * CORE_ACCEL_RES_PER_G / MOTION_ACCEL_RES_PER_G, 0, CORE_ACCEL_MAX_VALUE);
+}
+
+void motionToCoreAccel(const ControllerMotion* motion, uint16_t* out)
+{
+    // The wii remote x axis points to the left, y points forward and z points up
+    out[0] = encodeCoreAccelAxis(-motion->accel[0]);
+    out[1] = encodeCoreAccelAxis(-motion->accel[2]);
+    out[2] = encodeCoreAccelAxis(motion->accel[1]);
+}
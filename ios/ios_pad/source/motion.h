@@ -0,0 +1,72 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <imports.h>
+
+// Motion data is kept in a common format by all controllers with an IMU and
+// converted to MotionPlus data once padscore enables it.
+// Axes follow the orientation of a controller lying flat in front of the player:
+// x points to the right, y points up and z points towards the player.
+
+// Angular velocity units per degree per second
+#define MOTION_GYRO_RES_PER_DPS 16
+// Acceleration units per G
+#define MOTION_ACCEL_RES_PER_G  4096
+
+typedef struct {
+    // angular velocity around the x (pitch), y (yaw) and z (roll) axis
+    int16_t gyro[3];
+    // acceleration along the x, y and z axis
+    int16_t accel[3];
+} ControllerMotion;
+
+// Calibration of a single sensor axis, the calibrated value is (raw - bias) * numerator / denominator
+typedef struct {
+    int16_t bias;
+    int32_t numerator;
+    int32_t denominator;
+} MotionAxisCalibration;
+
+typedef struct {
+    MotionAxisCalibration gyro[3];
+    MotionAxisCalibration accel[3];
+} MotionCalibration;
+
+// Scales a raw sensor value with integer math, clamped to the int16 range
+int16_t scaleMotionValue(int32_t value, int32_t numerator, int32_t denominator);
+
+// Sets up all axes for the nominal resolution of a sensor, in raw units per dps and per G
+void setNominalMotionCalibration(MotionCalibration* calibration, int32_t gyroResPerDps, int32_t accelResPerG);
+
+// Sets up a gyro axis from the raw values read while turning at +speedPlus and -speedMinus dps,
+// returns 0 and leaves the axis alone if they're unusable
+int setGyroAxisCalibration(MotionAxisCalibration* axis, int16_t bias, int16_t plus, int16_t minus, int32_t speedPlus, int32_t speedMinus);
+
+// Sets up an accelerometer axis from the raw values read at +1G and -1G,
+// returns 0 and leaves the axis alone if they're unusable
+int setAccelAxisCalibration(MotionAxisCalibration* axis, int16_t plus, int16_t minus);
+
+// Calibrates raw gyro and accelerometer values, which are already in the common axis order
+void calibrateMotion(ControllerMotion* motion, const MotionCalibration* calibration, const int16_t* gyro, const int16_t* accel);
+
+// Converts the motion data to the 6 bytes of MotionPlus extension data
+void motionToMotionPlus(const ControllerMotion* motion, uint8_t* out);
+
+// Converts the acceleration to the 10-bit values of the wii remote accelerometer
+void motionToCoreAccel(const ControllerMotion* motion, uint16_t* out);
@@ -0,0 +1,125 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trace.h"
+
+#ifdef BLOOPAIR_TRACE
+
+uint32_t traceEnableMask = BLOOPAIR_TRACE_CATEGORY_ALL;
+
+typedef struct {
+    // Position of the record plus one once it has been written completely, 0 while it's being written
+    volatile uint32_t sequence;
+    BloopairTraceRecord record;
+} TraceSlot;
+
+static TraceSlot traceBuffer[TRACE_BUFFER_SIZE];
+
+// Records come from the bt, smd and report threads, while the ipc thread reads them.
+// Writers reserve a position while holding the reserve lock, then fill the slot and publish it with its sequence.
+// Both positions only ever increase, the buffer index is the lower bits.
+static volatile uint32_t traceWritePos = 0;
+static volatile uint32_t traceReserveLock = 0;
+static uint32_t traceReadPos = 0;
+static uint32_t traceLost = 0;
+
+// Records dropped because another thread was preempted while reserving, this only ever increases
+static volatile uint32_t traceContended = 0;
+static uint32_t traceContendedRead = 0;
+
+void traceRecord(uint8_t event, uint8_t handle, uint16_t arg0, uint32_t arg1)
+{
+    // Don't wait for the lock, the thread holding it might have a lower priority and never get to release it
+    if (atomicSwap(&traceReserveLock, 1)) {
+        traceContended++;
+        return;
+    }
+
+    uint32_t pos = traceWritePos++;
+    COMPILER_BARRIER();
+    traceReserveLock = 0;
+
+    uint64_t time;
+    IOS_GetUpTime64(&time);
+
+    TraceSlot* slot = &traceBuffer[pos & (TRACE_BUFFER_SIZE - 1)];
+    slot->sequence = 0;
+    COMPILER_BARRIER();
+
+    slot->record.timestamp = (uint32_t) time;
+    slot->record.event = event;
+    slot->record.handle = handle;
+    slot->record.arg0 = arg0;
+    slot->record.arg1 = arg1;
+
+    COMPILER_BARRIER();
+    slot->sequence = pos + 1;
+}
+
+int traceRead(uint32_t enableMask, BloopairTraceData* out, uint32_t maxRecords)
+{
+    traceEnableMask = enableMask;
+
+    // Skip anything which has been overwritten already
+    uint32_t available = traceWritePos - traceReadPos;
+    if (available > TRACE_BUFFER_SIZE) {
+        traceLost += available - TRACE_BUFFER_SIZE;
+        traceReadPos += available - TRACE_BUFFER_SIZE;
+        available = TRACE_BUFFER_SIZE;
+    }
+
+    if (available > maxRecords) {
+        available = maxRecords;
+    }
+
+    uint32_t numRecords = 0;
+    for (uint32_t i = 0; i < available; i++) {
+        TraceSlot* slot = &traceBuffer[traceReadPos & (TRACE_BUFFER_SIZE - 1)];
+        uint32_t sequence = slot->sequence;
+
+        // The writer of this record hasn't finished yet, continue from here with the next read
+        if (sequence == 0 || sequence < traceReadPos + 1) {
+            break;
+        }
+
+        if (sequence == traceReadPos + 1) {
+            out->records[numRecords] = slot->record;
+            COMPILER_BARRIER();
+
+            // Only keep the copy if the slot wasn't reused while copying it
+            if (slot->sequence == sequence) {
+                numRecords++;
+            } else {
+                traceLost++;
+            }
+        } else {
+            traceLost++;
+        }
+
+        traceReadPos++;
+    }
+
+    uint32_t contended = traceContended;
+    out->numLost = traceLost + (contended - traceContendedRead);
+    out->numRecords = numRecords;
+    traceContendedRead = contended;
+    traceLost = 0;
+
+    return sizeof(BloopairTraceData) + numRecords * sizeof(BloopairTraceRecord);
+}
+
+#endif
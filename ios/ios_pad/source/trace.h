@@ -0,0 +1,46 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <imports.h>
+#include <bloopair/trace.h>
+
+#ifdef BLOOPAIR_TRACE
+
+// Must be a power of two
+#define TRACE_BUFFER_SIZE 256
+
+extern uint32_t traceEnableMask;
+
+void traceRecord(uint8_t event, uint8_t handle, uint16_t arg0, uint32_t arg1);
+
+// Drains up to maxRecords records into out, returns the amount of bytes written
+int traceRead(uint32_t enableMask, BloopairTraceData* out, uint32_t maxRecords);
+
+#define TRACE(event, handle, arg0, arg1) \
+    do { \
+        if (traceEnableMask & BLOOPAIR_TRACE_EVENT_CATEGORY(event)) { \
+            traceRecord(event, handle, (uint16_t) (arg0), (uint32_t) (arg1)); \
+        } \
+    } while (0)
+
+#else
+
+#define TRACE(event, handle, arg0, arg1)
+
+#endif
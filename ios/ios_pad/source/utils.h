@@ -22,7 +22,13 @@
 #include <stdint.h>
 #include <assert.h>
 
+#ifdef BLOOPAIR_HOST
+// Host builds keep the big endian layout of the IOS for reports, so the drivers decode them the same way.
+// This includes the bitfield order, which is why structs nested in reports need to be PACKED as well.
+#define PACKED __attribute__ ((__packed__, scalar_storage_order("big-endian")))
+#else
 #define PACKED __attribute__ ((__packed__))
+#endif
 
 #define CHECK_SIZE(type, size) static_assert(sizeof(type) == size, #type " must be " #size " bytes")
 
@@ -34,6 +40,12 @@
     addr, \
     });
 
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+#define ABS(x) (((x) < 0) ? -(x) : (x))
+
 #define CLAMP(x, low, high) (((x) > (high)) ? (high) : (((x) < (low)) ? (low) : (x)))
 
 #define SCALE(x, oldMin, oldMax, newMin, newMax) ((newMin) + ((newMax) - (newMin)) * ((x) - (oldMin)) / ((oldMax) - (oldMin)))
@@ -41,6 +53,22 @@
 #define bswap16 __builtin_bswap16
 #define bswap32 __builtin_bswap32
 
+// Keeps the compiler from moving memory accesses across this point, the IOS runs on a single in-order core
+#define COMPILER_BARRIER() __asm__ volatile("" ::: "memory")
+
+// Stores value and returns the previous one as a single atomic operation.
+// The ARM926 has no exclusive loads and stores, but it still has swp.
+static inline uint32_t atomicSwap(volatile uint32_t* ptr, uint32_t value)
+{
+#ifdef __arm__
+    uint32_t old;
+    __asm__ volatile("swp %0, %1, [%2]" : "=&r" (old) : "r" (value), "r" (ptr) : "memory");
+    return old;
+#else
+    return __atomic_exchange_n(ptr, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
 uint32_t crc32(uint32_t seed, const void* data, size_t len);
 
 void dumpHex(const void *data, size_t size);
@@ -0,0 +1,42 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+// Host replacement for the parts of wut the Koopair input code uses, see host.h
+
+#include <stdint.h>
+
+typedef int64_t OSTime;
+
+// The bus clock of the Wii U is 248.625 MHz, the timer runs at a quarter of it
+#define OSTimerClockSpeed (248625000 / 4)
+
+#define OSSecondsToTicks(val) ((uint64_t) (val) * (uint64_t) OSTimerClockSpeed)
+#define OSMillisecondsToTicks(val) (((uint64_t) (val) * (uint64_t) (OSTimerClockSpeed / 125)) / 8)
+#define OSTicksToMicroseconds(val) (((uint64_t) (val) * 8) / (OSTimerClockSpeed / 125000))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+OSTime OSGetTime(void);
+
+OSTime OSGetSystemTime(void);
+
+#ifdef __cplusplus
+}
+#endif
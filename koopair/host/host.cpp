@@ -0,0 +1,234 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "host.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "BloopairIPC.hpp"
+#include "FrameClock.hpp"
+#include "Gfx.hpp"
+#include "MessageBox.hpp"
+#include "screens/ControllerListOptionsScreen.hpp"
+
+namespace
+{
+
+struct HostKPAD {
+    bool connected;
+    WPADExtensionType extension;
+    BloopairControllerType type;
+    std::array<KPADStatus, KPADController::kMaxSamples> samples;
+    uint32_t numSamples;
+};
+
+bool vpadConnected = false;
+VPADStatus vpadStatus{};
+
+std::array<HostKPAD, 7> kpads{};
+
+// Starts somewhere other than zero, like the console does
+OSTime hostTime = OSSecondsToTicks(1000);
+
+}
+
+void Host_SetVPAD(const VPADStatus* status)
+{
+    vpadConnected = status != nullptr;
+    if (status) {
+        vpadStatus = *status;
+    }
+}
+
+void Host_ConnectKPAD(KPADChan chan, WPADExtensionType extension, BloopairControllerType type)
+{
+    HostKPAD& kpad = kpads.at(chan);
+    kpad.connected = true;
+    kpad.extension = extension;
+    kpad.type = type;
+    kpad.numSamples = 0;
+}
+
+void Host_DisconnectKPAD(KPADChan chan)
+{
+    kpads.at(chan) = HostKPAD{};
+}
+
+void Host_QueueKPADSamples(KPADChan chan, std::span<const KPADStatus> samples)
+{
+    HostKPAD& kpad = kpads.at(chan);
+    kpad.numSamples = std::min(samples.size(), kpad.samples.size());
+    std::copy_n(samples.begin(), kpad.numSamples, kpad.samples.begin());
+}
+
+void Host_AdvanceTime(OSTime ticks)
+{
+    hostTime += ticks;
+}
+
+OSTime OSGetTime(void)
+{
+    return hostTime;
+}
+
+OSTime OSGetSystemTime(void)
+{
+    return hostTime;
+}
+
+int32_t VPADRead(VPADChan chan, VPADStatus* buffers, uint32_t count, VPADReadError* outError)
+{
+    if (!vpadConnected) {
+        *outError = VPAD_READ_INVALID_CONTROLLER;
+        return 0;
+    }
+
+    buffers[0] = vpadStatus;
+    *outError = VPAD_READ_SUCCESS;
+    return 1;
+}
+
+void KPADInit(void)
+{
+}
+
+void KPADShutdown(void)
+{
+}
+
+void KPADSetMaxControllers(uint32_t maxControllers)
+{
+}
+
+int32_t KPADReadEx(KPADChan chan, KPADStatus* data, uint32_t size, KPADError* outError)
+{
+    HostKPAD& kpad = kpads.at(chan);
+    if (!kpad.connected) {
+        *outError = KPAD_ERROR_INVALID_CONTROLLER;
+        return 0;
+    }
+
+    if (!kpad.numSamples) {
+        *outError = KPAD_ERROR_NO_SAMPLES;
+        return 0;
+    }
+
+    uint32_t count = std::min(kpad.numSamples, size);
+    std::copy_n(kpad.samples.begin(), count, data);
+    kpad.numSamples = 0;
+
+    *outError = KPAD_ERROR_OK;
+    return count;
+}
+
+int32_t WPADProbe(WPADChan chan, WPADExtensionType* outExtensionType)
+{
+    HostKPAD& kpad = kpads.at(chan);
+    if (!kpad.connected) {
+        return -1;
+    }
+
+    *outExtensionType = kpad.extension;
+    return 0;
+}
+
+void WPADDisconnect(WPADChan chan)
+{
+    Host_DisconnectKPAD(chan);
+}
+
+int32_t WPADGetAddress(WPADChan chan, WPADAddress* outAddress)
+{
+    std::memset(outAddress, 0, sizeof(*outAddress));
+    outAddress->btDeviceAddress[5] = chan;
+    return 0;
+}
+
+void WPADEnableURCC(BOOL enable)
+{
+}
+
+OSTime FrameClock::GetTime()
+{
+    return hostTime;
+}
+
+bool BloopairIPC::GetControllerInformation(KPADChan chan, BloopairControllerInformationData& outData)
+{
+    const HostKPAD& kpad = kpads.at(chan);
+    if (!kpad.connected || kpad.type == BLOOPAIR_CONTROLLER_INVALID) {
+        return false;
+    }
+
+    outData = BloopairControllerInformationData{};
+    outData.controllerType = kpad.type;
+    return true;
+}
+
+// Nothing is drawn in the host build
+
+void Gfx::DrawRectFilled(int x, int y, int w, int h, SDL_Color color)
+{
+}
+
+void Gfx::DrawRect(int x, int y, int w, int h, int borderSize, SDL_Color color)
+{
+}
+
+void Gfx::DrawIcon(int x, int y, int size, SDL_Color color, Uint16 icon, AlignFlags align, double angle)
+{
+}
+
+int Gfx::GetIconWidth(int size, Uint16 icon)
+{
+    return size;
+}
+
+void Gfx::Print(int x, int y, int size, SDL_Color color, const std::string& text, AlignFlags align, bool monospace)
+{
+}
+
+int Gfx::GetTextWidth(int size, const std::string& text, bool monospace)
+{
+    return size * text.size() / 2;
+}
+
+int Gfx::GetTextHeight(int size, const std::string& text, bool monospace)
+{
+    return size;
+}
+
+// The screens the controller list opens talk to the IOS module, they aren't part of the host build
+
+ControllerListOptionsScreen::ControllerListOptionsScreen(const KPADController* controller)
+ : mController(controller)
+{
+}
+
+ControllerListOptionsScreen::~ControllerListOptionsScreen()
+{
+}
+
+void ControllerListOptionsScreen::Draw()
+{
+}
+
+bool ControllerListOptionsScreen::Update(const CombinedInputController& input, float delta)
+{
+    return false;
+}
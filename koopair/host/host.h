@@ -0,0 +1,44 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include <coreinit/time.h>
+#include <vpad/input.h>
+#include <padscore/kpad.h>
+#include <bloopair/controllers/common.h>
+
+// Host build of the Koopair input code, used by the tests.
+// This replaces the wut functions the controllers and screens call with fake controllers set up through the functions below,
+// the Bloopair IPC with the controller types set here, and Gfx with functions which don't draw anything.
+// Only controllers, the controller manager and the screens which don't talk to the IOS module are part of it.
+
+// the status VPADRead returns, nullptr disconnects the GamePad
+void Host_SetVPAD(const VPADStatus* status);
+
+// connects a controller, type is what Bloopair reports for it, BLOOPAIR_CONTROLLER_INVALID if Bloopair doesn't know it
+void Host_ConnectKPAD(KPADChan chan, WPADExtensionType extension, BloopairControllerType type);
+
+void Host_DisconnectKPAD(KPADChan chan);
+
+// samples the next KPADReadEx returns, the newest one first, these are copied
+void Host_QueueKPADSamples(KPADChan chan, std::span<const KPADStatus> samples);
+
+// advances the time OSGetTime, OSGetSystemTime and FrameClock::GetTime return
+void Host_AdvanceTime(OSTime ticks);
@@ -0,0 +1,82 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+// Host replacement for the parts of wut the Koopair input code uses, see host.h
+
+#include <padscore/wpad.h>
+
+typedef WPADChan KPADChan;
+
+typedef enum {
+    KPAD_ERROR_OK           = 0,
+    KPAD_ERROR_NO_SAMPLES   = -1,
+    KPAD_ERROR_INVALID_CONTROLLER = -2,
+} KPADError;
+
+typedef struct {
+    float x;
+    float y;
+} KPADVec2D;
+
+typedef struct {
+    uint32_t hold;
+    uint32_t trigger;
+    uint32_t release;
+    KPADVec2D leftStick;
+    KPADVec2D rightStick;
+    float leftTrigger;
+    float rightTrigger;
+} KPADExtClassicStatus;
+
+typedef struct {
+    uint32_t hold;
+    uint32_t trigger;
+    uint32_t release;
+    KPADVec2D leftStick;
+    KPADVec2D rightStick;
+    int32_t charging;
+    int32_t wired;
+} KPADExtProControllerStatus;
+
+typedef struct {
+    uint32_t hold;
+    uint32_t trigger;
+    uint32_t release;
+    uint8_t extensionType;
+    int8_t error;
+    union {
+        KPADExtClassicStatus classic;
+        KPADExtProControllerStatus pro;
+    };
+} KPADStatus;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void KPADInit(void);
+
+void KPADShutdown(void);
+
+void KPADSetMaxControllers(uint32_t maxControllers);
+
+int32_t KPADReadEx(KPADChan chan, KPADStatus* data, uint32_t size, KPADError* outError);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,114 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+// Host replacement for the parts of wut the Koopair input code uses, see host.h
+
+#include <coreinit/ios.h>
+
+typedef enum {
+    WPAD_CHAN_0,
+    WPAD_CHAN_1,
+    WPAD_CHAN_2,
+    WPAD_CHAN_3,
+    WPAD_CHAN_4,
+    WPAD_CHAN_5,
+    WPAD_CHAN_6,
+} WPADChan;
+
+typedef enum {
+    WPAD_EXT_CORE           = 0,
+    WPAD_EXT_NUNCHUK        = 1,
+    WPAD_EXT_CLASSIC        = 2,
+    WPAD_EXT_MPLUS          = 5,
+    WPAD_EXT_MPLUS_NUNCHUK  = 6,
+    WPAD_EXT_MPLUS_CLASSIC  = 7,
+    WPAD_EXT_PRO_CONTROLLER = 31,
+} WPADExtensionType;
+
+typedef enum {
+    WPAD_BUTTON_LEFT        = 0x0001,
+    WPAD_BUTTON_RIGHT       = 0x0002,
+    WPAD_BUTTON_DOWN        = 0x0004,
+    WPAD_BUTTON_UP          = 0x0008,
+    WPAD_BUTTON_PLUS        = 0x0010,
+    WPAD_BUTTON_2           = 0x0100,
+    WPAD_BUTTON_1           = 0x0200,
+    WPAD_BUTTON_B           = 0x0400,
+    WPAD_BUTTON_A           = 0x0800,
+    WPAD_BUTTON_MINUS       = 0x1000,
+    WPAD_BUTTON_HOME        = 0x8000,
+} WPADButton;
+
+typedef enum {
+    WPAD_CLASSIC_BUTTON_UP      = 0x0001,
+    WPAD_CLASSIC_BUTTON_LEFT    = 0x0002,
+    WPAD_CLASSIC_BUTTON_ZR      = 0x0004,
+    WPAD_CLASSIC_BUTTON_X       = 0x0008,
+    WPAD_CLASSIC_BUTTON_A       = 0x0010,
+    WPAD_CLASSIC_BUTTON_Y       = 0x0020,
+    WPAD_CLASSIC_BUTTON_B       = 0x0040,
+    WPAD_CLASSIC_BUTTON_ZL      = 0x0080,
+    WPAD_CLASSIC_BUTTON_R       = 0x0200,
+    WPAD_CLASSIC_BUTTON_PLUS    = 0x0400,
+    WPAD_CLASSIC_BUTTON_HOME    = 0x0800,
+    WPAD_CLASSIC_BUTTON_MINUS   = 0x1000,
+    WPAD_CLASSIC_BUTTON_L       = 0x2000,
+    WPAD_CLASSIC_BUTTON_DOWN    = 0x4000,
+    WPAD_CLASSIC_BUTTON_RIGHT   = 0x8000,
+} WPADClassicButton;
+
+typedef enum {
+    WPAD_PRO_BUTTON_UP          = 0x00000001,
+    WPAD_PRO_BUTTON_LEFT        = 0x00000002,
+    WPAD_PRO_TRIGGER_ZR         = 0x00000004,
+    WPAD_PRO_BUTTON_X           = 0x00000008,
+    WPAD_PRO_BUTTON_A           = 0x00000010,
+    WPAD_PRO_BUTTON_Y           = 0x00000020,
+    WPAD_PRO_BUTTON_B           = 0x00000040,
+    WPAD_PRO_TRIGGER_ZL         = 0x00000080,
+    WPAD_PRO_RESERVED           = 0x00000100,
+    WPAD_PRO_TRIGGER_R          = 0x00000200,
+    WPAD_PRO_BUTTON_PLUS        = 0x00000400,
+    WPAD_PRO_BUTTON_HOME        = 0x00000800,
+    WPAD_PRO_BUTTON_MINUS       = 0x00001000,
+    WPAD_PRO_TRIGGER_L          = 0x00002000,
+    WPAD_PRO_BUTTON_DOWN        = 0x00004000,
+    WPAD_PRO_BUTTON_RIGHT       = 0x00008000,
+    WPAD_PRO_BUTTON_STICK_R     = 0x00010000,
+    WPAD_PRO_BUTTON_STICK_L     = 0x00020000,
+} WPADProButton;
+
+typedef struct {
+    uint8_t btDeviceAddress[6];
+} WPADAddress;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int32_t WPADProbe(WPADChan chan, WPADExtensionType* outExtensionType);
+
+void WPADDisconnect(WPADChan chan);
+
+int32_t WPADGetAddress(WPADChan chan, WPADAddress* outAddress);
+
+void WPADEnableURCC(BOOL enable);
+
+#ifdef __cplusplus
+}
+#endif
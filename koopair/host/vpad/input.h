@@ -0,0 +1,75 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+// Host replacement for the parts of wut the Koopair input code uses, see host.h
+
+#include <stdint.h>
+
+typedef enum {
+    VPAD_CHAN_0,
+} VPADChan;
+
+typedef enum {
+    VPAD_READ_SUCCESS       = 0,
+    VPAD_READ_NO_SAMPLES    = -1,
+    VPAD_READ_INVALID_CONTROLLER = -2,
+} VPADReadError;
+
+typedef enum {
+    VPAD_BUTTON_SYNC        = 0x00000001,
+    VPAD_BUTTON_HOME        = 0x00000002,
+    VPAD_BUTTON_MINUS       = 0x00000004,
+    VPAD_BUTTON_PLUS        = 0x00000008,
+    VPAD_BUTTON_R           = 0x00000010,
+    VPAD_BUTTON_L           = 0x00000020,
+    VPAD_BUTTON_ZR          = 0x00000040,
+    VPAD_BUTTON_ZL          = 0x00000080,
+    VPAD_BUTTON_DOWN        = 0x00000100,
+    VPAD_BUTTON_UP          = 0x00000200,
+    VPAD_BUTTON_RIGHT       = 0x00000400,
+    VPAD_BUTTON_LEFT        = 0x00000800,
+    VPAD_BUTTON_Y           = 0x00001000,
+    VPAD_BUTTON_X           = 0x00002000,
+    VPAD_BUTTON_B           = 0x00004000,
+    VPAD_BUTTON_A           = 0x00008000,
+    VPAD_BUTTON_STICK_R     = 0x00020000,
+    VPAD_BUTTON_STICK_L     = 0x00040000,
+} VPADButtons;
+
+typedef struct {
+    float x;
+    float y;
+} VPADVec2D;
+
+typedef struct {
+    uint32_t hold;
+    uint32_t trigger;
+    uint32_t release;
+    VPADVec2D leftStick;
+    VPADVec2D rightStick;
+} VPADStatus;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int32_t VPADRead(VPADChan chan, VPADStatus* buffers, uint32_t count, VPADReadError* outError);
+
+#ifdef __cplusplus
+}
+#endif
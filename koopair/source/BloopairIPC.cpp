@@ -102,6 +102,16 @@ bool ReadRawReport(KPADChan chan, BloopairReportBuffer& outReport)
     return Bloopair_ReadRawReport(bloopairHandle, (WPADChan) chan, &outReport) >= 0;
 }
 
+bool ReadAccumulatedRawReport(KPADChan chan, bool enable, BloopairReportBuffer& outReport)
+{
+    return Bloopair_ReadAccumulatedRawReport(bloopairHandle, (WPADChan) chan, enable, &outReport) >= 0;
+}
+
+bool GetControllerStatistics(KPADChan chan, BloopairControllerStatisticsData& outData)
+{
+    return Bloopair_GetControllerStatistics(bloopairHandle, (WPADChan) chan, &outData) >= 0;
+}
+
 bool ApplyConfiguration(const uint8_t* bda, const BloopairCommonConfiguration& configuration)
 {
     return Bloopair_ApplyControllerConfigurationForBDA(bloopairHandle, bda, &configuration) >= 0;
@@ -137,11 +147,38 @@ bool GetControllerMapping(KPADChan chan, BloopairMappingEntry* outEntries, uint8
     return Bloopair_GetControllerMapping(bloopairHandle, chan, outEntries, outNumMappings) >= 0;
 }
 
+bool ApplyControllerActions(const uint8_t* bda, const BloopairActionEntry* actions, uint8_t numActions)
+{
+    return Bloopair_ApplyControllerActionsForBDA(bloopairHandle, bda, actions, numActions) >= 0;
+}
+
+bool ApplyControllerActions(BloopairControllerType type, const BloopairActionEntry* actions, uint8_t numActions)
+{
+    return Bloopair_ApplyControllerActionsForControllerType(bloopairHandle, type, actions, numActions) >= 0;
+}
+
+bool GetControllerActions(KPADChan chan, BloopairActionEntry* outActions, uint8_t* outNumActions)
+{
+    return Bloopair_GetControllerActions(bloopairHandle, chan, outActions, outNumActions) >= 0;
+}
+
 bool ClearCustomConfiguration(const uint8_t* bda)
 {
     return Bloopair_ApplyCustomConfigurationForBDA(bloopairHandle, bda, nullptr, 0) >= 0;
 }
 
+bool ReadCapture(bool enable, const std::span<uint8_t>& outData, uint32_t& outSize, uint32_t& outNumLost)
+{
+    outSize = outData.size();
+    return Bloopair_ReadCapture(bloopairHandle, enable, outData.data(), &outSize, &outNumLost) >= 0;
+}
+
+bool ReadTrace(uint32_t enableMask, const std::span<BloopairTraceRecord>& outRecords, uint32_t& outNumRecords, uint32_t& outNumLost)
+{
+    outNumRecords = outRecords.size();
+    return Bloopair_ReadTrace(bloopairHandle, enableMask, outRecords.data(), &outNumRecords, &outNumLost) >= 0;
+}
+
 namespace detail
 {
 
@@ -68,6 +68,10 @@ bool GetControllerInformation(KPADChan chan, BloopairControllerInformationData&
 
 bool ReadRawReport(KPADChan chan, BloopairReportBuffer& outReport);
 
+bool ReadAccumulatedRawReport(KPADChan chan, bool enable, BloopairReportBuffer& outReport);
+
+bool GetControllerStatistics(KPADChan chan, BloopairControllerStatisticsData& outData);
+
 bool ApplyConfiguration(const uint8_t* bda, const BloopairCommonConfiguration& configuration);
 
 bool ApplyConfiguration(BloopairControllerType type, const BloopairCommonConfiguration& configuration);
@@ -82,6 +86,12 @@ bool ApplyControllerMapping(BloopairControllerType type, const BloopairMappingEn
 
 bool GetControllerMapping(KPADChan chan, BloopairMappingEntry* outEntries, uint8_t* outNumMappings);
 
+bool ApplyControllerActions(const uint8_t* bda, const BloopairActionEntry* actions, uint8_t numActions);
+
+bool ApplyControllerActions(BloopairControllerType type, const BloopairActionEntry* actions, uint8_t numActions);
+
+bool GetControllerActions(KPADChan chan, BloopairActionEntry* outActions, uint8_t* outNumActions);
+
 template <ConfigurationType T>
 bool ApplyCustomConfiguration(const uint8_t* bda, const T& configuration)
 {
@@ -96,6 +106,10 @@ bool ApplyCustomConfiguration(BloopairControllerType type, const T& configuratio
 
 bool ClearCustomConfiguration(const uint8_t* bda);
 
+bool ReadCapture(bool enable, const std::span<uint8_t>& outData, uint32_t& outSize, uint32_t& outNumLost);
+
+bool ReadTrace(uint32_t enableMask, const std::span<BloopairTraceRecord>& outRecords, uint32_t& outNumRecords, uint32_t& outNumLost);
+
 template <ConfigurationType T>
 bool GetCustomConfiguration(KPADChan chan, T& configuration)
 {
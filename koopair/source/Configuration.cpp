@@ -17,8 +17,13 @@
 #include "Configuration.hpp"
 #include "Utils.hpp"
 
+#include <bloopair/config.h>
+
+#include <algorithm>
 #include <fstream>
-#include <regex>
+#include <sstream>
+#include <cstdio>
+#include <unistd.h>
 
 namespace
 {
@@ -30,140 +35,104 @@ namespace
 #define BLOOPAIR_CONFIG_VERSION_MIN 0
 #define BLOOPAIR_CONFIG_VERSION_MAX 100
 
-const std::map<uint32_t, std::string> bloopairButtonNames = {
-    { BLOOPAIR_PRO_BUTTON_UP,       "up" },
-    { BLOOPAIR_PRO_BUTTON_LEFT,     "left" },
-    { BLOOPAIR_PRO_TRIGGER_ZR,      "zr" },
-    { BLOOPAIR_PRO_BUTTON_X,        "x" },
-    { BLOOPAIR_PRO_BUTTON_A,        "a" },
-    { BLOOPAIR_PRO_BUTTON_Y,        "y" },
-    { BLOOPAIR_PRO_BUTTON_B,        "b" },
-    { BLOOPAIR_PRO_TRIGGER_ZL,      "zl" },
-    { BLOOPAIR_PRO_RESERVED,        "reserved" },
-    { BLOOPAIR_PRO_TRIGGER_R,       "r" },
-    { BLOOPAIR_PRO_BUTTON_PLUS,     "plus" },
-    { BLOOPAIR_PRO_BUTTON_HOME,     "home" },
-    { BLOOPAIR_PRO_BUTTON_MINUS,    "minus" },
-    { BLOOPAIR_PRO_TRIGGER_L,       "l" },
-    { BLOOPAIR_PRO_BUTTON_DOWN,     "down" },
-    { BLOOPAIR_PRO_BUTTON_RIGHT,    "right" },
-    { BLOOPAIR_PRO_BUTTON_STICK_R,  "rstick" },
-    { BLOOPAIR_PRO_BUTTON_STICK_L,  "lstick" },
-    { BLOOPAIR_PRO_STICK_L_UP,      "lup" },
-    { BLOOPAIR_PRO_STICK_L_DOWN,    "ldown" },
-    { BLOOPAIR_PRO_STICK_L_LEFT,    "lleft" },
-    { BLOOPAIR_PRO_STICK_L_RIGHT,   "lright" },
-    { BLOOPAIR_PRO_STICK_R_UP,      "rrup" },
-    { BLOOPAIR_PRO_STICK_R_DOWN,    "rdown" },
-    { BLOOPAIR_PRO_STICK_R_LEFT,    "rleft" },
-    { BLOOPAIR_PRO_STICK_R_RIGHT,   "rright" },
-};
-
-const std::map<std::string, uint32_t> bloopairButtonNameValues = {
-    { "up",         BLOOPAIR_PRO_BUTTON_UP },
-    { "left",       BLOOPAIR_PRO_BUTTON_LEFT },
-    { "zr",         BLOOPAIR_PRO_TRIGGER_ZR },
-    { "x",          BLOOPAIR_PRO_BUTTON_X },
-    { "a",          BLOOPAIR_PRO_BUTTON_A },
-    { "y",          BLOOPAIR_PRO_BUTTON_Y },
-    { "b",          BLOOPAIR_PRO_BUTTON_B },
-    { "zl",         BLOOPAIR_PRO_TRIGGER_ZL },
-    { "reserved",   BLOOPAIR_PRO_RESERVED },
-    { "r",          BLOOPAIR_PRO_TRIGGER_R },
-    { "plus",       BLOOPAIR_PRO_BUTTON_PLUS },
-    { "home",       BLOOPAIR_PRO_BUTTON_HOME },
-    { "minus",      BLOOPAIR_PRO_BUTTON_MINUS },
-    { "l",          BLOOPAIR_PRO_TRIGGER_L },
-    { "down",       BLOOPAIR_PRO_BUTTON_DOWN },
-    { "right",      BLOOPAIR_PRO_BUTTON_RIGHT },
-    { "rstick",     BLOOPAIR_PRO_BUTTON_STICK_R },
-    { "lstick",     BLOOPAIR_PRO_BUTTON_STICK_L },
-    { "lup",        BLOOPAIR_PRO_STICK_L_UP },
-    { "ldown",      BLOOPAIR_PRO_STICK_L_DOWN },
-    { "lleft",      BLOOPAIR_PRO_STICK_L_LEFT },
-    { "lright",     BLOOPAIR_PRO_STICK_L_RIGHT },
-    { "rrup",       BLOOPAIR_PRO_STICK_R_UP },
-    { "rdown",      BLOOPAIR_PRO_STICK_R_DOWN },
-    { "rleft",      BLOOPAIR_PRO_STICK_R_LEFT },
-    { "rright",     BLOOPAIR_PRO_STICK_R_RIGHT },
-};
-
-const std::map<BloopairControllerType, std::string> bloopairControllerTypes = {
-    { BLOOPAIR_CONTROLLER_DUALSENSE,             "DualSense", },
-    { BLOOPAIR_CONTROLLER_DUALSHOCK3,            "DualShock-3", },
-    { BLOOPAIR_CONTROLLER_DUALSHOCK4,            "DualShock-4", },
-    { BLOOPAIR_CONTROLLER_SWITCH_GENERIC,        "Switch-Generic", },
-    { BLOOPAIR_CONTROLLER_SWITCH_JOYCON_LEFT,    "Switch-JoyCon-Left", },
-    { BLOOPAIR_CONTROLLER_SWITCH_JOYCON_RIGHT,   "Switch-JoyCon-Right", },
-    { BLOOPAIR_CONTROLLER_SWITCH_JOYCON_DUAL,    "Switch-JoyCon-Dual", },
-    { BLOOPAIR_CONTROLLER_SWITCH_PRO,            "Switch-Pro", },
-    { BLOOPAIR_CONTROLLER_SWITCH_N64,            "Switch-N64", },
-    { BLOOPAIR_CONTROLLER_XBOX_ONE,              "Xbox-One", },
-};
-
-const std::map<std::string, BloopairControllerType> bloopairControllerTypeValues = {
-    { "DualSense",              BLOOPAIR_CONTROLLER_DUALSENSE },
-    { "DualShock-3",            BLOOPAIR_CONTROLLER_DUALSHOCK3 },
-    { "DualShock-4",            BLOOPAIR_CONTROLLER_DUALSHOCK4 },
-    { "Switch-Generic",         BLOOPAIR_CONTROLLER_SWITCH_GENERIC },
-    { "Switch-JoyCon-Left",     BLOOPAIR_CONTROLLER_SWITCH_JOYCON_LEFT },
-    { "Switch-JoyCon-Right",    BLOOPAIR_CONTROLLER_SWITCH_JOYCON_RIGHT },
-    { "Switch-JoyCon-Dual",     BLOOPAIR_CONTROLLER_SWITCH_JOYCON_DUAL },
-    { "Switch-Pro",             BLOOPAIR_CONTROLLER_SWITCH_PRO },
-    { "Switch-N64",             BLOOPAIR_CONTROLLER_SWITCH_N64 },
-    { "Xbox-One",               BLOOPAIR_CONTROLLER_XBOX_ONE },
-};
-
-bool HexToBDA(const std::string& hex, uint8_t* bda)
+std::string GetControllerTypeName(BloopairControllerType type)
+{
+    const char* name = Bloopair_GetNameFromValue(BLOOPAIR_NAMES_CONTROLLER_TYPE, type);
+    return name ? name : "";
+}
+
+std::filesystem::path GetTempPath(const std::filesystem::path& path)
+{
+    return path.string() + BLOOPAIR_CONFIG_TEMP_SUFFIX;
+}
+
+std::filesystem::path GetBackupPath(const std::filesystem::path& path)
+{
+    return path.string() + BLOOPAIR_CONFIG_BACKUP_SUFFIX;
+}
+
+std::filesystem::path GetOldPath(const std::filesystem::path& path)
 {
-    // Need exactly 12 hex characters for a bda
-    if (hex.size() != 12) {
+    return path.string() + BLOOPAIR_CONFIG_OLD_SUFFIX;
+}
+
+bool ReadFile(const std::filesystem::path& path, std::string& outContents)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
         return false;
     }
 
-    // Only support uppercase hex characters
-    auto char2int = ([](char in) -> int {
-        if(in >= '0' && in <= '9')
-            return in - '0';
-        if(in >= 'A' && in <= 'F')
-            return in - 'A' + 10;
-        return -1;
-    });
-
-    for (size_t i = 0; i < hex.size(); i += 2) {
-        int hi = char2int(hex[i]);
-        int lo = char2int(hex[i + 1]);
-        if (hi == -1 || lo == -1) {
-            return false;
-        }
+    std::ostringstream stream;
+    stream << file.rdbuf();
+    outContents = std::move(stream).str();
+    return true;
+}
+
+// Only returns once the data is actually on the SD card
+bool WriteFileSynced(const std::filesystem::path& path, const std::string& header, const std::string& contents)
+{
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    bool success = std::fwrite(header.data(), 1, header.size(), file) == header.size() &&
+        std::fwrite(contents.data(), 1, contents.size(), file) == contents.size() &&
+        std::fflush(file) == 0 &&
+        fsync(fileno(file)) == 0;
+
+    return std::fclose(file) == 0 && success;
+}
+
+void RemoveFiles(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    std::filesystem::remove(GetBackupPath(path), ec);
+    std::filesystem::remove(GetTempPath(path), ec);
+    std::filesystem::remove(GetOldPath(path), ec);
+}
 
-        *(bda++) = hi << 4 | lo;
+// If saving stopped before the temporary file was renamed into place, it's complete as long as it passes the checksum check
+bool PromoteTempFile(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    if (std::filesystem::exists(path, ec)) {
+        return false;
     }
 
-    return true;
+    std::filesystem::path tempPath = GetTempPath(path);
+    std::string contents;
+    if (!ReadFile(tempPath, contents) || Bloopair_CheckConfigFile(contents.data(), contents.size()) != BLOOPAIR_CONFIG_CHECK_VALID) {
+        return false;
+    }
+
+    std::filesystem::rename(tempPath, path, ec);
+    return !ec;
 }
 
 } // namespace
 
 
 Configuration::Configuration(const std::filesystem::path& path, BloopairControllerType type)
- : mPath(path), mJson(), mControllerType(type)
+ : mPath(path), mFile(), mControllerType(type)
 {
     InitConfiguration();
 }
 
 Configuration::Configuration(BloopairControllerType type)
- : mPath(), mJson(), mControllerType(type)
+ : mPath(), mFile(), mControllerType(type)
 {
-    std::string filename = "Controller-" + bloopairControllerTypes.at(type) + ".conf";
+    std::string filename = BLOOPAIR_CONFIG_FILENAME_PREFIX + GetControllerTypeName(type) + BLOOPAIR_CONFIG_FILENAME_SUFFIX;
     mPath = std::filesystem::path(BLOOPAIR_CONFIGURATION_DIR) / filename;
     InitConfiguration();
 }
 
 Configuration::Configuration(const uint8_t* bda, BloopairControllerType type)
- : mPath(), mJson(), mControllerType(type)
+ : mPath(), mFile(), mControllerType(type)
 {
-    std::string filename = "Controller-" + Utils::ToHexString(bda, 6, true) + ".conf";
+    std::string filename = BLOOPAIR_CONFIG_FILENAME_PREFIX + Utils::ToHexString(bda, 6, true) + BLOOPAIR_CONFIG_FILENAME_SUFFIX;
     mPath = std::filesystem::path(BLOOPAIR_CONFIGURATION_DIR) / filename;
     InitConfiguration();
 }
@@ -174,25 +143,28 @@ Configuration::~Configuration()
 
 std::vector<Configuration> Configuration::LoadAll()
 {
-    std::vector<Configuration> configurations;
-    std::regex regex("^Controller-([A-Za-z0-9-]+)\\.conf$");
+    // Promoted before listing the configurations, so the directory doesn't change underneath the iterator
+    std::vector<std::filesystem::path> tempPaths;
+    for (const auto& entry : std::filesystem::directory_iterator(BLOOPAIR_CONFIGURATION_DIR)) {
+        if (entry.is_regular_file() && entry.path().filename().string().ends_with(BLOOPAIR_CONFIG_TEMP_SUFFIX)) {
+            tempPaths.push_back(entry.path());
+        }
+    }
+
+    for (std::filesystem::path& path : tempPaths) {
+        PromoteTempFile(path.replace_extension());
+    }
 
+    std::vector<Configuration> configurations;
     for (const auto& entry : std::filesystem::directory_iterator(BLOOPAIR_CONFIGURATION_DIR)) {
         if (!entry.is_regular_file()) {
             continue;
         }
 
         std::string filename = entry.path().filename().string();
-        std::smatch m;
-        if (!std::regex_search(filename, m, regex)) {
-            continue;
-        }
-
-        BloopairControllerType type = BLOOPAIR_CONTROLLER_INVALID;
+        BloopairControllerType type;
         uint8_t bda[6];
-        if (bloopairControllerTypeValues.contains(m.str(1))) {
-            type = bloopairControllerTypeValues.at(m.str(1));
-        } else if (!HexToBDA(m.str(1), bda)) {
+        if (!Bloopair_ParseConfigFilename(filename.c_str(), &type, bda)) {
             continue;
         }
 
@@ -204,32 +176,65 @@ std::vector<Configuration> Configuration::LoadAll()
 
 bool Configuration::Save()
 {
-    std::ofstream file(mPath);
-    file << mJson.dump(-1, ' ', false, nlohmann::json::error_handler_t::ignore);;
+    std::string contents(Bloopair_EncodeConfigFile(&mFile, nullptr, 0), '\0');
+    Bloopair_EncodeConfigFile(&mFile, contents.data(), contents.size() + 1);
+
+    char header[BLOOPAIR_CONFIG_HEADER_LENGTH + 1];
+    Bloopair_CreateConfigHeader(contents.data(), contents.size(), header);
+
+    // Write everything to a temporary file first, so a power loss can't leave a half written configuration behind
+    std::filesystem::path tempPath = GetTempPath(mPath);
+    std::error_code ec;
+    if (!WriteFileSynced(tempPath, header, contents)) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
 
-    return !!file;
+    // Renaming doesn't replace existing files on the SD card, so the previous configuration is moved aside.
+    // It becomes the backup, unless it has a checksum mismatch, then it's kept as the old file,
+    // so a damaged file doesn't replace an intact backup and hand edits don't get lost.
+    if (std::filesystem::exists(mPath, ec)) {
+        std::string previous;
+        bool intact = ReadFile(mPath, previous) && Bloopair_CheckConfigFile(previous.data(), previous.size()) != BLOOPAIR_CONFIG_CHECK_MISMATCH;
+        std::filesystem::path asidePath = intact ? GetBackupPath(mPath) : GetOldPath(mPath);
+        std::filesystem::remove(asidePath, ec);
+        std::filesystem::rename(mPath, asidePath, ec);
+        if (ec) {
+            // The previous configuration stays in place
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    // If this doesn't happen, the temporary file gets promoted the next time it's loaded
+    std::filesystem::rename(tempPath, mPath, ec);
+    return !ec;
 }
 
 void Configuration::SetCommonConfiguration(const BloopairCommonConfiguration& config)
 {
-    mJson["configuration"]["stickAsButtonDeadzone"] = config.stickAsButtonDeadzone;
+    mFile.common = config;
+    mFile.fields |= BLOOPAIR_CONFIG_FILE_HAS_ALL_COMMON;
 }
 
 void Configuration::SetMappings(const std::vector<BloopairMappingEntry>& mappings)
 {
-    // Sort mappings into a map
-    std::map<BloopairProButton, std::vector<uint8_t>> mappingsMap;
-    for (const BloopairMappingEntry& m : mappings) {
-        mappingsMap[(BloopairProButton) m.to].push_back(m.from);
-    }
+    // The codec groups the mappings by their target when writing them
+    mFile.numMappings = std::min<size_t>(mappings.size(), BLOOPAIR_MAX_MAPPINGS);
+    std::copy_n(mappings.begin(), mFile.numMappings, mFile.mappings);
+    mFile.fields |= BLOOPAIR_CONFIG_FILE_HAS_MAPPING;
+}
 
-    nlohmann::json mapping;
-    for (const auto& [key, val] : mappingsMap) {
-        std::string buttonName = bloopairButtonNames.at(key);
-        mapping[buttonName] = val;
+void Configuration::SetActions(const std::vector<BloopairActionEntry>& actions)
+{
+    // Sequence steps follow their sequence, so a list which doesn't fit can't be cut off
+    if (actions.size() > BLOOPAIR_MAX_ACTIONS) {
+        return;
     }
 
-    mJson["mapping"] = mapping;
+    mFile.numActions = actions.size();
+    std::copy(actions.begin(), actions.end(), mFile.actions);
+    mFile.fields |= BLOOPAIR_CONFIG_FILE_HAS_ACTIONS;
 }
 
 void Configuration::SetCustomConfiguraion(const DualsenseConfiguration& config)
@@ -238,7 +243,7 @@ void Configuration::SetCustomConfiguraion(const DualsenseConfiguration& config)
         return;
     }
 
-    // mJson["custom"]["someCustomField"] = config.SomeCustomField;
+    // mFile.someCustomField = config.SomeCustomField;
 }
 
 void Configuration::SetCustomConfiguraion(const Dualshock3Configuration& config)
@@ -247,7 +252,7 @@ void Configuration::SetCustomConfiguraion(const Dualshock3Configuration& config)
         return;
     }
 
-    // mJson["custom"]["someCustomField"] = config.SomeCustomField;
+    // mFile.someCustomField = config.SomeCustomField;
 }
 
 void Configuration::SetCustomConfiguraion(const Dualshock4Configuration& config)
@@ -256,7 +261,7 @@ void Configuration::SetCustomConfiguraion(const Dualshock4Configuration& config)
         return;
     }
 
-    // mJson["custom"]["someCustomField"] = config.SomeCustomField;
+    // mFile.someCustomField = config.SomeCustomField;
 }
 
 void Configuration::SetCustomConfiguraion(const SwitchConfiguration& config)
@@ -265,7 +270,8 @@ void Configuration::SetCustomConfiguraion(const SwitchConfiguration& config)
         return;
     }
 
-    mJson["custom"]["disableCalibration"] = config.disableCalibration;
+    mFile.disableCalibration = config.disableCalibration;
+    mFile.fields |= BLOOPAIR_CONFIG_FILE_HAS_CUSTOM | BLOOPAIR_CONFIG_FILE_HAS_DISABLE_CALIBRATION;
 }
 
 void Configuration::SetCustomConfiguraion(const XboxOneConfiguration& config)
@@ -274,26 +280,24 @@ void Configuration::SetCustomConfiguraion(const XboxOneConfiguration& config)
         return;
     }
 
-    // mJson["custom"]["someCustomField"] = config.SomeCustomField;
+    // mFile.someCustomField = config.SomeCustomField;
 }
 
 void Configuration::Remove()
 {
-    std::filesystem::remove(mPath);
+    RemoveFiles(mPath);
 }
 
 void Configuration::Remove(BloopairControllerType type)
 {
-    std::string filename = "Controller-" + bloopairControllerTypes.at(type) + ".conf";
-    std::filesystem::path path = std::filesystem::path(BLOOPAIR_CONFIGURATION_DIR) / filename;
-    std::filesystem::remove(path);
+    std::string filename = BLOOPAIR_CONFIG_FILENAME_PREFIX + GetControllerTypeName(type) + BLOOPAIR_CONFIG_FILENAME_SUFFIX;
+    RemoveFiles(std::filesystem::path(BLOOPAIR_CONFIGURATION_DIR) / filename);
 }
 
 void Configuration::Remove(const uint8_t* bda)
 {
-    std::string filename = "Controller-" + Utils::ToHexString(bda, 6, true) + ".conf";
-    std::filesystem::path path = std::filesystem::path(BLOOPAIR_CONFIGURATION_DIR) / filename;
-    std::filesystem::remove(path);
+    std::string filename = BLOOPAIR_CONFIG_FILENAME_PREFIX + Utils::ToHexString(bda, 6, true) + BLOOPAIR_CONFIG_FILENAME_SUFFIX;
+    RemoveFiles(std::filesystem::path(BLOOPAIR_CONFIGURATION_DIR) / filename);
 }
 
 std::string Configuration::GetFilename() const
@@ -303,7 +307,7 @@ std::string Configuration::GetFilename() const
 
 bool Configuration::InitConfiguration()
 {
-    if (!bloopairControllerTypes.contains(mControllerType)) {
+    if (GetControllerTypeName(mControllerType).empty()) {
         return false;
     }
 
@@ -313,50 +317,64 @@ bool Configuration::InitConfiguration()
     }
 
     // Initialize a default configuration
-    mJson = {};
-    mJson["version"] = BLOOPAIR_CONFIG_VERSION;
-    mJson["controllerType"] = bloopairControllerTypes.at(mControllerType);
+    mFile = {};
+    mFile.version = BLOOPAIR_CONFIG_VERSION;
+    mFile.controllerType = mControllerType;
 
     return true;
 }
 
 bool Configuration::LoadConfiguration()
 {
-    mJson = nlohmann::ordered_json::parse(std::ifstream(mPath), nullptr, false);
-    if (mJson.is_discarded()) {
+    PromoteTempFile(mPath);
+
+    // Files which pass the checksum come first, the backup is used if the configuration is damaged.
+    // Files which were edited by hand without removing the checksum are only used if nothing else works.
+    for (bool allowMismatch : { false, true }) {
+        if (LoadConfigurationFile(mPath, allowMismatch) || LoadConfigurationFile(GetBackupPath(mPath), allowMismatch)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool Configuration::LoadConfigurationFile(const std::filesystem::path& path, bool allowMismatch)
+{
+    std::string contents;
+    if (!ReadFile(path, contents)) {
+        return false;
+    }
+
+    if (!allowMismatch && Bloopair_CheckConfigFile(contents.data(), contents.size()) == BLOOPAIR_CONFIG_CHECK_MISMATCH) {
+        return false;
+    }
+
+    // The checksum header is a comment
+    if (!Bloopair_DecodeConfigFile(contents.data(), contents.size(), &mFile)) {
         return false;
     }
 
     // Version check
-    if (mJson.contains("version") &&
-       (mJson["version"].get<uint32_t>() < BLOOPAIR_CONFIG_VERSION_MIN ||
-        mJson["version"].get<uint32_t>() > BLOOPAIR_CONFIG_VERSION_MAX)) {
+    if (mFile.version < BLOOPAIR_CONFIG_VERSION_MIN || mFile.version > BLOOPAIR_CONFIG_VERSION_MAX) {
         return false;
     }
 
     // Controller type check
-    BloopairControllerType controllerType = BLOOPAIR_CONTROLLER_INVALID;
-    if (mJson.contains("controllerType")) {
-        std::string typeString = mJson["controllerType"].get<std::string>();
-        if (bloopairControllerTypeValues.contains(typeString)) {
-            controllerType = bloopairControllerTypeValues.at(typeString);
-        } else {
-            return false;
-        }
-    } else {
+    if (mFile.controllerType == BLOOPAIR_CONTROLLER_INVALID) {
         return false;
     }
 
     if (mControllerType == BLOOPAIR_CONTROLLER_INVALID) {
-        mControllerType = controllerType;
+        mControllerType = mFile.controllerType;
     } else {
-        if (controllerType != mControllerType) {
+        if (mFile.controllerType != mControllerType) {
             return false;
         }
     }
 
     // Update the version field
-    mJson["version"] = BLOOPAIR_CONFIG_VERSION;
+    mFile.version = BLOOPAIR_CONFIG_VERSION;
 
     return true;
 }
@@ -18,7 +18,7 @@
 
 #include <vector>
 #include <filesystem>
-#include <json/json.hpp>
+#include <bloopair/config_file.h>
 #include <bloopair/controllers/common.h>
 #include <bloopair/controllers/dualsense_controller.h>
 #include <bloopair/controllers/dualshock3_controller.h>
@@ -41,6 +41,8 @@ public:
 
     void SetMappings(const std::vector<BloopairMappingEntry>& mappings);
 
+    void SetActions(const std::vector<BloopairActionEntry>& actions);
+
     void SetCustomConfiguraion(const DualsenseConfiguration& config);
     void SetCustomConfiguraion(const Dualshock3Configuration& config);
     void SetCustomConfiguraion(const Dualshock4Configuration& config);
@@ -56,8 +58,9 @@ public:
 private:
     bool InitConfiguration();
     bool LoadConfiguration();
+    bool LoadConfigurationFile(const std::filesystem::path& path, bool allowMismatch);
 
     std::filesystem::path mPath;
-    nlohmann::ordered_json mJson;
+    BloopairConfigFile mFile;
     BloopairControllerType mControllerType;
 };
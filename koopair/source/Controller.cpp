@@ -17,8 +17,72 @@
 #include "Controller.hpp"
 #include "BloopairIPC.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 namespace {
 
+// The left stick presses a direction above the press threshold, and releases it below the release threshold.
+// Having some distance between the two avoids flickering when holding the stick around the threshold.
+constexpr float kStickPressThreshold = 0.5f;
+constexpr float kStickReleaseThreshold = 0.3f;
+
+struct StickDirection {
+    Controller::Buttons button;
+    bool vertical;
+    float sign;
+};
+
+constexpr StickDirection kStickDirections[] = {
+    { Controller::BUTTON_RIGHT, false,  1.0f },
+    { Controller::BUTTON_LEFT,  false, -1.0f },
+    { Controller::BUTTON_UP,    true,   1.0f },
+    { Controller::BUTTON_DOWN,  true,  -1.0f },
+};
+
+// Held directions start repeating after the delay, and repeat faster the longer they're held
+constexpr Controller::Buttons kRepeatButtons[] = {
+    Controller::BUTTON_RIGHT,
+    Controller::BUTTON_LEFT,
+    Controller::BUTTON_UP,
+    Controller::BUTTON_DOWN,
+};
+
+constexpr uint32_t kRepeatDelayMs = 350;
+constexpr uint32_t kRepeatIntervalsMs[] = {
+    150, 120, 100, 80, 80, 60, 60, 50, 50, 40, 40, 30, 30, 20,
+};
+
+// The right stick scrolls between these many entries per second, depending on how far it's pushed
+constexpr float kScrollDeadzone = 0.2f;
+constexpr float kScrollMinSpeed = 2.0f;
+constexpr float kScrollMaxSpeed = 30.0f;
+
+template <typename T>
+void AccumulateEdges(T& status, const T& sample)
+{
+    status.trigger |= sample.trigger;
+    status.release |= sample.release;
+}
+
+// Adds the button edges of an older sample to the status, so a press which started and ended in between updates isn't lost.
+// Everything else stays the newest sample, stick extremes only matter to the remap detector which reads the raw report.
+void AccumulateSample(KPADStatus& status, const KPADStatus& sample)
+{
+    AccumulateEdges(status, sample);
+
+    // the extension buttons are only comparable if the extension didn't change
+    if (sample.extensionType != status.extensionType) {
+        return;
+    }
+
+    if (status.extensionType == WPAD_EXT_PRO_CONTROLLER) {
+        AccumulateEdges(status.pro, sample.pro);
+    } else if (status.extensionType == WPAD_EXT_CLASSIC || status.extensionType == WPAD_EXT_MPLUS_CLASSIC) {
+        AccumulateEdges(status.classic, sample.classic);
+    }
+}
+
 std::string GetNameForExtensionType(WPADExtensionType type)
 {
     switch (type) {
@@ -63,6 +127,8 @@ std::string GetNameForBloopairControllerType(BloopairControllerType type)
         return "Switch N64 Controller";
     case BLOOPAIR_CONTROLLER_XBOX_ONE:
         return "Xbox One Controller";
+    case BLOOPAIR_CONTROLLER_GENERIC_HID:
+        return "Generic Controller";
     default:
         return "Unknown Pro Controller";
     }
@@ -162,11 +228,14 @@ const std::string& VPADController::GetName() const
 
 KPADController::KPADController(KPADChan chan) : Controller(),
     mIsConnected(false),
-    mRetrieveTimer(60),
+    mNextRetrieveTime(0),
     mName(),
+    mNameIdentity(UINT32_MAX),
     mChannel(chan),
     mExtension(),
     mStatus(),
+    mSamples(),
+    mNumSamples(0),
     mIsBloopairController(false),
     mControllerInfo()
 {
@@ -179,6 +248,8 @@ KPADController::~KPADController()
 
 bool KPADController::Update()
 {
+    mNumSamples = 0;
+
     if (!Controller::Update()) {
         return false;
     }
@@ -189,25 +260,31 @@ bool KPADController::Update()
     }
 
     KPADError error;
-    if (KPADReadEx(mChannel, &mStatus, 1, &error) <= 0 || error != KPAD_ERROR_OK) {
+    int32_t numSamples = KPADReadEx(mChannel, mSamples.data(), mSamples.size(), &error);
+    if (numSamples <= 0 || error != KPAD_ERROR_OK) {
         return false;
     }
 
+    mNumSamples = numSamples;
+
+    // KPAD buffers the samples since the last read, use the newest one with the presses and releases in between
+    mStatus = mSamples[0];
+    for (size_t i = 1; i < mNumSamples; i++) {
+        AccumulateSample(mStatus, mSamples[i]);
+    }
+
     // Sometimes the extension type is reported as 0xFF when the controller isn't ready yet
     if (mStatus.extensionType == 0xFF) {
         return false;
     }
     
-    if (!mIsConnected) {
-        RetreiveControllerInformation();
-    }
-
     // Some controllers e.g. Switch need some time to report back accurate information
     // We'll just continously poll the information every second
-    if (--mRetrieveTimer == 0) {
+    OSTime now = OSGetSystemTime();
+    if (!mIsConnected || now >= mNextRetrieveTime) {
         RetreiveControllerInformation();
 
-        mRetrieveTimer = 60;
+        mNextRetrieveTime = now + OSSecondsToTicks(1);
     }
 
     mIsConnected = true;
@@ -280,14 +357,27 @@ bool KPADController::IsBloopairController() const
 
 void KPADController::RetreiveControllerInformation()
 {
+    bool hasInformation = false;
     mIsBloopairController = false;
     if (mExtension == WPAD_EXT_PRO_CONTROLLER) {
-        if (BloopairIPC::GetControllerInformation(mChannel, mControllerInfo)) {
-            // Official controllers are not supported
-            if (GetControllerType() != BLOOPAIR_CONTROLLER_OFFICIAL) {
-                mIsBloopairController = true;
-            }
+        hasInformation = BloopairIPC::GetControllerInformation(mChannel, mControllerInfo);
 
+        // Official controllers are not supported
+        if (hasInformation && GetControllerType() != BLOOPAIR_CONTROLLER_OFFICIAL) {
+            mIsBloopairController = true;
+        }
+    }
+
+    // This is polled every second, only rebuild the name if the controller actually changed
+    uint32_t identity = (static_cast<uint32_t>(mExtension) << 16) | (hasInformation ? GetControllerType() + 1 : 0);
+    if (identity == mNameIdentity) {
+        return;
+    }
+
+    mNameIdentity = identity;
+
+    if (mExtension == WPAD_EXT_PRO_CONTROLLER) {
+        if (hasInformation) {
             mName = GetNameForBloopairControllerType(GetControllerType()) + " ("
                 + std::to_string(static_cast<int>(mChannel) + 1) + ")";
         } else {
@@ -330,15 +420,21 @@ std::array<uint8_t, 6> KPADController::GetBDA() const
 
 CombinedInputController::CombinedInputController() : Controller(),
     mName("Combined Controller"),
-    mPreviousButtons()
+    mPreviousButtons(),
+    mButtonsRepeated(),
+    mStickButtons(),
+    mRepeatStates(),
+    mScroll(0.0f),
+    mPreviousTime(0)
 {
+    static_assert(std::size(kRepeatButtons) == std::tuple_size_v<decltype(mRepeatStates)>);
 }
 
 CombinedInputController::~CombinedInputController()
 {
 }
 
-bool CombinedInputController::Combine(const std::vector<const Controller*>& controllers)
+bool CombinedInputController::Combine(std::span<const Controller* const> controllers, OSTime time)
 {
     if (!Controller::Update()) {
         return false;
@@ -348,36 +444,94 @@ bool CombinedInputController::Combine(const std::vector<const Controller*>& cont
         mButtonsHeld |= c->GetButtonsHeld();
         mButtonsTriggered |= c->GetButtonsTriggered();
 
-        if (c->GetStickL().x > 0.2f) {
-            if ((mPreviousButtons & BUTTON_RIGHT) == 0) {
-                mButtonsTriggered |= BUTTON_RIGHT;
-            }
-            mButtonsHeld |= BUTTON_RIGHT;
-        } else if (c->GetStickL().x < -0.2f) {
-            if ((mPreviousButtons & BUTTON_LEFT) == 0) {
-                mButtonsTriggered |= BUTTON_LEFT;
-            }
-            mButtonsHeld |= BUTTON_LEFT;
+        // Use whichever controller pushes its sticks the furthest
+        if (std::fabs(c->GetStickL().x) > std::fabs(mStickL.x)) mStickL.x = c->GetStickL().x;
+        if (std::fabs(c->GetStickL().y) > std::fabs(mStickL.y)) mStickL.y = c->GetStickL().y;
+        if (std::fabs(c->GetStickR().x) > std::fabs(mStickR.x)) mStickR.x = c->GetStickR().x;
+        if (std::fabs(c->GetStickR().y) > std::fabs(mStickR.y)) mStickR.y = c->GetStickR().y;
+    }
+
+    UpdateStickButtons();
+    mButtonsHeld |= mStickButtons;
+    mButtonsTriggered |= static_cast<Buttons>(mStickButtons & ~mPreviousButtons);
+
+    mButtonsRepeated = mButtonsTriggered;
+    UpdateRepeat(time);
+
+    float delta = mPreviousTime ? OSTicksToMicroseconds(time - mPreviousTime) / 1000000.0f : 0.0f;
+    UpdateScroll(delta);
+
+    mPreviousButtons = mButtonsHeld;
+    mPreviousTime = time;
+
+    return true;
+}
+
+void CombinedInputController::UpdateStickButtons()
+{
+    for (const StickDirection& direction : kStickDirections) {
+        float value = (direction.vertical ? mStickL.y : mStickL.x) * direction.sign;
+        float threshold = (mStickButtons & direction.button) ? kStickReleaseThreshold : kStickPressThreshold;
+
+        if (value > threshold) {
+            mStickButtons |= direction.button;
+        } else {
+            mStickButtons = static_cast<Buttons>(mStickButtons & ~direction.button);
         }
-        if (c->GetStickL().y > 0.2f) {
-            if ((mPreviousButtons & BUTTON_UP) == 0) {
-                mButtonsTriggered |= BUTTON_UP;
-            }
-            mButtonsHeld |= BUTTON_UP;
-        } else if (c->GetStickL().y < -0.2f) {
-            if ((mPreviousButtons & BUTTON_DOWN) == 0) {
-                mButtonsTriggered |= BUTTON_DOWN;
-            }
-            mButtonsHeld |= BUTTON_DOWN;
+    }
+}
+
+void CombinedInputController::UpdateRepeat(OSTime time)
+{
+    for (size_t i = 0; i < std::size(kRepeatButtons); i++) {
+        const Buttons button = kRepeatButtons[i];
+        RepeatState& state = mRepeatStates[i];
+
+        if (mButtonsTriggered & button) {
+            state.nextRepeat = time + OSMillisecondsToTicks(kRepeatDelayMs);
+            state.count = 0;
+        } else if ((mButtonsHeld & button) && time >= state.nextRepeat) {
+            mButtonsRepeated |= button;
+
+            uint32_t interval = kRepeatIntervalsMs[std::min<size_t>(state.count, std::size(kRepeatIntervalsMs) - 1)];
+            state.nextRepeat = time + OSMillisecondsToTicks(interval);
+            state.count++;
         }
+    }
+}
 
+void CombinedInputController::UpdateScroll(float delta)
+{
+    const float deflection = std::fabs(mStickR.y);
+    if (deflection <= kScrollDeadzone) {
+        mScroll = 0.0f;
+        return;
+    }
 
-        // TODO sticks
+    const float direction = mStickR.y > 0.0f ? 1.0f : -1.0f;
+
+    // Scroll by one entry right away, so short flicks move the selection
+    if (mScroll == 0.0f) {
+        mScroll = direction;
+    } else {
+        // Quadratic curve, so small movements allow fine control
+        float amount = (deflection - kScrollDeadzone) / (1.0f - kScrollDeadzone);
+        mScroll += direction * (kScrollMinSpeed + (kScrollMaxSpeed - kScrollMinSpeed) * amount * amount) * delta;
     }
 
-    mPreviousButtons = mButtonsHeld;
+    // At most one entry per frame
+    if (mScroll >= 1.0f) {
+        mButtonsRepeated |= BUTTON_UP;
+        mScroll = std::min(mScroll - 1.0f, 0.999f);
+    } else if (mScroll <= -1.0f) {
+        mButtonsRepeated |= BUTTON_DOWN;
+        mScroll = std::max(mScroll + 1.0f, -0.999f);
+    }
 
-    return true;
+    // Keep scrolling in the same direction even if the remainder is zero
+    if (mScroll == 0.0f) {
+        mScroll = direction * 0.001f;
+    }
 }
 
 bool CombinedInputController::IsConnected() const
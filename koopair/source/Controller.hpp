@@ -17,9 +17,10 @@
 #pragma once
 
 #include <string>
-#include <vector>
+#include <span>
 #include <array>
 
+#include <coreinit/time.h>
 #include <vpad/input.h>
 #include <padscore/kpad.h>
 #include <bloopair/bloopair.h>
@@ -153,21 +154,35 @@ public:
         return mChannel;
     }
 
+    // The newest sample, with the trigger and release edges of all samples read during the last update
     const KPADStatus& GetStatus() const
     {
         return mStatus;
     }
 
+    // All samples read during the last update, the newest one first
+    std::span<const KPADStatus> GetSamples() const
+    {
+        return { mSamples.data(), mNumSamples };
+    }
+
+    // Size of the sample buffer KPAD keeps for every channel
+    static constexpr size_t kMaxSamples = 16;
+
 private:
     void RetreiveControllerInformation();
 
     bool mIsConnected;
-    uint32_t mRetrieveTimer;
+    OSTime mNextRetrieveTime;
     std::string mName;
+    // extension and controller type the name was built for
+    uint32_t mNameIdentity;
 
     KPADChan mChannel;
     WPADExtensionType mExtension;
     KPADStatus mStatus;
+    std::array<KPADStatus, kMaxSamples> mSamples;
+    size_t mNumSamples;
 
     bool mIsBloopairController;
     BloopairControllerInformationData mControllerInfo;
@@ -178,14 +193,41 @@ public:
     CombinedInputController();
     ~CombinedInputController();
 
-    bool Combine(const std::vector<const Controller*>& controllers);
+    bool Combine(std::span<const Controller* const> controllers, OSTime time);
 
     virtual bool IsConnected() const override;
 
     virtual const std::string& GetName() const override;
 
+    // Triggered buttons, plus repeats while holding a direction or scrolling with the right stick.
+    // Use this for navigating lists and changing values.
+    Buttons GetButtonsRepeated() const
+    {
+        return mButtonsRepeated;
+    }
+
 private:
+    void UpdateStickButtons();
+
+    void UpdateRepeat(OSTime time);
+
+    void UpdateScroll(float delta);
+
     std::string mName;
 
     Buttons mPreviousButtons;
+    Buttons mButtonsRepeated;
+
+    // Directions the left stick is currently pressing
+    Buttons mStickButtons;
+
+    struct RepeatState {
+        OSTime nextRepeat;
+        uint32_t count;
+    };
+    std::array<RepeatState, 4> mRepeatStates;
+
+    // Fractional amount of entries scrolled with the right stick
+    float mScroll;
+    OSTime mPreviousTime;
 };
@@ -15,6 +15,7 @@
  *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include "ControllerManager.hpp"
+#include "FrameClock.hpp"
 
 #include <algorithm>
 
@@ -34,7 +35,9 @@ ControllerManager::ControllerManager() : mCombined(),
         KPADController(WPAD_CHAN_4),
         KPADController(WPAD_CHAN_5),
         KPADController(WPAD_CHAN_6),
-    })
+    }),
+    mConnectedKPADs(0),
+    mToCombine()
 {
 }
 
@@ -59,21 +62,29 @@ void ControllerManager::Finalize()
 
 bool ControllerManager::Update()
 {
-    std::vector<const Controller*> toCombine;
-    
+    size_t numToCombine = 0;
+
     if (mVPAD.Update()) {
-        toCombine.push_back(&mVPAD);
+        mToCombine[numToCombine++] = &mVPAD;
     }
 
+    uint32_t connected = 0;
     for (KPADController& kpad : mKPADs) {
-        if (!kpad.Update()) {
+        bool updated = kpad.Update();
+        if (kpad.IsConnected()) {
+            connected |= 1u << kpad.GetChannel();
+        }
+
+        if (!updated) {
             continue;
         }
 
-        toCombine.push_back(&kpad);
+        mToCombine[numToCombine++] = &kpad;
     }
 
-    mCombined.Combine(toCombine);
+    mConnectedKPADs = connected;
+
+    mCombined.Combine(std::span(mToCombine.data(), numToCombine), FrameClock::GetTime());
 
     return true;
 }
@@ -18,8 +18,8 @@
 
 #include "Controller.hpp"
 
-#include <vector>
 #include <array>
+#include <bit>
 #include <functional>
 
 class ControllerManager {
@@ -50,15 +50,13 @@ public:
 
     size_t GetConnectedKPADControllerCount() const
     {
-        size_t count = 0;
-
-        for (const KPADController& c : mKPADs) {
-            if (c.IsConnected()) {
-                count++;
-            }
-        }
+        return std::popcount(mConnectedKPADs);
+    }
 
-        return count;
+    // Bit n is set if KPAD channel n is connected, only changes on connects and disconnects
+    uint32_t GetConnectedKPADMask() const
+    {
+        return mConnectedKPADs;
     }
 
     const KPADController& GetKPADController(size_t i) const
@@ -73,4 +71,8 @@ private:
     CombinedInputController mCombined;
     VPADController mVPAD;
     std::array<KPADController, kMaxKPADControllers> mKPADs;
+    uint32_t mConnectedKPADs;
+
+    // Reused every frame, the VPAD and all KPADs
+    std::array<const Controller*, kMaxKPADControllers + 1> mToCombine;
 };
@@ -0,0 +1,198 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "DebugRecorder.hpp"
+#include "BloopairIPC.hpp"
+#include "Utils.hpp"
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <coreinit/time.h>
+
+#define BLOOPAIR_CAPTURE_DIR "/vol/external01/wiiu/bloopair/captures/"
+#define BLOOPAIR_TRACE_DIR "/vol/external01/wiiu/bloopair/traces/"
+
+namespace
+{
+
+struct Recording {
+    DebugRecorder::Status status;
+    std::ofstream file;
+};
+
+Recording capture;
+Recording trace;
+
+bool OpenRecording(Recording& recording, const char* dir, const char* name, const char* extension)
+{
+    OSCalendarTime ct;
+    OSTicksToCalendarTime(OSGetTime(), &ct);
+
+    std::filesystem::create_directories(dir);
+    recording.status.path = Utils::sprintf("%s%s_%04d%02d%02d_%02d%02d%02d.%s", dir, name,
+        ct.tm_year, ct.tm_mon + 1, ct.tm_mday, ct.tm_hour, ct.tm_min, ct.tm_sec, extension);
+    recording.status.size = 0;
+    recording.status.numLost = 0;
+
+    recording.file = std::ofstream(recording.status.path, std::ios::binary);
+    recording.status.failed = !recording.file.is_open();
+    return !recording.status.failed;
+}
+
+void FailRecording(Recording& recording)
+{
+    recording.status.failed = true;
+    recording.status.active = false;
+    recording.file.close();
+}
+
+void DrainCapture(bool enable)
+{
+    std::array<uint8_t, BLOOPAIR_CAPTURE_MAX_READ_SIZE> buffer;
+
+    // Keep draining until the buffer is empty, so we don't fall behind the controllers
+    while (true) {
+        uint32_t size;
+        uint32_t numLost;
+        if (!BloopairIPC::ReadCapture(enable, buffer, size, numLost)) {
+            FailRecording(capture);
+            return;
+        }
+
+        capture.file.write(reinterpret_cast<const char*>(buffer.data()), size);
+        capture.status.size += size;
+        capture.status.numLost += numLost;
+
+        if (size < buffer.size()) {
+            break;
+        }
+    }
+}
+
+void DrainTrace()
+{
+    std::array<BloopairTraceRecord, BLOOPAIR_TRACE_MAX_RECORDS_PER_READ> records;
+
+    // Keep draining until the buffer is empty, so we don't fall behind
+    while (true) {
+        uint32_t numRecords;
+        uint32_t numLost;
+        if (!BloopairIPC::ReadTrace(BLOOPAIR_TRACE_CATEGORY_ALL, records, numRecords, numLost)) {
+            FailRecording(trace);
+            return;
+        }
+
+        // The records are written as they are, tracedecode reads them back to back
+        trace.file.write(reinterpret_cast<const char*>(records.data()), numRecords * sizeof(BloopairTraceRecord));
+        trace.status.size += numRecords * sizeof(BloopairTraceRecord);
+        trace.status.numLost += numLost;
+
+        if (numRecords < records.size()) {
+            break;
+        }
+    }
+}
+
+}
+
+bool DebugRecorder::StartCapture()
+{
+    if (capture.status.active) {
+        return true;
+    }
+
+    if (!OpenRecording(capture, BLOOPAIR_CAPTURE_DIR, "capture", "bpcap")) {
+        return false;
+    }
+
+    BloopairCaptureFileHeader header{};
+    header.magic = BLOOPAIR_CAPTURE_MAGIC;
+    header.version = BLOOPAIR_CAPTURE_VERSION;
+    capture.file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    capture.status.active = true;
+
+    // The first read starts the capture
+    DrainCapture(true);
+    return capture.status.active;
+}
+
+void DebugRecorder::StopCapture()
+{
+    if (!capture.status.active) {
+        return;
+    }
+
+    DrainCapture(false);
+    capture.file.close();
+    capture.status.active = false;
+}
+
+const DebugRecorder::Status& DebugRecorder::GetCaptureStatus()
+{
+    return capture.status;
+}
+
+bool DebugRecorder::StartTrace()
+{
+    if (trace.status.active) {
+        return true;
+    }
+
+    if (!OpenRecording(trace, BLOOPAIR_TRACE_DIR, "trace", "bptrace")) {
+        return false;
+    }
+
+    trace.status.active = true;
+
+    // The first read also picks up what was traced before the recording started
+    DrainTrace();
+    return trace.status.active;
+}
+
+void DebugRecorder::StopTrace()
+{
+    if (!trace.status.active) {
+        return;
+    }
+
+    DrainTrace();
+    trace.file.close();
+    trace.status.active = false;
+}
+
+const DebugRecorder::Status& DebugRecorder::GetTraceStatus()
+{
+    return trace.status;
+}
+
+void DebugRecorder::Update()
+{
+    if (capture.status.active) {
+        DrainCapture(true);
+    }
+
+    if (trace.status.active) {
+        DrainTrace();
+    }
+}
+
+void DebugRecorder::Shutdown()
+{
+    StopCapture();
+    StopTrace();
+}
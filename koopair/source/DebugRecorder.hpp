@@ -0,0 +1,55 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Drains the IOS-PAD debug buffers to files on the SD card.
+// Recordings keep running while switching screens, they're only stopped explicitly or when Koopair exits.
+namespace DebugRecorder
+{
+
+struct Status {
+    bool active = false;
+    bool failed = false;
+    std::string path;
+    uint32_t size = 0;
+    uint32_t numLost = 0;
+};
+
+// Saves the controller traffic to wiiu/bloopair/captures/, see bloopair/capture.h for the format
+bool StartCapture();
+
+void StopCapture();
+
+const Status& GetCaptureStatus();
+
+// Saves the trace records to wiiu/bloopair/traces/, these can be decoded with tools/tracedecode
+bool StartTrace();
+
+void StopTrace();
+
+const Status& GetTraceStatus();
+
+// Drains everything which is being recorded, call this once per frame
+void Update();
+
+// Stops all recordings, this needs the Bloopair IPC handle to still be open
+void Shutdown();
+
+} // namespace DebugRecorder
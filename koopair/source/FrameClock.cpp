@@ -0,0 +1,165 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "FrameClock.hpp"
+#include "Gfx.hpp"
+#include "Utils.hpp"
+
+#include <algorithm>
+#include <coreinit/thread.h>
+
+namespace
+{
+
+constexpr uint32_t kDisplayRate = 60;
+
+// Delta times above this are clamped, e.g. after returning from the HOME Menu
+constexpr float kMaxDelta = 0.1f;
+
+// Seconds without input before dropping to 30 Hz
+constexpr float kIdleTimeout = 5.0f;
+
+OSTime frameStart = 0;
+float delta = 0.0f;
+
+uint32_t targetRate = 60;
+bool idleThrottleEnabled = true;
+float idleTime = 0.0f;
+
+bool overlayEnabled = false;
+
+// Frame times in milliseconds, as a ring buffer
+std::array<float, FrameClock::kHistorySize> frameTimes{};
+size_t frameTimePos = 0;
+
+}
+
+void FrameClock::Tick()
+{
+    OSTime now = OSGetSystemTime();
+
+    if (frameStart != 0) {
+        // Presenting already waits for vsync, so only sleep for what's left beyond the last vsync.
+        // Waking up half a display frame early makes sure we don't miss the vsync after it.
+        const OSTime period = OSSecondsToTicks(1) / GetCurrentRate();
+        const OSTime displayPeriod = OSSecondsToTicks(1) / kDisplayRate;
+        const OSTime wakeup = frameStart + period - displayPeriod / 2;
+        if (now < wakeup) {
+            OSSleepTicks(wakeup - now);
+            now = OSGetSystemTime();
+        }
+
+        delta = OSTicksToMicroseconds(now - frameStart) / 1000000.0f;
+
+        frameTimes[frameTimePos] = delta * 1000.0f;
+        frameTimePos = (frameTimePos + 1) % frameTimes.size();
+
+        delta = std::min(delta, kMaxDelta);
+    }
+
+    idleTime += delta;
+    frameStart = now;
+}
+
+OSTime FrameClock::GetTime()
+{
+    return frameStart;
+}
+
+float FrameClock::GetDelta()
+{
+    return delta;
+}
+
+void FrameClock::SetTargetRate(uint32_t rate)
+{
+    targetRate = rate >= kDisplayRate ? kDisplayRate : kDisplayRate / 2;
+}
+
+uint32_t FrameClock::GetTargetRate()
+{
+    return targetRate;
+}
+
+void FrameClock::SetIdleThrottleEnabled(bool enabled)
+{
+    idleThrottleEnabled = enabled;
+}
+
+bool FrameClock::IsIdleThrottleEnabled()
+{
+    return idleThrottleEnabled;
+}
+
+void FrameClock::ReportActivity()
+{
+    idleTime = 0.0f;
+}
+
+uint32_t FrameClock::GetCurrentRate()
+{
+    if (idleThrottleEnabled && idleTime >= kIdleTimeout) {
+        return kDisplayRate / 2;
+    }
+
+    return targetRate;
+}
+
+void FrameClock::SetOverlayEnabled(bool enabled)
+{
+    overlayEnabled = enabled;
+}
+
+bool FrameClock::IsOverlayEnabled()
+{
+    return overlayEnabled;
+}
+
+void FrameClock::DrawOverlay()
+{
+    if (!overlayEnabled) {
+        return;
+    }
+
+    constexpr int kBarWidth = 4;
+    constexpr int kGraphHeight = 150;
+    // Height of the graph in milliseconds
+    constexpr float kGraphRange = 50.0f;
+
+    const int width = frameTimes.size() * kBarWidth;
+    const int x = Gfx::SCREEN_WIDTH - width - 32;
+    const int y = 75 + 32;
+
+    Gfx::DrawRectFilled(x - 16, y - 16, width + 32, kGraphHeight + 80, { 0, 0, 0, 0xc0 });
+
+    // Oldest frame on the left
+    for (size_t i = 0; i < frameTimes.size(); i++) {
+        float frameTime = frameTimes[(frameTimePos + i) % frameTimes.size()];
+        int height = std::min(frameTime / kGraphRange, 1.0f) * kGraphHeight;
+
+        // Frames which took longer than the target are highlighted
+        SDL_Color color = frameTime > 1000.0f / GetCurrentRate() + 2.0f ? Gfx::COLOR_ERROR : Gfx::COLOR_HIGHLIGHTED;
+        Gfx::DrawRectFilled(x + i * kBarWidth, y + kGraphHeight - height, kBarWidth - 1, height, color);
+    }
+
+    // Target frame time line
+    int targetY = y + kGraphHeight - (int) ((1000.0f / GetCurrentRate()) / kGraphRange * kGraphHeight);
+    Gfx::DrawRectFilled(x, targetY, width, 2, Gfx::COLOR_WHITE);
+
+    float lastFrameTime = frameTimes[(frameTimePos + frameTimes.size() - 1) % frameTimes.size()];
+    Gfx::Print(x, y + kGraphHeight + 32, 40, Gfx::COLOR_TEXT,
+        Utils::sprintf("%5.1f ms (%u Hz)", lastFrameTime, GetCurrentRate()), Gfx::ALIGN_LEFT | Gfx::ALIGN_VERTICAL);
+}
@@ -0,0 +1,62 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <coreinit/time.h>
+
+namespace FrameClock
+{
+
+// Amount of frame times kept for the overlay graph
+constexpr size_t kHistorySize = 120;
+
+// Waits for the rest of the frame if running below the display rate, then starts a new frame
+void Tick();
+
+// Time at which the current frame started
+OSTime GetTime();
+
+// Seconds passed since the last frame, limited so long stalls don't cause jumps
+float GetDelta();
+
+// Target rate in Hz, either 60 or 30
+void SetTargetRate(uint32_t rate);
+
+uint32_t GetTargetRate();
+
+// Drops to 30 Hz after a while without any input
+void SetIdleThrottleEnabled(bool enabled);
+
+bool IsIdleThrottleEnabled();
+
+// Call when there was input this frame, keeps the idle throttle from kicking in
+void ReportActivity();
+
+// Rate the clock is currently running at, with the idle throttle applied
+uint32_t GetCurrentRate();
+
+void SetOverlayEnabled(bool enabled);
+
+bool IsOverlayEnabled();
+
+// Draws the frame time graph if the overlay is enabled
+void DrawOverlay();
+
+} // namespace FrameClock
@@ -16,10 +16,14 @@
  */
 #include "Gfx.hpp"
 #include "SDL_FontCache.h"
-#include <SDL2_gfxPrimitives.h>
 #include <SDL_image.h>
 #include <map>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
 #include <cstdarg>
+#include <cmath>
 
 #include <coreinit/debug.h>
 #include <coreinit/memory.h>
@@ -49,10 +53,114 @@ std::map<Uint16, SDL_Texture*> iconCache;
 
 SDL_Texture* appIcon = nullptr;
 
+// White anti-aliased discs and rings keyed by (radius, border size), a border of 0 is a filled disc
+std::map<std::pair<int, int>, SDL_Texture*> shapeCache;
+
+// Texts which haven't been drawn for a frame are dropped once there are more than this
+constexpr size_t MAX_CACHED_TEXTS = 256;
+
+uint32_t frameCounter = 0;
+
+// A glyph of a laid out text, positioned relative to the start of its line
+struct TextGlyph {
+    int cacheLevel;
+    uint32_t line;
+    SDL_FPoint texMin;
+    SDL_FPoint texMax;
+    SDL_FRect dst;
+};
+
+struct TextLayout {
+    // sorted by glyph cache level, so every level can be drawn at once
+    std::vector<TextGlyph> glyphs;
+    // scaled width of each line, for aligning them
+    std::vector<float> lineWidths;
+    uint32_t lastUsedFrame;
+};
+
+struct TextKeyView {
+    std::string_view text;
+    int size;
+    bool monospace;
+};
+
+bool operator==(const TextKeyView& lhs, const TextKeyView& rhs)
+{
+    return lhs.size == rhs.size && lhs.monospace == rhs.monospace && lhs.text == rhs.text;
+}
+
+struct TextKey {
+    std::string text;
+    int size;
+    bool monospace;
+
+    operator TextKeyView() const { return { text, size, monospace }; }
+};
+
+struct TextKeyHash {
+    using is_transparent = void;
+
+    size_t operator()(const TextKeyView& key) const
+    {
+        return std::hash<std::string_view>{}(key.text) ^ (key.size << 1) ^ key.monospace;
+    }
+};
+
+std::unordered_map<TextKey, TextLayout, TextKeyHash, std::equal_to<>> textCache;
+
+// Reused between draws, so drawing text doesn't allocate
+std::vector<SDL_Vertex> textVertices;
+std::vector<int> textIndices;
+
+// Everything drawn during a frame is recorded first.
+// Once the frame is done, only the area which changed since the last frame is drawn again.
+struct DrawCommand {
+    enum Type {
+        TYPE_CLEAR,
+        TYPE_RECT_FILLED,
+        TYPE_RECT_ROUNDED_FILLED,
+        TYPE_CIRCLE_FILLED,
+        TYPE_CIRCLE,
+        TYPE_ICON,
+        TYPE_TEXT,
+        TYPE_GEOMETRY,
+    } type;
+
+    // area of the screen touched by this command
+    SDL_Rect bounds;
+    SDL_Color color;
+
+    // position of circles and texts, destination rect of rects and icons
+    int x, y, w, h;
+    int radius;
+    int borderSize;
+    double angle;
+    Gfx::AlignFlags align;
+
+    SDL_Texture* texture;
+    FC_Font* font;
+    const TextLayout* layout;
+
+    // range of the frame's geometry vertices
+    size_t vertexOffset, vertexCount;
+};
+
+std::vector<DrawCommand> drawCommands;
+std::vector<DrawCommand> previousDrawCommands;
+
+// Vertices of all geometry drawn during a frame, these are swapped together with the commands
+std::vector<SDL_Vertex> geometryVertices;
+std::vector<SDL_Vertex> previousGeometryVertices;
+
+// Keeps the last drawn frame, so unchanged parts don't need to be drawn again
+SDL_Texture* backbuffer = nullptr;
+bool backbufferValid = false;
+
 FC_Font* GetFontForSize(int size)
 {
-    if (fontMap.contains(size)) {
-        return fontMap[size];
+    auto it = fontMap.find(size);
+    if (it != fontMap.end()) {
+        return it->second;
     }
 
     FC_Font* font = FC_CreateFont();
@@ -69,6 +177,162 @@ FC_Font* GetFontForSize(int size)
     return font;
 }
 
+float GetMonospaceScale(int size, bool monospace)
+{
+    // scale monospace font based on size
+    return monospace ? (size / 28.0f) : 1.0f;
+}
+
+TextLayout CreateTextLayout(FC_Font* font, const std::string& text, float scale)
+{
+    TextLayout layout{};
+    float lineHeight = (FC_GetLineHeight(font) + FC_GetLineSpacing(font)) * scale;
+    float letterSpacing = FC_GetSpacing(font) * scale;
+
+    float x = 0.0f;
+    float width = 0.0f;
+    uint32_t line = 0;
+    for (const char* c = text.c_str(); *c != '\0'; c++) {
+        if (*c == '\n') {
+            layout.lineWidths.push_back(width * scale);
+            x = 0.0f;
+            width = 0.0f;
+            line++;
+            continue;
+        }
+
+        // Same as SDL_FontCache, which replaces glyphs it can't render with spaces
+        FC_GlyphData glyph;
+        Uint32 codepoint = FC_GetCodepointFromUTF8(&c, 1);
+        if (!FC_GetGlyphData(font, &glyph, codepoint)) {
+            codepoint = ' ';
+            if (!FC_GetGlyphData(font, &glyph, codepoint)) {
+                continue;
+            }
+        }
+
+        width += glyph.rect.w;
+        if (codepoint != ' ') {
+            int texW, texH;
+            SDL_QueryTexture(FC_GetGlyphCacheLevel(font, glyph.cache_level), nullptr, nullptr, &texW, &texH);
+
+            TextGlyph textGlyph;
+            textGlyph.cacheLevel = glyph.cache_level;
+            textGlyph.line = line;
+            textGlyph.texMin = { (float) glyph.rect.x / texW, (float) glyph.rect.y / texH };
+            textGlyph.texMax = { (float) (glyph.rect.x + glyph.rect.w) / texW, (float) (glyph.rect.y + glyph.rect.h) / texH };
+            textGlyph.dst = { x, line * lineHeight, glyph.rect.w * scale, glyph.rect.h * scale };
+            layout.glyphs.push_back(textGlyph);
+        }
+
+        x += glyph.rect.w * scale + letterSpacing;
+    }
+
+    layout.lineWidths.push_back(width * scale);
+
+    std::stable_sort(layout.glyphs.begin(), layout.glyphs.end(), [](const TextGlyph& a, const TextGlyph& b) {
+        return a.cacheLevel < b.cacheLevel;
+    });
+
+    return layout;
+}
+
+const TextLayout* GetTextLayout(int size, const std::string& text, bool monospace)
+{
+    auto it = textCache.find(TextKeyView{ text, size, monospace });
+    if (it == textCache.end()) {
+        FC_Font* font = monospace ? monospaceFont : GetFontForSize(size);
+        if (!font) {
+            return nullptr;
+        }
+
+        it = textCache.emplace(TextKey{ text, size, monospace }, CreateTextLayout(font, text, GetMonospaceScale(size, monospace))).first;
+    }
+
+    it->second.lastUsedFrame = frameCounter;
+    return &it->second;
+}
+
+float GetLineOffset(const TextLayout& layout, uint32_t line, Gfx::AlignFlags align)
+{
+    if (align & Gfx::ALIGN_LEFT) {
+        return 0.0f;
+    } else if (align & Gfx::ALIGN_RIGHT) {
+        return -layout.lineWidths[line];
+    } else if (align & Gfx::ALIGN_HORIZONTAL) {
+        return -layout.lineWidths[line] / 2.0f;
+    }
+
+    return 0.0f;
+}
+
+SDL_Rect GetTextLayoutBounds(const TextLayout& layout, float x, float y, Gfx::AlignFlags align)
+{
+    if (layout.glyphs.empty()) {
+        return SDL_Rect{ (int) x, (int) y, 0, 0 };
+    }
+
+    float left = INFINITY, top = INFINITY, right = -INFINITY, bottom = -INFINITY;
+    for (const TextGlyph& glyph : layout.glyphs) {
+        float glyphX = x + GetLineOffset(layout, glyph.line, align) + glyph.dst.x;
+        float glyphY = y + glyph.dst.y;
+        left = std::min(left, glyphX);
+        top = std::min(top, glyphY);
+        right = std::max(right, glyphX + glyph.dst.w);
+        bottom = std::max(bottom, glyphY + glyph.dst.h);
+    }
+
+    // add a pixel on each side to account for the rounding when drawing
+    return SDL_Rect{ (int) std::floor(left) - 1, (int) std::floor(top) - 1,
+        (int) std::ceil(right - left) + 2, (int) std::ceil(bottom - top) + 2 };
+}
+
+void DrawTextLayout(FC_Font* font, const TextLayout& layout, float x, float y, Gfx::AlignFlags align, SDL_Color color)
+{
+    // Draw all glyphs on the same cache level with a single call
+    for (auto begin = layout.glyphs.begin(); begin != layout.glyphs.end();) {
+        auto end = std::find_if(begin, layout.glyphs.end(), [begin](const TextGlyph& g) { return g.cacheLevel != begin->cacheLevel; });
+        SDL_Texture* texture = FC_GetGlyphCacheLevel(font, begin->cacheLevel);
+
+        textVertices.clear();
+        textIndices.clear();
+        for (auto glyph = begin; glyph != end; glyph++) {
+            // snap to whole pixels like SDL_FontCache does, to keep the glyphs sharp
+            float left = (int) (x + GetLineOffset(layout, glyph->line, align) + glyph->dst.x);
+            float top = (int) (y + glyph->dst.y);
+            float right = left + (int) glyph->dst.w;
+            float bottom = top + (int) glyph->dst.h;
+
+            int base = textVertices.size();
+            textVertices.push_back({ { left, top }, color, { glyph->texMin.x, glyph->texMin.y } });
+            textVertices.push_back({ { right, top }, color, { glyph->texMax.x, glyph->texMin.y } });
+            textVertices.push_back({ { right, bottom }, color, { glyph->texMax.x, glyph->texMax.y } });
+            textVertices.push_back({ { left, bottom }, color, { glyph->texMin.x, glyph->texMax.y } });
+            textIndices.insert(textIndices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+        }
+
+        // the color is part of the vertices
+        SDL_SetTextureColorMod(texture, 0xff, 0xff, 0xff);
+        SDL_SetTextureAlphaMod(texture, 0xff);
+        if (SDL_RenderGeometry(renderer, texture, textVertices.data(), textVertices.size(), textIndices.data(), textIndices.size()) < 0) {
+            // not every renderer supports geometry, copy the glyphs one by one instead
+            int texW, texH;
+            SDL_QueryTexture(texture, nullptr, nullptr, &texW, &texH);
+            SDL_SetTextureColorMod(texture, color.r, color.g, color.b);
+            SDL_SetTextureAlphaMod(texture, color.a);
+            for (size_t i = 0; i < textVertices.size(); i += 4) {
+                const SDL_Vertex* v = &textVertices[i];
+                SDL_Rect src = { (int) (v[0].tex_coord.x * texW + 0.5f), (int) (v[0].tex_coord.y * texH + 0.5f),
+                    (int) ((v[2].tex_coord.x - v[0].tex_coord.x) * texW + 0.5f), (int) ((v[2].tex_coord.y - v[0].tex_coord.y) * texH + 0.5f) };
+                SDL_FRect dst = { v[0].position.x, v[0].position.y, v[2].position.x - v[0].position.x, v[2].position.y - v[0].position.y };
+                SDL_RenderCopyF(renderer, texture, &src, &dst);
+            }
+        }
+
+        begin = end;
+    }
+}
+
 SDL_Texture* LoadIcon(Uint16 icon)
 {
     if (icon == Gfx::APP_ICON) {
@@ -94,6 +358,228 @@ SDL_Texture* LoadIcon(Uint16 icon)
     return texture;
 }
 
+SDL_Texture* LoadShape(int radius, int borderSize)
+{
+    auto it = shapeCache.find({radius, borderSize});
+    if (it != shapeCache.end()) {
+        return it->second;
+    }
+
+    // The center is at pixel (radius + 1), with one pixel around for anti-aliasing
+    const int size = radius * 2 + 3;
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!surface) {
+        return nullptr;
+    }
+
+    const float outer = radius + 0.5f;
+    const float inner = borderSize > 0 ? outer - borderSize : 0.0f;
+
+    SDL_LockSurface(surface);
+    for (int y = 0; y < size; y++) {
+        Uint8* row = (Uint8*) surface->pixels + y * surface->pitch;
+        for (int x = 0; x < size; x++) {
+            float distance = std::hypot(x - (radius + 1), y - (radius + 1));
+
+            // coverage of the pixel, approximated by the distance of its center to the edges
+            float coverage = std::clamp(outer - distance + 0.5f, 0.0f, 1.0f);
+            if (borderSize > 0) {
+                coverage -= std::clamp(inner - distance + 0.5f, 0.0f, 1.0f);
+            }
+
+            row[x * 4 + 0] = 0xff;
+            row[x * 4 + 1] = 0xff;
+            row[x * 4 + 2] = 0xff;
+            row[x * 4 + 3] = (Uint8) (coverage * 0xff + 0.5f);
+        }
+    }
+    SDL_UnlockSurface(surface);
+
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_FreeSurface(surface);
+    if (!texture) {
+        return nullptr;
+    }
+
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+    shapeCache.insert({{radius, borderSize}, texture});
+    return texture;
+}
+
+void FillRect(int x, int y, int w, int h, SDL_Color color)
+{
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+
+    SDL_SetRenderDrawBlendMode(renderer, color.a == 0xff ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+
+    SDL_Rect rect{ x, y, w, h };
+    SDL_RenderFillRect(renderer, &rect);
+}
+
+void DrawShape(int x, int y, int radius, int borderSize, SDL_Color color)
+{
+    SDL_Texture* texture = LoadShape(radius, borderSize);
+    if (!texture) {
+        return;
+    }
+
+    SDL_SetTextureColorMod(texture, color.r, color.g, color.b);
+    SDL_SetTextureAlphaMod(texture, color.a);
+
+    SDL_Rect rect{ x - radius - 1, y - radius - 1, radius * 2 + 3, radius * 2 + 3 };
+    SDL_RenderCopy(renderer, texture, nullptr, &rect);
+}
+
+void DrawRoundedRect(int x, int y, int w, int h, int radius, SDL_Color color)
+{
+    radius = std::min(radius, std::min(w, h) / 2);
+
+    SDL_Texture* texture = radius > 0 ? LoadShape(radius, 0) : nullptr;
+    if (!texture) {
+        FillRect(x, y, w, h, color);
+        return;
+    }
+
+    SDL_SetTextureColorMod(texture, color.r, color.g, color.b);
+    SDL_SetTextureAlphaMod(texture, color.a);
+
+    // The corners are the quarters of a disc, the rest is filled without overlapping,
+    // so transparent colors still look right
+    const int right = x + w - radius;
+    const int bottom = y + h - radius;
+    const SDL_Rect corners[][2] = {
+        { { 1, 1, radius, radius },                           { x, y, radius, radius } },
+        { { radius + 2, 1, radius, radius },                  { right, y, radius, radius } },
+        { { 1, radius + 2, radius, radius },                  { x, bottom, radius, radius } },
+        { { radius + 2, radius + 2, radius, radius },         { right, bottom, radius, radius } },
+    };
+    for (const auto& [src, dst] : corners) {
+        SDL_RenderCopy(renderer, texture, &src, &dst);
+    }
+
+    FillRect(x + radius, y, w - radius * 2, radius, color);
+    FillRect(x, y + radius, w, h - radius * 2, color);
+    FillRect(x + radius, bottom, w - radius * 2, radius, color);
+}
+
+bool IsSameVertex(const SDL_Vertex& a, const SDL_Vertex& b)
+{
+    return a.position.x == b.position.x && a.position.y == b.position.y &&
+        a.color.r == b.color.r && a.color.g == b.color.g && a.color.b == b.color.b && a.color.a == b.color.a;
+}
+
+// a is a command of the current frame, b one of the previous frame
+bool IsSameCommand(const DrawCommand& a, const DrawCommand& b)
+{
+    if (a.type == DrawCommand::TYPE_GEOMETRY && b.type == DrawCommand::TYPE_GEOMETRY) {
+        return a.vertexCount == b.vertexCount &&
+            std::equal(geometryVertices.begin() + a.vertexOffset, geometryVertices.begin() + a.vertexOffset + a.vertexCount,
+                previousGeometryVertices.begin() + b.vertexOffset, IsSameVertex);
+    }
+
+    return a.type == b.type &&
+        a.bounds.x == b.bounds.x && a.bounds.y == b.bounds.y && a.bounds.w == b.bounds.w && a.bounds.h == b.bounds.h &&
+        a.color.r == b.color.r && a.color.g == b.color.g && a.color.b == b.color.b && a.color.a == b.color.a &&
+        a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h &&
+        a.radius == b.radius && a.borderSize == b.borderSize && a.angle == b.angle && a.align == b.align &&
+        a.texture == b.texture && a.font == b.font && a.layout == b.layout;
+}
+
+void AddDirtyRect(SDL_Rect& dirty, const SDL_Rect& rect)
+{
+    SDL_Rect result;
+    SDL_UnionRect(&dirty, &rect, &result);
+    dirty = result;
+}
+
+// Returns false if the frame looks exactly like the last one
+bool GetDirtyRect(SDL_Rect& dirty)
+{
+    if (!backbufferValid) {
+        dirty = SDL_Rect{ 0, 0, (int) Gfx::SCREEN_WIDTH, (int) Gfx::SCREEN_HEIGHT };
+        return true;
+    }
+
+    dirty = SDL_Rect{ 0, 0, 0, 0 };
+
+    if (drawCommands.size() == previousDrawCommands.size()) {
+        // Only the commands which changed need to be drawn again
+        for (size_t i = 0; i < drawCommands.size(); i++) {
+            if (!IsSameCommand(drawCommands[i], previousDrawCommands[i])) {
+                AddDirtyRect(dirty, drawCommands[i].bounds);
+                AddDirtyRect(dirty, previousDrawCommands[i].bounds);
+            }
+        }
+    } else {
+        // Everything after the first difference might have shifted
+        size_t first = 0;
+        while (first < drawCommands.size() && first < previousDrawCommands.size() &&
+            IsSameCommand(drawCommands[first], previousDrawCommands[first])) {
+            first++;
+        }
+
+        for (size_t i = first; i < drawCommands.size(); i++) {
+            AddDirtyRect(dirty, drawCommands[i].bounds);
+        }
+
+        for (size_t i = first; i < previousDrawCommands.size(); i++) {
+            AddDirtyRect(dirty, previousDrawCommands[i].bounds);
+        }
+    }
+
+    return !SDL_RectEmpty(&dirty);
+}
+
+void ExecuteCommand(const DrawCommand& command)
+{
+    const SDL_Color& color = command.color;
+
+    switch (command.type) {
+    case DrawCommand::TYPE_CLEAR:
+        // SDL_RenderClear ignores the clip rect, so fill instead
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+        SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+        SDL_RenderFillRect(renderer, nullptr);
+        break;
+    case DrawCommand::TYPE_RECT_FILLED:
+        // Filled rects include the end coordinates, like SDL2_gfx did
+        FillRect(command.x, command.y, command.w + 1, command.h + 1, color);
+        break;
+    case DrawCommand::TYPE_RECT_ROUNDED_FILLED:
+        DrawRoundedRect(command.x, command.y, command.w + 1, command.h + 1, command.radius, color);
+        break;
+    case DrawCommand::TYPE_CIRCLE_FILLED:
+        DrawShape(command.x, command.y, command.radius, 0, color);
+        break;
+    case DrawCommand::TYPE_CIRCLE:
+        DrawShape(command.x, command.y, command.radius, command.borderSize, color);
+        break;
+    case DrawCommand::TYPE_ICON: {
+        SDL_SetTextureColorMod(command.texture, color.r, color.g, color.b);
+        SDL_SetTextureAlphaMod(command.texture, color.a);
+
+        SDL_Rect rect{ command.x, command.y, command.w, command.h };
+        if (command.angle) {
+            SDL_RenderCopyEx(renderer, command.texture, nullptr, &rect, command.angle, nullptr, SDL_FLIP_NONE);
+        } else {
+            SDL_RenderCopy(renderer, command.texture, nullptr, &rect);
+        }
+        break;
+    }
+    case DrawCommand::TYPE_TEXT:
+        DrawTextLayout(command.font, *command.layout, command.x, command.y, command.align, color);
+        break;
+    case DrawCommand::TYPE_GEOMETRY:
+        // renderers without geometry support simply won't show it, this is only used for visualizations
+        SDL_RenderGeometry(renderer, nullptr, geometryVertices.data() + command.vertexOffset, command.vertexCount, nullptr, 0);
+        break;
+    }
+}
+
 }
 
 namespace Gfx
@@ -147,11 +633,34 @@ bool Init()
         return false;
     }
 
+    // Without render targets every frame is drawn completely
+    backbuffer = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (backbuffer) {
+        if (SDL_SetRenderTarget(renderer, backbuffer) == 0) {
+            SDL_SetTextureBlendMode(backbuffer, SDL_BLENDMODE_NONE);
+            SDL_SetRenderTarget(renderer, nullptr);
+        } else {
+            OSReport("Render targets not supported, drawing every frame completely\n");
+            SDL_DestroyTexture(backbuffer);
+            backbuffer = nullptr;
+        }
+    }
+
     return true;
 }
 
 void Shutdown()
 {
+    drawCommands.clear();
+    previousDrawCommands.clear();
+    geometryVertices.clear();
+    previousGeometryVertices.clear();
+    textCache.clear();
+
+    if (backbuffer) {
+        SDL_DestroyTexture(backbuffer);
+    }
+
     for (const auto& [key, value] : fontMap) {
         FC_FreeFont(value);
     }
@@ -160,6 +669,10 @@ void Shutdown()
         SDL_DestroyTexture(value);
     }
 
+    for (const auto& [key, value] : shapeCache) {
+        SDL_DestroyTexture(value);
+    }
+
     SDL_DestroyTexture(appIcon);
     FC_FreeFont(monospaceFont);
     TTF_CloseFont(iconFont);
@@ -171,18 +684,76 @@ void Shutdown()
 
 void Clear(SDL_Color color)
 {
-    SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
-    SDL_RenderClear(renderer);
+    // Anything recorded so far would be drawn over anyways
+    drawCommands.clear();
+    geometryVertices.clear();
+
+    DrawCommand command{};
+    command.type = DrawCommand::TYPE_CLEAR;
+    command.bounds = SDL_Rect{ 0, 0, (int) SCREEN_WIDTH, (int) SCREEN_HEIGHT };
+    command.color = color;
+    drawCommands.push_back(command);
 }
 
 void Render()
 {
+    if (backbuffer) {
+        SDL_Rect dirty;
+        if (GetDirtyRect(dirty)) {
+            // Draw everything touching the changed area, the rest of the backbuffer stays as is
+            SDL_SetRenderTarget(renderer, backbuffer);
+            SDL_RenderSetClipRect(renderer, &dirty);
+            for (const DrawCommand& command : drawCommands) {
+                if (SDL_HasIntersection(&command.bounds, &dirty)) {
+                    ExecuteCommand(command);
+                }
+            }
+            SDL_RenderSetClipRect(renderer, nullptr);
+            SDL_SetRenderTarget(renderer, nullptr);
+
+            backbufferValid = true;
+        }
+
+        SDL_RenderCopy(renderer, backbuffer, nullptr, nullptr);
+    } else {
+        for (const DrawCommand& command : drawCommands) {
+            ExecuteCommand(command);
+        }
+    }
+
     SDL_RenderPresent(renderer);
+
+    // Keep the commands of this frame around to compare the next one against
+    std::swap(drawCommands, previousDrawCommands);
+    drawCommands.clear();
+    std::swap(geometryVertices, previousGeometryVertices);
+    geometryVertices.clear();
+
+    // Drop texts which weren't drawn this frame, like values which keep changing
+    if (textCache.size() > MAX_CACHED_TEXTS) {
+        std::erase_if(textCache, [](const auto& entry) { return entry.second.lastUsedFrame != frameCounter; });
+    }
+
+    frameCounter++;
+}
+
+void Invalidate()
+{
+    backbufferValid = false;
 }
 
 void DrawRectFilled(int x, int y, int w, int h, SDL_Color color)
 {
-    boxRGBA(renderer, x, y, x + w, y + h, color.r, color.g, color.b, color.a);
+    DrawCommand command{};
+    command.type = DrawCommand::TYPE_RECT_FILLED;
+    // Filled rects include the end coordinates
+    command.bounds = SDL_Rect{ x, y, w + 1, h + 1 };
+    command.color = color;
+    command.x = x;
+    command.y = y;
+    command.w = w;
+    command.h = h;
+    drawCommands.push_back(command);
 }
 
 void DrawRect(int x, int y, int w, int h, int borderSize, SDL_Color color)
@@ -195,12 +766,28 @@ void DrawRect(int x, int y, int w, int h, int borderSize, SDL_Color color)
 
 void DrawRectRoundedFilled(int x, int y, int w, int h, int radius, SDL_Color color)
 {
-    roundedBoxRGBA(renderer, x, y, x + w, y + h, radius, color.r, color.g, color.b, color.a);
+    DrawCommand command{};
+    command.type = DrawCommand::TYPE_RECT_ROUNDED_FILLED;
+    command.bounds = SDL_Rect{ x, y, w + 1, h + 1 };
+    command.color = color;
+    command.x = x;
+    command.y = y;
+    command.w = w;
+    command.h = h;
+    command.radius = radius;
+    drawCommands.push_back(command);
 }
 
 void DrawCircleFilled(int x, int y, int radius, SDL_Color color)
 {
-    filledCircleRGBA(renderer, x, y, radius, color.r, color.g, color.b, color.a);
+    DrawCommand command{};
+    command.type = DrawCommand::TYPE_CIRCLE_FILLED;
+    command.bounds = SDL_Rect{ x - radius - 1, y - radius - 1, radius * 2 + 3, radius * 2 + 3 };
+    command.color = color;
+    command.x = x;
+    command.y = y;
+    command.radius = radius;
+    drawCommands.push_back(command);
 }
 
 void DrawCircle(int x, int y, int radius, int borderSize, SDL_Color color)
@@ -209,10 +796,42 @@ void DrawCircle(int x, int y, int radius, int borderSize, SDL_Color color)
         return;
     }
 
-    // TODO eh this is not nice
-    while (borderSize--) {
-        circleRGBA(renderer, x, y, radius - borderSize, color.r, color.g, color.b, color.a);
+    DrawCommand command{};
+    command.type = DrawCommand::TYPE_CIRCLE;
+    command.bounds = SDL_Rect{ x - radius - 1, y - radius - 1, radius * 2 + 3, radius * 2 + 3 };
+    command.color = color;
+    command.x = x;
+    command.y = y;
+    command.radius = radius;
+    command.borderSize = borderSize;
+    drawCommands.push_back(command);
+}
+
+void DrawGeometry(std::span<const SDL_Vertex> vertices)
+{
+    if (vertices.empty()) {
+        return;
+    }
+
+    float minX = vertices[0].position.x, maxX = minX;
+    float minY = vertices[0].position.y, maxY = minY;
+    for (const SDL_Vertex& vertex : vertices) {
+        minX = std::min(minX, vertex.position.x);
+        maxX = std::max(maxX, vertex.position.x);
+        minY = std::min(minY, vertex.position.y);
+        maxY = std::max(maxY, vertex.position.y);
     }
+
+    DrawCommand command{};
+    command.type = DrawCommand::TYPE_GEOMETRY;
+    // include partially covered pixels at the edges
+    command.bounds = SDL_Rect{ (int) std::floor(minX), (int) std::floor(minY),
+        (int) std::ceil(maxX) - (int) std::floor(minX) + 1, (int) std::ceil(maxY) - (int) std::floor(minY) + 1 };
+    command.color = COLOR_WHITE;
+    command.vertexOffset = geometryVertices.size();
+    command.vertexCount = vertices.size();
+    geometryVertices.insert(geometryVertices.end(), vertices.begin(), vertices.end());
+    drawCommands.push_back(command);
 }
 
 void DrawIcon(int x, int y, int size, SDL_Color color, Uint16 icon, AlignFlags align, double angle)
@@ -222,9 +841,6 @@ void DrawIcon(int x, int y, int size, SDL_Color color, Uint16 icon, AlignFlags a
         return;
     }
 
-    SDL_SetTextureColorMod(iconTex, color.r, color.g, color.b);
-    SDL_SetTextureAlphaMod(iconTex, color.a);
-
     int w, h;
     SDL_QueryTexture(iconTex, nullptr, nullptr, &w, &h);
 
@@ -247,12 +863,22 @@ void DrawIcon(int x, int y, int size, SDL_Color color, Uint16 icon, AlignFlags a
         rect.y -= rect.h / 2;
     }
 
-    // draw the icon
+    DrawCommand command{};
+    command.type = DrawCommand::TYPE_ICON;
+    command.bounds = rect;
     if (angle) {
-        SDL_RenderCopyEx(renderer, iconTex, nullptr, &rect, angle, nullptr, SDL_FLIP_NONE);
-    } else {
-        SDL_RenderCopy(renderer, iconTex, nullptr, &rect);
+        // a rotated icon stays within the circle around its center
+        int diameter = (int) std::ceil(std::hypot(rect.w, rect.h)) + 2;
+        command.bounds = SDL_Rect{ rect.x + rect.w / 2 - diameter / 2, rect.y + rect.h / 2 - diameter / 2, diameter, diameter };
     }
+    command.color = color;
+    command.x = rect.x;
+    command.y = rect.y;
+    command.w = rect.w;
+    command.h = rect.h;
+    command.angle = angle;
+    command.texture = iconTex;
+    drawCommands.push_back(command);
 }
 
 int GetIconWidth(int size, Uint16 icon)
@@ -268,34 +894,17 @@ int GetIconWidth(int size, Uint16 icon)
     return (int) (((float) w / h) * size);
 }
 
-void Print(int x, int y, int size, SDL_Color color, std::string text, AlignFlags align, bool monospace)
+void Print(int x, int y, int size, SDL_Color color, const std::string& text, AlignFlags align, bool monospace)
 {
     FC_Font* font = monospace ? monospaceFont : GetFontForSize(size);
-    if (!font) {
+    const TextLayout* layout = GetTextLayout(size, text, monospace);
+    if (!font || !layout) {
         return;
     }
 
-    FC_Effect effect;
-    effect.color = color;
-
-    // scale monospace font based on size
     if (monospace) {
-        effect.scale = FC_MakeScale(size / 28.0f, size / 28.0f);
         // TODO figure out how to center this properly
         y += 5;
-    } else {
-        effect.scale = FC_MakeScale(1,1);
-    }
-
-    if (align & ALIGN_LEFT) {
-        effect.alignment = FC_ALIGN_LEFT;
-    } else if (align & ALIGN_RIGHT) {
-        effect.alignment = FC_ALIGN_RIGHT;
-    } else if (align & ALIGN_HORIZONTAL) {
-        effect.alignment = FC_ALIGN_CENTER;
-    } else {
-        // left by default
-        effect.alignment = FC_ALIGN_LEFT;
     }
 
     if (align & ALIGN_BOTTOM) {
@@ -304,35 +913,38 @@ void Print(int x, int y, int size, SDL_Color color, std::string text, AlignFlags
         y -= GetTextHeight(size, text, monospace) / 2;
     }
 
-    FC_DrawEffect(font, renderer, x, y, effect, "%s", text.c_str());
+    DrawCommand command{};
+    command.type = DrawCommand::TYPE_TEXT;
+    command.bounds = GetTextLayoutBounds(*layout, x, y, align);
+    command.color = color;
+    command.x = x;
+    command.y = y;
+    command.align = align;
+    command.font = font;
+    command.layout = layout;
+    drawCommands.push_back(command);
 }
 
-int GetTextWidth(int size, std::string text, bool monospace)
+int GetTextWidth(int size, const std::string& text, bool monospace)
 {
-    FC_Font* font = monospace ? monospaceFont : GetFontForSize(size);
-    if (!font) {
+    const TextLayout* layout = GetTextLayout(size, text, monospace);
+    if (!layout) {
         return 0;
     }
 
-    float scale = monospace ? (size / 28.0f) : 1.0f;
-
-    return FC_GetWidth(font, "%s", text.c_str()) * scale;
+    return *std::max_element(layout->lineWidths.begin(), layout->lineWidths.end());
 }
 
-int GetTextHeight(int size, std::string text, bool monospace)
+int GetTextHeight(int size, const std::string& text, bool monospace)
 {
     // TODO this doesn't work nicely with monospace yet
-    monospace = false;
-
-    FC_Font* font = monospace ? monospaceFont : GetFontForSize(size);
+    FC_Font* font = GetFontForSize(size);
     if (!font) {
         return 0;
     }
 
-    float scale = monospace ? (size / 28.0f) : 1.0f;
-
-    return FC_GetHeight(GetFontForSize(size), "%s", text.c_str()) * scale;
+    int numLines = std::count(text.begin(), text.end(), '\n') + 1;
+    return FC_GetLineHeight(font) * numLines + FC_GetLineSpacing(font) * (numLines - 1);
 }
 
 }
-
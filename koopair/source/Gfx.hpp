@@ -18,6 +18,7 @@
 
 #include <SDL.h>
 #include <string>
+#include <span>
 
 namespace Gfx
 {
@@ -63,6 +64,9 @@ void Clear(SDL_Color color);
 
 void Render();
 
+// Draws the next frame completely, instead of only the parts which changed
+void Invalidate();
+
 void DrawRectFilled(int x, int y, int w, int h, SDL_Color color);
 
 void DrawRect(int x, int y, int w, int h, int borderSize, SDL_Color color);
@@ -73,16 +77,19 @@ void DrawCircleFilled(int x, int y, int radius, SDL_Color color);
 
 void DrawCircle(int x, int y, int radius, int borderSize, SDL_Color color);
 
+// Draws a list of untextured triangles with a single draw call
+void DrawGeometry(std::span<const SDL_Vertex> vertices);
+
 void DrawIcon(int x, int y, int size, SDL_Color color, Uint16 icon, AlignFlags align = ALIGN_CENTER, double angle = 0.0);
 
 int GetIconWidth(int size, Uint16 icon);
 
 static inline int GetIconHeight(int size, Uint16 icon) { return size; }
 
-void Print(int x, int y, int size, SDL_Color color, std::string text, AlignFlags align = ALIGN_LEFT | ALIGN_TOP, bool monospace = false);
+void Print(int x, int y, int size, SDL_Color color, const std::string& text, AlignFlags align = ALIGN_LEFT | ALIGN_TOP, bool monospace = false);
 
-int GetTextWidth(int size, std::string text, bool monospace = false);
+int GetTextWidth(int size, const std::string& text, bool monospace = false);
 
-int GetTextHeight(int size, std::string text, bool monospace = false);
+int GetTextHeight(int size, const std::string& text, bool monospace = false);
 
 }
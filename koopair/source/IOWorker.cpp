@@ -0,0 +1,152 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "IOWorker.hpp"
+
+#include <deque>
+
+#include <coreinit/thread.h>
+#include <coreinit/mutex.h>
+#include <coreinit/condition.h>
+
+namespace
+{
+
+constexpr uint32_t kStackSize = 128 * 1024;
+// Lower priority than the UI thread, so it doesn't delay frames
+constexpr int32_t kThreadPriority = 20;
+
+alignas(16) OSThread workerThread;
+alignas(16) uint8_t workerStack[kStackSize];
+
+OSMutex queueMutex;
+OSCondition queueCondition;
+
+// Protected by queueMutex
+std::deque<std::shared_ptr<IOWorker::Job>> queue;
+size_t numUnfinished = 0;
+bool running = false;
+
+int WorkerMain(int argc, const char** argv)
+{
+    OSLockMutex(&queueMutex);
+    while (true) {
+        while (queue.empty() && running) {
+            OSWaitCond(&queueCondition, &queueMutex);
+        }
+
+        // Only stop once everything which was queued is done
+        if (queue.empty()) {
+            break;
+        }
+
+        std::shared_ptr<IOWorker::Job> job = std::move(queue.front());
+        queue.pop_front();
+
+        OSUnlockMutex(&queueMutex);
+        job->Run();
+        OSLockMutex(&queueMutex);
+
+        numUnfinished--;
+    }
+    OSUnlockMutex(&queueMutex);
+
+    return 0;
+}
+
+}
+
+namespace IOWorker
+{
+
+Job::Job(std::function<bool()> work)
+ : mWork(std::move(work)),
+   mSucceeded(false),
+   mDone(false)
+{
+}
+
+void Job::Run()
+{
+    mSucceeded = mWork();
+
+    // The work isn't needed anymore, free whatever it captured on this thread
+    mWork = nullptr;
+
+    mDone.store(true, std::memory_order_release);
+}
+
+bool Init()
+{
+    OSInitMutex(&queueMutex);
+    OSInitCond(&queueCondition);
+
+    if (!OSCreateThread(&workerThread, WorkerMain, 0, nullptr, workerStack + kStackSize, kStackSize, kThreadPriority, OS_THREAD_ATTRIB_AFFINITY_ANY)) {
+        return false;
+    }
+
+    OSSetThreadName(&workerThread, "Koopair IO");
+
+    running = true;
+    OSResumeThread(&workerThread);
+    return true;
+}
+
+void Shutdown()
+{
+    OSLockMutex(&queueMutex);
+    if (!running) {
+        OSUnlockMutex(&queueMutex);
+        return;
+    }
+
+    running = false;
+    OSSignalCond(&queueCondition);
+    OSUnlockMutex(&queueMutex);
+
+    int result;
+    OSJoinThread(&workerThread, &result);
+}
+
+std::shared_ptr<const Job> Submit(std::function<bool()> work)
+{
+    auto job = std::make_shared<Job>(std::move(work));
+
+    OSLockMutex(&queueMutex);
+    if (!running) {
+        OSUnlockMutex(&queueMutex);
+        job->Run();
+        return job;
+    }
+
+    queue.push_back(job);
+    numUnfinished++;
+    OSSignalCond(&queueCondition);
+    OSUnlockMutex(&queueMutex);
+
+    return job;
+}
+
+bool IsBusy()
+{
+    OSLockMutex(&queueMutex);
+    bool busy = numUnfinished != 0;
+    OSUnlockMutex(&queueMutex);
+
+    return busy;
+}
+
+}
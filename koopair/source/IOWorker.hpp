@@ -0,0 +1,65 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+// Runs slow work like SD card access and IPC calls on a background thread, so the UI keeps rendering while it's busy.
+// Jobs run one after another in the order they were submitted.
+namespace IOWorker
+{
+
+class Job {
+public:
+    Job(std::function<bool()> work);
+
+    // Called on the worker thread
+    void Run();
+
+    // Poll this from the UI thread
+    bool IsDone() const
+    {
+        return mDone.load(std::memory_order_acquire);
+    }
+
+    // Return value of the work, only valid once the job is done
+    bool Succeeded() const
+    {
+        return mSucceeded;
+    }
+
+private:
+    std::function<bool()> mWork;
+    bool mSucceeded;
+    std::atomic<bool> mDone;
+};
+
+bool Init();
+
+// Finishes all jobs which are still queued before stopping the thread
+void Shutdown();
+
+// Queues work for the worker thread, the work should only use data it owns since it runs later.
+// If the worker isn't running the work runs right away.
+std::shared_ptr<const Job> Submit(std::function<bool()> work);
+
+// Are there any jobs which haven't finished yet
+bool IsBusy();
+
+} // namespace IOWorker
@@ -15,6 +15,7 @@
  *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include "ProcUI.hpp"
+#include "Gfx.hpp"
 #include <coreinit/foreground.h>
 #include <coreinit/title.h>
 #include <proc_ui/procui.h>
@@ -87,6 +88,8 @@ bool ProcUI::IsRunning()
     if (status == PROCUI_STATUS_EXITING) {
         isRunning = false;
     } else if (status == PROCUI_STATUS_RELEASE_FOREGROUND) {
+        // The backbuffer might not survive while we're in the background
+        Gfx::Invalidate();
         ProcUIDrawDoneRelease();
     }
 
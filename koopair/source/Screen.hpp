@@ -30,7 +30,7 @@ public:
 
     virtual void Draw() = 0;
 
-    virtual bool Update(const CombinedInputController& input) = 0;
+    virtual bool Update(const CombinedInputController& input, float delta) = 0;
 
 protected:
     void DrawTopBar(const char* name);
@@ -16,16 +16,35 @@
  */
 #include "Gfx.hpp"
 #include "ProcUI.hpp"
+#include "FrameClock.hpp"
+#include "IOWorker.hpp"
+#include "DebugRecorder.hpp"
 #include "screens/MainScreen.hpp"
 #include "ControllerManager.hpp"
 
 #include <memory>
+#include <cmath>
 #include <sndcore2/core.h>
 
+namespace
+{
+
+bool HasActivity(const CombinedInputController& input)
+{
+    auto isStickActive = [](const Controller::Stick& stick) {
+        return std::fabs(stick.x) > 0.1f || std::fabs(stick.y) > 0.1f;
+    };
+
+    return input.GetButtonsHeld() || isStickActive(input.GetStickL()) || isStickActive(input.GetStickR());
+}
+
+}
+
 int main(int argc, char const* argv[])
 {
     ProcUI::Init();
     Gfx::Init();
+    IOWorker::Init();
 
     // call AXInit to stop already playing sounds
     AXInit();
@@ -37,16 +56,29 @@ int main(int argc, char const* argv[])
     std::unique_ptr<Screen> mainScreen = std::make_unique<MainScreen>();
 
     while (ProcUI::IsRunning()) {
+        FrameClock::Tick();
+
         controllerMgr.Update();
+        DebugRecorder::Update();
 
-        if (!mainScreen->Update(controllerMgr.GetCombinedController())) {
+        const CombinedInputController& input = controllerMgr.GetCombinedController();
+        if (HasActivity(input)) {
+            FrameClock::ReportActivity();
+        }
+
+        if (!mainScreen->Update(input, FrameClock::GetDelta())) {
             ProcUI::StopRunning();
         }
 
         mainScreen->Draw();
+        FrameClock::DrawOverlay();
         Gfx::Render();
     }
 
+    // Let pending saves finish, they might still need the Bloopair IPC handle owned by the main screen
+    IOWorker::Shutdown();
+    DebugRecorder::Shutdown();
+
     mainScreen.reset();
 
     controllerMgr.Finalize();
@@ -70,7 +70,7 @@ void AboutScreen::Draw()
     DrawBottomBar(nullptr, "\ue044 Exit", "\ue001 Back");
 }
 
-bool AboutScreen::Update(const CombinedInputController& input)
+bool AboutScreen::Update(const CombinedInputController& input, float delta)
 {
     if (input.GetButtonsTriggered() & Controller::BUTTON_B) {
         return false;
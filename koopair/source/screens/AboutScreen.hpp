@@ -26,7 +26,7 @@ public:
 
     void Draw();
 
-    bool Update(const CombinedInputController& input);
+    bool Update(const CombinedInputController& input, float delta);
 
 private:
     ScreenList mCreditList;
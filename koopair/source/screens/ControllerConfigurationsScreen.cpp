@@ -28,12 +28,16 @@ constexpr size_t kMaxEntriesPerPage = 6;
 ControllerConfigurationsScreen::ControllerConfigurationsScreen()
  : mMessageBox(),
    mConfigurations(),
+   mLoadedConfigurations(std::make_shared<std::vector<Configuration>>()),
+   mLoadJob(),
    mSelected(0),
    mSelectionStart(0),
    mSelectionEnd(kMaxEntriesPerPage)
 {
-    mConfigurations = Configuration::LoadAll();
-    mSelectionEnd = std::min(mConfigurations.size(), kMaxEntriesPerPage);
+    mLoadJob = IOWorker::Submit([configurations = mLoadedConfigurations]() {
+        *configurations = Configuration::LoadAll();
+        return true;
+    });
 }
 
 ControllerConfigurationsScreen::~ControllerConfigurationsScreen()
@@ -44,7 +48,9 @@ void ControllerConfigurationsScreen::Draw()
 {
     DrawTopBar("Controller Configurations");
 
-    if (!mConfigurations.empty()) {
+    if (mLoadJob) {
+        Gfx::Print(Gfx::SCREEN_WIDTH / 2, Gfx::SCREEN_HEIGHT / 2, 64, Gfx::COLOR_TEXT, "Loading configurations...", Gfx::ALIGN_CENTER);
+    } else if (!mConfigurations.empty()) {
         int drawIndex = 0;
         for (size_t i = mSelectionStart; i < mSelectionEnd; i++) {
             int yOff = 75 + drawIndex * 150;
@@ -77,7 +83,7 @@ void ControllerConfigurationsScreen::Draw()
     }
 }
 
-bool ControllerConfigurationsScreen::Update(const CombinedInputController& input)
+bool ControllerConfigurationsScreen::Update(const CombinedInputController& input, float delta)
 {
     if (mMessageBox) {
         if (!mMessageBox->Update(input)) {
@@ -91,6 +97,17 @@ bool ControllerConfigurationsScreen::Update(const CombinedInputController& input
         return false;
     }
 
+    if (mLoadJob) {
+        if (!mLoadJob->IsDone()) {
+            return true;
+        }
+
+        mConfigurations = std::move(*mLoadedConfigurations);
+        mSelectionEnd = std::min(mConfigurations.size(), kMaxEntriesPerPage);
+        mLoadedConfigurations.reset();
+        mLoadJob.reset();
+    }
+
     if (!mConfigurations.empty()) {
         if (input.GetButtonsTriggered() & Controller::BUTTON_A) {
             mMessageBox = std::make_unique<MessageBox>(
@@ -99,7 +116,11 @@ bool ControllerConfigurationsScreen::Update(const CombinedInputController& input
                 std::vector{
                     MessageBox::Option{0, "\ue001 Back", [this]() {} },
                     MessageBox::Option{0xf1f8, "Remove", [this]() {
-                        mConfigurations[mSelected].Remove();
+                        // the removal can finish in the background, the entry is gone from the list right away
+                        IOWorker::Submit([configuration = mConfigurations[mSelected]]() mutable {
+                            configuration.Remove();
+                            return true;
+                        });
                         mConfigurations.erase(mConfigurations.begin() + mSelected);
 
                         // Reset selection
@@ -113,11 +134,11 @@ bool ControllerConfigurationsScreen::Update(const CombinedInputController& input
             );
         }
 
-        if (input.GetButtonsTriggered() & Controller::BUTTON_DOWN) {
+        if (input.GetButtonsRepeated() & Controller::BUTTON_DOWN) {
             if (mSelected < mConfigurations.size() - 1) {
                 mSelected++;
             }
-        } else if (input.GetButtonsTriggered() & Controller::BUTTON_UP) {
+        } else if (input.GetButtonsRepeated() & Controller::BUTTON_UP) {
             if (mSelected > 0) {
                 mSelected--;
             }
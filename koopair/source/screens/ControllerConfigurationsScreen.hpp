@@ -18,6 +18,7 @@
 
 #include "Screen.hpp"
 #include "Configuration.hpp"
+#include "IOWorker.hpp"
 
 class MessageBox;
 
@@ -29,12 +30,15 @@ public:
 
     void Draw();
 
-    bool Update(const CombinedInputController& input);
+    bool Update(const CombinedInputController& input, float delta);
 
 private:
     std::unique_ptr<MessageBox> mMessageBox;
 
     std::vector<Configuration> mConfigurations;
+    // the configurations are loaded on the I/O worker, they're moved over once it's done
+    std::shared_ptr<std::vector<Configuration>> mLoadedConfigurations;
+    std::shared_ptr<const IOWorker::Job> mLoadJob;
 
     size_t mSelected;
     size_t mSelectionStart;
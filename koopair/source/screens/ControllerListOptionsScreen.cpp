@@ -23,13 +23,114 @@
 #include "Configuration.hpp"
 #include "ControllerManager.hpp"
 
+namespace
+{
+
+// Copy of the changes made on this screen, so the I/O worker can save and apply them while the screen keeps running
+struct PendingChanges {
+    std::array<uint8_t, 6> bda;
+    BloopairControllerType type;
+    bool applyToAll;
+    bool mappingsChanged;
+    std::vector<BloopairMappingEntry> mappings;
+    bool actionsChanged;
+    std::vector<BloopairActionEntry> actions;
+    bool commonConfigurationChanged;
+    BloopairCommonConfiguration commonConfiguration;
+    bool customConfigurationChanged;
+    ControllerOptionsScreen::CustomConfiguration customConfiguration;
+};
+
+// Applies the changes for either a bda or a controller type, and saves them to the configuration
+template <typename Target>
+bool ApplyChanges(const PendingChanges& changes, Target target, Configuration& cfg)
+{
+    bool success = true;
+
+    if (changes.mappingsChanged) {
+        success &= BloopairIPC::ApplyControllerMapping(target, changes.mappings.data(), changes.mappings.size());
+        cfg.SetMappings(changes.mappings);
+    }
+    if (changes.actionsChanged) {
+        success &= BloopairIPC::ApplyControllerActions(target, changes.actions.data(), changes.actions.size());
+        cfg.SetActions(changes.actions);
+    }
+    if (changes.commonConfigurationChanged) {
+        success &= BloopairIPC::ApplyConfiguration(target, changes.commonConfiguration);
+        cfg.SetCommonConfiguration(changes.commonConfiguration);
+    }
+    if (changes.customConfigurationChanged) {
+        const ControllerOptionsScreen::CustomConfiguration& custom = changes.customConfiguration;
+        switch (changes.type) {
+            case BLOOPAIR_CONTROLLER_DUALSENSE:
+                success &= BloopairIPC::ApplyCustomConfiguration(target, custom.dualsense);
+                cfg.SetCustomConfiguraion(custom.dualsense);
+                break;
+            case BLOOPAIR_CONTROLLER_DUALSHOCK3:
+                success &= BloopairIPC::ApplyCustomConfiguration(target, custom.dualshock3);
+                cfg.SetCustomConfiguraion(custom.dualshock3);
+                break;
+            case BLOOPAIR_CONTROLLER_DUALSHOCK4:
+                success &= BloopairIPC::ApplyCustomConfiguration(target, custom.dualshock4);
+                cfg.SetCustomConfiguraion(custom.dualshock4);
+                break;
+            case BLOOPAIR_CONTROLLER_SWITCH_GENERIC:
+            case BLOOPAIR_CONTROLLER_SWITCH_JOYCON_LEFT:
+            case BLOOPAIR_CONTROLLER_SWITCH_JOYCON_RIGHT:
+            case BLOOPAIR_CONTROLLER_SWITCH_JOYCON_DUAL:
+            case BLOOPAIR_CONTROLLER_SWITCH_PRO:
+            case BLOOPAIR_CONTROLLER_SWITCH_N64:
+                success &= BloopairIPC::ApplyCustomConfiguration(target, custom.switch_);
+                cfg.SetCustomConfiguraion(custom.switch_);
+                break;
+            case BLOOPAIR_CONTROLLER_XBOX_ONE:
+                success &= BloopairIPC::ApplyCustomConfiguration(target, custom.xboxOne);
+                cfg.SetCustomConfiguraion(custom.xboxOne);
+                break;
+            default: break;
+        }
+    }
+
+    return cfg.Save() && success;
+}
+
+// Runs on the I/O worker
+bool SaveAndApply(const PendingChanges& changes)
+{
+    // Loading the existing configuration reads from the SD card, so this happens here as well
+    Configuration cfg(changes.bda.data(), changes.type);
+    bool success = ApplyChanges(changes, changes.bda.data(), cfg);
+
+    if (changes.applyToAll) {
+        Configuration typeCfg(changes.type);
+        success = ApplyChanges(changes, changes.type, typeCfg) && success;
+    }
+
+    return success;
+}
+
+// Runs on the I/O worker
+bool Reset(const std::array<uint8_t, 6>& bda)
+{
+    bool success = BloopairIPC::ClearConfiguration(bda.data());
+    success &= BloopairIPC::ApplyControllerMapping(bda.data(), nullptr, 0);
+    success &= BloopairIPC::ApplyControllerActions(bda.data(), nullptr, 0);
+    success &= BloopairIPC::ClearCustomConfiguration(bda.data());
+
+    Configuration::Remove(bda.data());
+
+    return success;
+}
+
+}
+
 ControllerListOptionsScreen::ControllerListOptionsScreen(const KPADController* controller)
  :  mController(controller),
     mSubscreen(),
     mMessageBox(),
     mEntries({
         { OPTION_ID_TEST,       { 0xf11b, "Test Controller" }},
-        { OPTION_ID_MAPPING,    { 0xf074, "Edit Controller Mapping" }},
+        { OPTION_ID_MAPPING,    { 0xf074, "Edit Controller Mapping and Actions" }},
         { OPTION_ID_OPTIONS,    { 0xf013, "Edit Controller Options" }},
         { OPTION_ID_SAVE_APPLY, { 0xf00c, "Save and Apply Changes" }},
         { OPTION_ID_RESET,      { 0xf1f8, "Reset to Defaults" }},
@@ -38,6 +139,8 @@ ControllerListOptionsScreen::ControllerListOptionsScreen(const KPADController* c
     mSelected(OPTION_ID_MIN),
     mMappingsChanged(false),
     mMappings(),
+    mActionsChanged(false),
+    mActions(),
     mCommonConfigurationChanged(false),
     mCommonConfiguration(),
     mCustomConfigurationChanged(false),
@@ -65,6 +168,14 @@ ControllerListOptionsScreen::ControllerListOptionsScreen(const KPADController* c
             }
         }
 
+        uint8_t numActions;
+        if (BloopairIPC::GetControllerActions(mController->GetChannel(), nullptr, &numActions)) {
+            mActions.resize(numActions);
+            if (!BloopairIPC::GetControllerActions(mController->GetChannel(), mActions.data(), &numActions)) {
+                mActions.clear();
+            }
+        }
+
         // TODO error handling
         BloopairIPC::GetConfiguration(mController->GetChannel(), mCommonConfiguration);
 
@@ -144,10 +255,31 @@ void ControllerListOptionsScreen::Draw()
     }
 }
 
-bool ControllerListOptionsScreen::Update(const CombinedInputController& input)
+bool ControllerListOptionsScreen::Update(const CombinedInputController& input, float delta)
 {
-    // Back out if the controller disconnects
-    if (!mController->IsConnected()) {
+    // Keep showing the overlay until the I/O worker is done, the controller is already disconnected at this point
+    if (mJob) {
+        if (!mJob->IsDone()) {
+            return true;
+        }
+
+        if (!mJob->Succeeded()) {
+            mMessageBox = std::make_unique<MessageBox>(
+                "Error",
+                mIsResetting ? "Failed to reset the controller to defaults." : "Failed to save and apply the changes.",
+                std::vector{
+                    MessageBox::Option{0, "\ue001 Back", [this]() {} },
+                }
+            );
+        }
+
+        mJob.reset();
+        mIsApplying = false;
+        mIsResetting = false;
+    }
+
+    // Back out if the controller disconnects, once any error has been shown
+    if (!mController->IsConnected() && !mMessageBox) {
         return false;
     }
 
@@ -156,12 +288,14 @@ bool ControllerListOptionsScreen::Update(const CombinedInputController& input)
     }
 
     if (mSubscreen) {
-        if (!mSubscreen->Update(input)) {
+        if (!mSubscreen->Update(input, delta)) {
             if (mSelected == OPTION_ID_MAPPING) {
                 ControllerMappingScreen* mappingScreen = static_cast<ControllerMappingScreen*>(mSubscreen.get());
 
                 mMappings = mappingScreen->GetMappings();
                 mMappingsChanged = mMappingsChanged || mappingScreen->GetMappingsChanged();
+                mActions = mappingScreen->GetActions();
+                mActionsChanged = mActionsChanged || mappingScreen->GetActionsChanged();
             } else if (mSelected == OPTION_ID_OPTIONS) {
                 ControllerOptionsScreen* optionsScreen = static_cast<ControllerOptionsScreen*>(mSubscreen.get());
 
@@ -171,7 +305,7 @@ bool ControllerListOptionsScreen::Update(const CombinedInputController& input)
                 mCustomConfigurationChanged = mCustomConfigurationChanged || optionsScreen->GetCustomChanged();
             }
 
-            mEntries[OPTION_ID_SAVE_APPLY].visible = mMappingsChanged || mCommonConfigurationChanged || mCustomConfigurationChanged;
+            mEntries[OPTION_ID_SAVE_APPLY].visible = mMappingsChanged || mActionsChanged || mCommonConfigurationChanged || mCustomConfigurationChanged;
             mSubscreen.reset();
         }
         return true;
@@ -202,7 +336,7 @@ bool ControllerListOptionsScreen::Update(const CombinedInputController& input)
         }
     }
 
-    if (input.GetButtonsTriggered() & Controller::BUTTON_DOWN) {
+    if (input.GetButtonsRepeated() & Controller::BUTTON_DOWN) {
         if (mSelected != OPTION_ID_MAX) {
             for (OptionID id = static_cast<OptionID>(mSelected + 1); id <= OPTION_ID_MAX; id = static_cast<OptionID>(id + 1)) {
                 if (mEntries[id].visible) {
@@ -211,7 +345,7 @@ bool ControllerListOptionsScreen::Update(const CombinedInputController& input)
                 }
             }
         }
-    } else if (input.GetButtonsTriggered() & Controller::BUTTON_UP) {
+    } else if (input.GetButtonsRepeated() & Controller::BUTTON_UP) {
         if (mSelected != OPTION_ID_MIN) {
             for (OptionID id = static_cast<OptionID>(mSelected - 1); id >= OPTION_ID_MIN; id = static_cast<OptionID>(id - 1)) {
                 if (mEntries[id].visible) {
@@ -223,17 +357,13 @@ bool ControllerListOptionsScreen::Update(const CombinedInputController& input)
     }
 
     if (mIsApplying) {
-        if (mApplyToAll) {
-            SaveAndApplyAll();
-        } else {
-            SaveAndApply();
-        }
-        mIsApplying = false;
+        StartSaveAndApply();
+        return true;
     }
 
     if (mIsResetting) {
-        Reset();
-        mIsResetting = false;
+        StartReset();
+        return true;
     }
 
     if (input.GetButtonsTriggered() & Controller::BUTTON_A) {
@@ -242,7 +372,7 @@ bool ControllerListOptionsScreen::Update(const CombinedInputController& input)
             mSubscreen = std::make_unique<ControllerTestScreen>(mController);
             break;
         case OPTION_ID_MAPPING:
-            mSubscreen = std::make_unique<ControllerMappingScreen>(mController, mMappings);
+            mSubscreen = std::make_unique<ControllerMappingScreen>(mController, mMappings, mActions);
             break;
         case OPTION_ID_OPTIONS:
             mSubscreen = std::make_unique<ControllerOptionsScreen>(mController, mCommonConfiguration, mCustomConfiguration);
@@ -269,7 +399,7 @@ bool ControllerListOptionsScreen::Update(const CombinedInputController& input)
         case OPTION_ID_RESET:
             mMessageBox = std::make_unique<MessageBox>(
                 "Are you sure?",
-                "This will reset the options and mappings for the current controller\n"
+                "This will reset the options, mappings and actions for the current controller\n"
                 "to the defaults.\n\n"
                 "The controller will be disconnected from the system\nand needs to be turned on again.",
                 std::vector{
@@ -298,64 +428,25 @@ bool ControllerListOptionsScreen::Update(const CombinedInputController& input)
     return true;
 }
 
-void ControllerListOptionsScreen::SaveAndApply()
+void ControllerListOptionsScreen::StartSaveAndApply()
 {
-    auto bda = mController->GetBDA();
+    PendingChanges changes{
+        mController->GetBDA(),
+        mController->GetControllerType(),
+        mApplyToAll,
+        mMappingsChanged,
+        mMappings,
+        mActionsChanged,
+        mActions,
+        mCommonConfigurationChanged,
+        mCommonConfiguration,
+        mCustomConfigurationChanged,
+        mCustomConfiguration,
+    };
 
     // Not disconnecting the controller before applying a mapping is undefined behaviour, since Bloopair needs to redo the init sequence
     mController->Disconnect();
 
-    Configuration cfg(bda.data(), mController->GetControllerType());
-
-    if (mMappingsChanged) {
-        BloopairIPC::ApplyControllerMapping(bda.data(), mMappings.data(), mMappings.size());
-        cfg.SetMappings(mMappings);
-    }
-    if (mCommonConfigurationChanged) {
-        BloopairIPC::ApplyConfiguration(bda.data(), mCommonConfiguration);
-        cfg.SetCommonConfiguration(mCommonConfiguration);
-    }
-    if (mCustomConfigurationChanged) {
-        switch (mController->GetControllerType()) {
-            case BLOOPAIR_CONTROLLER_DUALSENSE:
-                BloopairIPC::ApplyCustomConfiguration(bda.data(), mCustomConfiguration.dualsense);
-                cfg.SetCustomConfiguraion(mCustomConfiguration.dualsense);
-                break;
-            case BLOOPAIR_CONTROLLER_DUALSHOCK3:
-                BloopairIPC::ApplyCustomConfiguration(bda.data(), mCustomConfiguration.dualshock3);
-                cfg.SetCustomConfiguraion(mCustomConfiguration.dualshock3);
-                break;
-            case BLOOPAIR_CONTROLLER_DUALSHOCK4:
-                BloopairIPC::ApplyCustomConfiguration(bda.data(), mCustomConfiguration.dualshock4);
-                cfg.SetCustomConfiguraion(mCustomConfiguration.dualshock4);
-                break;
-            case BLOOPAIR_CONTROLLER_SWITCH_GENERIC:
-            case BLOOPAIR_CONTROLLER_SWITCH_JOYCON_LEFT:
-            case BLOOPAIR_CONTROLLER_SWITCH_JOYCON_RIGHT:
-            case BLOOPAIR_CONTROLLER_SWITCH_JOYCON_DUAL:
-            case BLOOPAIR_CONTROLLER_SWITCH_PRO:
-            case BLOOPAIR_CONTROLLER_SWITCH_N64:
-                BloopairIPC::ApplyCustomConfiguration(bda.data(), mCustomConfiguration.switch_);
-                cfg.SetCustomConfiguraion(mCustomConfiguration.switch_);
-                break;
-            case BLOOPAIR_CONTROLLER_XBOX_ONE:
-                BloopairIPC::ApplyCustomConfiguration(bda.data(), mCustomConfiguration.xboxOne);
-                cfg.SetCustomConfiguraion(mCustomConfiguration.xboxOne);
-                break;
-            default: break;
-        }
-    }
-    cfg.Save();
-}
-
-void ControllerListOptionsScreen::SaveAndApplyAll()
-{
-    BloopairControllerType type = mController->GetControllerType();
-
-    // Let's apply to the current controller too
-    SaveAndApply();
-
-    // Not disconnecting controllers before applying a mapping is undefined behaviour, since Bloopair needs to redo the init sequence
     // If we apply to all controllers of a type just disconnect all controllers
     if (mApplyToAll) {
         for (size_t i = 0; i < 0; i++) {
@@ -368,60 +459,19 @@ void ControllerListOptionsScreen::SaveAndApplyAll()
         }
     }
 
-    Configuration cfg(type);
-
-    if (mMappingsChanged) {
-        BloopairIPC::ApplyControllerMapping(type, mMappings.data(), mMappings.size());
-        cfg.SetMappings(mMappings);
-    }
-    if (mCommonConfigurationChanged) {
-        BloopairIPC::ApplyConfiguration(type, mCommonConfiguration);
-        cfg.SetCommonConfiguration(mCommonConfiguration);
-    }
-    if (mCustomConfigurationChanged) {
-        switch (mController->GetControllerType()) {
-            case BLOOPAIR_CONTROLLER_DUALSENSE:
-                BloopairIPC::ApplyCustomConfiguration(type, mCustomConfiguration.dualsense);
-                cfg.SetCustomConfiguraion(mCustomConfiguration.dualsense);
-                break;
-            case BLOOPAIR_CONTROLLER_DUALSHOCK3:
-                BloopairIPC::ApplyCustomConfiguration(type, mCustomConfiguration.dualshock3);
-                cfg.SetCustomConfiguraion(mCustomConfiguration.dualshock3);
-                break;
-            case BLOOPAIR_CONTROLLER_DUALSHOCK4:
-                BloopairIPC::ApplyCustomConfiguration(type, mCustomConfiguration.dualshock4);
-                cfg.SetCustomConfiguraion(mCustomConfiguration.dualshock4);
-                break;
-            case BLOOPAIR_CONTROLLER_SWITCH_GENERIC:
-            case BLOOPAIR_CONTROLLER_SWITCH_JOYCON_LEFT:
-            case BLOOPAIR_CONTROLLER_SWITCH_JOYCON_RIGHT:
-            case BLOOPAIR_CONTROLLER_SWITCH_JOYCON_DUAL:
-            case BLOOPAIR_CONTROLLER_SWITCH_PRO:
-            case BLOOPAIR_CONTROLLER_SWITCH_N64:
-                BloopairIPC::ApplyCustomConfiguration(type, mCustomConfiguration.switch_);
-                cfg.SetCustomConfiguraion(mCustomConfiguration.switch_);
-                break;
-            case BLOOPAIR_CONTROLLER_XBOX_ONE:
-                BloopairIPC::ApplyCustomConfiguration(type, mCustomConfiguration.xboxOne);
-                cfg.SetCustomConfiguraion(mCustomConfiguration.xboxOne);
-                break;
-            default: break;
-        }
-    }
-    cfg.Save();
+    mJob = IOWorker::Submit([changes = std::move(changes)]() {
+        return SaveAndApply(changes);
+    });
 }
 
-void ControllerListOptionsScreen::Reset()
+void ControllerListOptionsScreen::StartReset()
 {
     auto bda = mController->GetBDA();
 
     // Not disconnecting the controller before applying a mapping is undefined behaviour, since Bloopair needs to redo the init sequence
     mController->Disconnect();
 
-    // TODO error handling
-    BloopairIPC::ClearConfiguration(bda.data());
-    BloopairIPC::ApplyControllerMapping(bda.data(), nullptr, 0);
-    BloopairIPC::ClearCustomConfiguration(bda.data());
-
-    Configuration::Remove(bda.data());
+    mJob = IOWorker::Submit([bda]() {
+        return Reset(bda);
+    });
 }
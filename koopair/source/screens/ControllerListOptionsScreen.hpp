@@ -22,6 +22,7 @@
 
 #include "Screen.hpp"
 #include "ControllerOptionsScreen.hpp"
+#include "IOWorker.hpp"
 
 class MessageBox;
 
@@ -33,12 +34,11 @@ public:
 
     void Draw();
 
-    bool Update(const CombinedInputController& input);
+    bool Update(const CombinedInputController& input, float delta);
 
 private:
-    void SaveAndApply();
-    void SaveAndApplyAll();
-    void Reset();
+    void StartSaveAndApply();
+    void StartReset();
 
     const KPADController* mController;
     std::unique_ptr<Screen> mSubscreen;
@@ -66,6 +66,8 @@ private:
 
     bool mMappingsChanged;
     std::vector<BloopairMappingEntry> mMappings;
+    bool mActionsChanged;
+    std::vector<BloopairActionEntry> mActions;
     bool mCommonConfigurationChanged;
     BloopairCommonConfiguration mCommonConfiguration;
     bool mCustomConfigurationChanged;
@@ -74,6 +76,8 @@ private:
     bool mIsApplying;
     bool mApplyToAll;
     bool mIsResetting;
+    // saving, applying or resetting which is running on the I/O worker
+    std::shared_ptr<const IOWorker::Job> mJob;
 
     bool mDiscard;
 };
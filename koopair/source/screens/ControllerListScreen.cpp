@@ -20,6 +20,8 @@
 
 ControllerListScreen::ControllerListScreen()
  : mControllers(),
+   mControllerCount(0),
+   mConnectedMask(0),
    mSelected(0)
 {
 }
@@ -37,20 +39,19 @@ void ControllerListScreen::Draw()
 
     DrawTopBar("Controller List");
 
-    const size_t controllerCount = mControllers.size();
+    const size_t controllerCount = mControllerCount;
     if (controllerCount) {
-        uint32_t cnt = 0;
-        for (const auto& [chan, name] : mControllers) {
+        ControllerManager& controllerMgr = ControllerManager::Get();
+
+        for (uint32_t cnt = 0; cnt < controllerCount; cnt++) {
             int yOff = 75 + cnt * 150;
             Gfx::DrawRectFilled(0, yOff, Gfx::SCREEN_WIDTH, 150, Gfx::COLOR_ALT_BACKGROUND);
             Gfx::DrawIcon(68, yOff + 150 / 2, 60, Gfx::COLOR_TEXT, 0xf11b);
-            Gfx::Print(128 + 8, yOff + 150 / 2, 60, Gfx::COLOR_TEXT, name, Gfx::ALIGN_VERTICAL);
+            Gfx::Print(128 + 8, yOff + 150 / 2, 60, Gfx::COLOR_TEXT, controllerMgr.GetKPADController(mControllers[cnt]).GetName(), Gfx::ALIGN_VERTICAL);
 
             if (cnt == mSelected) {
                 Gfx::DrawRect(0, yOff, Gfx::SCREEN_WIDTH, 150, 8, Gfx::COLOR_HIGHLIGHTED);
             }
-
-            cnt++;
         }
     } else {
         Gfx::Print(Gfx::SCREEN_WIDTH / 2, Gfx::SCREEN_HEIGHT / 2, 64, Gfx::COLOR_TEXT, "No controllers connected", Gfx::ALIGN_CENTER);
@@ -59,10 +60,10 @@ void ControllerListScreen::Draw()
     DrawBottomBar(controllerCount ? "\ue07d Navigate" : nullptr, "\ue044 Exit", controllerCount ? "\ue000 Select / \ue001 Back" : "\ue001 Back");
 }
 
-bool ControllerListScreen::Update(const CombinedInputController& input)
+bool ControllerListScreen::Update(const CombinedInputController& input, float delta)
 {
     if (mControllerOptionsScreen) {
-        if (!mControllerOptionsScreen->Update(input)) {
+        if (!mControllerOptionsScreen->Update(input, delta)) {
             mControllerOptionsScreen.reset();
         }
         return true;
@@ -70,17 +71,21 @@ bool ControllerListScreen::Update(const CombinedInputController& input)
 
     ControllerManager& controllerMgr = ControllerManager::Get();
 
-    mControllers.clear();
-    for (size_t i = 0; i < ControllerManager::kMaxKPADControllers; i++) {
-        const KPADController& controller = controllerMgr.GetKPADController(i);
-        if (!controller.IsConnected() || controller.GetExtensionType() != WPAD_EXT_PRO_CONTROLLER) {
-            continue;
-        }
+    if (mConnectedMask != controllerMgr.GetConnectedKPADMask()) {
+        mConnectedMask = controllerMgr.GetConnectedKPADMask();
 
-        mControllers.emplace_back(controller.GetChannel(), controller.GetName());
+        mControllerCount = 0;
+        for (size_t i = 0; i < ControllerManager::kMaxKPADControllers; i++) {
+            const KPADController& controller = controllerMgr.GetKPADController(i);
+            if (!controller.IsConnected() || controller.GetExtensionType() != WPAD_EXT_PRO_CONTROLLER) {
+                continue;
+            }
+
+            mControllers[mControllerCount++] = controller.GetChannel();
+        }
     }
 
-    const size_t controllerCount = mControllers.size();
+    const size_t controllerCount = mControllerCount;
 
     // Make sure the controller still points at a valid index
     if (controllerCount > 0 && mSelected >= controllerCount) {
@@ -93,15 +98,15 @@ bool ControllerListScreen::Update(const CombinedInputController& input)
 
     if (input.GetButtonsTriggered() & Controller::BUTTON_A) {
         if (controllerCount > 0) {
-            mControllerOptionsScreen = std::make_unique<ControllerListOptionsScreen>(&controllerMgr.GetKPADController(mControllers[mSelected].first));
+            mControllerOptionsScreen = std::make_unique<ControllerListOptionsScreen>(&controllerMgr.GetKPADController(mControllers[mSelected]));
         }
     }
 
-    if (input.GetButtonsTriggered() & Controller::BUTTON_DOWN) {
+    if (input.GetButtonsRepeated() & Controller::BUTTON_DOWN) {
         if (controllerCount > 0 && mSelected < controllerCount - 1) {
             mSelected++;
         }
-    } else if (input.GetButtonsTriggered() & Controller::BUTTON_UP) {
+    } else if (input.GetButtonsRepeated() & Controller::BUTTON_UP) {
         if (mSelected > 0) {
             mSelected--;
         }
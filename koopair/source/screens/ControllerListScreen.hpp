@@ -17,9 +17,7 @@
 #pragma once
 
 #include <memory>
-#include <vector>
-#include <string>
-#include <utility>
+#include <array>
 
 #include "Screen.hpp"
 #include "ControllerManager.hpp"
@@ -35,10 +33,13 @@ public:
 
     void Draw();
 
-    bool Update(const CombinedInputController& input);
+    bool Update(const CombinedInputController& input, float delta);
 
 private:
-    std::vector<std::pair<KPADChan, std::string>> mControllers;
+    // Only rebuilt when controllers connect or disconnect
+    std::array<KPADChan, ControllerManager::kMaxKPADControllers> mControllers;
+    size_t mControllerCount;
+    uint32_t mConnectedMask;
     uint32_t mSelected;
 
     std::unique_ptr<Screen> mControllerOptionsScreen;
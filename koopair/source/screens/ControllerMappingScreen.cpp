@@ -23,6 +23,7 @@
 #include <bloopair/controllers/dualsense_controller.h>
 #include <bloopair/controllers/dualshock3_controller.h>
 #include <bloopair/controllers/dualshock4_controller.h>
+#include <bloopair/controllers/generic_controller.h>
 #include <bloopair/controllers/switch_controller.h>
 #include <bloopair/controllers/xbox_one_controller.h>
 
@@ -31,6 +32,36 @@ namespace
 
 constexpr size_t kMaxEntriesPerPage = 6;
 
+// Turbo rate in presses per second, the same range as the loader accepts
+constexpr uint8_t kMinTurboRate = 1;
+constexpr uint8_t kMaxTurboRate = 50;
+constexpr uint8_t kDefaultTurboRate = 10;
+
+// Sequence step duration in 10ms ticks
+constexpr uint8_t kDefaultStepDuration = 10;
+
+const char* GetActionTypeName(uint8_t type)
+{
+    switch (type) {
+        case BLOOPAIR_ACTION_TURBO: return "Turbo";
+        case BLOOPAIR_ACTION_TOGGLE: return "Toggle";
+        case BLOOPAIR_ACTION_CHORD: return "Chord";
+        case BLOOPAIR_ACTION_SEQUENCE: return "Sequence";
+        case BLOOPAIR_ACTION_SEQUENCE_STEP: return "Step";
+        default: return "Unknown";
+    }
+}
+
+// Index of the sequence a step belongs to
+size_t FindSequence(const std::vector<BloopairActionEntry>& actions, size_t index)
+{
+    while (index > 0 && actions[index].type == BLOOPAIR_ACTION_SEQUENCE_STEP) {
+        index--;
+    }
+
+    return index;
+}
+
 // TODO split this up
 std::string GetButtonName(BloopairControllerType type, uint8_t button)
 {
@@ -184,6 +215,19 @@ std::string GetButtonName(BloopairControllerType type, uint8_t button)
                 case XBOX_ONE_TRIGGER_L: return "Trigger (L)";
             }
             break;
+        case BLOOPAIR_CONTROLLER_GENERIC_HID:
+            switch (button) {
+                case GENERIC_BUTTON_UP: return "\ue079";
+                case GENERIC_BUTTON_DOWN: return "\ue07a";
+                case GENERIC_BUTTON_LEFT: return "\ue07b";
+                case GENERIC_BUTTON_RIGHT: return "\ue07c";
+                default:
+                    if (button <= GENERIC_BUTTON_16) {
+                        return "Button " + std::to_string(button - GENERIC_BUTTON_1 + 1);
+                    }
+                    break;
+            }
+            break;
         default: break;
     }
 
@@ -192,7 +236,7 @@ std::string GetButtonName(BloopairControllerType type, uint8_t button)
 
 }
 
-ControllerMappingScreen::ControllerMappingScreen(const KPADController* controller, const std::vector<BloopairMappingEntry>& mappings)
+ControllerMappingScreen::ControllerMappingScreen(const KPADController* controller, const std::vector<BloopairMappingEntry>& mappings, const std::vector<BloopairActionEntry>& actions)
  : mController(controller),
    mMappableButtons({
        { BLOOPAIR_PRO_BUTTON_A, "\ue000" },
@@ -226,6 +270,12 @@ ControllerMappingScreen::ControllerMappingScreen(const KPADController* controlle
    mMappingState(MAPPING_STATE_NONE),
    mOldButtons(0),
    mMappingsChanged(false),
+   mAccumulating(false),
+   mPage(PAGE_MAPPINGS),
+   mActions(actions),
+   mActionState(ACTION_STATE_NONE),
+   mHeldButtons(0),
+   mActionsChanged(false),
    mSelected(0),
    mSelectionStart(0),
    mSelectionEnd(kMaxEntriesPerPage)
@@ -240,10 +290,20 @@ ControllerMappingScreen::ControllerMappingScreen(const KPADController* controlle
 
 ControllerMappingScreen::~ControllerMappingScreen()
 {
+    StopReading();
     ProcUI::SetHomeButtonMenuEnabled(true);
 }
 
 void ControllerMappingScreen::Draw()
+{
+    if (mPage == PAGE_ACTIONS) {
+        DrawActions();
+    } else {
+        DrawMappings();
+    }
+}
+
+void ControllerMappingScreen::DrawMappings()
 {
     DrawTopBar("Controller Mapping");
 
@@ -281,7 +341,7 @@ void ControllerMappingScreen::Draw()
         Gfx::Print(Gfx::SCREEN_WIDTH / 2, 100, 60, Gfx::COLOR_ACCENT, "\ufe3d", Gfx::ALIGN_CENTER);
     }
 
-    DrawBottomBar("\ue07d Navigate", "\ue001 Back", "\ue002 Clear / \ue000 Add");
+    DrawBottomBar("\ue07d Navigate / \ue083\ue084 Actions", "\ue001 Back", "\ue002 Clear / \ue000 Add");
 
     if (mMappingState != MAPPING_STATE_NONE) {
         Gfx::DrawRectFilled(0, 0, Gfx::SCREEN_WIDTH, Gfx::SCREEN_WIDTH, { 0, 0, 0, 0xa0 });
@@ -289,17 +349,157 @@ void ControllerMappingScreen::Draw()
     }
 }
 
-bool ControllerMappingScreen::Update(const CombinedInputController& input)
+void ControllerMappingScreen::DrawActions()
 {
-    if (mMappingState == MAPPING_STATE_NONE) {
+    DrawTopBar("Controller Actions");
+
+    auto ButtonsToString = ([&](uint32_t buttons) {
+        std::string str;
+        for (const auto& [button, name] : mMappableButtons) {
+            if (button < BLOOPAIR_PRO_STICK_MIN && (buttons & BTN(button))) {
+                str += std::string(name) + "+";
+            }
+        }
+
+        // Remove the trailing plus
+        if (!str.empty()) {
+            str.pop_back();
+        } else {
+            str = "-";
+        }
+
+        return str;
+    });
+
+    // The last row adds a new action
+    size_t numRows = mActions.size() + 1;
+
+    int drawIndex = 0;
+    for (size_t i = mSelectionStart; i < std::min(mSelectionEnd, numRows); i++) {
+        int yOff = 75 + drawIndex * 150;
+        Gfx::DrawRectFilled(0, yOff, Gfx::SCREEN_WIDTH, 150, Gfx::COLOR_ALT_BACKGROUND);
+
+        if (i == mActions.size()) {
+            Gfx::Print(Gfx::SCREEN_WIDTH / 2, yOff + 150 / 2, 60, Gfx::COLOR_TEXT, "Add Action", Gfx::ALIGN_CENTER);
+        } else {
+            const BloopairActionEntry& a = mActions[i];
+            bool isStep = a.type == BLOOPAIR_ACTION_SEQUENCE_STEP;
+
+            // Steps are indented below their sequence
+            int xOff = isStep ? 64 : 0;
+            Gfx::DrawRectFilled(xOff, yOff, 250 - 8, 150, Gfx::COLOR_GRAY);
+            Gfx::Print(xOff + 250 / 2, yOff + 150 / 2, 50, Gfx::COLOR_TEXT, GetActionTypeName(a.type), Gfx::ALIGN_CENTER);
+
+            std::string str;
+            switch (a.type) {
+                case BLOOPAIR_ACTION_TURBO:
+                    str = ButtonsToString(a.trigger) + ": " + ButtonsToString(a.buttons) + " (" + std::to_string(a.param) + "/s)";
+                    break;
+                case BLOOPAIR_ACTION_SEQUENCE:
+                    str = ButtonsToString(a.trigger) + ": " + std::to_string(a.param) + (a.param == 1 ? " step" : " steps");
+                    break;
+                case BLOOPAIR_ACTION_SEQUENCE_STEP:
+                    str = ButtonsToString(a.buttons) + " (" + std::to_string(a.param * 10) + "ms)";
+                    break;
+                default:
+                    str = ButtonsToString(a.trigger) + ": " + ButtonsToString(a.buttons);
+                    break;
+            }
+
+            Gfx::Print(xOff + 275, yOff + 150 / 2, 60, Gfx::COLOR_TEXT, str, Gfx::ALIGN_VERTICAL);
+        }
+
+        if (i == mSelected) {
+            Gfx::DrawRect(0, yOff, Gfx::SCREEN_WIDTH, 150, 8, Gfx::COLOR_HIGHLIGHTED);
+        }
+
+        drawIndex++;
+    }
+
+    // Draw scroll indicators
+    if (mSelectionEnd < numRows) {
+        Gfx::Print(Gfx::SCREEN_WIDTH / 2, Gfx::SCREEN_HEIGHT - 100, 60, Gfx::COLOR_ACCENT, "\ufe3e", Gfx::ALIGN_CENTER);
+    }
+    if (mSelectionStart > 0) {
+        Gfx::Print(Gfx::SCREEN_WIDTH / 2, 100, 60, Gfx::COLOR_ACCENT, "\ufe3d", Gfx::ALIGN_CENTER);
+    }
+
+    const char* hint = "\ue000 Add";
+    if (mSelected < mActions.size()) {
+        switch (mActions[mSelected].type) {
+            case BLOOPAIR_ACTION_TURBO:
+                hint = "\ue07e Rate / \ue003 Type / \ue002 Remove / \ue000 Edit";
+                break;
+            case BLOOPAIR_ACTION_SEQUENCE:
+                hint = "\ue045 Add Step / \ue003 Type / \ue002 Remove / \ue000 Edit";
+                break;
+            case BLOOPAIR_ACTION_SEQUENCE_STEP:
+                hint = "\ue07e Duration / \ue045 Add Step / \ue002 Remove / \ue000 Edit";
+                break;
+            default:
+                hint = "\ue003 Type / \ue002 Remove / \ue000 Edit";
+                break;
+        }
+    }
+
+    DrawBottomBar("\ue07d Navigate / \ue083\ue084 Mapping", "\ue001 Back", hint);
+
+    if (mActionState != ACTION_STATE_NONE) {
+        const char* text = "Release all buttons...";
+        if (mActionState == ACTION_STATE_WAIT_TRIGGER) {
+            text = "Hold the buttons which start the action...";
+        } else if (mActionState == ACTION_STATE_WAIT_BUTTONS) {
+            text = "Hold the buttons the action presses...";
+        }
+
+        Gfx::DrawRectFilled(0, 0, Gfx::SCREEN_WIDTH, Gfx::SCREEN_WIDTH, { 0, 0, 0, 0xa0 });
+        Gfx::Print(Gfx::SCREEN_WIDTH / 2, Gfx::SCREEN_HEIGHT / 2, 64, Gfx::COLOR_TEXT, text, Gfx::ALIGN_CENTER);
+    }
+}
+
+bool ControllerMappingScreen::Update(const CombinedInputController& input, float delta)
+{
+    if (mMappingState == MAPPING_STATE_NONE && mActionState == ACTION_STATE_NONE) {
         if (input.GetButtonsTriggered() & Controller::BUTTON_B) {
             return false;
         }
 
+        if (input.GetButtonsTriggered() & (Controller::BUTTON_L | Controller::BUTTON_R)) {
+            mPage = (mPage == PAGE_MAPPINGS) ? PAGE_ACTIONS : PAGE_MAPPINGS;
+            mSelected = 0;
+            mSelectionStart = 0;
+            mSelectionEnd = kMaxEntriesPerPage;
+            return true;
+        }
+    }
+
+    if (mPage == PAGE_ACTIONS) {
+        UpdateActions(input);
+    } else {
+        UpdateMappings(input);
+    }
+
+    if (mMappingState == MAPPING_STATE_NONE && mActionState == ACTION_STATE_NONE) {
+        StopReading();
+    }
+
+    if (mSelected >= mSelectionEnd) {
+        mSelectionEnd = mSelected + 1;
+        mSelectionStart = mSelectionEnd - kMaxEntriesPerPage;
+    } else if (mSelected < mSelectionStart) {
+        mSelectionStart = mSelected;
+        mSelectionEnd = mSelectionStart + kMaxEntriesPerPage;
+    }
+
+    return true;
+}
+
+void ControllerMappingScreen::UpdateMappings(const CombinedInputController& input)
+{
+    if (mMappingState == MAPPING_STATE_NONE) {
         if (input.GetButtonsTriggered() & Controller::BUTTON_A) {
-            BloopairReportBuffer report{};
-            BloopairIPC::ReadRawReport(mController->GetChannel(), report);
-            
+            BloopairReportBuffer report = ReadReport();
+
             mOldButtons = report.buttons;
             mMappingState = MAPPING_STATE_WAIT_RELEASE;
         }
@@ -309,11 +509,11 @@ bool ControllerMappingScreen::Update(const CombinedInputController& input)
             mMappingsChanged = true;
         }
 
-        if (input.GetButtonsTriggered() & Controller::BUTTON_DOWN) {
+        if (input.GetButtonsRepeated() & Controller::BUTTON_DOWN) {
             if (mSelected < mMappableButtons.size() - 1) {
                 mSelected++;
             }
-        } else if (input.GetButtonsTriggered() & Controller::BUTTON_UP) {
+        } else if (input.GetButtonsRepeated() & Controller::BUTTON_UP) {
             if (mSelected > 0) {
                 mSelected--;
             }
@@ -321,8 +521,7 @@ bool ControllerMappingScreen::Update(const CombinedInputController& input)
     }
 
     if (mMappingState != MAPPING_STATE_NONE) {
-        BloopairReportBuffer report{};
-        BloopairIPC::ReadRawReport(mController->GetChannel(), report);
+        BloopairReportBuffer report = ReadReport();
 
         if (mMappingState == MAPPING_STATE_WAIT) {
             if (HandleStickRemap(report)) {
@@ -349,16 +548,87 @@ bool ControllerMappingScreen::Update(const CombinedInputController& input)
             }
         }
     }
+}
 
-    if (mSelected >= mSelectionEnd) {
-        mSelectionEnd = mSelected + 1;
-        mSelectionStart = mSelectionEnd - kMaxEntriesPerPage;
-    } else if (mSelected < mSelectionStart) {
-        mSelectionStart = mSelected;
-        mSelectionEnd = mSelectionStart + kMaxEntriesPerPage;
+void ControllerMappingScreen::UpdateActions(const CombinedInputController& input)
+{
+    if (mActionState == ACTION_STATE_NONE) {
+        if (input.GetButtonsTriggered() & Controller::BUTTON_A) {
+            if (mSelected == mActions.size()) {
+                if (mActions.size() >= BLOOPAIR_MAX_ACTIONS) {
+                    return;
+                }
+
+                mActions.push_back({ BLOOPAIR_ACTION_TURBO, kDefaultTurboRate, 0, 0, 0 });
+                mActionsChanged = true;
+            }
+
+            mHeldButtons = 0;
+            mActionState = ACTION_STATE_WAIT_RELEASE;
+            return;
+        }
+
+        if (mSelected < mActions.size()) {
+            BloopairActionEntry& a = mActions[mSelected];
+
+            if (input.GetButtonsTriggered() & Controller::BUTTON_X) {
+                RemoveAction(mSelected);
+            } else if (input.GetButtonsTriggered() & Controller::BUTTON_Y) {
+                CycleActionType(mSelected);
+            } else if (input.GetButtonsTriggered() & Controller::BUTTON_PLUS) {
+                AddSequenceStep(mSelected);
+            } else if (input.GetButtonsRepeated() & (Controller::BUTTON_LEFT | Controller::BUTTON_RIGHT)) {
+                int step = (input.GetButtonsRepeated() & Controller::BUTTON_RIGHT) ? 1 : -1;
+                if (a.type == BLOOPAIR_ACTION_TURBO) {
+                    a.param = std::clamp<int>(a.param + step, kMinTurboRate, kMaxTurboRate);
+                    mActionsChanged = true;
+                } else if (a.type == BLOOPAIR_ACTION_SEQUENCE_STEP) {
+                    a.param = std::clamp<int>(a.param + step, 1, 255);
+                    mActionsChanged = true;
+                }
+            }
+        }
+
+        if (input.GetButtonsRepeated() & Controller::BUTTON_DOWN) {
+            if (mSelected < mActions.size()) {
+                mSelected++;
+            }
+        } else if (input.GetButtonsRepeated() & Controller::BUTTON_UP) {
+            if (mSelected > 0) {
+                mSelected--;
+            }
+        }
+
+        return;
     }
 
-    return true;
+    uint32_t buttons = GetMappedButtons(ReadReport());
+
+    // The buttons used to start editing might still be held
+    if (mActionState == ACTION_STATE_WAIT_RELEASE) {
+        if (!buttons) {
+            bool isStep = mActions[mSelected].type == BLOOPAIR_ACTION_SEQUENCE_STEP;
+            mActionState = isStep ? ACTION_STATE_WAIT_BUTTONS : ACTION_STATE_WAIT_TRIGGER;
+        }
+        return;
+    }
+
+    // Everything held at once counts, it's taken once all buttons are released
+    mHeldButtons |= buttons;
+    if (!mHeldButtons || buttons) {
+        return;
+    }
+
+    if (mActionState == ACTION_STATE_WAIT_TRIGGER) {
+        mActions[mSelected].trigger = mHeldButtons;
+        mActionState = (mActions[mSelected].type == BLOOPAIR_ACTION_SEQUENCE) ? ACTION_STATE_NONE : ACTION_STATE_WAIT_BUTTONS;
+    } else {
+        mActions[mSelected].buttons = mHeldButtons;
+        mActionState = ACTION_STATE_NONE;
+    }
+
+    mHeldButtons = 0;
+    mActionsChanged = true;
 }
 
 bool ControllerMappingScreen::GetMappingsChanged() const
@@ -379,6 +649,28 @@ std::vector<BloopairMappingEntry> ControllerMappingScreen::GetMappings() const
     return packedMappings;
 }
 
+bool ControllerMappingScreen::GetActionsChanged() const
+{
+    return mActionsChanged;
+}
+
+std::vector<BloopairActionEntry> ControllerMappingScreen::GetActions() const
+{
+    // Bloopair refuses actions without a trigger, so leave out the ones which were never set up
+    std::vector<BloopairActionEntry> actions;
+    for (size_t i = 0; i < mActions.size(); i++) {
+        const BloopairActionEntry& a = mActions[i];
+        size_t numSteps = (a.type == BLOOPAIR_ACTION_SEQUENCE) ? a.param : 0;
+        if (a.trigger) {
+            actions.insert(actions.end(), mActions.begin() + i, mActions.begin() + i + 1 + numSteps);
+        }
+
+        i += numSteps;
+    }
+
+    return actions;
+}
+
 bool ControllerMappingScreen::HandleButtonRemap(const BloopairReportBuffer& report)
 {
     auto& mapping = mMappings[mMappableButtons[mSelected].first];
@@ -439,3 +731,129 @@ bool ControllerMappingScreen::HandleStickRemap(const BloopairReportBuffer& repor
 
     return changed;
 }
+
+BloopairReportBuffer ControllerMappingScreen::ReadReport()
+{
+    BloopairReportBuffer report{};
+    if (BloopairIPC::ReadAccumulatedRawReport(mController->GetChannel(), true, report)) {
+        mAccumulating = true;
+    } else {
+        // Older Bloopair versions can only read the current report
+        BloopairIPC::ReadRawReport(mController->GetChannel(), report);
+    }
+
+    return report;
+}
+
+void ControllerMappingScreen::StopReading()
+{
+    if (!mAccumulating) {
+        return;
+    }
+
+    // Nothing else reads the accumulated report, so there's no need for Bloopair to keep it up to date
+    BloopairReportBuffer report;
+    BloopairIPC::ReadAccumulatedRawReport(mController->GetChannel(), false, report);
+    mAccumulating = false;
+}
+
+uint32_t ControllerMappingScreen::GetMappedButtons(const BloopairReportBuffer& report) const
+{
+    // Actions run on the mapped buttons, so run the raw report through the mappings edited on this screen
+    auto IsPressed = ([&](uint8_t from) {
+        switch (from) {
+            case BLOOPAIR_PRO_STICK_L_UP: return report.left_stick_y < -500;
+            case BLOOPAIR_PRO_STICK_L_DOWN: return report.left_stick_y > 500;
+            case BLOOPAIR_PRO_STICK_L_LEFT: return report.left_stick_x < -500;
+            case BLOOPAIR_PRO_STICK_L_RIGHT: return report.left_stick_x > 500;
+            case BLOOPAIR_PRO_STICK_R_UP: return report.right_stick_y < -500;
+            case BLOOPAIR_PRO_STICK_R_DOWN: return report.right_stick_y > 500;
+            case BLOOPAIR_PRO_STICK_R_LEFT: return report.right_stick_x < -500;
+            case BLOOPAIR_PRO_STICK_R_RIGHT: return report.right_stick_x > 500;
+            case BLOOPAIR_PRO_ANALOG_TRIGGER_L: return report.left_trigger > BLOOPAIR_TRIGGER_MAX / 2;
+            case BLOOPAIR_PRO_ANALOG_TRIGGER_R: return report.right_trigger > BLOOPAIR_TRIGGER_MAX / 2;
+            default: return from < BLOOPAIR_PRO_STICK_MIN && (report.buttons & BTN(from)) != 0;
+        }
+    });
+
+    uint32_t buttons = 0;
+    for (const auto& [button, mappings] : mMappings) {
+        if (button >= BLOOPAIR_PRO_STICK_MIN) {
+            continue;
+        }
+
+        if (std::any_of(mappings.begin(), mappings.end(), IsPressed)) {
+            buttons |= BTN(button);
+        }
+    }
+
+    return buttons;
+}
+
+void ControllerMappingScreen::CycleActionType(size_t index)
+{
+    BloopairActionEntry& a = mActions[index];
+    if (a.type == BLOOPAIR_ACTION_SEQUENCE_STEP) {
+        return;
+    }
+
+    if (a.type == BLOOPAIR_ACTION_SEQUENCE) {
+        // Back to a turbo, which drops the steps
+        mActions.erase(mActions.begin() + index + 1, mActions.begin() + index + 1 + a.param);
+        a.type = BLOOPAIR_ACTION_TURBO;
+        a.param = kDefaultTurboRate;
+    } else if (a.type == BLOOPAIR_ACTION_CHORD) {
+        // A sequence needs at least one step, which starts out pressing the buttons of the chord
+        if (mActions.size() >= BLOOPAIR_MAX_ACTIONS) {
+            a.type = BLOOPAIR_ACTION_TURBO;
+            a.param = kDefaultTurboRate;
+        } else {
+            a.type = BLOOPAIR_ACTION_SEQUENCE;
+            a.param = 1;
+            mActions.insert(mActions.begin() + index + 1, { BLOOPAIR_ACTION_SEQUENCE_STEP, kDefaultStepDuration, 0, 0, a.buttons });
+        }
+    } else {
+        a.type++;
+        a.param = 0;
+    }
+
+    mActionsChanged = true;
+}
+
+void ControllerMappingScreen::AddSequenceStep(size_t index)
+{
+    size_t sequence = FindSequence(mActions, index);
+    BloopairActionEntry& a = mActions[sequence];
+    if (a.type != BLOOPAIR_ACTION_SEQUENCE || a.param == 255 || mActions.size() >= BLOOPAIR_MAX_ACTIONS) {
+        return;
+    }
+
+    // Add the step to the end of the sequence and wait for its buttons
+    a.param++;
+    mSelected = sequence + a.param;
+    mActions.insert(mActions.begin() + mSelected, { BLOOPAIR_ACTION_SEQUENCE_STEP, kDefaultStepDuration, 0, 0, 0 });
+
+    mHeldButtons = 0;
+    mActionState = ACTION_STATE_WAIT_RELEASE;
+    mActionsChanged = true;
+}
+
+void ControllerMappingScreen::RemoveAction(size_t index)
+{
+    BloopairActionEntry& a = mActions[index];
+    if (a.type == BLOOPAIR_ACTION_SEQUENCE_STEP) {
+        size_t sequence = FindSequence(mActions, index);
+        mActions.erase(mActions.begin() + index);
+
+        // A sequence without steps is removed as well
+        if (--mActions[sequence].param == 0) {
+            mActions.erase(mActions.begin() + sequence);
+        }
+    } else {
+        size_t numSteps = (a.type == BLOOPAIR_ACTION_SEQUENCE) ? a.param : 0;
+        mActions.erase(mActions.begin() + index, mActions.begin() + index + 1 + numSteps);
+    }
+
+    mSelected = std::min(mSelected, mActions.size());
+    mActionsChanged = true;
+}
@@ -23,20 +23,37 @@
 class ControllerMappingScreen : public Screen
 {
 public:
-    ControllerMappingScreen(const KPADController* controller, const std::vector<BloopairMappingEntry>& mappings);
+    ControllerMappingScreen(const KPADController* controller, const std::vector<BloopairMappingEntry>& mappings, const std::vector<BloopairActionEntry>& actions);
     virtual ~ControllerMappingScreen();
 
     void Draw();
 
-    bool Update(const CombinedInputController& input);
+    bool Update(const CombinedInputController& input, float delta);
 
     bool GetMappingsChanged() const;
     std::vector<BloopairMappingEntry> GetMappings() const;
 
+    bool GetActionsChanged() const;
+    std::vector<BloopairActionEntry> GetActions() const;
+
 private:
+    void DrawMappings();
+    void DrawActions();
+
+    void UpdateMappings(const CombinedInputController& input);
+    void UpdateActions(const CombinedInputController& input);
+
     bool HandleButtonRemap(const BloopairReportBuffer& report);
     bool HandleStickRemap(const BloopairReportBuffer& report);
 
+    BloopairReportBuffer ReadReport();
+    void StopReading();
+
+    uint32_t GetMappedButtons(const BloopairReportBuffer& report) const;
+    void CycleActionType(size_t index);
+    void AddSequenceStep(size_t index);
+    void RemoveAction(size_t index);
+
     const KPADController* mController;
 
     std::vector<std::pair<BloopairProButton, const char*>> mMappableButtons;
@@ -50,6 +67,26 @@ private:
     } mMappingState;
     uint32_t mOldButtons;
     bool mMappingsChanged;
+    // Bloopair accumulates the raw reports while waiting for input, so short presses aren't missed
+    bool mAccumulating;
+
+    enum {
+        PAGE_MAPPINGS,
+        PAGE_ACTIONS,
+    } mPage;
+
+    // Flat list like the actions are applied, sequence steps follow their sequence
+    std::vector<BloopairActionEntry> mActions;
+
+    enum {
+        ACTION_STATE_NONE,
+        ACTION_STATE_WAIT_RELEASE,
+        ACTION_STATE_WAIT_TRIGGER,
+        ACTION_STATE_WAIT_BUTTONS,
+    } mActionState;
+    // Mapped buttons held so far while waiting for the trigger or buttons
+    uint32_t mHeldButtons;
+    bool mActionsChanged;
 
     size_t mSelected;
     size_t mSelectionStart;
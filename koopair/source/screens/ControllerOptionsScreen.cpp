@@ -43,9 +43,7 @@ ControllerOptionsScreen::ControllerOptionsScreen(const KPADController* controlle
    mCustomOptions(),
    mSelected(1),
    mSelectionStart(0),
-   mSelectionEnd(kMaxEntriesPerPage),
-   mIncrease(false),
-   mButtonHoldTime(0)
+   mSelectionEnd(kMaxEntriesPerPage)
 {
     switch (mController->GetControllerType()) {
         case BLOOPAIR_CONTROLLER_DUALSENSE:
@@ -118,38 +116,20 @@ void ControllerOptionsScreen::Draw()
     DrawBottomBar("\ue07d Navigate", "\ue001 Back", "\ue07e Modify");
 }
 
-bool ControllerOptionsScreen::Update(const CombinedInputController& input)
+bool ControllerOptionsScreen::Update(const CombinedInputController& input, float delta)
 {
     if (input.GetButtonsTriggered() & Controller::BUTTON_B) {
         return false;
     }
 
-    if (input.GetButtonsTriggered() & Controller::BUTTON_LEFT) {
-        mButtonHoldTime = 0;
-        mIncrease = false;
+    // Holding left or right keeps changing the value, faster the longer it's held
+    if (input.GetButtonsRepeated() & Controller::BUTTON_LEFT) {
         DecreaseOption(GetCurrentOption());
-    }
-
-    if (input.GetButtonsTriggered() & Controller::BUTTON_RIGHT) {
-        mButtonHoldTime = 0;
-        mIncrease = true;
+    } else if (input.GetButtonsRepeated() & Controller::BUTTON_RIGHT) {
         IncreaseOption(GetCurrentOption());
     }
 
-    if (input.GetButtonsHeld() & (Controller::BUTTON_LEFT | Controller::BUTTON_RIGHT)) {
-        mButtonHoldTime++;
-
-        if (mButtonHoldTime >= 20) {
-            Option& option = GetCurrentOption();
-            if (mIncrease) {
-                IncreaseOption(option);
-            } else {
-                DecreaseOption(option);
-            }
-        }
-    }
-
-    if (input.GetButtonsTriggered() & Controller::BUTTON_DOWN) {
+    if (input.GetButtonsRepeated() & Controller::BUTTON_DOWN) {
         if (mSelected < mOptions.size() + mCustomOptions.size() - 1) {
             mSelected++;
 
@@ -158,7 +138,7 @@ bool ControllerOptionsScreen::Update(const CombinedInputController& input)
                 mSelected++;
             }
         }
-    } else if (input.GetButtonsTriggered() & Controller::BUTTON_UP) {
+    } else if (input.GetButtonsRepeated() & Controller::BUTTON_UP) {
         // assume the first element is always a title
         if (mSelected > 1) {
             mSelected--;
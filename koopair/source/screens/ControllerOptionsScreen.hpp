@@ -43,7 +43,7 @@ public:
 
     void Draw();
 
-    bool Update(const CombinedInputController& input);
+    bool Update(const CombinedInputController& input, float delta);
 
     bool GetCommonChanged() const;
     const BloopairCommonConfiguration& GetCommonConfiguration() const;
@@ -100,7 +100,4 @@ private:
     size_t mSelected;
     size_t mSelectionStart;
     size_t mSelectionEnd;
-
-    bool mIncrease;
-    uint32_t mButtonHoldTime;
 };
@@ -87,7 +87,7 @@ void ControllerPairingScreen::Draw()
     }
 }
 
-bool ControllerPairingScreen::Update(const CombinedInputController& input)
+bool ControllerPairingScreen::Update(const CombinedInputController& input, float delta)
 {
     if (mMessageBox) {
         if (!mMessageBox->Update(input)) {
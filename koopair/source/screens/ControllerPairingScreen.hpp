@@ -32,7 +32,7 @@ public:
 
     void Draw();
 
-    bool Update(const CombinedInputController& input);
+    bool Update(const CombinedInputController& input, float delta);
 
 private:
     static int32_t HidAttachCallback(HIDClient* client, HIDDevice* device, HIDAttachEvent event);
@@ -19,6 +19,9 @@
 #include "Utils.hpp"
 #include "ControllerManager.hpp"
 #include "ProcUI.hpp"
+#include "BloopairIPC.hpp"
+#include <algorithm>
+#include <cmath>
 
 namespace
 {
@@ -48,14 +51,72 @@ const char* GetCharacterForButton(WPADProButton button)
     return nullptr;
 }
 
+// How often the statistics are read from IOS-PAD
+constexpr float kStatisticsInterval = 0.5f;
+
+constexpr SDL_Color kColorLeftX  = { 0x00, 0x91, 0xea, 0xff };
+constexpr SDL_Color kColorLeftY  = { 0x6c, 0xd4, 0xff, 0xff };
+constexpr SDL_Color kColorRightX = { 0xff, 0x33, 0x33, 0xff };
+constexpr SDL_Color kColorRightY = { 0xff, 0xa0, 0x40, 0xff };
+
+void AddQuad(std::vector<SDL_Vertex>& vertices, SDL_FPoint a, SDL_FPoint b, SDL_FPoint c, SDL_FPoint d, SDL_Color color)
+{
+    vertices.push_back({ a, color, {} });
+    vertices.push_back({ b, color, {} });
+    vertices.push_back({ c, color, {} });
+    vertices.push_back({ a, color, {} });
+    vertices.push_back({ c, color, {} });
+    vertices.push_back({ d, color, {} });
+}
+
+void AddRect(std::vector<SDL_Vertex>& vertices, float x, float y, float w, float h, SDL_Color color)
+{
+    AddQuad(vertices, { x, y }, { x + w, y }, { x + w, y + h }, { x, y + h }, color);
+}
+
+void AddLine(std::vector<SDL_Vertex>& vertices, SDL_FPoint from, SDL_FPoint to, float thickness, SDL_Color color)
+{
+    float dx = to.x - from.x;
+    float dy = to.y - from.y;
+    float length = std::sqrt(dx * dx + dy * dy);
+    if (length == 0.0f) {
+        return;
+    }
+
+    // offset both ends along the normal
+    float nx = -dy / length * thickness / 2.0f;
+    float ny = dx / length * thickness / 2.0f;
+    AddQuad(vertices, { from.x + nx, from.y + ny }, { to.x + nx, to.y + ny }, { to.x - nx, to.y - ny }, { from.x - nx, from.y - ny }, color);
+}
+
 }
 
 ControllerTestScreen::ControllerTestScreen(const KPADController* controller)
  : mController(controller),
    mStatus(),
-   mHoldCount(0)
+   mHoldTime(0.0f),
+   mLeftHistory(),
+   mRightHistory(),
+   mHistoryPos(0),
+   mIntervalBins(),
+   mLastSampleCount(0),
+   mTotalSamples(0),
+   mOverruns(0),
+   mHasStatistics(false),
+   mStatisticsTime(kStatisticsInterval),
+   mFirstStatistics(),
+   mLastStatistics(),
+   mStatisticsSamples(0),
+   mReportRate(0.0f),
+   mLatency(0.0f),
+   mLatencyMax(0.0f),
+   mMissedSamples(0),
+   mVertices()
 {
     ProcUI::SetHomeButtonMenuEnabled(false);
+
+    // four traces and the histogram bars
+    mVertices.reserve((kHistorySize * 4 + kNumIntervalBins) * 6);
 }
 
 ControllerTestScreen::~ControllerTestScreen()
@@ -106,27 +167,96 @@ void ControllerTestScreen::Draw()
 
     // TODO draw LEDs?
 
+    DrawStickGraph(32, 835, 960, 160);
+    DrawIntervalHistogram(1024, 835, 400, 160);
+    DrawStatistics(1456, 835);
+
     DrawBottomBar(nullptr, nullptr, "\ue001 Back (Hold)");
 }
 
-bool ControllerTestScreen::Update(const CombinedInputController& input)
+bool ControllerTestScreen::Update(const CombinedInputController& input, float delta)
 {
     if (input.GetButtonsHeld() & Controller::BUTTON_B) {
-        mHoldCount++;
+        mHoldTime += delta;
     } else {
-        mHoldCount = 0;
+        mHoldTime = 0.0f;
     }
 
-    // Hold for 3 Seconds
-    if (mHoldCount >= 60) {
+    // Hold for 1 second
+    if (mHoldTime >= 1.0f) {
         return false;
     }
 
     mStatus = mController->GetStatus();
 
+    std::span<const KPADStatus> samples = mController->GetSamples();
+    if (!samples.empty()) {
+        // the samples are newest first
+        for (auto it = samples.rbegin(); it != samples.rend(); it++) {
+            mLeftHistory[mHistoryPos] = it->pro.leftStick;
+            mRightHistory[mHistoryPos] = it->pro.rightStick;
+            mHistoryPos = (mHistoryPos + 1) % kHistorySize;
+        }
+
+        // KPAD doesn't timestamp samples, so spread them evenly over the time since the last update
+        size_t bin = std::min<size_t>(delta * 1000.0f / samples.size(), kNumIntervalBins - 1);
+        mIntervalBins[bin] += samples.size();
+
+        if (samples.size() >= KPADController::kMaxSamples) {
+            mOverruns++;
+        }
+    }
+
+    mLastSampleCount = samples.size();
+    mTotalSamples += samples.size();
+
+    mStatisticsTime += delta;
+    if (mStatisticsTime >= kStatisticsInterval) {
+        mStatisticsTime = 0.0f;
+        UpdateStatistics();
+    }
+
     return true;
 }
 
+void ControllerTestScreen::UpdateStatistics()
+{
+    BloopairControllerStatisticsData statistics;
+    if (!BloopairIPC::IsActive() || mController->GetExtensionType() != WPAD_EXT_PRO_CONTROLLER ||
+        !BloopairIPC::GetControllerStatistics(mController->GetChannel(), statistics)) {
+        mHasStatistics = false;
+        return;
+    }
+
+    if (!mHasStatistics) {
+        // rates need two reads, start counting missed samples from here
+        mHasStatistics = true;
+        mFirstStatistics = mLastStatistics = statistics;
+        mStatisticsSamples = mTotalSamples;
+        mReportRate = mLatency = mLatencyMax = 0.0f;
+        mMissedSamples = 0;
+        return;
+    }
+
+    uint64_t elapsed = statistics.uptime - mLastStatistics.uptime;
+    if (elapsed) {
+        mReportRate = (statistics.numReceived - mLastStatistics.numReceived) * 1000000.0f / elapsed;
+    }
+
+    uint32_t latencyCount = statistics.latencyCount - mLastStatistics.latencyCount;
+    if (latencyCount) {
+        mLatency = (statistics.latencyTotal - mLastStatistics.latencyTotal) / (latencyCount * 1000.0f);
+    }
+    mLatencyMax = statistics.latencyMax / 1000.0f;
+
+    // every report sent by IOS-PAD should show up as a KPAD sample
+    int32_t sent = statistics.numSent - mFirstStatistics.numSent;
+    int32_t received = mTotalSamples - mStatisticsSamples;
+    mMissedSamples = std::max(sent - received, 0);
+
+    mLastStatistics = statistics;
+}
+
 void ControllerTestScreen::DrawStick(uint32_t x, uint32_t y, const KPADVec2D& stick, bool pressed)
 {
     // Draw the pressed background first
@@ -178,3 +308,75 @@ void ControllerTestScreen::DrawDPAD(uint32_t x, uint32_t y, uint32_t held)
 
     Gfx::Print(x, y, 200, Gfx::COLOR_WHITE, "\ue041", Gfx::ALIGN_CENTER);
 }
+
+void ControllerTestScreen::DrawStickGraph(int x, int y, int w, int h)
+{
+    Gfx::DrawRectFilled(x, y, w, h, Gfx::COLOR_ALT_BACKGROUND);
+
+    mVertices.clear();
+    AddRect(mVertices, x, y + h / 2, w, 1, Gfx::COLOR_GRAY);
+
+    auto addTrace = [&](const std::array<KPADVec2D, kHistorySize>& history, bool useY, SDL_Color color) {
+        SDL_FPoint last{};
+        for (size_t i = 0; i < kHistorySize; i++) {
+            const KPADVec2D& stick = history[(mHistoryPos + i) % kHistorySize];
+            float value = std::clamp(useY ? stick.y : stick.x, -1.0f, 1.0f);
+
+            SDL_FPoint point{ x + i * (w - 1.0f) / (kHistorySize - 1), y + h / 2.0f - value * (h / 2.0f - 4.0f) };
+            if (i > 0) {
+                AddLine(mVertices, last, point, 3.0f, color);
+            }
+            last = point;
+        }
+    };
+
+    addTrace(mLeftHistory, false, kColorLeftX);
+    addTrace(mLeftHistory, true, kColorLeftY);
+    addTrace(mRightHistory, false, kColorRightX);
+    addTrace(mRightHistory, true, kColorRightY);
+
+    Gfx::DrawGeometry(mVertices);
+
+    Gfx::Print(x + 8, y + 4, 28, kColorLeftX, "LX");
+    Gfx::Print(x + 56, y + 4, 28, kColorLeftY, "LY");
+    Gfx::Print(x + 104, y + 4, 28, kColorRightX, "RX");
+    Gfx::Print(x + 152, y + 4, 28, kColorRightY, "RY");
+}
+
+void ControllerTestScreen::DrawIntervalHistogram(int x, int y, int w, int h)
+{
+    Gfx::DrawRectFilled(x, y, w, h, Gfx::COLOR_ALT_BACKGROUND);
+    Gfx::Print(x + 8, y + 4, 28, Gfx::COLOR_ALT_TEXT, "Sample interval (0 - 15+ ms)");
+
+    uint32_t maxCount = *std::max_element(mIntervalBins.begin(), mIntervalBins.end());
+    if (!maxCount) {
+        return;
+    }
+
+    const float barsTop = y + 40.0f;
+    const float barsHeight = h - 48.0f;
+    const float barWidth = (w - 16.0f) / kNumIntervalBins;
+
+    mVertices.clear();
+    for (size_t i = 0; i < kNumIntervalBins; i++) {
+        float height = std::max(mIntervalBins[i] * barsHeight / maxCount, mIntervalBins[i] ? 2.0f : 0.0f);
+        AddRect(mVertices, x + 8 + i * barWidth, barsTop + barsHeight - height, barWidth - 2.0f, height, Gfx::COLOR_HIGHLIGHTED);
+    }
+
+    Gfx::DrawGeometry(mVertices);
+}
+
+void ControllerTestScreen::DrawStatistics(int x, int y)
+{
+    Gfx::Print(x, y, 32, Gfx::COLOR_TEXT, Utils::sprintf("Samples: %u (%u this frame)", mTotalSamples, mLastSampleCount));
+    Gfx::Print(x, y + 32, 32, mOverruns ? Gfx::COLOR_ERROR : Gfx::COLOR_TEXT, Utils::sprintf("Buffer overruns: %u", mOverruns));
+
+    if (!mHasStatistics) {
+        Gfx::Print(x, y + 64, 32, Gfx::COLOR_ALT_TEXT, "No IOS-PAD statistics");
+        return;
+    }
+
+    Gfx::Print(x, y + 64, 32, mMissedSamples ? Gfx::COLOR_ERROR : Gfx::COLOR_TEXT, Utils::sprintf("Missed samples: %d", mMissedSamples));
+    Gfx::Print(x, y + 96, 32, Gfx::COLOR_TEXT, Utils::sprintf("HID rate: %.0f Hz", mReportRate));
+    Gfx::Print(x, y + 128, 32, Gfx::COLOR_TEXT, Utils::sprintf("Latency: %.1f ms (max %.1f)", mLatency, mLatencyMax));
+}
@@ -19,6 +19,9 @@
 #include "Screen.hpp"
 
 #include "Controller.hpp"
+#include <array>
+#include <vector>
+#include <SDL.h>
 
 class ControllerTestScreen : public Screen
 {
@@ -28,7 +31,7 @@ public:
 
     void Draw();
 
-    bool Update(const CombinedInputController& input);
+    bool Update(const CombinedInputController& input, float delta);
 
 private:
     void DrawStick(uint32_t x, uint32_t y, const KPADVec2D& stick, bool pressed);
@@ -37,7 +40,44 @@ private:
 
     void DrawDPAD(uint32_t x, uint32_t y, uint32_t held);
 
+    void UpdateStatistics();
+
+    void DrawStickGraph(int x, int y, int w, int h);
+
+    void DrawIntervalHistogram(int x, int y, int w, int h);
+
+    void DrawStatistics(int x, int y);
+
     const KPADController* mController;
     KPADStatus mStatus;
-    int mHoldCount;
+    // seconds B has been held for
+    float mHoldTime;
+
+    // stick positions of the last samples, the oldest one is at mHistoryPos
+    static constexpr size_t kHistorySize = 240;
+    std::array<KPADVec2D, kHistorySize> mLeftHistory;
+    std::array<KPADVec2D, kHistorySize> mRightHistory;
+    size_t mHistoryPos;
+
+    // amount of samples by their interval in milliseconds, the last bin includes everything above
+    static constexpr size_t kNumIntervalBins = 16;
+    std::array<uint32_t, kNumIntervalBins> mIntervalBins;
+    uint32_t mLastSampleCount;
+    uint32_t mTotalSamples;
+    // updates where KPAD's sample buffer was full, which means older samples were dropped
+    uint32_t mOverruns;
+
+    // statistics from IOS-PAD, only available while Bloopair is running
+    bool mHasStatistics;
+    float mStatisticsTime;
+    BloopairControllerStatisticsData mFirstStatistics;
+    BloopairControllerStatisticsData mLastStatistics;
+    uint32_t mStatisticsSamples;
+    float mReportRate;
+    float mLatency;
+    float mLatencyMax;
+    int32_t mMissedSamples;
+
+    // reused every frame, so drawing the graphs doesn't allocate
+    std::vector<SDL_Vertex> mVertices;
 };
@@ -27,8 +27,8 @@ namespace
 {
 
 // Let's make sure to not break API for patch versions
-constexpr uint32_t kMinBloopairVersion = BLOOPAIR_VERSION(1,   0,   0);
-constexpr uint32_t kMaxBloopairVersion = BLOOPAIR_VERSION(1,   0, 255);
+constexpr uint32_t kMinBloopairVersion = BLOOPAIR_VERSION(1,   1,   0);
+constexpr uint32_t kMaxBloopairVersion = BLOOPAIR_VERSION(1,   1, 255);
 
 }
 
@@ -120,10 +120,10 @@ void MainScreen::Draw()
     DrawBottomBar(mStateFailure ? nullptr : "Please wait...", mStateFailure ? "\ue044 Exit" : nullptr, nullptr);
 }
 
-bool MainScreen::Update(const CombinedInputController& input)
+bool MainScreen::Update(const CombinedInputController& input, float delta)
 {
     if (mMenuScreen) {
-        if (!mMenuScreen->Update(input)) {
+        if (!mMenuScreen->Update(input, delta)) {
             // menu wants to exit
             return false;
         }
@@ -28,7 +28,7 @@ public:
 
     void Draw();
 
-    bool Update(const CombinedInputController& input);
+    bool Update(const CombinedInputController& input, float delta);
 
 protected:
     void DrawStatus(std::string status, SDL_Color color = Gfx::COLOR_TEXT);
@@ -66,21 +66,21 @@ void MenuScreen::Draw()
     DrawBottomBar("\ue07d Navigate", "\ue044 Exit", "\ue000 Select");
 }
 
-bool MenuScreen::Update(const CombinedInputController& input)
+bool MenuScreen::Update(const CombinedInputController& input, float delta)
 {
     if (mSubscreen) {
-        if (!mSubscreen->Update(input)) {
+        if (!mSubscreen->Update(input, delta)) {
             // subscreen wants to exit
             mSubscreen.reset();
         }
         return true;
     }
 
-    if (input.GetButtonsTriggered() & Controller::BUTTON_DOWN) {
+    if (input.GetButtonsRepeated() & Controller::BUTTON_DOWN) {
         if (mSelected < MENU_ID_MAX) {
             mSelected = static_cast<MenuID>(mSelected + 1);
         }
-    } else if (input.GetButtonsTriggered() & Controller::BUTTON_UP) {
+    } else if (input.GetButtonsRepeated() & Controller::BUTTON_UP) {
         if (mSelected > MENU_ID_MIN) {
             mSelected = static_cast<MenuID>(mSelected - 1);
         }
@@ -28,7 +28,7 @@ public:
 
     void Draw();
 
-    bool Update(const CombinedInputController& input);
+    bool Update(const CombinedInputController& input, float delta);
 
 private:
     std::unique_ptr<Screen> mSubscreen;
@@ -16,8 +16,13 @@
  */
 #include "SettingsScreen.hpp"
 #include "Gfx.hpp"
+#include "BloopairIPC.hpp"
+#include "FrameClock.hpp"
+#include "DebugRecorder.hpp"
+#include "Utils.hpp"
 
 SettingsScreen::SettingsScreen()
+ :  mSelected(SETTING_ID_MIN)
 {
 }
 
@@ -29,16 +34,106 @@ void SettingsScreen::Draw()
 {
     DrawTopBar("Settings");
 
-    Gfx::Print(Gfx::SCREEN_WIDTH / 2, Gfx::SCREEN_HEIGHT / 2, 60, Gfx::COLOR_TEXT, "Nothing here yet :)", Gfx::ALIGN_CENTER);
+    int yOff = DrawHeader(32, 75 + 64, Gfx::SCREEN_WIDTH - 64, 0xf3fd, "Performance");
+    DrawEntry(yOff, "Frame rate", FrameClock::GetTargetRate() == 30 ? "30 Hz" : "60 Hz", mSelected == SETTING_ID_FRAME_RATE);
+    yOff += 100;
+    DrawEntry(yOff, "Lower frame rate when idle", FrameClock::IsIdleThrottleEnabled() ? "On" : "Off", mSelected == SETTING_ID_IDLE_THROTTLE);
+    yOff += 100;
+    DrawEntry(yOff, "Frame time overlay", FrameClock::IsOverlayEnabled() ? "On" : "Off", mSelected == SETTING_ID_FRAME_TIME_OVERLAY);
+    yOff += 100;
 
-    DrawBottomBar("\ue001 Back", nullptr, nullptr);
+    yOff = DrawHeader(32, yOff + 64, Gfx::SCREEN_WIDTH - 64, 0xf188, "Debugging");
+    const DebugRecorder::Status& captureStatus = DebugRecorder::GetCaptureStatus();
+    DrawEntry(yOff, "Capture controller traffic", captureStatus.active ? "Recording" : "Off", mSelected == SETTING_ID_CAPTURE,
+        captureStatus.active ? Gfx::COLOR_ACCENT : Gfx::COLOR_TEXT);
+
+    yOff += 100;
+
+    const DebugRecorder::Status& traceStatus = DebugRecorder::GetTraceStatus();
+    DrawEntry(yOff, "Record trace", traceStatus.active ? "Recording" : "Off", mSelected == SETTING_ID_TRACE,
+        traceStatus.active ? Gfx::COLOR_ACCENT : Gfx::COLOR_TEXT);
+    yOff += 100;
+
+    if (mSelected == SETTING_ID_TRACE) {
+        if (traceStatus.failed) {
+            Gfx::Print(Gfx::SCREEN_WIDTH / 2, yOff + 50, 50, Gfx::COLOR_ERROR,
+                "Failed to record the trace!\nTracing is only supported by debug builds of Bloopair.", Gfx::ALIGN_HORIZONTAL);
+        } else if (!traceStatus.path.empty()) {
+            Gfx::Print(Gfx::SCREEN_WIDTH / 2, yOff + 50, 50, Gfx::COLOR_ALT_TEXT,
+                Utils::sprintf("%s\n%u bytes recorded, %u records lost", traceStatus.path.c_str(), traceStatus.size, traceStatus.numLost), Gfx::ALIGN_HORIZONTAL);
+        }
+    } else if (captureStatus.failed) {
+        Gfx::Print(Gfx::SCREEN_WIDTH / 2, yOff + 50, 50, Gfx::COLOR_ERROR,
+            "Failed to capture!\nCapturing is only supported by debug builds of Bloopair.", Gfx::ALIGN_HORIZONTAL);
+    } else if (!captureStatus.path.empty()) {
+        Gfx::Print(Gfx::SCREEN_WIDTH / 2, yOff + 50, 50, Gfx::COLOR_ALT_TEXT,
+            Utils::sprintf("%s\n%u bytes captured, %u records dropped", captureStatus.path.c_str(), captureStatus.size, captureStatus.numLost), Gfx::ALIGN_HORIZONTAL);
+    }
+
+    const char* action = "\ue000 Change";
+    if (mSelected == SETTING_ID_CAPTURE) {
+        action = captureStatus.active ? "\ue000 Stop" : "\ue000 Start";
+    } else if (mSelected == SETTING_ID_TRACE) {
+        action = traceStatus.active ? "\ue000 Stop" : "\ue000 Start";
+    }
+
+    DrawBottomBar("\ue07d Navigate", "\ue001 Back", action);
+}
+
+void SettingsScreen::DrawEntry(int yOff, const char* name, const char* value, bool selected, SDL_Color valueColor)
+{
+    Gfx::DrawRectFilled(0, yOff, Gfx::SCREEN_WIDTH, 100, Gfx::COLOR_ALT_BACKGROUND);
+    Gfx::Print(128 + 8, yOff + 100 / 2, 50, Gfx::COLOR_TEXT, name, Gfx::ALIGN_VERTICAL);
+    Gfx::Print(Gfx::SCREEN_WIDTH - 128, yOff + 100 / 2, 50, valueColor, value, Gfx::ALIGN_VERTICAL | Gfx::ALIGN_RIGHT);
+
+    if (selected) {
+        Gfx::DrawRect(0, yOff, Gfx::SCREEN_WIDTH, 100, 8, Gfx::COLOR_HIGHLIGHTED);
+    }
 }
 
-bool SettingsScreen::Update(const CombinedInputController& input)
+bool SettingsScreen::Update(const CombinedInputController& input, float delta)
 {
     if (input.GetButtonsTriggered() & Controller::BUTTON_B) {
         return false;
     }
 
+    if (input.GetButtonsRepeated() & Controller::BUTTON_DOWN) {
+        if (mSelected < SETTING_ID_MAX) {
+            mSelected = static_cast<SettingID>(mSelected + 1);
+        }
+    } else if (input.GetButtonsRepeated() & Controller::BUTTON_UP) {
+        if (mSelected > SETTING_ID_MIN) {
+            mSelected = static_cast<SettingID>(mSelected - 1);
+        }
+    }
+
+    if (input.GetButtonsTriggered() & Controller::BUTTON_A) {
+        switch (mSelected) {
+        case SETTING_ID_FRAME_RATE:
+            FrameClock::SetTargetRate(FrameClock::GetTargetRate() == 30 ? 60 : 30);
+            break;
+        case SETTING_ID_IDLE_THROTTLE:
+            FrameClock::SetIdleThrottleEnabled(!FrameClock::IsIdleThrottleEnabled());
+            break;
+        case SETTING_ID_FRAME_TIME_OVERLAY:
+            FrameClock::SetOverlayEnabled(!FrameClock::IsOverlayEnabled());
+            break;
+        case SETTING_ID_CAPTURE:
+            if (DebugRecorder::GetCaptureStatus().active) {
+                DebugRecorder::StopCapture();
+            } else {
+                DebugRecorder::StartCapture();
+            }
+            break;
+        case SETTING_ID_TRACE:
+            if (DebugRecorder::GetTraceStatus().active) {
+                DebugRecorder::StopTrace();
+            } else {
+                DebugRecorder::StartTrace();
+            }
+            break;
+        }
+    }
+
     return true;
 }
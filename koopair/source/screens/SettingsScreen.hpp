@@ -17,6 +17,7 @@
 #pragma once
 
 #include "Screen.hpp"
+#include "Gfx.hpp"
 
 class SettingsScreen : public Screen
 {
@@ -26,7 +27,20 @@ public:
 
     void Draw();
 
-    bool Update(const CombinedInputController& input);
+    bool Update(const CombinedInputController& input, float delta);
 
 private:
+    void DrawEntry(int yOff, const char* name, const char* value, bool selected, SDL_Color valueColor = Gfx::COLOR_TEXT);
+
+    enum SettingID {
+        SETTING_ID_FRAME_RATE,
+        SETTING_ID_IDLE_THROTTLE,
+        SETTING_ID_FRAME_TIME_OVERLAY,
+        SETTING_ID_CAPTURE,
+        SETTING_ID_TRACE,
+
+        SETTING_ID_MIN = SETTING_ID_FRAME_RATE,
+        SETTING_ID_MAX = SETTING_ID_TRACE,
+    };
+    SettingID mSelected;
 };
@@ -165,6 +165,54 @@ IOSError Bloopair_GetControllerInformation(IOSHandle handle, WPADChan chan, Bloo
  */
 IOSError Bloopair_ReadRawReport(IOSHandle handle, WPADChan chan, BloopairReportBuffer* outReport);
 
+/**
+ * Start or stop accumulating the raw reports of the specified channel and read everything accumulated since the last read.
+ * 
+ * \note
+ * The report contains everything the controller reported since the previous read:
+ * the buttons of all reports combined, the stick values furthest from the centre and the largest trigger values.
+ * The first read after starting returns the current report.
+ * Reading resets this to the current state of the controller, so only one reader should accumulate a channel,
+ * otherwise each of them only sees part of the input.
+ * 
+ * \param handle
+ * A handle obtained by \link Bloopair_Open \endlink.
+ * 
+ * \param chan
+ * A WPAD / KPAD channel to read the report from.
+ * 
+ * \param enable
+ * \c TRUE to start or keep accumulating, \c FALSE to read the remaining report and stop accumulating.
+ * 
+ * \param outReport
+ * A pointer to store the report to.
+ * 
+ * \return
+ * \c IOS_ERROR_OK on success.
+ */
+IOSError Bloopair_ReadAccumulatedRawReport(IOSHandle handle, WPADChan chan, BOOL enable, BloopairReportBuffer* outReport);
+
+/**
+ * Read the input statistics of the controller on the specified channel.
+ * 
+ * \note
+ * The counters only ever increase, the rates can be calculated from the difference between two reads.
+ * \c latencyMax is reset every time the statistics are read.
+ * 
+ * \param handle
+ * A handle obtained by \link Bloopair_Open \endlink.
+ * 
+ * \param chan
+ * A WPAD / KPAD channel to read the statistics for.
+ * 
+ * \param outData
+ * A pointer to store the statistics to.
+ * 
+ * \return
+ * \c IOS_ERROR_OK on success.
+ */
+IOSError Bloopair_GetControllerStatistics(IOSHandle handle, WPADChan chan, BloopairControllerStatisticsData* outData);
+
 /**
  * Apply a configuration for the specified BDA.
  * 
@@ -255,6 +303,54 @@ IOSError Bloopair_ApplyControllerMappingForBDA(IOSHandle handle, const uint8_t*
  */
 IOSError Bloopair_ApplyControllerMappingForControllerType(IOSHandle handle, BloopairControllerType controllerType, const BloopairMappingEntry* mappings, uint8_t numMappings);
 
+/**
+ * Apply controller actions (turbo, toggle, chord and sequences) for the specified BDA.
+ * 
+ * \warning
+ * If the controller is currently connected it needs to be disconnected first.
+ * Keeping the controller connected results in undefined behaviour.
+ * 
+ * \param handle
+ * A handle obtained by \link Bloopair_Open \endlink.
+ * 
+ * \param bda
+ * A pointer to a 6-byte bluetooth device address to apply the actions for.
+ * 
+ * \param actions
+ * A pointer to read the actions from or \c NULL to remove the actions.
+ * 
+ * \param numActions
+ * The amount of actions which should be applied, at most \c BLOOPAIR_MAX_ACTIONS, or \c 0 to remove the actions.
+ * 
+ * \return
+ * \c IOS_ERROR_OK on success.
+ */
+IOSError Bloopair_ApplyControllerActionsForBDA(IOSHandle handle, const uint8_t* bda, const BloopairActionEntry* actions, uint8_t numActions);
+
+/**
+ * Apply controller actions (turbo, toggle, chord and sequences) for all controllers of the specified controller type.
+ * 
+ * \warning
+ * If any controllers of this type are currently connected they needs to be disconnected first.
+ * Keeping the controllers connected results in undefined behaviour.
+ * 
+ * \param handle
+ * A handle obtained by \link Bloopair_Open \endlink.
+ * 
+ * \param controllerType
+ * The controller type to apply the actions for.
+ * 
+ * \param actions
+ * A pointer to read the actions from or \c NULL to remove the actions.
+ * 
+ * \param numActions
+ * The amount of actions which should be applied, at most \c BLOOPAIR_MAX_ACTIONS, or \c 0 to remove the actions.
+ * 
+ * \return
+ * \c IOS_ERROR_OK on success.
+ */
+IOSError Bloopair_ApplyControllerActionsForControllerType(IOSHandle handle, BloopairControllerType controllerType, const BloopairActionEntry* actions, uint8_t numActions);
+
 /**
  * Apply a custom configuration for the specified BDA.
  * 
@@ -377,6 +473,26 @@ IOSError Bloopair_GetControllerMapping(IOSHandle handle, WPADChan chan, Bloopair
  */
 IOSError Bloopair_GetDefaultControllerMapping(IOSHandle handle, BloopairControllerType controllerType, BloopairMappingEntry* outMappings, uint8_t* outNumMappings);
 
+/**
+ * Get the controller actions for the specified channel.
+ * 
+ * \param handle
+ * A handle obtained by \link Bloopair_Open \endlink.
+ * 
+ * \param chan
+ * The channel to get the actions for.
+ * 
+ * \param outActions
+ * A pointer to store the actions to or \c NULL.
+ * 
+ * \param outNumActions
+ * A pointer to read the amount of actions which can be stored from and to write the amount of actions successfully stored to.
+ * 
+ * \return
+ * \c IOS_ERROR_OK on success.
+ */
+IOSError Bloopair_GetControllerActions(IOSHandle handle, WPADChan chan, BloopairActionEntry* outActions, uint8_t* outNumActions);
+
 /**
  * Get the controller custom configuration for the specified channel.
  * 
@@ -417,6 +533,117 @@ IOSError Bloopair_GetCustomConfiguration(IOSHandle handle, WPADChan chan, void*
  */
 IOSError Bloopair_GetDefaultCustomConfiguration(IOSHandle handle, BloopairControllerType controllerType, void* outCustom, uint32_t* outSize);
 
+/**
+ * Drain the IOS-PAD trace buffer.
+ * 
+ * \note
+ * Tracing is only available in debug builds, release builds will return \c IOS_ERROR_INVALID.
+ * 
+ * \param handle
+ * A handle obtained by \link Bloopair_Open \endlink.
+ * 
+ * \param enableMask
+ * A mask of \c BLOOPAIR_TRACE_CATEGORY_* values which should be recorded from now on.
+ * 
+ * \param outRecords
+ * A pointer to store the records to.
+ * 
+ * \param outNumRecords
+ * A pointer to read the amount of records which can be stored from and to write the amount of records stored to.
+ * At most \c BLOOPAIR_TRACE_MAX_RECORDS_PER_READ records are read per call.
+ * 
+ * \param outNumLost
+ * A pointer to store the amount of records which were overwritten or dropped since the last read to or \c NULL.
+ * 
+ * \return
+ * \c IOS_ERROR_OK on success.
+ */
+IOSError Bloopair_ReadTrace(IOSHandle handle, uint32_t enableMask, BloopairTraceRecord* outRecords, uint32_t* outNumRecords, uint32_t* outNumLost);
+
+/**
+ * Start or stop capturing controller traffic and drain the capture buffer.
+ * The drained data is a stream of capture records, see \c bloopair/capture.h for the format.
+ * 
+ * \note
+ * Capturing is only available in debug builds, release builds will return \c IOS_ERROR_INVALID.
+ * 
+ * \param handle
+ * A handle obtained by \link Bloopair_Open \endlink.
+ * 
+ * \param enable
+ * \c TRUE to start or keep capturing, \c FALSE to drain the remaining data and stop capturing.
+ * 
+ * \param outData
+ * A pointer to store the drained data to.
+ * 
+ * \param outSize
+ * A pointer to read the maximum size which can be stored from and to write the amount of bytes stored to.
+ * At most \c BLOOPAIR_CAPTURE_MAX_READ_SIZE bytes are read per call.
+ * 
+ * \param outNumLost
+ * A pointer to store the amount of records which were dropped since the last read to or \c NULL.
+ * 
+ * \return
+ * \c IOS_ERROR_OK on success.
+ */
+IOSError Bloopair_ReadCapture(IOSHandle handle, BOOL enable, void* outData, uint32_t* outSize, uint32_t* outNumLost);
+
+/**
+ * Add entries to the device registry, which selects the driver for a controller based on its VID/PID.
+ * Entries for a VID/PID which has already been added are replaced, added entries take priority over the builtin ones.
+ * 
+ * \note
+ * Entries only apply to controllers which connect after they have been added.
+ * 
+ * \param handle
+ * A handle obtained by \link Bloopair_Open \endlink.
+ * 
+ * \param entries
+ * A pointer to the entries to add.
+ * 
+ * \param numEntries
+ * The amount of entries to add, at most \c BLOOPAIR_MAX_DEVICE_ENTRIES_PER_REQUEST.
+ * 
+ * \return
+ * \c IOS_ERROR_OK on success.
+ */
+IOSError Bloopair_AddDeviceEntries(IOSHandle handle, const BloopairDeviceEntry* entries, uint32_t numEntries);
+
+/**
+ * Select the profile which is modified by the following Apply calls.
+ * A profile contains the configurations for a single title, which are layered over the global configurations
+ * while the title is running. Profiles are created the first time they are selected here.
+ * 
+ * \note
+ * Select the global profile again once done, other clients expect Apply calls to modify the global configurations.
+ * 
+ * \param handle
+ * A handle obtained by \link Bloopair_Open \endlink.
+ * 
+ * \param titleId
+ * The title ID of the profile or \c 0 for the global profile.
+ * 
+ * \return
+ * \c IOS_ERROR_OK on success.
+ */
+IOSError Bloopair_SetConfigurationProfile(IOSHandle handle, uint64_t titleId);
+
+/**
+ * Switch all controllers to the profile of a title.
+ * Connected controllers switch to the new configuration before their next report,
+ * titles without a profile only use the global configurations.
+ * 
+ * \param handle
+ * A handle obtained by \link Bloopair_Open \endlink.
+ * 
+ * \param titleId
+ * The title ID of the title which is running or \c 0 to only use the global configurations.
+ * 
+ * \return
+ * \c 1 if the title has a profile, \c 0 if it doesn't or an error code.
+ */
+IOSError Bloopair_SelectProfile(IOSHandle handle, uint64_t titleId);
+
 #ifdef __cplusplus
 }
 #endif
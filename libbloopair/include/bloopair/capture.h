@@ -0,0 +1,84 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Capture file format
+ *
+ * All values are big endian.
+ * A capture file starts with a BloopairCaptureFileHeader, followed by a stream of records until the end of the file.
+ * Every record starts with a BloopairCaptureRecordHeader, followed by `length` bytes of payload:
+ * - BLOOPAIR_CAPTURE_TYPE_INPUT: the raw HID report received from the controller, starting with the report id
+ * - BLOOPAIR_CAPTURE_TYPE_OUTPUT: the raw HID report sent to the controller, starting with the report id
+ * - BLOOPAIR_CAPTURE_TYPE_CONNECT: a BloopairCaptureConnectInfo, written when a controller connects
+ *   or when the capture is started for already connected controllers
+ * - BLOOPAIR_CAPTURE_TYPE_DISCONNECT: no payload
+ *
+ * Records are not padded, the stream returned by BLOOPAIR_FUNC_READ_CAPTURE can be appended to the file as is.
+ */
+
+#define BLOOPAIR_CAPTURE_MAGIC      0x42504350 // BPCP
+#define BLOOPAIR_CAPTURE_VERSION    1
+
+typedef enum {
+    BLOOPAIR_CAPTURE_TYPE_INPUT,
+    BLOOPAIR_CAPTURE_TYPE_OUTPUT,
+    BLOOPAIR_CAPTURE_TYPE_CONNECT,
+    BLOOPAIR_CAPTURE_TYPE_DISCONNECT,
+} BloopairCaptureType;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+} BloopairCaptureFileHeader;
+
+typedef struct __attribute__ ((__packed__)) {
+    //! Lower 32-bits of the IOS uptime in microseconds.
+    uint32_t timestamp;
+    uint8_t handle;
+    uint8_t type;
+    uint16_t length;
+} BloopairCaptureRecordHeader;
+
+typedef struct __attribute__ ((__packed__)) {
+    uint8_t controllerType;
+    uint8_t reserved;
+    uint16_t vendor_id;
+    uint16_t product_id;
+    uint8_t bd_address[6];
+} BloopairCaptureConnectInfo;
+
+// structure associated with BLOOPAIR_FUNC_READ_CAPTURE request
+typedef struct {
+    //! Non-zero to start or keep capturing, zero to stop capturing after this read.
+    uint32_t enable;
+    //! Maximum amount of bytes to drain.
+    uint32_t maxSize;
+} BloopairCaptureRequestData;
+
+// structure associated with BLOOPAIR_FUNC_READ_CAPTURE response
+typedef struct {
+    //! Amount of records which were dropped since the last read, due to the buffer being full.
+    uint32_t numLost;
+    uint32_t size;
+    uint8_t data[];
+} BloopairCaptureData;
+
+#define BLOOPAIR_CAPTURE_MAX_READ_SIZE (4096 - sizeof(BloopairCaptureData))
@@ -0,0 +1,165 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "controllers/common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//! Configuration files are named Controller-<controller type name or BDA>.conf
+#define BLOOPAIR_CONFIG_FILENAME_PREFIX "Controller-"
+#define BLOOPAIR_CONFIG_FILENAME_SUFFIX ".conf"
+
+//! Koopair writes a new configuration to a temporary file first, and keeps the previous one as a backup.
+//! A previous file with a checksum mismatch is kept as the old file instead, so it doesn't replace an intact backup.
+//! A temporary file passing the checksum check is used when its configuration is missing.
+#define BLOOPAIR_CONFIG_TEMP_SUFFIX ".tmp"
+#define BLOOPAIR_CONFIG_BACKUP_SUFFIX ".bak"
+#define BLOOPAIR_CONFIG_OLD_SUFFIX ".old"
+
+//! Configuration files written by Koopair start with a comment line holding the size and CRC-32 of the rest of the file,
+//! like <tt>// bloopair-checksum 0000002A 1C291CA3 (remove this line when editing by hand)</tt>.
+//! Since it's a comment the file stays valid JSON, as long as comments are ignored when parsing it.
+#define BLOOPAIR_CONFIG_HEADER_PREFIX "// bloopair-checksum "
+#define BLOOPAIR_CONFIG_HEADER_SUFFIX " (remove this line when editing by hand)\n"
+//! Length of the header line, including the newline.
+#define BLOOPAIR_CONFIG_HEADER_LENGTH (sizeof(BLOOPAIR_CONFIG_HEADER_PREFIX) - 1 + 17 + sizeof(BLOOPAIR_CONFIG_HEADER_SUFFIX) - 1)
+
+typedef enum {
+    //! The file has no checksum header, like files written by hand.
+    BLOOPAIR_CONFIG_CHECK_NO_HEADER,
+    //! The size and checksum match the contents.
+    BLOOPAIR_CONFIG_CHECK_VALID,
+    //! The file was cut off, damaged or edited without removing the header.
+    BLOOPAIR_CONFIG_CHECK_MISMATCH,
+} BloopairConfigCheckResult;
+
+//! Tables of the names used in configuration files.
+typedef enum {
+    //! \c BloopairControllerType names, like \c Switch-Pro.
+    BLOOPAIR_NAMES_CONTROLLER_TYPE,
+    //! \c BloopairProButton names, like \c zl or \c lup.
+    BLOOPAIR_NAMES_BUTTON,
+    //! \c BLOOPAIR_QUIRK_* flag names, like \c noRumble.
+    BLOOPAIR_NAMES_QUIRK,
+    //! \c BloopairActionType names, like \c turbo.
+    BLOOPAIR_NAMES_ACTION_TYPE,
+} BloopairNameTable;
+
+/**
+ * Look up the value of a name.
+ * 
+ * \param table
+ * The table to look the name up in.
+ * 
+ * \param name
+ * The name, doesn't need to be null-terminated.
+ * 
+ * \param length
+ * The length of the name.
+ * 
+ * \param outValue
+ * A pointer to store the value to.
+ * 
+ * \return
+ * Non-zero if the table contains the name.
+ */
+int Bloopair_GetValueFromName(BloopairNameTable table, const char* name, uint32_t length, uint32_t* outValue);
+
+/**
+ * Look up the name of a value.
+ * 
+ * \param table
+ * The table to look the value up in.
+ * 
+ * \param value
+ * The value.
+ * 
+ * \return
+ * The name or \c NULL if the value has no name.
+ */
+const char* Bloopair_GetNameFromValue(BloopairNameTable table, uint32_t value);
+
+/**
+ * Parse a BDA written as 12 uppercase hex characters, like \c AABBCCDDEEFF.
+ * 
+ * \param hex
+ * The characters to parse, doesn't need to be null-terminated.
+ * 
+ * \param length
+ * The amount of characters, must be 12.
+ * 
+ * \param outBda
+ * A pointer to store the 6 bytes of the BDA to.
+ * 
+ * \return
+ * Non-zero on success.
+ */
+int Bloopair_ParseBDA(const char* hex, uint32_t length, uint8_t* outBda);
+
+/**
+ * Parse the name of a configuration file.
+ * 
+ * \param filename
+ * The filename without any directories.
+ * 
+ * \param outType
+ * A pointer to store the controller type to, \c BLOOPAIR_CONTROLLER_INVALID if the configuration is for a BDA.
+ * 
+ * \param outBda
+ * A pointer to store the BDA to, if the configuration is for a BDA.
+ * 
+ * \return
+ * Non-zero if this is the name of a configuration file.
+ */
+int Bloopair_ParseConfigFilename(const char* filename, BloopairControllerType* outType, uint8_t* outBda);
+
+/**
+ * Create the checksum header for the contents of a configuration file.
+ * 
+ * \param data
+ * The contents which follow the header.
+ * 
+ * \param size
+ * The size of the contents.
+ * 
+ * \param outHeader
+ * A buffer of at least \c BLOOPAIR_CONFIG_HEADER_LENGTH + 1 bytes to store the null-terminated header to.
+ */
+void Bloopair_CreateConfigHeader(const void* data, uint32_t size, char* outHeader);
+
+/**
+ * Check a configuration file against its checksum header in a single pass, without parsing it.
+ * 
+ * \param data
+ * The complete file, including the header.
+ * 
+ * \param size
+ * The size of the file.
+ * 
+ * \return
+ * The result of the check.
+ */
+BloopairConfigCheckResult Bloopair_CheckConfigFile(const void* data, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
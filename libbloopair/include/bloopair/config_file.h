@@ -0,0 +1,157 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "config.h"
+#include "devices.h"
+#include "controllers/common.h"
+#include "controllers/switch_controller.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//! The JSON of configuration files is read in a single pass, without building a document first.
+//! Comments are allowed anywhere whitespace is. Unknown fields and fields with the wrong type are ignored,
+//! numbers are only accepted if they're integers which fit into the field.
+
+//! Maximum amount of mapping entries per controller.
+#define BLOOPAIR_MAX_MAPPINGS 255
+
+//! Fields which were present in a configuration file, everything else keeps the defaults of the IOS module.
+enum {
+    //! The \c configuration object.
+    BLOOPAIR_CONFIG_FILE_HAS_COMMON                     = 1 << 0,
+    BLOOPAIR_CONFIG_FILE_HAS_STICK_AS_BUTTON_DEADZONE   = 1 << 1,
+    BLOOPAIR_CONFIG_FILE_HAS_QUIRKS                     = 1 << 2,
+    BLOOPAIR_CONFIG_FILE_HAS_REPORT_INTERVAL            = 1 << 3,
+    BLOOPAIR_CONFIG_FILE_HAS_TRIGGER_THRESHOLD          = 1 << 4,
+    BLOOPAIR_CONFIG_FILE_HAS_TRIGGER_HYSTERESIS         = 1 << 5,
+    //! The \c mapping object.
+    BLOOPAIR_CONFIG_FILE_HAS_MAPPING                    = 1 << 6,
+    //! The \c actions array.
+    BLOOPAIR_CONFIG_FILE_HAS_ACTIONS                    = 1 << 7,
+    //! The \c custom object.
+    BLOOPAIR_CONFIG_FILE_HAS_CUSTOM                     = 1 << 8,
+    BLOOPAIR_CONFIG_FILE_HAS_DISABLE_CALIBRATION        = 1 << 9,
+    BLOOPAIR_CONFIG_FILE_HAS_COMBINE_WITH               = 1 << 10,
+};
+
+//! All fields of the \c configuration object.
+#define BLOOPAIR_CONFIG_FILE_HAS_ALL_COMMON \
+    (BLOOPAIR_CONFIG_FILE_HAS_COMMON | BLOOPAIR_CONFIG_FILE_HAS_STICK_AS_BUTTON_DEADZONE | BLOOPAIR_CONFIG_FILE_HAS_QUIRKS | \
+     BLOOPAIR_CONFIG_FILE_HAS_REPORT_INTERVAL | BLOOPAIR_CONFIG_FILE_HAS_TRIGGER_THRESHOLD | BLOOPAIR_CONFIG_FILE_HAS_TRIGGER_HYSTERESIS)
+
+//! Contents of a controller configuration file.
+typedef struct {
+    //! \c BLOOPAIR_CONFIG_FILE_HAS_* flags.
+    uint32_t fields;
+    //! \c 0 if the file has no version.
+    uint32_t version;
+    //! \c BLOOPAIR_CONTROLLER_INVALID if the controller type is missing or unknown.
+    BloopairControllerType controllerType;
+    //! Only the fields which are flagged are set.
+    BloopairCommonConfiguration common;
+    uint32_t numMappings;
+    BloopairMappingEntry mappings[BLOOPAIR_MAX_MAPPINGS];
+    //! Sequences are followed by their steps, like the IOS module expects them.
+    uint32_t numActions;
+    BloopairActionEntry actions[BLOOPAIR_MAX_ACTIONS];
+    //! Custom configuration of the Switch controller types.
+    uint8_t disableCalibration;
+    uint8_t combineWith[6];
+} BloopairConfigFile;
+
+/**
+ * Called for every valid device of a devices file.
+ */
+typedef void (*BloopairDeviceEntryCallback)(const BloopairDeviceEntry* entry, void* userdata);
+
+/**
+ * Decode a controller configuration file.
+ * Mappings or actions which don't fit into the file, or a sequence without steps leave out the whole section.
+ * 
+ * \param data
+ * The contents of the file, including the checksum header.
+ * 
+ * \param size
+ * The size of the contents.
+ * 
+ * \param outFile
+ * A pointer to store the decoded configuration to.
+ * 
+ * \return
+ * Non-zero if the contents are valid JSON with an object at the top.
+ */
+int Bloopair_DecodeConfigFile(const char* data, uint32_t size, BloopairConfigFile* outFile);
+
+/**
+ * Encode a controller configuration file, without the checksum header.
+ * 
+ * \param file
+ * The configuration, only flagged fields are written.
+ * 
+ * \param out
+ * The buffer to write the null-terminated JSON to, can be \c NULL if \p size is \c 0.
+ * 
+ * \param size
+ * The size of the buffer.
+ * 
+ * \return
+ * The length of the JSON without the null-terminator, the output was cut off if this isn't less than \p size.
+ */
+uint32_t Bloopair_EncodeConfigFile(const BloopairConfigFile* file, char* out, uint32_t size);
+
+/**
+ * Overwrite the common configuration fields which were present in a configuration file.
+ */
+void Bloopair_ApplyConfigFileCommon(const BloopairConfigFile* file, BloopairCommonConfiguration* config);
+
+/**
+ * Overwrite the Switch configuration fields which were present in a configuration file.
+ */
+void Bloopair_ApplyConfigFileSwitch(const BloopairConfigFile* file, SwitchConfiguration* config);
+
+/**
+ * Decode the devices file, which adds entries to the device registry.
+ * Devices with an invalid vendor id, product id or controller type are skipped.
+ * 
+ * \param data
+ * The contents of the file.
+ * 
+ * \param size
+ * The size of the contents.
+ * 
+ * \param outVersion
+ * A pointer to store the version of the file to, \c 0 if the file has no version.
+ * 
+ * \param callback
+ * Called for every valid device, in the order they appear in the file.
+ * 
+ * \param userdata
+ * Passed to the callback.
+ * 
+ * \return
+ * Non-zero if the contents are valid JSON with a \c devices array.
+ */
+int Bloopair_DecodeDevicesFile(const char* data, uint32_t size, uint32_t* outVersion, BloopairDeviceEntryCallback callback, void* userdata);
+
+#ifdef __cplusplus
+}
+#endif
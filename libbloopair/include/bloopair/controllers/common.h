@@ -36,6 +36,8 @@ typedef enum {
     BLOOPAIR_CONTROLLER_SWITCH_N64,
 
     BLOOPAIR_CONTROLLER_XBOX_ONE             = 0x30,
+
+    BLOOPAIR_CONTROLLER_GENERIC_HID          = 0x40,
 } BloopairControllerType;
 
 //! Bloopair Pro Controller buttons.
@@ -88,11 +90,30 @@ enum BloopairProButton {
     BLOOPAIR_PRO_STICK_R_LEFT,
     BLOOPAIR_PRO_STICK_R_RIGHT,
 
+    //! These aren't part of the button bitfield and only exist for mapping analog triggers.
+    //! As a source they're the analog triggers of the controller, as a target they're
+    //! reported as ZL / ZR once they pass the trigger threshold.
+    BLOOPAIR_PRO_ANALOG_MIN = 40,
+    BLOOPAIR_PRO_ANALOG_TRIGGER_L = BLOOPAIR_PRO_ANALOG_MIN,
+    BLOOPAIR_PRO_ANALOG_TRIGGER_R,
+
     BLOOPAIR_PRO_BUTTON_MAX,
 };
 
+//! Full range of the analog trigger channels.
+#define BLOOPAIR_TRIGGER_MAX 0x3ff
+
 typedef struct {
     uint16_t stickAsButtonDeadzone;
+    //! Report rate hint in milliseconds, overrides the hint of the device registry if not \c 0.
+    uint8_t reportInterval;
+    uint8_t reserved;
+    //! \c BLOOPAIR_QUIRK_* flags, which are added to the flags of the device registry.
+    uint32_t quirks;
+    //! Analog trigger value at which a trigger mapped to a button is pressed.
+    uint16_t triggerThreshold;
+    //! How far below the threshold a pressed trigger needs to go to be released again.
+    uint16_t triggerHysteresis;
 } BloopairCommonConfiguration;
 
 typedef struct {
@@ -102,10 +123,43 @@ typedef struct {
     uint8_t to;
 } BloopairMappingEntry;
 
+//! Bloopair mapping action types.
+typedef enum {
+    //! Presses \c buttons at \c param times per second while all \c trigger buttons are held.
+    BLOOPAIR_ACTION_TURBO,
+    //! Pressing all \c trigger buttons turns \c buttons on or off.
+    BLOOPAIR_ACTION_TOGGLE,
+    //! Holding all \c trigger buttons at once presses \c buttons instead.
+    BLOOPAIR_ACTION_CHORD,
+    //! Pressing all \c trigger buttons plays the \c param entries following this one.
+    BLOOPAIR_ACTION_SEQUENCE,
+    //! A step of a sequence, which presses \c buttons for \c param 10ms ticks.
+    BLOOPAIR_ACTION_SEQUENCE_STEP,
+} BloopairActionType;
+
+//! Maximum amount of actions per controller.
+#define BLOOPAIR_MAX_ACTIONS 64
+
+//! Actions run on the buttons after mapping, so \c trigger and \c buttons are \c BloopairProButton bits.
+typedef struct {
+    //! One of the \c BloopairActionType s
+    uint8_t type;
+    //! Depends on the type
+    uint8_t param;
+    uint16_t reserved;
+    //! Buttons which start the action, unused for sequence steps
+    uint32_t trigger;
+    //! Buttons pressed by the action
+    uint32_t buttons;
+} BloopairActionEntry;
+
 typedef struct {
     uint32_t buttons;
     int16_t left_stick_x;
     int16_t right_stick_x;
     int16_t left_stick_y;
     int16_t right_stick_y;
+    //! Analog triggers from \c 0 to \c BLOOPAIR_TRIGGER_MAX, \c 0 for controllers without them.
+    uint16_t left_trigger;
+    uint16_t right_trigger;
 } BloopairReportBuffer;
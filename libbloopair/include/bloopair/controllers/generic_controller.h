@@ -0,0 +1,46 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "common.h"
+
+// Buttons for controllers handled by the generic HID driver.
+// GENERIC_BUTTON_1 - GENERIC_BUTTON_16 match usages 1 - 16 of the HID button page.
+enum {
+    GENERIC_BUTTON_1,
+    GENERIC_BUTTON_2,
+    GENERIC_BUTTON_3,
+    GENERIC_BUTTON_4,
+    GENERIC_BUTTON_5,
+    GENERIC_BUTTON_6,
+    GENERIC_BUTTON_7,
+    GENERIC_BUTTON_8,
+    GENERIC_BUTTON_9,
+    GENERIC_BUTTON_10,
+    GENERIC_BUTTON_11,
+    GENERIC_BUTTON_12,
+    GENERIC_BUTTON_13,
+    GENERIC_BUTTON_14,
+    GENERIC_BUTTON_15,
+    GENERIC_BUTTON_16,
+
+    // Mapped from the hat switch
+    GENERIC_BUTTON_UP,
+    GENERIC_BUTTON_RIGHT,
+    GENERIC_BUTTON_DOWN,
+    GENERIC_BUTTON_LEFT,
+};
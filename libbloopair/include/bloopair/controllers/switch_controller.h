@@ -53,4 +53,6 @@ enum {
 
 typedef struct {
     uint8_t disableCalibration;
+    //! Address of the Joy-Con this Joy-Con should always be combined with, all zeroes if unset.
+    uint8_t combineWith[6];
 } SwitchConfiguration;
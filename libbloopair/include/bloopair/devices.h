@@ -0,0 +1,54 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+
+//! Device quirks, which make drivers skip or change parts of the controller setup.
+enum {
+    //! Don't read the stick calibration from the controller and use default values instead.
+    BLOOPAIR_QUIRK_SKIP_CALIBRATION     = 1 << 0,
+    //! Drop the first input report, which contains invalid data on some controllers.
+    BLOOPAIR_QUIRK_DROP_FIRST_REPORT    = 1 << 1,
+    //! Don't switch the controller to full reports and keep using basic reports.
+    BLOOPAIR_QUIRK_FORCE_BASIC_REPORT   = 1 << 2,
+    //! The controller doesn't support rumble.
+    BLOOPAIR_QUIRK_NO_RUMBLE            = 1 << 3,
+    //! The controller doesn't support player LEDs.
+    BLOOPAIR_QUIRK_NO_LED               = 1 << 4,
+};
+
+//! An entry of the device registry, which selects the driver for a VID/PID.
+typedef struct {
+    uint16_t vendor_id;
+    uint16_t product_id;
+    //! Controller type of the driver to use, any Switch controller type selects the Switch driver.
+    uint8_t controllerType;
+    //! Report rate hint, the interval in milliseconds in which the controller sends reports or \c 0 if unknown.
+    uint8_t reportInterval;
+    uint8_t reserved[2];
+    //! \c BLOOPAIR_QUIRK_* flags for this device.
+    uint32_t quirks;
+} BloopairDeviceEntry;
+
+// structure associated with BLOOPAIR_FUNC_ADD_DEVICE_ENTRIES
+typedef struct {
+    uint32_t numEntries;
+    BloopairDeviceEntry entries[];
+} BloopairAddDeviceEntriesData;
+
+#define BLOOPAIR_MAX_DEVICE_ENTRIES_PER_REQUEST ((4096 - sizeof(BloopairAddDeviceEntriesData)) / sizeof(BloopairDeviceEntry))
@@ -18,6 +18,9 @@
 #pragma once
 
 #include <stdint.h>
+#include "trace.h"
+#include "capture.h"
+#include "devices.h"
 
 #define BLOOPAIR_LIB 0x10
 
@@ -33,6 +36,15 @@
 #define BLOOPAIR_FUNC_GET_CONTROLLER_CONFIG         9
 #define BLOOPAIR_FUNC_GET_CONTROLLER_MAPPING        10
 #define BLOOPAIR_FUNC_GET_CUSTOM_CONFIGURATION      11
+#define BLOOPAIR_FUNC_READ_TRACE                    12
+#define BLOOPAIR_FUNC_READ_CAPTURE                  13
+#define BLOOPAIR_FUNC_ADD_DEVICE_ENTRIES            14
+#define BLOOPAIR_FUNC_APPLY_CONTROLLER_ACTIONS      15
+#define BLOOPAIR_FUNC_GET_CONTROLLER_ACTIONS        16
+#define BLOOPAIR_FUNC_SET_CONFIGURATION_PROFILE     17
+#define BLOOPAIR_FUNC_SELECT_PROFILE                18
+#define BLOOPAIR_FUNC_GET_CONTROLLER_STATISTICS     19
+#define BLOOPAIR_FUNC_READ_ACCUMULATED_RAW_REPORT   20
 
 #define BLOOPAIR_VERSION_MAJOR(v) (((v) >> 16) & 0xff)
 #define BLOOPAIR_VERSION_MINOR(v) (((v) >> 8) & 0xff)
@@ -73,18 +85,52 @@ typedef struct {
 // - BLOOPAIR_FUNC_GET_CONTROLLER_CONFIG
 // - BLOOPAIR_FUNC_GET_CONTROLLER_MAPPING
 // - BLOOPAIR_FUNC_GET_CUSTOM_CONFIGURATION
+// - BLOOPAIR_FUNC_GET_CONTROLLER_ACTIONS
+// - BLOOPAIR_FUNC_GET_CONTROLLER_STATISTICS
 typedef struct {
     uint8_t handle;
     uint8_t controllerType;
 } BloopairControllerRequestData;
 
+// structure associated with BLOOPAIR_FUNC_READ_ACCUMULATED_RAW_REPORT
+typedef struct {
+    uint8_t handle;
+    // keep accumulating after this read
+    uint8_t enable;
+} BloopairAccumulatedReportRequestData;
+
+// structure associated with BLOOPAIR_FUNC_GET_CONTROLLER_STATISTICS
+// All times are in microseconds, the counters only ever increase and wrap around
+typedef struct {
+    // IOS uptime at the time the statistics were read
+    uint64_t uptime;
+    // amount of HID reports received from the controller
+    uint32_t numReceived;
+    // amount of reports sent to padscore
+    uint32_t numSent;
+    // sum of the time between receiving a HID report and sending its data to padscore
+    uint32_t latencyTotal;
+    // amount of sent reports which are included in latencyTotal
+    uint32_t latencyCount;
+    // highest latency since the statistics were last read
+    uint32_t latencyMax;
+} BloopairControllerStatisticsData;
+
 // structure associated with
 // - BLOOPAIR_FUNC_APPLY_CONTROLLER_CONFIG
 // - BLOOPAIR_FUNC_APPLY_CONTROLLER_MAPPING
 // - BLOOPAIR_FUNC_APPLY_CUSTOM_CONFIGURATION
+// - BLOOPAIR_FUNC_APPLY_CONTROLLER_ACTIONS
 typedef struct {
     uint8_t controllerType;
     uint8_t bd_address[6];
     uint32_t dataSize;
     uint8_t data[];
 } BloopairApplyControllerConfigurationData;
+
+// structure associated with
+// - BLOOPAIR_FUNC_SET_CONFIGURATION_PROFILE
+// - BLOOPAIR_FUNC_SELECT_PROFILE
+typedef struct {
+    uint64_t titleId;
+} BloopairProfileData;
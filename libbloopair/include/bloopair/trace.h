@@ -0,0 +1,82 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+
+// The upper nibble of an event id selects its category
+#define BLOOPAIR_TRACE_EVENT_CATEGORY(event) (1u << ((event) >> 4))
+
+#define BLOOPAIR_TRACE_CATEGORY_SMD     BLOOPAIR_TRACE_EVENT_CATEGORY(0x00)
+#define BLOOPAIR_TRACE_CATEGORY_HH      BLOOPAIR_TRACE_EVENT_CATEGORY(0x10)
+#define BLOOPAIR_TRACE_CATEGORY_SWITCH  BLOOPAIR_TRACE_EVENT_CATEGORY(0x20)
+#define BLOOPAIR_TRACE_CATEGORY_ALL     0xffffffff
+
+enum {
+    //! arg0: message length, arg1: report id
+    BLOOPAIR_TRACE_EVENT_SMD_OUTPUT             = 0x00,
+
+    //! arg0: event, arg1: event data pointer
+    BLOOPAIR_TRACE_EVENT_HH_EVENT               = 0x10,
+    //! arg0: status, arg1: initController result
+    BLOOPAIR_TRACE_EVENT_HH_OPEN,
+    //! arg0: status
+    BLOOPAIR_TRACE_EVENT_HH_CLOSE,
+    //! no args
+    BLOOPAIR_TRACE_EVENT_HH_VC_UNPLUG,
+
+    //! arg0: subcommand, arg1: ack
+    BLOOPAIR_TRACE_EVENT_SWITCH_SUBCMD_RESPONSE = 0x20,
+    //! arg0: subcommand, arg1: ack
+    BLOOPAIR_TRACE_EVENT_SWITCH_SUBCMD_FAILED,
+    //! arg0: device type
+    BLOOPAIR_TRACE_EVENT_SWITCH_DEVICE_TYPE,
+    //! arg0: size, arg1: SPI address
+    BLOOPAIR_TRACE_EVENT_SWITCH_SPI_READ,
+    //! arg0: subcommand, arg1: packet counter of the previous attempt
+    BLOOPAIR_TRACE_EVENT_SWITCH_SUBCMD_RETRY,
+    //! arg0: subcommand, arg1: packet counter of the last attempt
+    BLOOPAIR_TRACE_EVENT_SWITCH_SUBCMD_TIMEOUT,
+};
+
+//! A single trace record, stored in big endian.
+typedef struct {
+    //! Lower 32-bits of the IOS uptime in microseconds.
+    uint32_t timestamp;
+    uint8_t event;
+    uint8_t handle;
+    uint16_t arg0;
+    uint32_t arg1;
+} BloopairTraceRecord;
+
+// structure associated with BLOOPAIR_FUNC_READ_TRACE request
+typedef struct {
+    //! Categories which should be recorded from now on.
+    uint32_t enableMask;
+    //! Maximum amount of records to drain.
+    uint32_t maxRecords;
+} BloopairTraceRequestData;
+
+// structure associated with BLOOPAIR_FUNC_READ_TRACE response
+typedef struct {
+    //! Amount of records which were overwritten or dropped since the last read.
+    uint32_t numLost;
+    uint32_t numRecords;
+    BloopairTraceRecord records[];
+} BloopairTraceData;
+
+#define BLOOPAIR_TRACE_MAX_RECORDS_PER_READ ((4096 - sizeof(BloopairTraceData)) / sizeof(BloopairTraceRecord))
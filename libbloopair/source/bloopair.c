@@ -186,6 +186,31 @@ IOSError Bloopair_GetControllerInformation(IOSHandle handle, WPADChan chan, Bloo
     return res;
 }
 
+IOSError Bloopair_GetControllerStatistics(IOSHandle handle, WPADChan chan, BloopairControllerStatisticsData* data)
+{
+    BtrmIoctlv* ioctlv = allocBtrmIoctlv(BLOOPAIR_LIB, BLOOPAIR_FUNC_GET_CONTROLLER_STATISTICS);
+    if (!ioctlv) {
+        return IOS_ERROR_FAILALLOC;
+    }
+
+    BloopairControllerRequestData* request = (BloopairControllerRequestData*) ioctlv->request.data;
+    request->handle = getHandleForChannel(chan);
+
+    IOSError res = executeBtrmIoctlv(handle, ioctlv);
+    if (res >= 0) {
+        if (res == sizeof(*data)) {
+            memcpy(data, ioctlv->response.data, res);
+            res = IOS_ERROR_OK;
+        } else {
+            res = IOS_ERROR_INVALIDSIZE;
+        }
+    }
+
+    freeBtrmIoctlv(ioctlv);
+
+    return res;
+}
+
 IOSError Bloopair_ReadRawReport(IOSHandle handle, WPADChan chan, BloopairReportBuffer* outReport)
 {
     BtrmIoctlv* ioctlv = allocBtrmIoctlv(BLOOPAIR_LIB, BLOOPAIR_FUNC_READ_RAW_REPORT);
@@ -211,6 +236,32 @@ IOSError Bloopair_ReadRawReport(IOSHandle handle, WPADChan chan, BloopairReportB
     return res;
 }
 
+IOSError Bloopair_ReadAccumulatedRawReport(IOSHandle handle, WPADChan chan, BOOL enable, BloopairReportBuffer* outReport)
+{
+    BtrmIoctlv* ioctlv = allocBtrmIoctlv(BLOOPAIR_LIB, BLOOPAIR_FUNC_READ_ACCUMULATED_RAW_REPORT);
+    if (!ioctlv) {
+        return IOS_ERROR_FAILALLOC;
+    }
+
+    BloopairAccumulatedReportRequestData* request = (BloopairAccumulatedReportRequestData*) ioctlv->request.data;
+    request->handle = getHandleForChannel(chan);
+    request->enable = enable ? 1 : 0;
+
+    IOSError res = executeBtrmIoctlv(handle, ioctlv);
+    if (res >= 0) {
+        if (res == sizeof(*outReport)) {
+            memcpy(outReport, ioctlv->response.data, res);
+            res = IOS_ERROR_OK;
+        } else {
+            res = IOS_ERROR_INVALIDSIZE;
+        }
+    }
+
+    freeBtrmIoctlv(ioctlv);
+
+    return res;
+}
+
 static IOSError _Bloopair_ApplyControllerConfiguration(IOSHandle handle, BloopairControllerType controllerType, const uint8_t* bda, const BloopairCommonConfiguration* commonConfiguration)
 {
     BtrmIoctlv* ioctlv = allocBtrmIoctlv(BLOOPAIR_LIB, BLOOPAIR_FUNC_APPLY_CONTROLLER_CONFIG);
@@ -305,6 +356,57 @@ IOSError Bloopair_ApplyControllerMappingForControllerType(IOSHandle handle, Bloo
     return _Bloopair_ApplyControllerMapping(handle, controllerType, NULL, mappings, numMappings);
 }
 
+static IOSError _Bloopair_ApplyControllerActions(IOSHandle handle, BloopairControllerType controllerType, const uint8_t* bda, const BloopairActionEntry* actions, uint8_t numActions)
+{
+    if (numActions > BLOOPAIR_MAX_ACTIONS) {
+        return IOS_ERROR_INVALIDARG;
+    }
+
+    BtrmIoctlv* ioctlv = allocBtrmIoctlv(BLOOPAIR_LIB, BLOOPAIR_FUNC_APPLY_CONTROLLER_ACTIONS);
+    if (!ioctlv) {
+        return IOS_ERROR_FAILALLOC;
+    }
+
+    BloopairApplyControllerConfigurationData* configData = (BloopairApplyControllerConfigurationData*) ioctlv->request.data;
+    configData->controllerType = controllerType;
+    if (bda) {
+        memcpy(configData->bd_address, bda, 6);
+    } else {
+        memset(configData->bd_address, 0, 6);
+    }
+
+    if (actions) {
+        configData->dataSize = numActions * sizeof(*actions);
+        memcpy(configData->data, actions, configData->dataSize);
+    } else {
+        configData->dataSize = 0;
+    }
+
+    IOSError res = executeBtrmIoctlv(handle, ioctlv);
+
+    freeBtrmIoctlv(ioctlv);
+
+    return res;
+}
+
+IOSError Bloopair_ApplyControllerActionsForBDA(IOSHandle handle, const uint8_t* bda, const BloopairActionEntry* actions, uint8_t numActions)
+{
+    if (!bda) {
+        return IOS_ERROR_INVALIDARG;
+    }
+
+    return _Bloopair_ApplyControllerActions(handle, BLOOPAIR_CONTROLLER_INVALID, bda, actions, numActions);
+}
+
+IOSError Bloopair_ApplyControllerActionsForControllerType(IOSHandle handle, BloopairControllerType controllerType, const BloopairActionEntry* actions, uint8_t numActions)
+{
+    if (controllerType == BLOOPAIR_CONTROLLER_INVALID) {
+        return IOS_ERROR_INVALIDARG;
+    }
+
+    return _Bloopair_ApplyControllerActions(handle, controllerType, NULL, actions, numActions);
+}
+
 static IOSError _Bloopair_ApplyCustomConfiguration(IOSHandle handle, BloopairControllerType controllerType, const uint8_t* bda, const void* customConfiguration, uint32_t size)
 {
     BtrmIoctlv* ioctlv = allocBtrmIoctlv(BLOOPAIR_LIB, BLOOPAIR_FUNC_APPLY_CUSTOM_CONFIGURATION);
@@ -439,6 +541,35 @@ IOSError Bloopair_GetDefaultControllerMapping(IOSHandle handle, BloopairControll
     return _Bloopair_GetControllerMapping(handle, controllerType, WPAD_CHAN_0, outMappings, outNumMappings);
 }
 
+IOSError Bloopair_GetControllerActions(IOSHandle handle, WPADChan chan, BloopairActionEntry* outActions, uint8_t* outNumActions)
+{
+    BtrmIoctlv* ioctlv = allocBtrmIoctlv(BLOOPAIR_LIB, BLOOPAIR_FUNC_GET_CONTROLLER_ACTIONS);
+    if (!ioctlv) {
+        return IOS_ERROR_FAILALLOC;
+    }
+
+    BloopairControllerRequestData* request = (BloopairControllerRequestData*) ioctlv->request.data;
+    request->controllerType = BLOOPAIR_CONTROLLER_INVALID;
+    request->handle = getHandleForChannel(chan);
+
+    IOSError res = executeBtrmIoctlv(handle, ioctlv);
+    if (res >= 0) {
+        if (outNumActions) {
+            if (outActions && *outNumActions >= res) {
+                memcpy(outActions, ioctlv->response.data, sizeof(*outActions) * res);
+            }
+
+            *outNumActions = res;
+        }
+
+        res = IOS_ERROR_OK;
+    }
+
+    freeBtrmIoctlv(ioctlv);
+
+    return res;
+}
+
 static IOSError _Bloopair_GetCustomConfiguration(IOSHandle handle, BloopairControllerType controllerType, WPADChan chan, void* outCustom, uint32_t* outSize)
 {
     BtrmIoctlv* ioctlv = allocBtrmIoctlv(BLOOPAIR_LIB, BLOOPAIR_FUNC_GET_CUSTOM_CONFIGURATION);
@@ -483,3 +614,129 @@ IOSError Bloopair_GetDefaultCustomConfiguration(IOSHandle handle, BloopairContro
 
     return _Bloopair_GetCustomConfiguration(handle, controllerType, WPAD_CHAN_0, outCustom, outSize);
 }
+
+IOSError Bloopair_ReadTrace(IOSHandle handle, uint32_t enableMask, BloopairTraceRecord* outRecords, uint32_t* outNumRecords, uint32_t* outNumLost)
+{
+    if (!outRecords || !outNumRecords) {
+        return IOS_ERROR_INVALIDARG;
+    }
+
+    BtrmIoctlv* ioctlv = allocBtrmIoctlv(BLOOPAIR_LIB, BLOOPAIR_FUNC_READ_TRACE);
+    if (!ioctlv) {
+        return IOS_ERROR_FAILALLOC;
+    }
+
+    BloopairTraceRequestData* request = (BloopairTraceRequestData*) ioctlv->request.data;
+    request->enableMask = enableMask;
+    request->maxRecords = *outNumRecords;
+    if (request->maxRecords > BLOOPAIR_TRACE_MAX_RECORDS_PER_READ) {
+        request->maxRecords = BLOOPAIR_TRACE_MAX_RECORDS_PER_READ;
+    }
+
+    IOSError res = executeBtrmIoctlv(handle, ioctlv);
+    if (res >= 0) {
+        BloopairTraceData* data = (BloopairTraceData*) ioctlv->response.data;
+        memcpy(outRecords, data->records, data->numRecords * sizeof(*outRecords));
+        *outNumRecords = data->numRecords;
+        if (outNumLost) {
+            *outNumLost = data->numLost;
+        }
+
+        res = IOS_ERROR_OK;
+    }
+
+    freeBtrmIoctlv(ioctlv);
+
+    return res;
+}
+
+IOSError Bloopair_ReadCapture(IOSHandle handle, BOOL enable, void* outData, uint32_t* outSize, uint32_t* outNumLost)
+{
+    if (!outData || !outSize) {
+        return IOS_ERROR_INVALIDARG;
+    }
+
+    BtrmIoctlv* ioctlv = allocBtrmIoctlv(BLOOPAIR_LIB, BLOOPAIR_FUNC_READ_CAPTURE);
+    if (!ioctlv) {
+        return IOS_ERROR_FAILALLOC;
+    }
+
+    BloopairCaptureRequestData* request = (BloopairCaptureRequestData*) ioctlv->request.data;
+    request->enable = enable;
+    request->maxSize = *outSize;
+    if (request->maxSize > BLOOPAIR_CAPTURE_MAX_READ_SIZE) {
+        request->maxSize = BLOOPAIR_CAPTURE_MAX_READ_SIZE;
+    }
+
+    IOSError res = executeBtrmIoctlv(handle, ioctlv);
+    if (res >= 0) {
+        BloopairCaptureData* data = (BloopairCaptureData*) ioctlv->response.data;
+        memcpy(outData, data->data, data->size);
+        *outSize = data->size;
+        if (outNumLost) {
+            *outNumLost = data->numLost;
+        }
+
+        res = IOS_ERROR_OK;
+    }
+
+    freeBtrmIoctlv(ioctlv);
+
+    return res;
+}
+
+IOSError Bloopair_AddDeviceEntries(IOSHandle handle, const BloopairDeviceEntry* entries, uint32_t numEntries)
+{
+    if (!entries || numEntries > BLOOPAIR_MAX_DEVICE_ENTRIES_PER_REQUEST) {
+        return IOS_ERROR_INVALIDARG;
+    }
+
+    BtrmIoctlv* ioctlv = allocBtrmIoctlv(BLOOPAIR_LIB, BLOOPAIR_FUNC_ADD_DEVICE_ENTRIES);
+    if (!ioctlv) {
+        return IOS_ERROR_FAILALLOC;
+    }
+
+    BloopairAddDeviceEntriesData* data = (BloopairAddDeviceEntriesData*) ioctlv->request.data;
+    data->numEntries = numEntries;
+    memcpy(data->entries, entries, numEntries * sizeof(*entries));
+
+    IOSError res = executeBtrmIoctlv(handle, ioctlv);
+
+    freeBtrmIoctlv(ioctlv);
+
+    return res;
+}
+
+IOSError Bloopair_SetConfigurationProfile(IOSHandle handle, uint64_t titleId)
+{
+    BtrmIoctlv* ioctlv = allocBtrmIoctlv(BLOOPAIR_LIB, BLOOPAIR_FUNC_SET_CONFIGURATION_PROFILE);
+    if (!ioctlv) {
+        return IOS_ERROR_FAILALLOC;
+    }
+
+    BloopairProfileData* data = (BloopairProfileData*) ioctlv->request.data;
+    data->titleId = titleId;
+
+    IOSError res = executeBtrmIoctlv(handle, ioctlv);
+
+    freeBtrmIoctlv(ioctlv);
+
+    return res;
+}
+
+IOSError Bloopair_SelectProfile(IOSHandle handle, uint64_t titleId)
+{
+    BtrmIoctlv* ioctlv = allocBtrmIoctlv(BLOOPAIR_LIB, BLOOPAIR_FUNC_SELECT_PROFILE);
+    if (!ioctlv) {
+        return IOS_ERROR_FAILALLOC;
+    }
+
+    BloopairProfileData* data = (BloopairProfileData*) ioctlv->request.data;
+    data->titleId = titleId;
+
+    IOSError res = executeBtrmIoctlv(handle, ioctlv);
+
+    freeBtrmIoctlv(ioctlv);
+
+    return res;
+}
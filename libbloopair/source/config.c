@@ -0,0 +1,291 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bloopair/config.h"
+#include "bloopair/devices.h"
+
+#include <string.h>
+
+typedef struct {
+    const char* name;
+    uint32_t value;
+} BloopairName;
+
+// All tables are sorted by name, so names can be binary searched
+static const BloopairName controller_type_names[] = {
+    { "DualSense",           BLOOPAIR_CONTROLLER_DUALSENSE },
+    { "DualShock-3",         BLOOPAIR_CONTROLLER_DUALSHOCK3 },
+    { "DualShock-4",         BLOOPAIR_CONTROLLER_DUALSHOCK4 },
+    { "Generic-HID",         BLOOPAIR_CONTROLLER_GENERIC_HID },
+    { "Switch-Generic",      BLOOPAIR_CONTROLLER_SWITCH_GENERIC },
+    { "Switch-JoyCon-Dual",  BLOOPAIR_CONTROLLER_SWITCH_JOYCON_DUAL },
+    { "Switch-JoyCon-Left",  BLOOPAIR_CONTROLLER_SWITCH_JOYCON_LEFT },
+    { "Switch-JoyCon-Right", BLOOPAIR_CONTROLLER_SWITCH_JOYCON_RIGHT },
+    { "Switch-N64",          BLOOPAIR_CONTROLLER_SWITCH_N64 },
+    { "Switch-Pro",          BLOOPAIR_CONTROLLER_SWITCH_PRO },
+    { "Xbox-One",            BLOOPAIR_CONTROLLER_XBOX_ONE },
+};
+
+static const BloopairName button_names[] = {
+    { "a",        BLOOPAIR_PRO_BUTTON_A },
+    { "b",        BLOOPAIR_PRO_BUTTON_B },
+    { "down",     BLOOPAIR_PRO_BUTTON_DOWN },
+    { "home",     BLOOPAIR_PRO_BUTTON_HOME },
+    { "l",        BLOOPAIR_PRO_TRIGGER_L },
+    { "ldown",    BLOOPAIR_PRO_STICK_L_DOWN },
+    { "left",     BLOOPAIR_PRO_BUTTON_LEFT },
+    { "lleft",    BLOOPAIR_PRO_STICK_L_LEFT },
+    { "lright",   BLOOPAIR_PRO_STICK_L_RIGHT },
+    { "lstick",   BLOOPAIR_PRO_BUTTON_STICK_L },
+    { "ltrigger", BLOOPAIR_PRO_ANALOG_TRIGGER_L },
+    { "lup",      BLOOPAIR_PRO_STICK_L_UP },
+    { "minus",    BLOOPAIR_PRO_BUTTON_MINUS },
+    { "plus",     BLOOPAIR_PRO_BUTTON_PLUS },
+    { "r",        BLOOPAIR_PRO_TRIGGER_R },
+    { "rdown",    BLOOPAIR_PRO_STICK_R_DOWN },
+    { "reserved", BLOOPAIR_PRO_RESERVED },
+    { "right",    BLOOPAIR_PRO_BUTTON_RIGHT },
+    { "rleft",    BLOOPAIR_PRO_STICK_R_LEFT },
+    { "rright",   BLOOPAIR_PRO_STICK_R_RIGHT },
+    { "rrup",     BLOOPAIR_PRO_STICK_R_UP },
+    { "rstick",   BLOOPAIR_PRO_BUTTON_STICK_R },
+    { "rtrigger", BLOOPAIR_PRO_ANALOG_TRIGGER_R },
+    { "up",       BLOOPAIR_PRO_BUTTON_UP },
+    { "x",        BLOOPAIR_PRO_BUTTON_X },
+    { "y",        BLOOPAIR_PRO_BUTTON_Y },
+    { "zl",       BLOOPAIR_PRO_TRIGGER_ZL },
+    { "zr",       BLOOPAIR_PRO_TRIGGER_ZR },
+};
+
+static const BloopairName quirk_names[] = {
+    { "dropFirstReport",  BLOOPAIR_QUIRK_DROP_FIRST_REPORT },
+    { "forceBasicReport", BLOOPAIR_QUIRK_FORCE_BASIC_REPORT },
+    { "noLed",            BLOOPAIR_QUIRK_NO_LED },
+    { "noRumble",         BLOOPAIR_QUIRK_NO_RUMBLE },
+    { "skipCalibration",  BLOOPAIR_QUIRK_SKIP_CALIBRATION },
+};
+
+static const BloopairName action_type_names[] = {
+    { "chord",    BLOOPAIR_ACTION_CHORD },
+    { "sequence", BLOOPAIR_ACTION_SEQUENCE },
+    { "toggle",   BLOOPAIR_ACTION_TOGGLE },
+    { "turbo",    BLOOPAIR_ACTION_TURBO },
+};
+
+static const struct {
+    const BloopairName* names;
+    uint32_t num;
+} name_tables[] = {
+    [BLOOPAIR_NAMES_CONTROLLER_TYPE]    = { controller_type_names, sizeof(controller_type_names) / sizeof(controller_type_names[0]) },
+    [BLOOPAIR_NAMES_BUTTON]             = { button_names, sizeof(button_names) / sizeof(button_names[0]) },
+    [BLOOPAIR_NAMES_QUIRK]              = { quirk_names, sizeof(quirk_names) / sizeof(quirk_names[0]) },
+    [BLOOPAIR_NAMES_ACTION_TYPE]        = { action_type_names, sizeof(action_type_names) / sizeof(action_type_names[0]) },
+};
+
+static int compareName(const char* entry, const char* name, uint32_t length)
+{
+    int res = strncmp(entry, name, length);
+    if (res != 0) {
+        return res;
+    }
+
+    // entry starts with name, it's only equal if it ends there as well
+    return entry[length] != '\0';
+}
+
+int Bloopair_GetValueFromName(BloopairNameTable table, const char* name, uint32_t length, uint32_t* outValue)
+{
+    if ((uint32_t) table >= sizeof(name_tables) / sizeof(name_tables[0])) {
+        return 0;
+    }
+
+    const BloopairName* names = name_tables[table].names;
+    uint32_t lo = 0;
+    uint32_t hi = name_tables[table].num;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        int res = compareName(names[mid].name, name, length);
+        if (res == 0) {
+            *outValue = names[mid].value;
+            return 1;
+        }
+
+        if (res < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return 0;
+}
+
+const char* Bloopair_GetNameFromValue(BloopairNameTable table, uint32_t value)
+{
+    if ((uint32_t) table >= sizeof(name_tables) / sizeof(name_tables[0])) {
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < name_tables[table].num; i++) {
+        if (name_tables[table].names[i].value == value) {
+            return name_tables[table].names[i].name;
+        }
+    }
+
+    return NULL;
+}
+
+static int hexCharToInt(char c)
+{
+    // Only uppercase hex characters are supported
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+
+    return -1;
+}
+
+int Bloopair_ParseBDA(const char* hex, uint32_t length, uint8_t* outBda)
+{
+    // Need exactly 12 hex characters for a bda
+    if (length != 12) {
+        return 0;
+    }
+
+    uint8_t bda[6];
+    for (uint32_t i = 0; i < 6; i++) {
+        int hi = hexCharToInt(hex[i * 2]);
+        int lo = hexCharToInt(hex[i * 2 + 1]);
+        if (hi < 0 || lo < 0) {
+            return 0;
+        }
+
+        bda[i] = hi << 4 | lo;
+    }
+
+    memcpy(outBda, bda, sizeof(bda));
+    return 1;
+}
+
+int Bloopair_ParseConfigFilename(const char* filename, BloopairControllerType* outType, uint8_t* outBda)
+{
+    const uint32_t prefixLength = sizeof(BLOOPAIR_CONFIG_FILENAME_PREFIX) - 1;
+    const uint32_t suffixLength = sizeof(BLOOPAIR_CONFIG_FILENAME_SUFFIX) - 1;
+
+    uint32_t length = strlen(filename);
+    if (length <= prefixLength + suffixLength ||
+        memcmp(filename, BLOOPAIR_CONFIG_FILENAME_PREFIX, prefixLength) != 0 ||
+        memcmp(filename + length - suffixLength, BLOOPAIR_CONFIG_FILENAME_SUFFIX, suffixLength) != 0) {
+        return 0;
+    }
+
+    // The part in between is either the name of a controller type or a bda
+    const char* name = filename + prefixLength;
+    uint32_t nameLength = length - prefixLength - suffixLength;
+
+    uint32_t type;
+    if (Bloopair_GetValueFromName(BLOOPAIR_NAMES_CONTROLLER_TYPE, name, nameLength, &type)) {
+        *outType = (BloopairControllerType) type;
+        return 1;
+    }
+
+    if (Bloopair_ParseBDA(name, nameLength, outBda)) {
+        *outType = BLOOPAIR_CONTROLLER_INVALID;
+        return 1;
+    }
+
+    return 0;
+}
+
+static uint32_t crc32(const uint8_t* data, uint32_t size)
+{
+    // Configuration files are small, so this doesn't need a table
+    uint32_t crc = 0xffffffff;
+    for (uint32_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+        }
+    }
+
+    return ~crc;
+}
+
+static void writeHex32(char* out, uint32_t value)
+{
+    static const char digits[] = "0123456789ABCDEF";
+    for (int i = 7; i >= 0; i--) {
+        out[i] = digits[value & 0xf];
+        value >>= 4;
+    }
+}
+
+static int parseHex32(const char* hex, uint32_t* outValue)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        int digit = hexCharToInt(hex[i]);
+        if (digit < 0) {
+            return 0;
+        }
+
+        value = value << 4 | digit;
+    }
+
+    *outValue = value;
+    return 1;
+}
+
+void Bloopair_CreateConfigHeader(const void* data, uint32_t size, char* outHeader)
+{
+    const uint32_t prefixLength = sizeof(BLOOPAIR_CONFIG_HEADER_PREFIX) - 1;
+
+    memcpy(outHeader, BLOOPAIR_CONFIG_HEADER_PREFIX, prefixLength);
+    writeHex32(outHeader + prefixLength, size);
+    outHeader[prefixLength + 8] = ' ';
+    writeHex32(outHeader + prefixLength + 9, crc32((const uint8_t*) data, size));
+    memcpy(outHeader + prefixLength + 17, BLOOPAIR_CONFIG_HEADER_SUFFIX, sizeof(BLOOPAIR_CONFIG_HEADER_SUFFIX));
+}
+
+BloopairConfigCheckResult Bloopair_CheckConfigFile(const void* data, uint32_t size)
+{
+    const uint32_t prefixLength = sizeof(BLOOPAIR_CONFIG_HEADER_PREFIX) - 1;
+    const char* file = (const char*) data;
+
+    if (size < prefixLength || memcmp(file, BLOOPAIR_CONFIG_HEADER_PREFIX, prefixLength) != 0) {
+        return BLOOPAIR_CONFIG_CHECK_NO_HEADER;
+    }
+
+    uint32_t expectedSize, expectedCrc;
+    if (size < BLOOPAIR_CONFIG_HEADER_LENGTH ||
+        !parseHex32(file + prefixLength, &expectedSize) ||
+        !parseHex32(file + prefixLength + 9, &expectedCrc) ||
+        file[BLOOPAIR_CONFIG_HEADER_LENGTH - 1] != '\n') {
+        return BLOOPAIR_CONFIG_CHECK_MISMATCH;
+    }
+
+    const uint8_t* contents = (const uint8_t*) file + BLOOPAIR_CONFIG_HEADER_LENGTH;
+    uint32_t contentsSize = size - BLOOPAIR_CONFIG_HEADER_LENGTH;
+    if (contentsSize != expectedSize || crc32(contents, contentsSize) != expectedCrc) {
+        return BLOOPAIR_CONFIG_CHECK_MISMATCH;
+    }
+
+    return BLOOPAIR_CONFIG_CHECK_VALID;
+}
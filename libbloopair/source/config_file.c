@@ -0,0 +1,1230 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bloopair/config_file.h"
+
+#include <string.h>
+
+// Nesting deeper than this is rejected, so skipping unknown values can't run out of stack
+#define MAX_DEPTH 32
+
+// Keys and names longer than this can't be any of the known ones
+#define MAX_NAME_LENGTH 32
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define CLAMP(x, lo, hi) MIN(MAX(x, lo), hi)
+
+typedef struct {
+    const char* pos;
+    const char* end;
+    int depth;
+    int error;
+} Reader;
+
+typedef struct {
+    char text[MAX_NAME_LENGTH];
+    // MAX_NAME_LENGTH if the string didn't fit
+    uint32_t length;
+} Name;
+
+static int fail(Reader* r)
+{
+    r->error = 1;
+    r->pos = r->end;
+    return 0;
+}
+
+static void skipSpace(Reader* r)
+{
+    while (r->pos < r->end) {
+        char c = *r->pos;
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            r->pos++;
+        } else if (c == '/' && r->end - r->pos >= 2 && r->pos[1] == '/') {
+            while (r->pos < r->end && *r->pos != '\n') {
+                r->pos++;
+            }
+        } else if (c == '/' && r->end - r->pos >= 2 && r->pos[1] == '*') {
+            r->pos += 2;
+            while (r->end - r->pos >= 2 && !(r->pos[0] == '*' && r->pos[1] == '/')) {
+                r->pos++;
+            }
+
+            if (r->end - r->pos < 2) {
+                fail(r);
+                return;
+            }
+            r->pos += 2;
+        } else {
+            return;
+        }
+    }
+}
+
+static char peek(Reader* r)
+{
+    skipSpace(r);
+    return r->pos < r->end ? *r->pos : '\0';
+}
+
+static int consume(Reader* r, char c)
+{
+    if (peek(r) != c) {
+        return 0;
+    }
+
+    r->pos++;
+    return 1;
+}
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+
+    return -1;
+}
+
+static int readEscapedCodepoint(Reader* r, uint32_t* outCodepoint)
+{
+    if (r->end - r->pos < 4) {
+        return fail(r);
+    }
+
+    uint32_t codepoint = 0;
+    for (int i = 0; i < 4; i++) {
+        int digit = hexValue(*r->pos++);
+        if (digit < 0) {
+            return fail(r);
+        }
+
+        codepoint = codepoint << 4 | digit;
+    }
+
+    *outCodepoint = codepoint;
+    return 1;
+}
+
+static void appendChar(Name* name, char c)
+{
+    if (!name) {
+        return;
+    }
+
+    if (name->length < MAX_NAME_LENGTH - 1) {
+        name->text[name->length++] = c;
+    } else {
+        name->length = MAX_NAME_LENGTH;
+    }
+}
+
+// Reads a string, name can be NULL to skip it
+static int readString(Reader* r, Name* name)
+{
+    if (name) {
+        name->length = 0;
+    }
+
+    if (!consume(r, '"')) {
+        return fail(r);
+    }
+
+    while (r->pos < r->end) {
+        char c = *r->pos++;
+        if (c == '"') {
+            return 1;
+        }
+
+        if ((unsigned char) c < 0x20) {
+            return fail(r);
+        }
+
+        if (c != '\\') {
+            appendChar(name, c);
+            continue;
+        }
+
+        if (r->pos >= r->end) {
+            break;
+        }
+
+        c = *r->pos++;
+        switch (c) {
+        case '"':  appendChar(name, '"');  break;
+        case '\\': appendChar(name, '\\'); break;
+        case '/':  appendChar(name, '/');  break;
+        case 'b':  appendChar(name, '\b'); break;
+        case 'f':  appendChar(name, '\f'); break;
+        case 'n':  appendChar(name, '\n'); break;
+        case 'r':  appendChar(name, '\r'); break;
+        case 't':  appendChar(name, '\t'); break;
+        case 'u': {
+            uint32_t codepoint;
+            if (!readEscapedCodepoint(r, &codepoint)) {
+                return 0;
+            }
+
+            // surrogates need to come in pairs
+            if (codepoint >= 0xdc00 && codepoint <= 0xdfff) {
+                return fail(r);
+            }
+
+            if (codepoint >= 0xd800 && codepoint <= 0xdbff) {
+                uint32_t low;
+                if (r->end - r->pos < 2 || r->pos[0] != '\\' || r->pos[1] != 'u') {
+                    return fail(r);
+                }
+                r->pos += 2;
+
+                if (!readEscapedCodepoint(r, &low)) {
+                    return 0;
+                }
+
+                if (low < 0xdc00 || low > 0xdfff) {
+                    return fail(r);
+                }
+
+                codepoint = 0x10000 + ((codepoint - 0xd800) << 10) + (low - 0xdc00);
+            }
+
+            // None of the names contain anything but ASCII, so the rest only has to make them mismatch.
+            // The lookups compare with strncmp, so a null character mustn't end the name early.
+            appendChar(name, codepoint > 0 && codepoint < 0x80 ? (char) codepoint : '\x80');
+            break;
+        }
+        default:
+            return fail(r);
+        }
+    }
+
+    return fail(r);
+}
+
+static int isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Reads a number, outValue is only set for integers which aren't too large to be any field
+static int readNumber(Reader* r, int64_t* outValue, int* outIsInteger)
+{
+    skipSpace(r);
+
+    int negative = r->pos < r->end && *r->pos == '-';
+    if (negative) {
+        r->pos++;
+    }
+
+    if (r->pos >= r->end || !isDigit(*r->pos)) {
+        return fail(r);
+    }
+
+    int64_t value = 0;
+    int isInteger = 1;
+    if (*r->pos == '0') {
+        r->pos++;
+    } else {
+        while (r->pos < r->end && isDigit(*r->pos)) {
+            if (value > 0xffffffffll) {
+                isInteger = 0;
+            } else {
+                value = value * 10 + (*r->pos - '0');
+            }
+            r->pos++;
+        }
+    }
+
+    if (r->pos < r->end && *r->pos == '.') {
+        r->pos++;
+        if (r->pos >= r->end || !isDigit(*r->pos)) {
+            return fail(r);
+        }
+
+        while (r->pos < r->end && isDigit(*r->pos)) {
+            r->pos++;
+        }
+        isInteger = 0;
+    }
+
+    if (r->pos < r->end && (*r->pos == 'e' || *r->pos == 'E')) {
+        r->pos++;
+        if (r->pos < r->end && (*r->pos == '+' || *r->pos == '-')) {
+            r->pos++;
+        }
+
+        if (r->pos >= r->end || !isDigit(*r->pos)) {
+            return fail(r);
+        }
+
+        while (r->pos < r->end && isDigit(*r->pos)) {
+            r->pos++;
+        }
+        isInteger = 0;
+    }
+
+    *outValue = negative ? -value : value;
+    *outIsInteger = isInteger;
+    return 1;
+}
+
+static int readLiteral(Reader* r, const char* literal)
+{
+    uint32_t length = strlen(literal);
+    skipSpace(r);
+    if ((uint32_t) (r->end - r->pos) < length || memcmp(r->pos, literal, length) != 0) {
+        return fail(r);
+    }
+
+    r->pos += length;
+    return 1;
+}
+
+static int beginContainer(Reader* r, char open)
+{
+    if (!consume(r, open)) {
+        return fail(r);
+    }
+
+    if (++r->depth > MAX_DEPTH) {
+        return fail(r);
+    }
+
+    return 1;
+}
+
+// Moves to the next member of an object, count is the amount of members read so far
+static int nextMember(Reader* r, uint32_t* count, Name* key)
+{
+    if (r->error) {
+        return 0;
+    }
+
+    if (consume(r, '}')) {
+        r->depth--;
+        return 0;
+    }
+
+    if (*count && !consume(r, ',')) {
+        return fail(r);
+    }
+
+    if (!readString(r, key) || !consume(r, ':')) {
+        return fail(r);
+    }
+
+    (*count)++;
+    return 1;
+}
+
+// Moves to the next element of an array, count is the amount of elements read so far
+static int nextElement(Reader* r, uint32_t* count)
+{
+    if (r->error) {
+        return 0;
+    }
+
+    if (consume(r, ']')) {
+        r->depth--;
+        return 0;
+    }
+
+    if (*count && !consume(r, ',')) {
+        return fail(r);
+    }
+
+    (*count)++;
+    return 1;
+}
+
+static int skipValue(Reader* r)
+{
+    uint32_t count = 0;
+    int64_t value;
+    int isInteger;
+
+    switch (peek(r)) {
+    case '{':
+        if (!beginContainer(r, '{')) {
+            return 0;
+        }
+        while (nextMember(r, &count, NULL)) {
+            skipValue(r);
+        }
+        break;
+    case '[':
+        if (!beginContainer(r, '[')) {
+            return 0;
+        }
+        while (nextElement(r, &count)) {
+            skipValue(r);
+        }
+        break;
+    case '"':
+        return readString(r, NULL);
+    case 't':
+        return readLiteral(r, "true");
+    case 'f':
+        return readLiteral(r, "false");
+    case 'n':
+        return readLiteral(r, "null");
+    default:
+        return readNumber(r, &value, &isInteger);
+    }
+
+    return !r->error;
+}
+
+static int isKey(const Name* key, const char* name)
+{
+    return key->length == strlen(name) && memcmp(key->text, name, key->length) == 0;
+}
+
+// The value readers return 0 and skip the value if it has the wrong type
+
+static int readInteger(Reader* r, int64_t min, int64_t max, int64_t* outValue)
+{
+    char c = peek(r);
+    if (c != '-' && !isDigit(c)) {
+        skipValue(r);
+        return 0;
+    }
+
+    int64_t value;
+    int isInteger;
+    if (!readNumber(r, &value, &isInteger) || !isInteger || value < min || value > max) {
+        return 0;
+    }
+
+    *outValue = value;
+    return 1;
+}
+
+static int readBool(Reader* r, uint8_t* outValue)
+{
+    char c = peek(r);
+    if (c == 't' && readLiteral(r, "true")) {
+        *outValue = 1;
+        return 1;
+    }
+    if (c == 'f' && readLiteral(r, "false")) {
+        *outValue = 0;
+        return 1;
+    }
+
+    skipValue(r);
+    return 0;
+}
+
+static int readName(Reader* r, BloopairNameTable table, uint32_t* outValue)
+{
+    if (peek(r) != '"') {
+        skipValue(r);
+        return 0;
+    }
+
+    Name name;
+    if (!readString(r, &name) || name.length >= MAX_NAME_LENGTH) {
+        return 0;
+    }
+
+    return Bloopair_GetValueFromName(table, name.text, name.length, outValue);
+}
+
+static uint32_t readQuirks(Reader* r)
+{
+    uint32_t quirks = 0;
+    uint32_t count = 0;
+    if (!beginContainer(r, '[')) {
+        return 0;
+    }
+
+    while (nextElement(r, &count)) {
+        uint32_t quirk;
+        if (readName(r, BLOOPAIR_NAMES_QUIRK, &quirk)) {
+            quirks |= quirk;
+        }
+    }
+
+    return quirks;
+}
+
+static uint32_t readButtons(Reader* r)
+{
+    uint32_t buttons = 0;
+    uint32_t count = 0;
+    if (peek(r) != '[') {
+        skipValue(r);
+        return 0;
+    }
+
+    if (!beginContainer(r, '[')) {
+        return 0;
+    }
+
+    while (nextElement(r, &count)) {
+        // only actual buttons can be part of an action
+        uint32_t button;
+        if (readName(r, BLOOPAIR_NAMES_BUTTON, &button) && button < BLOOPAIR_PRO_STICK_MIN) {
+            buttons |= 1u << button;
+        }
+    }
+
+    return buttons;
+}
+
+static void readCommon(Reader* r, BloopairConfigFile* file)
+{
+    BloopairCommonConfiguration* common = &file->common;
+    if (peek(r) != '{') {
+        skipValue(r);
+        return;
+    }
+
+    if (!beginContainer(r, '{')) {
+        return;
+    }
+    file->fields |= BLOOPAIR_CONFIG_FILE_HAS_COMMON;
+
+    Name key;
+    uint32_t count = 0;
+    while (nextMember(r, &count, &key)) {
+        int64_t value;
+        if (isKey(&key, "stickAsButtonDeadzone")) {
+            if (readInteger(r, 0, UINT16_MAX, &value)) {
+                common->stickAsButtonDeadzone = value;
+                file->fields |= BLOOPAIR_CONFIG_FILE_HAS_STICK_AS_BUTTON_DEADZONE;
+            }
+        } else if (isKey(&key, "quirks")) {
+            if (peek(r) == '[') {
+                common->quirks = readQuirks(r);
+                file->fields |= BLOOPAIR_CONFIG_FILE_HAS_QUIRKS;
+            } else {
+                skipValue(r);
+            }
+        } else if (isKey(&key, "reportInterval")) {
+            if (readInteger(r, 0, UINT8_MAX, &value)) {
+                common->reportInterval = value;
+                file->fields |= BLOOPAIR_CONFIG_FILE_HAS_REPORT_INTERVAL;
+            }
+        } else if (isKey(&key, "triggerThreshold")) {
+            if (readInteger(r, 0, UINT16_MAX, &value)) {
+                common->triggerThreshold = value;
+                file->fields |= BLOOPAIR_CONFIG_FILE_HAS_TRIGGER_THRESHOLD;
+            }
+        } else if (isKey(&key, "triggerHysteresis")) {
+            if (readInteger(r, 0, UINT16_MAX, &value)) {
+                common->triggerHysteresis = value;
+                file->fields |= BLOOPAIR_CONFIG_FILE_HAS_TRIGGER_HYSTERESIS;
+            }
+        } else {
+            skipValue(r);
+        }
+    }
+}
+
+static void addMapping(BloopairConfigFile* file, uint32_t to, int64_t from, int* overflow)
+{
+    if (file->numMappings >= BLOOPAIR_MAX_MAPPINGS) {
+        *overflow = 1;
+        return;
+    }
+
+    file->mappings[file->numMappings].from = from;
+    file->mappings[file->numMappings].to = to;
+    file->numMappings++;
+}
+
+static void readMapping(Reader* r, BloopairConfigFile* file)
+{
+    if (peek(r) != '{') {
+        skipValue(r);
+        return;
+    }
+
+    if (!beginContainer(r, '{')) {
+        return;
+    }
+
+    file->numMappings = 0;
+    int overflow = 0;
+
+    Name key;
+    uint32_t count = 0;
+    while (nextMember(r, &count, &key)) {
+        uint32_t to;
+        if (key.length >= MAX_NAME_LENGTH || !Bloopair_GetValueFromName(BLOOPAIR_NAMES_BUTTON, key.text, key.length, &to)) {
+            skipValue(r);
+            continue;
+        }
+
+        // every button has a list of sources, a single source doesn't need to be in a list
+        int64_t from;
+        if (peek(r) != '[') {
+            if (readInteger(r, 0, UINT8_MAX, &from)) {
+                addMapping(file, to, from, &overflow);
+            }
+            continue;
+        }
+
+        uint32_t numSources = 0;
+        if (!beginContainer(r, '[')) {
+            break;
+        }
+
+        while (nextElement(r, &numSources)) {
+            if (readInteger(r, 0, UINT8_MAX, &from)) {
+                addMapping(file, to, from, &overflow);
+            }
+        }
+    }
+
+    if (overflow) {
+        file->numMappings = 0;
+        file->fields &= ~BLOOPAIR_CONFIG_FILE_HAS_MAPPING;
+    } else {
+        file->fields |= BLOOPAIR_CONFIG_FILE_HAS_MAPPING;
+    }
+}
+
+static void readStep(Reader* r, BloopairActionEntry* step)
+{
+    int64_t duration = 100;
+
+    step->type = BLOOPAIR_ACTION_SEQUENCE_STEP;
+    if (peek(r) != '{') {
+        skipValue(r);
+    } else if (beginContainer(r, '{')) {
+        Name key;
+        uint32_t count = 0;
+        while (nextMember(r, &count, &key)) {
+            if (isKey(&key, "buttons")) {
+                step->buttons = readButtons(r);
+            } else if (isKey(&key, "duration")) {
+                readInteger(r, INT32_MIN, INT32_MAX, &duration);
+            } else {
+                skipValue(r);
+            }
+        }
+    }
+
+    // duration in milliseconds, which runs in 10ms ticks
+    step->param = CLAMP(duration / 10, 1, 255);
+}
+
+// Sequence steps follow the action, so they're put in place as they are read
+static void readAction(Reader* r, BloopairConfigFile* file, int* overflow)
+{
+    if (peek(r) != '{') {
+        skipValue(r);
+        return;
+    }
+
+    if (!beginContainer(r, '{')) {
+        return;
+    }
+
+    uint32_t index = file->numActions;
+    int hasSlot = index < BLOOPAIR_MAX_ACTIONS;
+    BloopairActionEntry entry = { 0 };
+    uint32_t type = 0;
+    int hasType = 0;
+    int64_t rate = 10;
+    uint32_t numSteps = 0;
+    int hasSteps = 0;
+
+    Name key;
+    uint32_t count = 0;
+    while (nextMember(r, &count, &key)) {
+        if (isKey(&key, "type")) {
+            hasType = readName(r, BLOOPAIR_NAMES_ACTION_TYPE, &type);
+        } else if (isKey(&key, "trigger")) {
+            entry.trigger = readButtons(r);
+        } else if (isKey(&key, "buttons")) {
+            entry.buttons = readButtons(r);
+        } else if (isKey(&key, "rate")) {
+            readInteger(r, INT32_MIN, INT32_MAX, &rate);
+        } else if (isKey(&key, "steps")) {
+            numSteps = 0;
+            hasSteps = peek(r) == '[';
+            if (!hasSteps) {
+                skipValue(r);
+                continue;
+            }
+
+            uint32_t numElements = 0;
+            if (!beginContainer(r, '[')) {
+                return;
+            }
+
+            while (nextElement(r, &numElements)) {
+                BloopairActionEntry step = { 0 };
+                readStep(r, &step);
+
+                uint32_t stepIndex = index + 1 + numSteps++;
+                if (stepIndex < BLOOPAIR_MAX_ACTIONS) {
+                    file->actions[stepIndex] = step;
+                }
+            }
+        } else {
+            skipValue(r);
+        }
+    }
+
+    if (r->error || !hasType) {
+        return;
+    }
+
+    entry.type = type;
+    if (type == BLOOPAIR_ACTION_TURBO) {
+        // in presses per second
+        entry.param = CLAMP(rate, 1, 50);
+    } else if (type == BLOOPAIR_ACTION_SEQUENCE) {
+        if (!hasSteps || numSteps == 0 || numSteps > 255) {
+            return;
+        }
+
+        entry.param = numSteps;
+    } else {
+        numSteps = 0;
+    }
+
+    if (!hasSlot || index + 1 + numSteps > BLOOPAIR_MAX_ACTIONS) {
+        *overflow = 1;
+        return;
+    }
+
+    file->actions[index] = entry;
+    file->numActions = index + 1 + numSteps;
+}
+
+static void readActions(Reader* r, BloopairConfigFile* file)
+{
+    if (peek(r) != '[') {
+        skipValue(r);
+        return;
+    }
+
+    if (!beginContainer(r, '[')) {
+        return;
+    }
+
+    file->numActions = 0;
+    int overflow = 0;
+
+    uint32_t count = 0;
+    while (nextElement(r, &count)) {
+        readAction(r, file, &overflow);
+    }
+
+    if (overflow) {
+        file->numActions = 0;
+        file->fields &= ~BLOOPAIR_CONFIG_FILE_HAS_ACTIONS;
+    } else {
+        file->fields |= BLOOPAIR_CONFIG_FILE_HAS_ACTIONS;
+    }
+}
+
+static void readCustom(Reader* r, BloopairConfigFile* file)
+{
+    if (peek(r) != '{') {
+        skipValue(r);
+        return;
+    }
+
+    if (!beginContainer(r, '{')) {
+        return;
+    }
+    file->fields |= BLOOPAIR_CONFIG_FILE_HAS_CUSTOM;
+
+    Name key;
+    uint32_t count = 0;
+    while (nextMember(r, &count, &key)) {
+        if (isKey(&key, "disableCalibration")) {
+            if (readBool(r, &file->disableCalibration)) {
+                file->fields |= BLOOPAIR_CONFIG_FILE_HAS_DISABLE_CALIBRATION;
+            }
+        } else if (isKey(&key, "combineWith")) {
+            Name address;
+            if (peek(r) != '"') {
+                skipValue(r);
+            } else if (readString(r, &address) && Bloopair_ParseBDA(address.text, address.length, file->combineWith)) {
+                file->fields |= BLOOPAIR_CONFIG_FILE_HAS_COMBINE_WITH;
+            }
+        } else {
+            skipValue(r);
+        }
+    }
+}
+
+// Only whitespace and comments can follow the top level value
+static int finish(Reader* r)
+{
+    skipSpace(r);
+    return !r->error && r->pos == r->end;
+}
+
+int Bloopair_DecodeConfigFile(const char* data, uint32_t size, BloopairConfigFile* outFile)
+{
+    Reader r = { data, data + size, 0, 0 };
+
+    memset(outFile, 0, sizeof(*outFile));
+    outFile->controllerType = BLOOPAIR_CONTROLLER_INVALID;
+
+    if (!beginContainer(&r, '{')) {
+        return 0;
+    }
+
+    Name key;
+    uint32_t count = 0;
+    while (nextMember(&r, &count, &key)) {
+        if (isKey(&key, "version")) {
+            int64_t version;
+            if (readInteger(&r, 0, UINT32_MAX, &version)) {
+                outFile->version = version;
+            }
+        } else if (isKey(&key, "controllerType")) {
+            uint32_t type;
+            outFile->controllerType = readName(&r, BLOOPAIR_NAMES_CONTROLLER_TYPE, &type) ? (BloopairControllerType) type : BLOOPAIR_CONTROLLER_INVALID;
+        } else if (isKey(&key, "configuration")) {
+            readCommon(&r, outFile);
+        } else if (isKey(&key, "mapping")) {
+            readMapping(&r, outFile);
+        } else if (isKey(&key, "actions")) {
+            readActions(&r, outFile);
+        } else if (isKey(&key, "custom")) {
+            readCustom(&r, outFile);
+        } else {
+            skipValue(&r);
+        }
+    }
+
+    return finish(&r);
+}
+
+void Bloopair_ApplyConfigFileCommon(const BloopairConfigFile* file, BloopairCommonConfiguration* config)
+{
+    if (file->fields & BLOOPAIR_CONFIG_FILE_HAS_STICK_AS_BUTTON_DEADZONE) {
+        config->stickAsButtonDeadzone = file->common.stickAsButtonDeadzone;
+    }
+    if (file->fields & BLOOPAIR_CONFIG_FILE_HAS_QUIRKS) {
+        config->quirks = file->common.quirks;
+    }
+    if (file->fields & BLOOPAIR_CONFIG_FILE_HAS_REPORT_INTERVAL) {
+        config->reportInterval = file->common.reportInterval;
+    }
+    if (file->fields & BLOOPAIR_CONFIG_FILE_HAS_TRIGGER_THRESHOLD) {
+        config->triggerThreshold = file->common.triggerThreshold;
+    }
+    if (file->fields & BLOOPAIR_CONFIG_FILE_HAS_TRIGGER_HYSTERESIS) {
+        config->triggerHysteresis = file->common.triggerHysteresis;
+    }
+}
+
+void Bloopair_ApplyConfigFileSwitch(const BloopairConfigFile* file, SwitchConfiguration* config)
+{
+    if (file->fields & BLOOPAIR_CONFIG_FILE_HAS_DISABLE_CALIBRATION) {
+        config->disableCalibration = file->disableCalibration;
+    }
+    if (file->fields & BLOOPAIR_CONFIG_FILE_HAS_COMBINE_WITH) {
+        memcpy(config->combineWith, file->combineWith, sizeof(config->combineWith));
+    }
+}
+
+static int readHexId(Reader* r, uint16_t* outId)
+{
+    Name name;
+    if (peek(r) != '"') {
+        skipValue(r);
+        return 0;
+    }
+
+    if (!readString(r, &name) || name.length == 0 || name.length > 4) {
+        return 0;
+    }
+
+    uint16_t id = 0;
+    for (uint32_t i = 0; i < name.length; i++) {
+        int digit = hexValue(name.text[i]);
+        if (digit < 0) {
+            return 0;
+        }
+
+        id = id << 4 | digit;
+    }
+
+    *outId = id;
+    return 1;
+}
+
+static void readDevice(Reader* r, BloopairDeviceEntryCallback callback, void* userdata)
+{
+    if (peek(r) != '{') {
+        skipValue(r);
+        return;
+    }
+
+    if (!beginContainer(r, '{')) {
+        return;
+    }
+
+    BloopairDeviceEntry entry = { 0 };
+    int hasVendorId = 0;
+    int hasProductId = 0;
+    int hasType = 0;
+
+    Name key;
+    uint32_t count = 0;
+    while (nextMember(r, &count, &key)) {
+        int64_t value;
+        uint32_t type = 0;
+        if (isKey(&key, "vendorId")) {
+            hasVendorId = readHexId(r, &entry.vendor_id);
+        } else if (isKey(&key, "productId")) {
+            hasProductId = readHexId(r, &entry.product_id);
+        } else if (isKey(&key, "controllerType")) {
+            hasType = readName(r, BLOOPAIR_NAMES_CONTROLLER_TYPE, &type);
+            entry.controllerType = type;
+        } else if (isKey(&key, "quirks")) {
+            if (peek(r) == '[') {
+                entry.quirks = readQuirks(r);
+            } else {
+                skipValue(r);
+            }
+        } else if (isKey(&key, "reportInterval")) {
+            if (readInteger(r, 0, UINT8_MAX, &value)) {
+                entry.reportInterval = value;
+            }
+        } else {
+            skipValue(r);
+        }
+    }
+
+    if (!r->error && hasVendorId && hasProductId && hasType) {
+        callback(&entry, userdata);
+    }
+}
+
+int Bloopair_DecodeDevicesFile(const char* data, uint32_t size, uint32_t* outVersion, BloopairDeviceEntryCallback callback, void* userdata)
+{
+    Reader r = { data, data + size, 0, 0 };
+    int hasDevices = 0;
+
+    *outVersion = 0;
+
+    if (!beginContainer(&r, '{')) {
+        return 0;
+    }
+
+    Name key;
+    uint32_t count = 0;
+    while (nextMember(&r, &count, &key)) {
+        if (isKey(&key, "version")) {
+            int64_t version;
+            if (readInteger(&r, 0, UINT32_MAX, &version)) {
+                *outVersion = version;
+            }
+        } else if (isKey(&key, "devices") && peek(&r) == '[') {
+            if (!beginContainer(&r, '[')) {
+                break;
+            }
+
+            uint32_t numDevices = 0;
+            while (nextElement(&r, &numDevices)) {
+                readDevice(&r, callback, userdata);
+            }
+            hasDevices = 1;
+        } else {
+            skipValue(&r);
+        }
+    }
+
+    return finish(&r) && hasDevices;
+}
+
+typedef struct {
+    char* out;
+    uint32_t size;
+    uint32_t length;
+} Writer;
+
+static void writeChar(Writer* w, char c)
+{
+    // one byte is always left for the null-terminator
+    if (w->length + 1 < w->size) {
+        w->out[w->length] = c;
+    }
+    w->length++;
+}
+
+static void writeRaw(Writer* w, const char* text)
+{
+    while (*text) {
+        writeChar(w, *text++);
+    }
+}
+
+static void writeUint(Writer* w, uint32_t value)
+{
+    char digits[10];
+    int num = 0;
+    do {
+        digits[num++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+
+    while (num) {
+        writeChar(w, digits[--num]);
+    }
+}
+
+static void writeString(Writer* w, const char* text)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    writeChar(w, '"');
+    for (; *text; text++) {
+        unsigned char c = *text;
+        if (c == '"' || c == '\\') {
+            writeChar(w, '\\');
+            writeChar(w, c);
+        } else if (c < 0x20) {
+            writeRaw(w, "\\u00");
+            writeChar(w, hex[c >> 4]);
+            writeChar(w, hex[c & 0xf]);
+        } else {
+            writeChar(w, c);
+        }
+    }
+    writeChar(w, '"');
+}
+
+// Writes the separator if needed and the key of the next member
+static void writeKey(Writer* w, int* first, const char* key)
+{
+    if (!*first) {
+        writeChar(w, ',');
+    }
+    *first = 0;
+
+    writeString(w, key);
+    writeChar(w, ':');
+}
+
+static void writeNames(Writer* w, BloopairNameTable table, uint32_t mask)
+{
+    int first = 1;
+    writeChar(w, '[');
+    for (uint32_t i = 0; i < 32; i++) {
+        // buttons are named by their bit, quirks by their flag
+        const char* name = Bloopair_GetNameFromValue(table, table == BLOOPAIR_NAMES_BUTTON ? i : 1u << i);
+        if ((mask & (1u << i)) && name) {
+            if (!first) {
+                writeChar(w, ',');
+            }
+            first = 0;
+            writeString(w, name);
+        }
+    }
+    writeChar(w, ']');
+}
+
+static void writeCommon(Writer* w, const BloopairConfigFile* file)
+{
+    int first = 1;
+    writeChar(w, '{');
+    if (file->fields & BLOOPAIR_CONFIG_FILE_HAS_STICK_AS_BUTTON_DEADZONE) {
+        writeKey(w, &first, "stickAsButtonDeadzone");
+        writeUint(w, file->common.stickAsButtonDeadzone);
+    }
+    if (file->fields & BLOOPAIR_CONFIG_FILE_HAS_REPORT_INTERVAL) {
+        writeKey(w, &first, "reportInterval");
+        writeUint(w, file->common.reportInterval);
+    }
+    if (file->fields & BLOOPAIR_CONFIG_FILE_HAS_TRIGGER_THRESHOLD) {
+        writeKey(w, &first, "triggerThreshold");
+        writeUint(w, file->common.triggerThreshold);
+    }
+    if (file->fields & BLOOPAIR_CONFIG_FILE_HAS_TRIGGER_HYSTERESIS) {
+        writeKey(w, &first, "triggerHysteresis");
+        writeUint(w, file->common.triggerHysteresis);
+    }
+    if (file->fields & BLOOPAIR_CONFIG_FILE_HAS_QUIRKS) {
+        writeKey(w, &first, "quirks");
+        writeNames(w, BLOOPAIR_NAMES_QUIRK, file->common.quirks);
+    }
+    writeChar(w, '}');
+}
+
+static void writeMapping(Writer* w, const BloopairConfigFile* file)
+{
+    // the sources are grouped by the button they're mapped to
+    int first = 1;
+    writeChar(w, '{');
+    for (uint32_t to = 0; to < BLOOPAIR_PRO_BUTTON_MAX; to++) {
+        const char* name = Bloopair_GetNameFromValue(BLOOPAIR_NAMES_BUTTON, to);
+        if (!name) {
+            continue;
+        }
+
+        int firstSource = 1;
+        for (uint32_t i = 0; i < file->numMappings; i++) {
+            if (file->mappings[i].to != to) {
+                continue;
+            }
+
+            if (firstSource) {
+                writeKey(w, &first, name);
+                writeChar(w, '[');
+            } else {
+                writeChar(w, ',');
+            }
+            firstSource = 0;
+            writeUint(w, file->mappings[i].from);
+        }
+
+        if (!firstSource) {
+            writeChar(w, ']');
+        }
+    }
+    writeChar(w, '}');
+}
+
+static void writeActions(Writer* w, const BloopairConfigFile* file)
+{
+    int firstAction = 1;
+    writeChar(w, '[');
+    for (uint32_t i = 0; i < file->numActions; i++) {
+        const BloopairActionEntry* a = &file->actions[i];
+        const char* type = Bloopair_GetNameFromValue(BLOOPAIR_NAMES_ACTION_TYPE, a->type);
+        if (!type || (a->type == BLOOPAIR_ACTION_SEQUENCE && a->param >= file->numActions - i)) {
+            continue;
+        }
+
+        if (!firstAction) {
+            writeChar(w, ',');
+        }
+        firstAction = 0;
+
+        int first = 1;
+        writeChar(w, '{');
+        writeKey(w, &first, "type");
+        writeString(w, type);
+        writeKey(w, &first, "trigger");
+        writeNames(w, BLOOPAIR_NAMES_BUTTON, a->trigger);
+
+        if (a->type == BLOOPAIR_ACTION_SEQUENCE) {
+            writeKey(w, &first, "steps");
+            writeChar(w, '[');
+            for (uint32_t j = 1; j <= a->param; j++) {
+                int firstStep = 1;
+                if (j > 1) {
+                    writeChar(w, ',');
+                }
+                writeChar(w, '{');
+                writeKey(w, &firstStep, "buttons");
+                writeNames(w, BLOOPAIR_NAMES_BUTTON, a[j].buttons);
+                writeKey(w, &firstStep, "duration");
+                writeUint(w, a[j].param * 10);
+                writeChar(w, '}');
+            }
+            writeChar(w, ']');
+            i += a->param;
+        } else {
+            writeKey(w, &first, "buttons");
+            writeNames(w, BLOOPAIR_NAMES_BUTTON, a->buttons);
+        }
+
+        if (a->type == BLOOPAIR_ACTION_TURBO) {
+            writeKey(w, &first, "rate");
+            writeUint(w, a->param);
+        }
+        writeChar(w, '}');
+    }
+    writeChar(w, ']');
+}
+
+static void writeCustom(Writer* w, const BloopairConfigFile* file)
+{
+    static const char hex[] = "0123456789ABCDEF";
+
+    int first = 1;
+    writeChar(w, '{');
+    if (file->fields & BLOOPAIR_CONFIG_FILE_HAS_DISABLE_CALIBRATION) {
+        writeKey(w, &first, "disableCalibration");
+        writeRaw(w, file->disableCalibration ? "true" : "false");
+    }
+    if (file->fields & BLOOPAIR_CONFIG_FILE_HAS_COMBINE_WITH) {
+        char address[13];
+        for (int i = 0; i < 6; i++) {
+            address[i * 2] = hex[file->combineWith[i] >> 4];
+            address[i * 2 + 1] = hex[file->combineWith[i] & 0xf];
+        }
+        address[12] = '\0';
+
+        writeKey(w, &first, "combineWith");
+        writeString(w, address);
+    }
+    writeChar(w, '}');
+}
+
+uint32_t Bloopair_EncodeConfigFile(const BloopairConfigFile* file, char* out, uint32_t size)
+{
+    Writer w = { out, size, 0 };
+    int first = 1;
+
+    writeChar(&w, '{');
+    writeKey(&w, &first, "version");
+    writeUint(&w, file->version);
+
+    const char* type = Bloopair_GetNameFromValue(BLOOPAIR_NAMES_CONTROLLER_TYPE, file->controllerType);
+    if (type) {
+        writeKey(&w, &first, "controllerType");
+        writeString(&w, type);
+    }
+
+    if (file->fields & BLOOPAIR_CONFIG_FILE_HAS_COMMON) {
+        writeKey(&w, &first, "configuration");
+        writeCommon(&w, file);
+    }
+    if (file->fields & BLOOPAIR_CONFIG_FILE_HAS_MAPPING) {
+        writeKey(&w, &first, "mapping");
+        writeMapping(&w, file);
+    }
+    if (file->fields & BLOOPAIR_CONFIG_FILE_HAS_ACTIONS) {
+        writeKey(&w, &first, "actions");
+        writeActions(&w, file);
+    }
+    if (file->fields & BLOOPAIR_CONFIG_FILE_HAS_CUSTOM) {
+        writeKey(&w, &first, "custom");
+        writeCustom(&w, file);
+    }
+    writeChar(&w, '}');
+
+    if (size) {
+        out[MIN(w.length, size - 1)] = '\0';
+    }
+
+    return w.length;
+}
@@ -15,72 +15,40 @@
  *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include "config.hpp"
+#include "config_cache.hpp"
 
-#include <map>
+#include <algorithm>
+#include <cstdlib>
 #include <string>
 #include <fstream>
 #include <filesystem>
-#include <regex>
+#include <sstream>
+#include <vector>
 
 #include <coreinit/debug.h>
 
 #include <bloopair/bloopair.h>
+#include <bloopair/config.h>
+#include <bloopair/config_file.h>
 #include <bloopair/controllers/dualsense_controller.h>
 #include <bloopair/controllers/dualshock3_controller.h>
 #include <bloopair/controllers/dualshock4_controller.h>
 #include <bloopair/controllers/switch_controller.h>
 #include <bloopair/controllers/xbox_one_controller.h>
-#include <json/json.hpp>
 
 #define BLOOPAIR_CONFIGURATION_DIR "/vol/external01/wiiu/bloopair/"
+#define BLOOPAIR_DEVICES_FILENAME "devices.conf"
+#define BLOOPAIR_TITLE_PROFILE_PREFIX "Title-"
+#define BLOOPAIR_CACHE_FILENAME "bloopair.cache"
 
 // Bump up the versions by 100 for breaking config changes
 #define BLOOPAIR_CONFIG_VERSION_MIN 0
 #define BLOOPAIR_CONFIG_VERSION_MAX 100
 
-static const std::map<std::string, uint32_t> bloopairButtonNameValues = {
-    { "up",         BLOOPAIR_PRO_BUTTON_UP },
-    { "left",       BLOOPAIR_PRO_BUTTON_LEFT },
-    { "zr",         BLOOPAIR_PRO_TRIGGER_ZR },
-    { "x",          BLOOPAIR_PRO_BUTTON_X },
-    { "a",          BLOOPAIR_PRO_BUTTON_A },
-    { "y",          BLOOPAIR_PRO_BUTTON_Y },
-    { "b",          BLOOPAIR_PRO_BUTTON_B },
-    { "zl",         BLOOPAIR_PRO_TRIGGER_ZL },
-    { "reserved",   BLOOPAIR_PRO_RESERVED },
-    { "r",          BLOOPAIR_PRO_TRIGGER_R },
-    { "plus",       BLOOPAIR_PRO_BUTTON_PLUS },
-    { "home",       BLOOPAIR_PRO_BUTTON_HOME },
-    { "minus",      BLOOPAIR_PRO_BUTTON_MINUS },
-    { "l",          BLOOPAIR_PRO_TRIGGER_L },
-    { "down",       BLOOPAIR_PRO_BUTTON_DOWN },
-    { "right",      BLOOPAIR_PRO_BUTTON_RIGHT },
-    { "rstick",     BLOOPAIR_PRO_BUTTON_STICK_R },
-    { "lstick",     BLOOPAIR_PRO_BUTTON_STICK_L },
-    { "lup",        BLOOPAIR_PRO_STICK_L_UP },
-    { "ldown",      BLOOPAIR_PRO_STICK_L_DOWN },
-    { "lleft",      BLOOPAIR_PRO_STICK_L_LEFT },
-    { "lright",     BLOOPAIR_PRO_STICK_L_RIGHT },
-    { "rrup",       BLOOPAIR_PRO_STICK_R_UP },
-    { "rdown",      BLOOPAIR_PRO_STICK_R_DOWN },
-    { "rleft",      BLOOPAIR_PRO_STICK_R_LEFT },
-    { "rright",     BLOOPAIR_PRO_STICK_R_RIGHT },
-};
-
-static const std::map<std::string, BloopairControllerType> bloopairControllerTypeValues = {
-    { "DualSense",              BLOOPAIR_CONTROLLER_DUALSENSE },
-    { "DualShock-3",            BLOOPAIR_CONTROLLER_DUALSHOCK3 },
-    { "DualShock-4",            BLOOPAIR_CONTROLLER_DUALSHOCK4 },
-    { "Switch-Generic",         BLOOPAIR_CONTROLLER_SWITCH_GENERIC },
-    { "Switch-JoyCon-Left",     BLOOPAIR_CONTROLLER_SWITCH_JOYCON_LEFT },
-    { "Switch-JoyCon-Right",    BLOOPAIR_CONTROLLER_SWITCH_JOYCON_RIGHT },
-    { "Switch-JoyCon-Dual",     BLOOPAIR_CONTROLLER_SWITCH_JOYCON_DUAL },
-    { "Switch-Pro",             BLOOPAIR_CONTROLLER_SWITCH_PRO },
-    { "Switch-N64",             BLOOPAIR_CONTROLLER_SWITCH_N64 },
-    { "Xbox-One",               BLOOPAIR_CONTROLLER_XBOX_ONE },
-};
-
-static bool LoadCommonConfiguration(const nlohmann::json& common, IOSHandle handle, BloopairControllerType type, const uint8_t* bda)
+// Records every payload submitted while parsing the configuration
+static ConfigCache configCache;
+
+static bool LoadCommonConfiguration(const BloopairConfigFile& file, IOSHandle handle, BloopairControllerType type, const uint8_t* bda)
 {
     // Start by getting the default configuration
     BloopairCommonConfiguration configuration;
@@ -89,17 +57,11 @@ static bool LoadCommonConfiguration(const nlohmann::json& common, IOSHandle hand
     }
 
     // Overwrite fields from the config
-    if (common.contains("stickAsButtonDeadzone")) {
-        configuration.stickAsButtonDeadzone = common["stickAsButtonDeadzone"];
-    }
+    Bloopair_ApplyConfigFileCommon(&file, &configuration);
 
     // Apply configuration
     IOSError error;
-    if (bda) {
-        error = Bloopair_ApplyControllerConfigurationForBDA(handle, bda, &configuration);
-    } else {
-        error = Bloopair_ApplyControllerConfigurationForControllerType(handle, type, &configuration);
-    }
+    error = configCache.Submit(handle, ConfigCacheRecord::TYPE_COMMON, type, bda, &configuration, sizeof(configuration));
 
     if (error < 0) {
         OSReport("Bloopair Loader: ApplyControllerConfiguration failed %x\n", error);
@@ -109,52 +71,48 @@ static bool LoadCommonConfiguration(const nlohmann::json& common, IOSHandle hand
     return true;
 }
 
-static bool LoadControllerMapping(const nlohmann::json& mapping, IOSHandle handle, BloopairControllerType type, const uint8_t* bda)
+static bool LoadControllerMapping(const BloopairConfigFile& file, IOSHandle handle, BloopairControllerType type, const uint8_t* bda)
 {
-    std::vector<BloopairMappingEntry> mappings;
-    for (const auto& [key, val] : mapping.items()) {
-        if (!bloopairButtonNameValues.contains(key)) {
-            OSReport("Bloopair Loader: Ignoring unknown button %s\n", key.c_str());
-            continue;
-        }
+    IOSError error;
+    error = configCache.Submit(handle, ConfigCacheRecord::TYPE_MAPPING, type, bda, file.mappings, file.numMappings * sizeof(BloopairMappingEntry));
 
-        uint8_t button = bloopairButtonNameValues.at(key);
-        for (const auto& ent : val) {
-            mappings.push_back(BloopairMappingEntry{ent.get<uint8_t>(), button});
-        }
+    if (error < 0) {
+        OSReport("Bloopair Loader: ApplyControllerMapping failed %x\n", error);
+        return false;
     }
 
+    return true;
+}
+
+static bool LoadControllerActions(const BloopairConfigFile& file, IOSHandle handle, BloopairControllerType type, const uint8_t* bda)
+{
     IOSError error;
-    if (bda) {
-        error = Bloopair_ApplyControllerMappingForBDA(handle, bda, mappings.data(), mappings.size());
-    } else {
-        error = Bloopair_ApplyControllerMappingForControllerType(handle, type, mappings.data(), mappings.size());
-    }
+    error = configCache.Submit(handle, ConfigCacheRecord::TYPE_ACTIONS, type, bda, file.actions, file.numActions * sizeof(BloopairActionEntry));
 
     if (error < 0) {
-        OSReport("Bloopair Loader: ApplyControllerMapping failed %x\n", error);
+        OSReport("Bloopair Loader: ApplyControllerActions failed %x\n", error);
         return false;
     }
 
     return true;
 }
 
-static bool LoadDualSenseCustomConfiguration(const nlohmann::json& custom, IOSHandle handle, BloopairControllerType type, const uint8_t* bda)
+static bool LoadDualSenseCustomConfiguration(const BloopairConfigFile& file, IOSHandle handle, BloopairControllerType type, const uint8_t* bda)
 {
     return true;
 }
 
-static bool LoadDualShock3CustomConfiguration(const nlohmann::json& custom, IOSHandle handle, BloopairControllerType type, const uint8_t* bda)
+static bool LoadDualShock3CustomConfiguration(const BloopairConfigFile& file, IOSHandle handle, BloopairControllerType type, const uint8_t* bda)
 {
     return true;
 }
 
-static bool LoadDualShock4CustomConfiguration(const nlohmann::json& custom, IOSHandle handle, BloopairControllerType type, const uint8_t* bda)
+static bool LoadDualShock4CustomConfiguration(const BloopairConfigFile& file, IOSHandle handle, BloopairControllerType type, const uint8_t* bda)
 {
     return true;
 }
 
-static bool LoadSwitchCustomConfiguration(const nlohmann::json& custom, IOSHandle handle, BloopairControllerType type, const uint8_t* bda)
+static bool LoadSwitchCustomConfiguration(const BloopairConfigFile& file, IOSHandle handle, BloopairControllerType type, const uint8_t* bda)
 {
     // Start by getting the default configuration
     SwitchConfiguration config;
@@ -164,17 +122,11 @@ static bool LoadSwitchCustomConfiguration(const nlohmann::json& custom, IOSHandl
     }
 
     // Overwrite fields from the config
-    if (custom.contains("disableCalibration")) {
-        config.disableCalibration = custom["disableCalibration"];
-    }
+    Bloopair_ApplyConfigFileSwitch(&file, &config);
 
     // Apply configuration
     IOSError error;
-    if (bda) {
-        error = Bloopair_ApplyCustomConfigurationForBDA(handle, bda, &config, sizeof(config));
-    } else {
-        error = Bloopair_ApplyCustomConfigurationForControllerType(handle, type, &config, sizeof(config));
-    }
+    error = configCache.Submit(handle, ConfigCacheRecord::TYPE_CUSTOM, type, bda, &config, sizeof(config));
 
     if (error < 0) {
         OSReport("Bloopair Loader: ApplyCustomConfiguration failed %x\n", error);
@@ -184,85 +136,126 @@ static bool LoadSwitchCustomConfiguration(const nlohmann::json& custom, IOSHandl
     return true;
 }
 
-static bool LoadXboxOneCustomConfiguration(const nlohmann::json& custom, IOSHandle handle, BloopairControllerType type, const uint8_t* bda)
+static bool LoadXboxOneCustomConfiguration(const BloopairConfigFile& file, IOSHandle handle, BloopairControllerType type, const uint8_t* bda)
 {
     return true;
 }
 
-static bool LoadCustomConfiguration(const nlohmann::json& custom, IOSHandle handle, BloopairControllerType type, const uint8_t* bda)
+static bool LoadCustomConfiguration(const BloopairConfigFile& file, IOSHandle handle, BloopairControllerType type, const uint8_t* bda)
 {
     switch (type) {
         case BLOOPAIR_CONTROLLER_DUALSENSE:
-            return LoadDualSenseCustomConfiguration(custom, handle, type, bda);
+            return LoadDualSenseCustomConfiguration(file, handle, type, bda);
         case BLOOPAIR_CONTROLLER_DUALSHOCK3:
-            return LoadDualShock3CustomConfiguration(custom, handle, type, bda);
+            return LoadDualShock3CustomConfiguration(file, handle, type, bda);
         case BLOOPAIR_CONTROLLER_DUALSHOCK4:
-            return LoadDualShock4CustomConfiguration(custom, handle, type, bda);
+            return LoadDualShock4CustomConfiguration(file, handle, type, bda);
         case BLOOPAIR_CONTROLLER_SWITCH_GENERIC:
         case BLOOPAIR_CONTROLLER_SWITCH_JOYCON_LEFT:
         case BLOOPAIR_CONTROLLER_SWITCH_JOYCON_RIGHT:
         case BLOOPAIR_CONTROLLER_SWITCH_JOYCON_DUAL:
         case BLOOPAIR_CONTROLLER_SWITCH_PRO:
         case BLOOPAIR_CONTROLLER_SWITCH_N64:
-            return LoadSwitchCustomConfiguration(custom, handle, type, bda);
+            return LoadSwitchCustomConfiguration(file, handle, type, bda);
         case BLOOPAIR_CONTROLLER_XBOX_ONE:
-            return LoadXboxOneCustomConfiguration(custom, handle, type, bda);
+            return LoadXboxOneCustomConfiguration(file, handle, type, bda);
         default: break;
     }
 
     return false;
 }
 
+static bool ReadFile(const std::filesystem::path& path, std::string& outContents)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    std::ostringstream stream;
+    stream << file.rdbuf();
+    outContents = std::move(stream).str();
+    return true;
+}
+
+static bool ParseConfigurationFile(const std::filesystem::path& path, bool allowMismatch, BloopairConfigFile& outConfig)
+{
+    std::string contents;
+    if (!ReadFile(path, contents)) {
+        return false;
+    }
+
+    // Files written by Koopair can be checked without parsing them
+    if (!allowMismatch && Bloopair_CheckConfigFile(contents.data(), contents.size()) == BLOOPAIR_CONFIG_CHECK_MISMATCH) {
+        OSReport("Bloopair Loader: Checksum mismatch in %s\n", path.filename().c_str());
+        return false;
+    }
+
+    // The checksum header is a comment
+    return Bloopair_DecodeConfigFile(contents.data(), contents.size(), &outConfig);
+}
+
+// Falls back to the backup Koopair keeps if the configuration is damaged.
+// A file edited by hand without removing the checksum is only used if there's nothing else.
+static bool ParseConfiguration(const std::filesystem::path& path, BloopairConfigFile& outConfig)
+{
+    std::filesystem::path backupPath = path.string() + BLOOPAIR_CONFIG_BACKUP_SUFFIX;
+
+    for (bool allowMismatch : { false, true }) {
+        if (ParseConfigurationFile(path, allowMismatch, outConfig) || ParseConfigurationFile(backupPath, allowMismatch, outConfig)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 static bool LoadAndApplySingleConfiguration(const std::filesystem::path& path, BloopairControllerType nameType, const uint8_t* bda, IOSHandle handle)
 {
-    nlohmann::json config = nlohmann::json::parse(std::ifstream(path), nullptr, false);
-    if (config.is_discarded()) {
+    BloopairConfigFile config;
+    if (!ParseConfiguration(path, config)) {
         OSReport("Bloopair Loader: Invalid json\n");
         return false;
     }
 
     // Version check
-    if (config.contains("version") &&
-       (config["version"].get<uint32_t>() < BLOOPAIR_CONFIG_VERSION_MIN ||
-        config["version"].get<uint32_t>() > BLOOPAIR_CONFIG_VERSION_MAX)) {
+    if (config.version < BLOOPAIR_CONFIG_VERSION_MIN || config.version > BLOOPAIR_CONFIG_VERSION_MAX) {
         OSReport("Bloopair Loader: Unsupported version\n");
         return false;
     }
 
     // Controller type check
-    BloopairControllerType controllerType = BLOOPAIR_CONTROLLER_INVALID;
-    if (config.contains("controllerType")) {
-        std::string typeString = config["controllerType"].get<std::string>();
-        if (bloopairControllerTypeValues.contains(typeString)) {
-            controllerType = bloopairControllerTypeValues.at(typeString);
-        } else {
-            OSReport("Bloopair Loader: Configuration contains invalid controller type\n");
-            return false;
-        }
-    } else {
-        OSReport("Bloopair Loader: Configuration is missing controller type\n");
+    if (config.controllerType == BLOOPAIR_CONTROLLER_INVALID) {
+        OSReport("Bloopair Loader: Configuration is missing controller type or it's invalid\n");
         return false;
     }
 
+    BloopairControllerType controllerType = config.controllerType;
     if (nameType != BLOOPAIR_CONTROLLER_INVALID && controllerType != nameType) {
         OSReport("Bloopair Loader: Configuration name doesn't match controller type in content\n");
         return false;
     }
 
-    if (config.contains("configuration")) {
-        if (!LoadCommonConfiguration(config["configuration"], handle, controllerType, bda)) {
+    if (config.fields & BLOOPAIR_CONFIG_FILE_HAS_COMMON) {
+        if (!LoadCommonConfiguration(config, handle, controllerType, bda)) {
             OSReport("Bloopair Loader: Failed to load common configuration\n");
         }
     }
 
-    if (config.contains("mapping")) {
-        if (!LoadControllerMapping(config["mapping"], handle, controllerType, bda)) {
+    if (config.fields & BLOOPAIR_CONFIG_FILE_HAS_MAPPING) {
+        if (!LoadControllerMapping(config, handle, controllerType, bda)) {
             OSReport("Bloopair Loader: Failed to load controller mapping\n");
         }
     }
 
-    if (config.contains("custom")) {
-        if (!LoadCustomConfiguration(config["custom"], handle, controllerType, bda)) {
+    if (config.fields & BLOOPAIR_CONFIG_FILE_HAS_ACTIONS) {
+        if (!LoadControllerActions(config, handle, controllerType, bda)) {
+            OSReport("Bloopair Loader: Failed to load controller actions\n");
+        }
+    }
+
+    if (config.fields & BLOOPAIR_CONFIG_FILE_HAS_CUSTOM) {
+        if (!LoadCustomConfiguration(config, handle, controllerType, bda)) {
             OSReport("Bloopair Loader: Failed to load custom configuration\n");
         }
     }
@@ -270,66 +263,243 @@ static bool LoadAndApplySingleConfiguration(const std::filesystem::path& path, B
     return true;
 }
 
-bool HexToBDA(const std::string& hex, uint8_t* bda)
+static bool LoadAndApplyDeviceEntries(IOSHandle handle)
 {
-    // Need exactly 12 hex characters for a bda
-    if (hex.size() != 12) {
+    std::error_code ec;
+    std::filesystem::path path = BLOOPAIR_CONFIGURATION_DIR BLOOPAIR_DEVICES_FILENAME;
+    if (!std::filesystem::exists(path, ec)) {
+        return true;
+    }
+
+    std::string contents;
+    std::vector<BloopairDeviceEntry> entries;
+    uint32_t version;
+    auto addEntry = [](const BloopairDeviceEntry* entry, void* userdata) {
+        static_cast<std::vector<BloopairDeviceEntry>*>(userdata)->push_back(*entry);
+    };
+
+    if (!ReadFile(path, contents) || !Bloopair_DecodeDevicesFile(contents.data(), contents.size(), &version, addEntry, &entries)) {
+        OSReport("Bloopair Loader: Invalid json or devices is missing\n");
         return false;
     }
 
-    // Only support uppercase hex characters
-    auto char2int = ([](char in) -> int {
-        if(in >= '0' && in <= '9')
-            return in - '0';
-        if(in >= 'A' && in <= 'F')
-            return in - 'A' + 10;
-        return -1;
-    });
+    // Version check
+    if (version < BLOOPAIR_CONFIG_VERSION_MIN || version > BLOOPAIR_CONFIG_VERSION_MAX) {
+        OSReport("Bloopair Loader: Unsupported version\n");
+        return false;
+    }
 
-    for (size_t i = 0; i < hex.size(); i += 2) {
-        int hi = char2int(hex[i]);
-        int lo = char2int(hex[i + 1]);
-        if (hi == -1 || lo == -1) {
+    for (size_t i = 0; i < entries.size(); i += BLOOPAIR_MAX_DEVICE_ENTRIES_PER_REQUEST) {
+        uint32_t num = std::min<size_t>(entries.size() - i, BLOOPAIR_MAX_DEVICE_ENTRIES_PER_REQUEST);
+        IOSError error = configCache.Submit(handle, ConfigCacheRecord::TYPE_DEVICES, BLOOPAIR_CONTROLLER_INVALID, nullptr,
+            entries.data() + i, num * sizeof(BloopairDeviceEntry));
+        if (error < 0) {
+            OSReport("Bloopair Loader: AddDeviceEntries failed %x\n", error);
             return false;
         }
-
-        *(bda++) = hi << 4 | lo;
     }
 
     return true;
 }
 
-bool LoadAndApplyBloopairConfiguration(IOSHandle handle)
+static bool ParseTitleProfileName(const std::string& name, uint64_t& outTitleId)
 {
-    std::regex regex("^Controller-([A-Za-z0-9-]+)\\.conf$");
+    // Title-<16 hex digits title id>
+    std::string prefix = BLOOPAIR_TITLE_PROFILE_PREFIX;
+    if (name.size() != prefix.size() + 16 || name.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
 
+    char* end;
+    outTitleId = std::strtoull(name.c_str() + prefix.size(), &end, 16);
+    return *end == '\0' && outTitleId != 0;
+}
+
+static void LoadAndApplyConfigurationDirectory(const std::filesystem::path& dir, IOSHandle handle)
+{
     std::error_code ec;
-    for (const auto& entry : std::filesystem::directory_iterator(BLOOPAIR_CONFIGURATION_DIR, ec)) {
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
         if (!entry.is_regular_file()) {
             continue;
         }
 
-        std::string filename = entry.path().filename().string();
-        std::smatch m;
-        if (!std::regex_search(filename, m, regex)) {
-            OSReport("Bloopair Loader: %s doesn't match filename pattern\n", filename.c_str());
+        std::filesystem::path path = entry.path();
+        std::string filename = path.filename().string();
+        if (filename == BLOOPAIR_DEVICES_FILENAME || filename == BLOOPAIR_CACHE_FILENAME) {
             continue;
         }
 
-        BloopairControllerType type = BLOOPAIR_CONTROLLER_INVALID;
+        // Leftovers from Koopair saving a configuration, complete temporary files were promoted already
+        if (filename.ends_with(BLOOPAIR_CONFIG_TEMP_SUFFIX) || filename.ends_with(BLOOPAIR_CONFIG_OLD_SUFFIX)) {
+            continue;
+        }
+
+        // Backups are loaded together with their configuration, unless saving stopped before the new file was in place
+        if (filename.ends_with(BLOOPAIR_CONFIG_BACKUP_SUFFIX)) {
+            path.replace_extension();
+            if (std::filesystem::exists(path, ec)) {
+                continue;
+            }
+
+            filename = path.filename().string();
+        }
+
+        BloopairControllerType type;
         uint8_t bda[6];
-        if (bloopairControllerTypeValues.contains(m.str(1))) {
-            type = bloopairControllerTypeValues.at(m.str(1));
-        } else if (!HexToBDA(m.str(1), bda)) {
-            OSReport("Bloopair Loader: %s has an invalid filename\n", filename.c_str());
+        if (!Bloopair_ParseConfigFilename(filename.c_str(), &type, bda)) {
+            OSReport("Bloopair Loader: %s isn't a valid configuration filename\n", filename.c_str());
             continue;
         }
 
-        if (!LoadAndApplySingleConfiguration(entry.path(), type, type ? nullptr : bda, handle)) {
+        if (!LoadAndApplySingleConfiguration(path, type, type ? nullptr : bda, handle)) {
             OSReport("Bloopair Loader: Failed to load %s\n", filename.c_str());
             continue;
         }
     }
+}
+
+// If saving stopped before Koopair renamed the new configuration into place, the temporary file is complete
+// as long as it passes the checksum check.
+static void PromoteTemporaryConfigurations(const std::filesystem::path& dir)
+{
+    std::vector<std::filesystem::path> tempPaths;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (entry.is_regular_file() && entry.path().filename().string().ends_with(BLOOPAIR_CONFIG_TEMP_SUFFIX)) {
+            tempPaths.push_back(entry.path());
+        }
+    }
+
+    // Renamed after iterating, so the directory doesn't change underneath the iterator
+    for (const std::filesystem::path& tempPath : tempPaths) {
+        std::filesystem::path path = tempPath;
+        path.replace_extension();
+
+        BloopairControllerType type;
+        uint8_t bda[6];
+        if (!Bloopair_ParseConfigFilename(path.filename().c_str(), &type, bda) || std::filesystem::exists(path, ec)) {
+            continue;
+        }
+
+        std::string contents;
+        if (!ReadFile(tempPath, contents) || Bloopair_CheckConfigFile(contents.data(), contents.size()) != BLOOPAIR_CONFIG_CHECK_VALID) {
+            continue;
+        }
+
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec) {
+            OSReport("Bloopair Loader: Failed to rename %s\n", tempPath.filename().c_str());
+        }
+    }
+}
+
+static std::vector<ConfigCacheSource> CollectConfigurationSources()
+{
+    std::vector<ConfigCacheSource> sources;
+    auto addSource = [&sources](const std::filesystem::directory_entry& entry, const std::string& path) {
+        std::error_code ec;
+        ConfigCacheSource source{};
+        source.path = path;
+        source.size = entry.file_size(ec);
+        source.mtime = entry.last_write_time(ec).time_since_epoch().count();
+        sources.push_back(source);
+    };
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(BLOOPAIR_CONFIGURATION_DIR, ec)) {
+        std::string name = entry.path().filename().string();
+        if (entry.is_regular_file()) {
+            // The cache and its temporary file aren't configuration files
+            if (name.rfind(BLOOPAIR_CACHE_FILENAME, 0) != 0) {
+                addSource(entry, name);
+            }
+            continue;
+        }
+
+        uint64_t titleId;
+        if (!entry.is_directory() || !ParseTitleProfileName(name, titleId)) {
+            continue;
+        }
+
+        for (const auto& titleEntry : std::filesystem::directory_iterator(entry.path(), ec)) {
+            if (titleEntry.is_regular_file()) {
+                addSource(titleEntry, name + "/" + titleEntry.path().filename().string());
+            }
+        }
+    }
+
+    // Directory order isn't guaranteed to stay the same
+    std::sort(sources.begin(), sources.end(), [](const ConfigCacheSource& a, const ConfigCacheSource& b) {
+        return a.path < b.path;
+    });
+
+    return sources;
+}
+
+bool LoadAndApplyBloopairConfiguration(IOSHandle handle)
+{
+    std::filesystem::path cachePath = BLOOPAIR_CONFIGURATION_DIR BLOOPAIR_CACHE_FILENAME;
+
+    // Before collecting the sources, so the cache matches the directory after promoting
+    std::error_code ec;
+    PromoteTemporaryConfigurations(BLOOPAIR_CONFIGURATION_DIR);
+    for (const auto& entry : std::filesystem::directory_iterator(BLOOPAIR_CONFIGURATION_DIR, ec)) {
+        uint64_t titleId;
+        if (entry.is_directory() && ParseTitleProfileName(entry.path().filename().string(), titleId)) {
+            PromoteTemporaryConfigurations(entry.path());
+        }
+    }
+
+    std::vector<ConfigCacheSource> sources = CollectConfigurationSources();
+    int32_t version = Bloopair_GetVersion(handle);
+
+    // Release builds don't have a commit hash
+    char commitHash[41];
+    if (Bloopair_GetCommitHash(handle, commitHash, sizeof(commitHash)) < 0) {
+        commitHash[0] = '\0';
+    }
+
+    // If none of the files changed, the payloads from the cache can be submitted without parsing anything
+    if (configCache.Load(cachePath, version, commitHash, sources)) {
+        if (configCache.Apply(handle)) {
+            return true;
+        }
+
+        // Applying is idempotent, so just parse everything again
+        OSReport("Bloopair Loader: Failed to apply %s\n", BLOOPAIR_CACHE_FILENAME);
+        Bloopair_SetConfigurationProfile(handle, 0);
+    }
+
+    configCache = ConfigCache();
+
+    if (!LoadAndApplyDeviceEntries(handle)) {
+        OSReport("Bloopair Loader: Failed to load %s\n", BLOOPAIR_DEVICES_FILENAME);
+    }
+
+    LoadAndApplyConfigurationDirectory(BLOOPAIR_CONFIGURATION_DIR, handle);
+
+    // Preload the profiles of all titles, so switching between them doesn't need to touch the sd card
+    for (const auto& entry : std::filesystem::directory_iterator(BLOOPAIR_CONFIGURATION_DIR, ec)) {
+        uint64_t titleId;
+        if (!entry.is_directory() || !ParseTitleProfileName(entry.path().filename().string(), titleId)) {
+            continue;
+        }
+
+        IOSError error = configCache.Submit(handle, ConfigCacheRecord::TYPE_PROFILE, BLOOPAIR_CONTROLLER_INVALID, nullptr, &titleId, sizeof(titleId));
+        if (error < 0) {
+            OSReport("Bloopair Loader: SetConfigurationProfile failed %x\n", error);
+            continue;
+        }
+
+        LoadAndApplyConfigurationDirectory(entry.path(), handle);
+    }
+
+    uint64_t globalProfile = 0;
+    configCache.Submit(handle, ConfigCacheRecord::TYPE_PROFILE, BLOOPAIR_CONTROLLER_INVALID, nullptr, &globalProfile, sizeof(globalProfile));
+
+    if (!configCache.Save(cachePath, version, commitHash, sources)) {
+        OSReport("Bloopair Loader: Failed to write %s\n", BLOOPAIR_CACHE_FILENAME);
+    }
 
     return true;
 }
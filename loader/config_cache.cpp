@@ -0,0 +1,299 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config_cache.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <coreinit/debug.h>
+
+#include <bloopair/bloopair.h>
+
+#define CONFIG_CACHE_MAGIC      0x42504343 // BPCC
+// Bump this when the layout of the cache or of the records changes
+#define CONFIG_CACHE_VERSION    2
+
+struct ConfigCacheHeader {
+    uint32_t magic;
+    uint32_t cacheVersion;
+    int32_t bloopairVersion;
+    // debug builds share a version, so the commit hash tells them apart, empty for release builds
+    char commitHash[41];
+    uint8_t reserved[3];
+    uint32_t numSources;
+    uint32_t numRecords;
+};
+
+struct ConfigCacheSourceHeader {
+    uint64_t size;
+    int64_t mtime;
+    uint32_t pathLength;
+};
+
+struct ConfigCacheRecordHeader {
+    uint8_t type;
+    uint8_t controllerType;
+    uint8_t hasBda;
+    uint8_t bda[6];
+    uint8_t reserved;
+    uint16_t dataSize;
+};
+
+namespace {
+
+class CacheReader {
+public:
+    CacheReader(const std::vector<uint8_t>& data) : mData(data), mOffset(0) { }
+
+    bool Read(void* out, size_t size)
+    {
+        if (mData.size() - mOffset < size) {
+            return false;
+        }
+
+        std::memcpy(out, mData.data() + mOffset, size);
+        mOffset += size;
+        return true;
+    }
+
+    bool AtEnd() const { return mOffset == mData.size(); }
+
+private:
+    const std::vector<uint8_t>& mData;
+    size_t mOffset;
+};
+
+class CacheWriter {
+public:
+    void Write(const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        mData.insert(mData.end(), bytes, bytes + size);
+    }
+
+    const std::vector<uint8_t>& Data() const { return mData; }
+
+private:
+    std::vector<uint8_t> mData;
+};
+
+}
+
+bool ConfigCache::Load(const std::filesystem::path& path, int32_t version, const std::string& commitHash, const std::vector<ConfigCacheSource>& sources)
+{
+    mRecords.clear();
+
+    // Read the whole cache at once
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    CacheReader reader(data);
+
+    ConfigCacheHeader header;
+    if (!reader.Read(&header, sizeof(header)) ||
+        header.magic != CONFIG_CACHE_MAGIC ||
+        header.cacheVersion != CONFIG_CACHE_VERSION ||
+        header.bloopairVersion != version ||
+        strnlen(header.commitHash, sizeof(header.commitHash)) == sizeof(header.commitHash) ||
+        header.commitHash != commitHash ||
+        header.numSources != sources.size()) {
+        return false;
+    }
+
+    // Any added, removed or modified file makes the cache stale
+    for (const ConfigCacheSource& source : sources) {
+        ConfigCacheSourceHeader sourceHeader;
+        if (!reader.Read(&sourceHeader, sizeof(sourceHeader)) ||
+            sourceHeader.size != source.size ||
+            sourceHeader.mtime != source.mtime ||
+            sourceHeader.pathLength != source.path.size()) {
+            return false;
+        }
+
+        std::string sourcePath(sourceHeader.pathLength, '\0');
+        if (!reader.Read(sourcePath.data(), sourcePath.size()) || sourcePath != source.path) {
+            return false;
+        }
+    }
+
+    std::vector<ConfigCacheRecord> records(header.numRecords);
+    for (ConfigCacheRecord& record : records) {
+        ConfigCacheRecordHeader recordHeader;
+        if (!reader.Read(&recordHeader, sizeof(recordHeader))) {
+            return false;
+        }
+
+        record.type = (ConfigCacheRecord::Type) recordHeader.type;
+        record.controllerType = (BloopairControllerType) recordHeader.controllerType;
+        record.hasBda = recordHeader.hasBda;
+        std::memcpy(record.bda, recordHeader.bda, sizeof(record.bda));
+
+        record.data.resize(recordHeader.dataSize);
+        if (!reader.Read(record.data.data(), record.data.size())) {
+            return false;
+        }
+    }
+
+    // A cache which was only partially written has a different size
+    if (!reader.AtEnd()) {
+        return false;
+    }
+
+    mRecords = std::move(records);
+    return true;
+}
+
+bool ConfigCache::Save(const std::filesystem::path& path, int32_t version, const std::string& commitHash, const std::vector<ConfigCacheSource>& sources) const
+{
+    if (commitHash.size() >= sizeof(ConfigCacheHeader::commitHash)) {
+        return false;
+    }
+
+    CacheWriter writer;
+
+    ConfigCacheHeader header{};
+    header.magic = CONFIG_CACHE_MAGIC;
+    header.cacheVersion = CONFIG_CACHE_VERSION;
+    header.bloopairVersion = version;
+    std::memcpy(header.commitHash, commitHash.data(), commitHash.size());
+    header.numSources = sources.size();
+    header.numRecords = mRecords.size();
+    writer.Write(&header, sizeof(header));
+
+    for (const ConfigCacheSource& source : sources) {
+        ConfigCacheSourceHeader sourceHeader{};
+        sourceHeader.size = source.size;
+        sourceHeader.mtime = source.mtime;
+        sourceHeader.pathLength = source.path.size();
+        writer.Write(&sourceHeader, sizeof(sourceHeader));
+        writer.Write(source.path.data(), source.path.size());
+    }
+
+    for (const ConfigCacheRecord& record : mRecords) {
+        ConfigCacheRecordHeader recordHeader{};
+        recordHeader.type = record.type;
+        recordHeader.controllerType = record.controllerType;
+        recordHeader.hasBda = record.hasBda;
+        std::memcpy(recordHeader.bda, record.bda, sizeof(recordHeader.bda));
+        recordHeader.dataSize = record.data.size();
+        writer.Write(&recordHeader, sizeof(recordHeader));
+        writer.Write(record.data.data(), record.data.size());
+    }
+
+    // A cache which is cut off while writing would just be dropped on the next boot,
+    // but writing it next to the previous one keeps the previous cache around until then
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(writer.Data().data()), writer.Data().size());
+    file.close();
+
+    std::error_code ec;
+    if (!file) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+
+    // Renaming doesn't replace existing files on the SD card
+    std::filesystem::remove(path, ec);
+    std::filesystem::rename(tempPath, path, ec);
+    return !ec;
+}
+
+IOSError ConfigCache::Submit(IOSHandle handle, ConfigCacheRecord::Type type, BloopairControllerType controllerType, const uint8_t* bda, const void* data, uint32_t size)
+{
+    ConfigCacheRecord record{};
+    record.type = type;
+    record.controllerType = controllerType;
+    record.hasBda = bda != nullptr;
+    if (bda) {
+        std::memcpy(record.bda, bda, sizeof(record.bda));
+    }
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    record.data.assign(bytes, bytes + size);
+
+    IOSError error = Execute(handle, record);
+    if (error >= 0) {
+        mRecords.push_back(std::move(record));
+    }
+
+    return error;
+}
+
+bool ConfigCache::Apply(IOSHandle handle) const
+{
+    bool success = true;
+    for (const ConfigCacheRecord& record : mRecords) {
+        IOSError error = Execute(handle, record);
+        if (error < 0) {
+            OSReport("Bloopair Loader: Failed to apply cached record %u: %x\n", record.type, error);
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+IOSError ConfigCache::Execute(IOSHandle handle, const ConfigCacheRecord& record)
+{
+    const uint8_t* bda = record.hasBda ? record.bda : nullptr;
+    const void* data = record.data.data();
+    uint32_t size = record.data.size();
+
+    switch (record.type) {
+    case ConfigCacheRecord::TYPE_COMMON:
+        if (size != sizeof(BloopairCommonConfiguration)) {
+            return IOS_ERROR_INVALIDARG;
+        }
+
+        return bda ? Bloopair_ApplyControllerConfigurationForBDA(handle, bda, (const BloopairCommonConfiguration*) data) :
+            Bloopair_ApplyControllerConfigurationForControllerType(handle, record.controllerType, (const BloopairCommonConfiguration*) data);
+    case ConfigCacheRecord::TYPE_MAPPING: {
+        uint8_t num = size / sizeof(BloopairMappingEntry);
+        return bda ? Bloopair_ApplyControllerMappingForBDA(handle, bda, (const BloopairMappingEntry*) data, num) :
+            Bloopair_ApplyControllerMappingForControllerType(handle, record.controllerType, (const BloopairMappingEntry*) data, num);
+    }
+    case ConfigCacheRecord::TYPE_ACTIONS: {
+        uint8_t num = size / sizeof(BloopairActionEntry);
+        return bda ? Bloopair_ApplyControllerActionsForBDA(handle, bda, (const BloopairActionEntry*) data, num) :
+            Bloopair_ApplyControllerActionsForControllerType(handle, record.controllerType, (const BloopairActionEntry*) data, num);
+    }
+    case ConfigCacheRecord::TYPE_CUSTOM:
+        return bda ? Bloopair_ApplyCustomConfigurationForBDA(handle, bda, data, size) :
+            Bloopair_ApplyCustomConfigurationForControllerType(handle, record.controllerType, data, size);
+    case ConfigCacheRecord::TYPE_DEVICES:
+        return Bloopair_AddDeviceEntries(handle, (const BloopairDeviceEntry*) data, size / sizeof(BloopairDeviceEntry));
+    case ConfigCacheRecord::TYPE_PROFILE: {
+        uint64_t titleId;
+        if (size != sizeof(titleId)) {
+            return IOS_ERROR_INVALIDARG;
+        }
+
+        std::memcpy(&titleId, data, sizeof(titleId));
+        return Bloopair_SetConfigurationProfile(handle, titleId);
+    }
+    }
+
+    return IOS_ERROR_INVALIDARG;
+}
@@ -0,0 +1,74 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <coreinit/ios.h>
+#include <bloopair/controllers/common.h>
+
+// A file the cached payloads were created from
+struct ConfigCacheSource {
+    std::string path;
+    uint64_t size;
+    int64_t mtime;
+
+    bool operator==(const ConfigCacheSource& other) const = default;
+};
+
+// A single payload submitted to Bloopair
+struct ConfigCacheRecord {
+    enum Type : uint8_t {
+        TYPE_COMMON,
+        TYPE_MAPPING,
+        TYPE_ACTIONS,
+        TYPE_CUSTOM,
+        TYPE_DEVICES,
+        TYPE_PROFILE,
+    };
+
+    Type type;
+    BloopairControllerType controllerType;
+    // if set the payload is for the bda instead of the controller type
+    bool hasBda;
+    uint8_t bda[6];
+    std::vector<uint8_t> data;
+};
+
+// Stores the payloads resolved from the configuration files, so later boots don't need to parse them again
+class ConfigCache {
+public:
+    // Loads the cache, fails if it was created from other sources or for another Bloopair version or build
+    bool Load(const std::filesystem::path& path, int32_t version, const std::string& commitHash, const std::vector<ConfigCacheSource>& sources);
+
+    // Writes the cache to a temporary file first, which replaces the previous cache once it's complete
+    bool Save(const std::filesystem::path& path, int32_t version, const std::string& commitHash, const std::vector<ConfigCacheSource>& sources) const;
+
+    // Submits a payload and records it for the cache
+    IOSError Submit(IOSHandle handle, ConfigCacheRecord::Type type, BloopairControllerType controllerType, const uint8_t* bda, const void* data, uint32_t size);
+
+    // Submits all recorded payloads
+    bool Apply(IOSHandle handle) const;
+
+private:
+    static IOSError Execute(IOSHandle handle, const ConfigCacheRecord& record);
+
+    std::vector<ConfigCacheRecord> mRecords;
+};
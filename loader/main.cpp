@@ -22,6 +22,7 @@
 #include <string>
 
 #include <coreinit/foreground.h>
+#include <coreinit/title.h>
 #include <coreinit/cache.h>
 #include <coreinit/memorymap.h>
 #include <coreinit/dynload.h>
@@ -106,6 +107,11 @@ int main(int argc, char **argv)
         LoadAndApplyBloopairConfiguration(bloopairHandle);
     }
 
+    // The loader runs on every title launch, switch to the profile of the title which is starting
+    if (Bloopair_SelectProfile(bloopairHandle, OSGetTitleID()) < 0) {
+        OSReport("Bloopair Loader: Failed to select profile\n");
+    }
+
     Bloopair_Close(bloopairHandle);
 
     return 0;
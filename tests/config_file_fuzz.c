@@ -0,0 +1,215 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Fuzzes the configuration file codec. Everything which decodes has to encode into a file which decodes to the same
+// configuration again, so the loader and Koopair agree on every file either of them writes.
+//
+// Built with libFuzzer (make fuzz CC=clang) LLVMFuzzerTestOneInput is the entry point,
+// otherwise main mutates the seeds below for a fixed amount of rounds, which is what make check runs.
+
+#include "test.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <bloopair/config_file.h>
+
+static const char* seeds[] = {
+    "// bloopair-checksum 0000002A 1C291CA3 (remove this line when editing by hand)\n"
+    "{\"version\":0,\"controllerType\":\"Switch-Pro\",\"configuration\":{\"stickAsButtonDeadzone\":420,\"reportInterval\":8,"
+    "\"triggerThreshold\":256,\"triggerHysteresis\":64,\"quirks\":[\"noRumble\",\"noLed\"]},"
+    "\"mapping\":{\"a\":[1],\"b\":[0,5],\"zl\":[40]},\"custom\":{\"disableCalibration\":true,\"combineWith\":\"AABBCCDDEEFF\"}}",
+
+    "{\n"
+    "    \"version\": 0,\n"
+    "    \"controllerType\": \"DualSense\",\n"
+    "    \"actions\": [\n"
+    "        { \"type\": \"turbo\", \"trigger\": [ \"a\" ], \"buttons\": [ \"a\" ], \"rate\": 15 },\n"
+    "        { \"type\": \"toggle\", \"trigger\": [ \"zr\" ], \"buttons\": [ \"zr\" ] },\n"
+    "        { \"type\": \"chord\", \"trigger\": [ \"l\", \"r\" ], \"buttons\": [ \"home\" ] },\n"
+    "        { \"type\": \"sequence\", \"trigger\": [ \"minus\", \"down\" ], \"steps\": [\n"
+    "            { \"buttons\": [ \"down\" ], \"duration\": 50 },\n"
+    "            { \"buttons\": [ \"right\" ], \"duration\": 50 },\n"
+    "            { \"buttons\": [ \"y\" ], \"duration\": 100 }\n"
+    "        ] }\n"
+    "    ]\n"
+    "}\n",
+
+    "/* escapes and unknown fields */ {\"controllerType\":\"Xbox\\u002dOne\",\"unknown\":[{\"a\":null},false,-1.5e3],"
+    "\"mapping\":{\"lup\":2,\"r\\u00e9\":[1]}}",
+
+    "{\"version\":0,\"devices\":[{\"vendorId\":\"057e\",\"productId\":\"2069\",\"controllerType\":\"Switch-Pro\"},"
+    "{\"vendorId\":\"2dc8\",\"productId\":\"6001\",\"controllerType\":\"Generic-HID\",\"quirks\":[\"noRumble\"],\"reportInterval\":15}]}",
+};
+
+// A buffer which is exactly as large as the input, so reading past the end is caught by the sanitizers
+static char* copyInput(const uint8_t* data, size_t size)
+{
+    char* copy = malloc(size ? size : 1);
+    memcpy(copy, data, size);
+    return copy;
+}
+
+static void countDevice(const BloopairDeviceEntry* entry, void* userdata)
+{
+    (*(uint32_t*) userdata)++;
+}
+
+static char* encode(const BloopairConfigFile* file, uint32_t* outLength)
+{
+    uint32_t length = Bloopair_EncodeConfigFile(file, NULL, 0);
+    char* out = malloc(length + 1);
+
+    // the length has to be the same with and without a buffer
+    if (Bloopair_EncodeConfigFile(file, out, length + 1) != length || strlen(out) != length) {
+        fprintf(stderr, "encoded length mismatch\n");
+        abort();
+    }
+
+    // a buffer which is too small still gets terminated
+    if (length) {
+        char small[8];
+        Bloopair_EncodeConfigFile(file, small, sizeof(small));
+        if (strncmp(small, out, sizeof(small) - 1) != 0 || strlen(small) >= sizeof(small)) {
+            fprintf(stderr, "cut off encoding doesn't match\n");
+            abort();
+        }
+    }
+
+    *outLength = length;
+    return out;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    char* input = copyInput(data, size);
+
+    uint32_t version;
+    uint32_t numDevices = 0;
+    Bloopair_DecodeDevicesFile(input, size, &version, countDevice, &numDevices);
+
+    static BloopairConfigFile file;
+    static BloopairConfigFile again;
+    if (Bloopair_DecodeConfigFile(input, size, &file)) {
+        uint32_t length;
+        char* encoded = encode(&file, &length);
+
+        if (!Bloopair_DecodeConfigFile(encoded, length, &again)) {
+            fprintf(stderr, "encoded file doesn't decode:\n%s\n", encoded);
+            abort();
+        }
+
+        // mappings are grouped by their target, so compare the encoded files instead of the structs
+        uint32_t againLength;
+        char* reencoded = encode(&again, &againLength);
+        if (againLength != length || memcmp(encoded, reencoded, length) != 0) {
+            fprintf(stderr, "encoding doesn't round trip:\n%s\n%s\n", encoded, reencoded);
+            abort();
+        }
+
+        free(reencoded);
+        free(encoded);
+    }
+
+    free(input);
+    return 0;
+}
+
+#ifndef BLOOPAIR_LIBFUZZER
+
+static uint32_t nextRandom(uint32_t* state)
+{
+    // xorshift32, so every run covers the same inputs
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static const char tokens[] = "{}[]:,\"\\/*-.0123456789eEtfnu aZ\n";
+
+static size_t mutate(uint8_t* buf, size_t size, size_t maxSize, uint32_t* state)
+{
+    uint32_t numMutations = 1 + nextRandom(state) % 4;
+    for (uint32_t i = 0; i < numMutations; i++) {
+        size_t pos = size ? nextRandom(state) % size : 0;
+        switch (nextRandom(state) % 5) {
+        case 0: // replace a byte with a random one
+            if (size) {
+                buf[pos] = nextRandom(state);
+            }
+            break;
+        case 1: // replace a byte with something the parser looks at
+            if (size) {
+                buf[pos] = tokens[nextRandom(state) % (sizeof(tokens) - 1)];
+            }
+            break;
+        case 2: // insert a token
+            if (size < maxSize) {
+                memmove(buf + pos + 1, buf + pos, size - pos);
+                buf[pos] = tokens[nextRandom(state) % (sizeof(tokens) - 1)];
+                size++;
+            }
+            break;
+        case 3: { // remove a range
+            size_t length = size ? nextRandom(state) % (size - pos) + 1 : 0;
+            memmove(buf + pos, buf + pos + length, size - pos - length);
+            size -= length;
+            break;
+        }
+        case 4: { // duplicate a range, which nests containers deeper
+            size_t length = size ? nextRandom(state) % (size - pos) + 1 : 0;
+            length = length < maxSize - size ? length : maxSize - size;
+            memmove(buf + pos + length, buf + pos, size - pos);
+            size += length;
+            break;
+        }
+        }
+    }
+
+    return size;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t rounds = argc > 1 ? strtoul(argv[1], NULL, 0) : 200000;
+
+    static BloopairConfigFile file;
+    CHECK(Bloopair_DecodeConfigFile(seeds[0], strlen(seeds[0]), &file));
+    CHECK(Bloopair_DecodeConfigFile(seeds[1], strlen(seeds[1]), &file));
+    CHECK(Bloopair_DecodeConfigFile(seeds[2], strlen(seeds[2]), &file));
+
+    uint32_t version;
+    uint32_t numDevices = 0;
+    CHECK(Bloopair_DecodeDevicesFile(seeds[3], strlen(seeds[3]), &version, countDevice, &numDevices));
+    CHECK_EQ(numDevices, 2);
+
+    uint8_t buf[4096];
+    uint32_t state = 0x2545f491;
+    for (uint32_t i = 0; i < rounds; i++) {
+        const char* seed = seeds[nextRandom(&state) % (sizeof(seeds) / sizeof(seeds[0]))];
+        size_t size = strlen(seed);
+        memcpy(buf, seed, size);
+
+        size = mutate(buf, size, sizeof(buf), &state);
+        LLVMFuzzerTestOneInput(buf, size);
+    }
+
+    return TEST_RESULT();
+}
+
+#endif
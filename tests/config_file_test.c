@@ -0,0 +1,250 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Decodes the examples of the loader README and the edge cases of the configuration format,
+// and checks the exact JSON Koopair writes.
+
+#include "test.h"
+
+#include <string.h>
+#include <bloopair/config_file.h>
+
+static BloopairConfigFile file;
+
+static int decode(const char* json)
+{
+    return Bloopair_DecodeConfigFile(json, strlen(json), &file);
+}
+
+static void testCommon(void)
+{
+    CHECK(decode(
+        "// bloopair-checksum 00000000 00000000 (remove this line when editing by hand)\n"
+        "{ \"version\": 0, \"controllerType\": \"Switch-Pro\",\n"
+        "  \"configuration\": { \"triggerThreshold\": 256, \"triggerHysteresis\": 64, \"quirks\": [ \"noRumble\", \"unknown\", \"noLed\" ] } }"));
+    CHECK_EQ(file.controllerType, BLOOPAIR_CONTROLLER_SWITCH_PRO);
+    CHECK_EQ(file.fields, BLOOPAIR_CONFIG_FILE_HAS_COMMON | BLOOPAIR_CONFIG_FILE_HAS_TRIGGER_THRESHOLD |
+        BLOOPAIR_CONFIG_FILE_HAS_TRIGGER_HYSTERESIS | BLOOPAIR_CONFIG_FILE_HAS_QUIRKS);
+    CHECK_EQ(file.common.quirks, BLOOPAIR_QUIRK_NO_RUMBLE | BLOOPAIR_QUIRK_NO_LED);
+
+    // fields which aren't in the file keep the defaults
+    BloopairCommonConfiguration config = { .stickAsButtonDeadzone = 1000, .triggerThreshold = 1, .quirks = BLOOPAIR_QUIRK_SKIP_CALIBRATION };
+    Bloopair_ApplyConfigFileCommon(&file, &config);
+    CHECK_EQ(config.stickAsButtonDeadzone, 1000);
+    CHECK_EQ(config.triggerThreshold, 256);
+    CHECK_EQ(config.triggerHysteresis, 64);
+    CHECK_EQ(config.quirks, BLOOPAIR_QUIRK_NO_RUMBLE | BLOOPAIR_QUIRK_NO_LED);
+
+    // values which don't fit or have the wrong type are ignored
+    CHECK(decode("{\"configuration\":{\"stickAsButtonDeadzone\":70000,\"reportInterval\":\"8\",\"triggerThreshold\":1.5,\"triggerHysteresis\":-1}}"));
+    CHECK_EQ(file.fields, BLOOPAIR_CONFIG_FILE_HAS_COMMON);
+    CHECK_EQ(file.controllerType, BLOOPAIR_CONTROLLER_INVALID);
+
+    CHECK(decode("{\"controllerType\":\"Switch-Pr\"}"));
+    CHECK_EQ(file.controllerType, BLOOPAIR_CONTROLLER_INVALID);
+}
+
+static void testMapping(void)
+{
+    CHECK(decode("{ \"mapping\": { \"zl\": [ 40 ], \"lright\": [ 41, 3 ], \"rtrigger\": 35, \"nothing\": [ 1 ] } }"));
+    CHECK(file.fields & BLOOPAIR_CONFIG_FILE_HAS_MAPPING);
+    CHECK_EQ(file.numMappings, 4);
+    CHECK_EQ(file.mappings[0].from, 40);
+    CHECK_EQ(file.mappings[0].to, BLOOPAIR_PRO_TRIGGER_ZL);
+    CHECK_EQ(file.mappings[1].from, 41);
+    CHECK_EQ(file.mappings[1].to, BLOOPAIR_PRO_STICK_L_RIGHT);
+    CHECK_EQ(file.mappings[2].from, 3);
+    CHECK_EQ(file.mappings[3].from, 35);
+    CHECK_EQ(file.mappings[3].to, BLOOPAIR_PRO_ANALOG_TRIGGER_R);
+
+    // more mappings than the IOS module can take leave out the whole mapping
+    char json[4096] = "{\"mapping\":{\"a\":[0";
+    for (int i = 1; i < BLOOPAIR_MAX_MAPPINGS + 1; i++) {
+        strcat(json, ",1");
+    }
+    strcat(json, "]}}");
+    CHECK(decode(json));
+    CHECK(!(file.fields & BLOOPAIR_CONFIG_FILE_HAS_MAPPING));
+    CHECK_EQ(file.numMappings, 0);
+}
+
+static void testActions(void)
+{
+    CHECK(decode(
+        "{ \"actions\": [\n"
+        "    { \"type\": \"turbo\", \"trigger\": [ \"a\" ], \"buttons\": [ \"a\" ], \"rate\": 15 },\n"
+        "    { \"type\": \"toggle\", \"trigger\": [ \"zr\" ], \"buttons\": [ \"zr\" ] },\n"
+        "    { \"type\": \"chord\", \"trigger\": [ \"l\", \"r\" ], \"buttons\": [ \"home\" ] },\n"
+        "    { \"steps\": [\n"
+        "        { \"buttons\": [ \"down\" ], \"duration\": 50 },\n"
+        "        { \"buttons\": [ \"right\" ], \"duration\": 50 },\n"
+        "        { \"buttons\": [ \"y\" ], \"duration\": 100 }\n"
+        "    ], \"type\": \"sequence\", \"trigger\": [ \"minus\", \"down\" ] },\n"
+        "    { \"type\": \"sequence\", \"trigger\": [ \"x\" ], \"steps\": [] },\n"
+        "    { \"type\": \"unknown\", \"trigger\": [ \"x\" ], \"steps\": [ {} ] },\n"
+        "    { \"type\": \"turbo\", \"trigger\": [ \"b\", \"lup\" ], \"buttons\": [ \"b\" ] }\n"
+        "] }"));
+    CHECK(file.fields & BLOOPAIR_CONFIG_FILE_HAS_ACTIONS);
+    CHECK_EQ(file.numActions, 8);
+
+    CHECK_EQ(file.actions[0].type, BLOOPAIR_ACTION_TURBO);
+    CHECK_EQ(file.actions[0].param, 15);
+    CHECK_EQ(file.actions[0].trigger, BTN(BLOOPAIR_PRO_BUTTON_A));
+    CHECK_EQ(file.actions[1].type, BLOOPAIR_ACTION_TOGGLE);
+    CHECK_EQ(file.actions[2].trigger, BTN(BLOOPAIR_PRO_TRIGGER_L) | BTN(BLOOPAIR_PRO_TRIGGER_R));
+
+    // the steps came before the type, they still end up after their sequence
+    CHECK_EQ(file.actions[3].type, BLOOPAIR_ACTION_SEQUENCE);
+    CHECK_EQ(file.actions[3].param, 3);
+    CHECK_EQ(file.actions[3].trigger, BTN(BLOOPAIR_PRO_BUTTON_MINUS) | BTN(BLOOPAIR_PRO_BUTTON_DOWN));
+    CHECK_EQ(file.actions[4].type, BLOOPAIR_ACTION_SEQUENCE_STEP);
+    CHECK_EQ(file.actions[4].buttons, BTN(BLOOPAIR_PRO_BUTTON_DOWN));
+    CHECK_EQ(file.actions[4].param, 5);
+    CHECK_EQ(file.actions[6].param, 10);
+
+    // the sequence without steps and the unknown action are skipped, stick directions can't be action buttons
+    CHECK_EQ(file.actions[7].type, BLOOPAIR_ACTION_TURBO);
+    CHECK_EQ(file.actions[7].param, 10);
+    CHECK_EQ(file.actions[7].trigger, BTN(BLOOPAIR_PRO_BUTTON_B));
+
+    // more entries than the IOS module can take leave out all actions
+    char json[8192] = "{\"actions\":[{\"type\":\"sequence\",\"trigger\":[\"a\"],\"steps\":[{}";
+    for (int i = 1; i < BLOOPAIR_MAX_ACTIONS; i++) {
+        strcat(json, ",{}");
+    }
+    strcat(json, "]}]}");
+    CHECK(decode(json));
+    CHECK(!(file.fields & BLOOPAIR_CONFIG_FILE_HAS_ACTIONS));
+    CHECK_EQ(file.numActions, 0);
+}
+
+static void testCustom(void)
+{
+    CHECK(decode("{ \"custom\": { \"combineWith\": \"AABBCCDDEEFF\" } }"));
+    CHECK_EQ(file.fields, BLOOPAIR_CONFIG_FILE_HAS_CUSTOM | BLOOPAIR_CONFIG_FILE_HAS_COMBINE_WITH);
+
+    SwitchConfiguration config = { .disableCalibration = 1 };
+    Bloopair_ApplyConfigFileSwitch(&file, &config);
+    CHECK_EQ(config.disableCalibration, 1);
+    CHECK_EQ(config.combineWith[0], 0xaa);
+    CHECK_EQ(config.combineWith[5], 0xff);
+
+    CHECK(decode("{ \"custom\": { \"combineWith\": \"aabbccddeeff\", \"disableCalibration\": false } }"));
+    CHECK_EQ(file.fields, BLOOPAIR_CONFIG_FILE_HAS_CUSTOM | BLOOPAIR_CONFIG_FILE_HAS_DISABLE_CALIBRATION);
+}
+
+static void testInvalid(void)
+{
+    static const char* invalid[] = {
+        "",
+        "[]",
+        "{",
+        "{\"version\":0,}",
+        "{\"version\":01}",
+        "{\"version\":0} {}",
+        "{\"a\":\"\\x\"}",
+        "{\"a\":\"\\ud800\"}",
+        "{\"a\":tru}",
+        "/* unterminated {}",
+        "{\"a\":" "[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[" "]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]" "}",
+    };
+
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        if (decode(invalid[i])) {
+            fprintf(stderr, "%s: expected invalid\n", invalid[i]);
+            test_failures++;
+        }
+    }
+}
+
+static void testEncode(void)
+{
+    memset(&file, 0, sizeof(file));
+    file.controllerType = BLOOPAIR_CONTROLLER_SWITCH_JOYCON_LEFT;
+    file.fields = BLOOPAIR_CONFIG_FILE_HAS_ALL_COMMON | BLOOPAIR_CONFIG_FILE_HAS_MAPPING |
+        BLOOPAIR_CONFIG_FILE_HAS_CUSTOM | BLOOPAIR_CONFIG_FILE_HAS_DISABLE_CALIBRATION;
+    file.common.stickAsButtonDeadzone = 420;
+    file.common.quirks = BLOOPAIR_QUIRK_NO_LED | BLOOPAIR_QUIRK_SKIP_CALIBRATION;
+    file.mappings[0] = (BloopairMappingEntry) { 5, BLOOPAIR_PRO_BUTTON_B };
+    file.mappings[1] = (BloopairMappingEntry) { 4, BLOOPAIR_PRO_BUTTON_A };
+    file.mappings[2] = (BloopairMappingEntry) { 7, BLOOPAIR_PRO_BUTTON_B };
+    file.numMappings = 3;
+    file.disableCalibration = 1;
+
+    char out[512];
+    uint32_t length = Bloopair_EncodeConfigFile(&file, out, sizeof(out));
+    const char* expected = "{\"version\":0,\"controllerType\":\"Switch-JoyCon-Left\","
+        "\"configuration\":{\"stickAsButtonDeadzone\":420,\"reportInterval\":0,\"triggerThreshold\":0,\"triggerHysteresis\":0,"
+        "\"quirks\":[\"skipCalibration\",\"noLed\"]},\"mapping\":{\"a\":[4],\"b\":[5,7]},\"custom\":{\"disableCalibration\":true}}";
+    CHECK_EQ(length, strlen(expected));
+    if (strcmp(out, expected) != 0) {
+        fprintf(stderr, "encoded:\n%s\nexpected:\n%s\n", out, expected);
+        test_failures++;
+    }
+}
+
+static void collectDevice(const BloopairDeviceEntry* entry, void* userdata)
+{
+    BloopairDeviceEntry* entries = userdata;
+    for (int i = 0; i < 4; i++) {
+        if (!entries[i].vendor_id) {
+            entries[i] = *entry;
+            return;
+        }
+    }
+}
+
+static void testDevices(void)
+{
+    const char* json =
+        "{\n"
+        "    \"version\": 0,\n"
+        "    \"devices\": [\n"
+        "        { \"vendorId\": \"057e\", \"productId\": \"2069\", \"controllerType\": \"Switch-Pro\" },\n"
+        "        { \"vendorId\": \"2dc8\", \"productId\": \"6001\", \"controllerType\": \"Generic-HID\", \"quirks\": [ \"noRumble\" ], \"reportInterval\": 15 },\n"
+        "        { \"vendorId\": \"12345\", \"productId\": \"1\", \"controllerType\": \"Generic-HID\" },\n"
+        "        { \"vendorId\": \"1\", \"productId\": \"1\", \"controllerType\": \"Nothing\" }\n"
+        "    ]\n"
+        "}\n";
+
+    BloopairDeviceEntry entries[4] = { 0 };
+    uint32_t version = 1;
+    CHECK(Bloopair_DecodeDevicesFile(json, strlen(json), &version, collectDevice, entries));
+    CHECK_EQ(version, 0);
+    CHECK_EQ(entries[0].vendor_id, 0x057e);
+    CHECK_EQ(entries[0].product_id, 0x2069);
+    CHECK_EQ(entries[0].controllerType, BLOOPAIR_CONTROLLER_SWITCH_PRO);
+    CHECK_EQ(entries[1].vendor_id, 0x2dc8);
+    CHECK_EQ(entries[1].quirks, BLOOPAIR_QUIRK_NO_RUMBLE);
+    CHECK_EQ(entries[1].reportInterval, 15);
+    CHECK_EQ(entries[2].vendor_id, 0);
+
+    CHECK(!Bloopair_DecodeDevicesFile("{\"version\":0}", 13, &version, collectDevice, entries));
+}
+
+int main(void)
+{
+    testCommon();
+    testMapping();
+    testActions();
+    testCustom();
+    testInvalid();
+    testEncode();
+    testDevices();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,175 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Checks Bloopair_ParseConfigFilename against known names, and against the regex the loader and Koopair used before
+// for generated names, so both accept exactly the same files.
+
+#include "test.h"
+
+#include <regex.h>
+#include <stdint.h>
+#include <string.h>
+#include <bloopair/config.h>
+
+typedef struct {
+    const char* filename;
+    int valid;
+    BloopairControllerType type;
+    uint8_t bda[6];
+} FilenameCase;
+
+static const FilenameCase cases[] = {
+    { "Controller-DualSense.conf",           1, BLOOPAIR_CONTROLLER_DUALSENSE },
+    { "Controller-Switch-JoyCon-Dual.conf",  1, BLOOPAIR_CONTROLLER_SWITCH_JOYCON_DUAL },
+    { "Controller-Switch-JoyCon-Right.conf", 1, BLOOPAIR_CONTROLLER_SWITCH_JOYCON_RIGHT },
+    { "Controller-Xbox-One.conf",            1, BLOOPAIR_CONTROLLER_XBOX_ONE },
+    { "Controller-A0B1C2D3E4F5.conf",        1, BLOOPAIR_CONTROLLER_INVALID, { 0xa0, 0xb1, 0xc2, 0xd3, 0xe4, 0xf5 } },
+    { "Controller-000000000000.conf",        1, BLOOPAIR_CONTROLLER_INVALID, { 0 } },
+    // type names are case sensitive and bdas are uppercase only
+    { "Controller-dualsense.conf",           0 },
+    { "Controller-a0b1c2d3e4f5.conf",        0 },
+    // prefix, suffix and the part in between have to be complete
+    { "Controller-.conf",                    0 },
+    { "Controller-DualSense",                0 },
+    { "Controller-DualSense.conf.bak",       0 },
+    { "Controller-DualSense.conf.tmp",       0 },
+    { "controller-DualSense.conf",           0 },
+    { "Controller-Switch.conf",              0 },
+    { "Controller-Switch-Pro-.conf",         0 },
+    { "Controller-A0B1C2D3E4F.conf",         0 },
+    { "Controller-A0B1C2D3E4F5A.conf",       0 },
+    { "Controller-A0B1C2D3E4G5.conf",        0 },
+    { "Controller-",                         0 },
+    { "",                                    0 },
+    { "devices.json",                        0 },
+};
+
+static void testCases(void)
+{
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const FilenameCase* c = &cases[i];
+
+        BloopairControllerType type = BLOOPAIR_CONTROLLER_GENERIC_HID;
+        uint8_t bda[6] = { 0x55, 0x55, 0x55, 0x55, 0x55, 0x55 };
+        int valid = Bloopair_ParseConfigFilename(c->filename, &type, bda);
+        if (!!valid != c->valid) {
+            fprintf(stderr, "%s: expected %s\n", c->filename, c->valid ? "valid" : "invalid");
+            test_failures++;
+            continue;
+        }
+
+        if (!valid) {
+            continue;
+        }
+
+        CHECK_EQ(type, c->type);
+        if (type == BLOOPAIR_CONTROLLER_INVALID) {
+            CHECK(memcmp(bda, c->bda, sizeof(bda)) == 0);
+        }
+    }
+}
+
+static int isControllerTypeName(const char* name, size_t length)
+{
+    uint32_t value;
+    return Bloopair_GetValueFromName(BLOOPAIR_NAMES_CONTROLLER_TYPE, name, length, &value);
+}
+
+static int isUppercaseBda(const char* name, size_t length)
+{
+    if (length != 12) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        if (!((name[i] >= '0' && name[i] <= '9') || (name[i] >= 'A' && name[i] <= 'F'))) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static uint32_t nextRandom(uint32_t* state)
+{
+    // xorshift32, so the generated names are the same on every run
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static void testAgainstRegex(void)
+{
+    regex_t regex;
+    if (regcomp(&regex, "^Controller-([A-Za-z0-9-]+)\\.conf$", REG_EXTENDED) != 0) {
+        CHECK(!"regcomp");
+        return;
+    }
+
+    static const char* pieces[] = {
+        "Controller-", "Controller", ".conf", ".co", "DualSense", "Switch-", "JoyCon", "-Left", "-Dual", "Xbox-One",
+        "A0B1C2", "D3E4F5", "a0b1c2", "0", "F", "G", "-", ".", "_", " ",
+    };
+
+    uint32_t state = 0x1badb002;
+    for (int i = 0; i < 200000; i++) {
+        char filename[128] = "";
+
+        // mostly start with the prefix, so the interesting part in between gets covered
+        if (nextRandom(&state) % 4 != 0) {
+            strcat(filename, "Controller-");
+        }
+
+        uint32_t numPieces = nextRandom(&state) % 5;
+        for (uint32_t j = 0; j < numPieces; j++) {
+            strcat(filename, pieces[nextRandom(&state) % (sizeof(pieces) / sizeof(pieces[0]))]);
+        }
+
+        if (nextRandom(&state) % 4 != 0) {
+            strcat(filename, ".conf");
+        }
+
+        // the loader accepted a name if the regex matched and the group was a type name or a bda
+        regmatch_t m[2];
+        int expected = 0;
+        if (regexec(&regex, filename, 2, m, 0) == 0) {
+            const char* name = filename + m[1].rm_so;
+            size_t length = m[1].rm_eo - m[1].rm_so;
+            expected = isControllerTypeName(name, length) || isUppercaseBda(name, length);
+        }
+
+        BloopairControllerType type;
+        uint8_t bda[6];
+        int valid = !!Bloopair_ParseConfigFilename(filename, &type, bda);
+        if (valid != expected) {
+            fprintf(stderr, "\"%s\": parsed as %s, the regex says %s\n", filename,
+                valid ? "valid" : "invalid", expected ? "valid" : "invalid");
+            test_failures++;
+        }
+    }
+
+    regfree(&regex);
+}
+
+int main(void)
+{
+    testCases();
+    testAgainstRegex();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,376 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Compiles report descriptors of real controllers with the generic HID driver and checks the resulting fields,
+// followed by an input report to make sure the fields are extracted from the right bits.
+
+#include "test.h"
+
+#include <string.h>
+#include <controllers.h>
+#include <configuration.h>
+#include <generic_controller.h>
+#include <bloopair/controllers/generic_controller.h>
+
+typedef struct {
+    uint8_t target;
+    uint8_t size;
+    uint16_t offset;
+    int32_t logical_min;
+    int32_t logical_max;
+} ExpectedField;
+
+int controllerInit_generic(Controller* controller, const uint8_t* descriptor, uint16_t descriptor_len);
+
+#define STICKS(first_offset) \
+    { GENERIC_TARGET_LEFT_STICK_X,  8, (first_offset) +  0, 0, 255, }, \
+    { GENERIC_TARGET_LEFT_STICK_Y,  8, (first_offset) +  8, 0, 255, }, \
+    { GENERIC_TARGET_RIGHT_STICK_X, 8, (first_offset) + 16, 0, 255, }, \
+    { GENERIC_TARGET_RIGHT_STICK_Y, 8, (first_offset) + 24, 0, 255, }
+
+#define HAT(offset) { GENERIC_TARGET_HAT, 4, (offset), 0, 7, }
+
+#define BUTTON(n, first_offset) { GENERIC_BUTTON_1 + (n) - 1, 1, (first_offset) + (n) - 1, 0, 1, }
+
+#define BUTTONS_12(first_offset) \
+    BUTTON(1, first_offset), BUTTON(2, first_offset), BUTTON(3, first_offset), BUTTON(4, first_offset), \
+    BUTTON(5, first_offset), BUTTON(6, first_offset), BUTTON(7, first_offset), BUTTON(8, first_offset), \
+    BUTTON(9, first_offset), BUTTON(10, first_offset), BUTTON(11, first_offset), BUTTON(12, first_offset)
+
+// DualShock 4, the input and output reports of the USB descriptor, which the controller also reports over bluetooth.
+// The feature reports are left out, they don't affect the input fields.
+static const uint8_t dualshock4_descriptor[] = {
+    0x05, 0x01,         // Usage Page (Generic Desktop)
+    0x09, 0x05,         // Usage (Gamepad)
+    0xa1, 0x01,         // Collection (Application)
+    0x85, 0x01,         //   Report ID (1)
+    0x09, 0x30,         //   Usage (X)
+    0x09, 0x31,         //   Usage (Y)
+    0x09, 0x32,         //   Usage (Z)
+    0x09, 0x35,         //   Usage (Rz)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x26, 0xff, 0x00,   //   Logical Maximum (255)
+    0x75, 0x08,         //   Report Size (8)
+    0x95, 0x04,         //   Report Count (4)
+    0x81, 0x02,         //   Input (Data, Variable, Absolute)
+    0x09, 0x39,         //   Usage (Hat switch)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x25, 0x07,         //   Logical Maximum (7)
+    0x35, 0x00,         //   Physical Minimum (0)
+    0x46, 0x3b, 0x01,   //   Physical Maximum (315)
+    0x65, 0x14,         //   Unit (Degrees)
+    0x75, 0x04,         //   Report Size (4)
+    0x95, 0x01,         //   Report Count (1)
+    0x81, 0x42,         //   Input (Data, Variable, Absolute, Null State)
+    0x65, 0x00,         //   Unit (None)
+    0x05, 0x09,         //   Usage Page (Button)
+    0x19, 0x01,         //   Usage Minimum (1)
+    0x29, 0x0e,         //   Usage Maximum (14)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x25, 0x01,         //   Logical Maximum (1)
+    0x75, 0x01,         //   Report Size (1)
+    0x95, 0x0e,         //   Report Count (14)
+    0x81, 0x02,         //   Input (Data, Variable, Absolute)
+    0x06, 0x00, 0xff,   //   Usage Page (Vendor Defined 0xFF00)
+    0x09, 0x20,         //   Usage (0x20)
+    0x75, 0x06,         //   Report Size (6)
+    0x95, 0x01,         //   Report Count (1)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x25, 0x7f,         //   Logical Maximum (127)
+    0x81, 0x02,         //   Input (Data, Variable, Absolute)
+    0x05, 0x01,         //   Usage Page (Generic Desktop)
+    0x09, 0x33,         //   Usage (Rx)
+    0x09, 0x34,         //   Usage (Ry)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x26, 0xff, 0x00,   //   Logical Maximum (255)
+    0x75, 0x08,         //   Report Size (8)
+    0x95, 0x02,         //   Report Count (2)
+    0x81, 0x02,         //   Input (Data, Variable, Absolute)
+    0x06, 0x00, 0xff,   //   Usage Page (Vendor Defined 0xFF00)
+    0x09, 0x21,         //   Usage (0x21)
+    0x95, 0x36,         //   Report Count (54)
+    0x81, 0x02,         //   Input (Data, Variable, Absolute)
+    0x85, 0x05,         //   Report ID (5)
+    0x09, 0x22,         //   Usage (0x22)
+    0x95, 0x1f,         //   Report Count (31)
+    0x91, 0x02,         //   Output (Data, Variable, Absolute)
+    0xc0,               // End Collection
+};
+
+static const ExpectedField dualshock4_fields[] = {
+    STICKS(8),
+    HAT(40),
+    BUTTONS_12(44),
+    BUTTON(13, 44),
+    BUTTON(14, 44),
+    // Rx / Ry are the analog triggers, the right stick was already claimed by Z / Rz
+};
+
+// 8BitDo controllers in D-input mode, report 3 starts with the hat followed by the sticks.
+// The analog triggers are on the simulation controls page and the buttons come last.
+static const uint8_t eightbitdo_descriptor[] = {
+    0x05, 0x01,         // Usage Page (Generic Desktop)
+    0x09, 0x05,         // Usage (Gamepad)
+    0xa1, 0x01,         // Collection (Application)
+    0x85, 0x03,         //   Report ID (3)
+    0x05, 0x01,         //   Usage Page (Generic Desktop)
+    0x09, 0x39,         //   Usage (Hat switch)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x25, 0x07,         //   Logical Maximum (7)
+    0x35, 0x00,         //   Physical Minimum (0)
+    0x46, 0x3b, 0x01,   //   Physical Maximum (315)
+    0x65, 0x14,         //   Unit (Degrees)
+    0x75, 0x04,         //   Report Size (4)
+    0x95, 0x01,         //   Report Count (1)
+    0x81, 0x42,         //   Input (Data, Variable, Absolute, Null State)
+    0x65, 0x00,         //   Unit (None)
+    0x75, 0x04,         //   Report Size (4)
+    0x95, 0x01,         //   Report Count (1)
+    0x81, 0x03,         //   Input (Constant, Variable, Absolute)
+    0x09, 0x30,         //   Usage (X)
+    0x09, 0x31,         //   Usage (Y)
+    0x09, 0x32,         //   Usage (Z)
+    0x09, 0x35,         //   Usage (Rz)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x26, 0xff, 0x00,   //   Logical Maximum (255)
+    0x75, 0x08,         //   Report Size (8)
+    0x95, 0x04,         //   Report Count (4)
+    0x81, 0x02,         //   Input (Data, Variable, Absolute)
+    0x05, 0x02,         //   Usage Page (Simulation Controls)
+    0x09, 0xc5,         //   Usage (Brake)
+    0x09, 0xc4,         //   Usage (Accelerator)
+    0x95, 0x02,         //   Report Count (2)
+    0x81, 0x02,         //   Input (Data, Variable, Absolute)
+    0x05, 0x09,         //   Usage Page (Button)
+    0x19, 0x01,         //   Usage Minimum (1)
+    0x29, 0x0f,         //   Usage Maximum (15)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x25, 0x01,         //   Logical Maximum (1)
+    0x75, 0x01,         //   Report Size (1)
+    0x95, 0x0f,         //   Report Count (15)
+    0x81, 0x02,         //   Input (Data, Variable, Absolute)
+    0x75, 0x01,         //   Report Size (1)
+    0x95, 0x01,         //   Report Count (1)
+    0x81, 0x03,         //   Input (Constant, Variable, Absolute)
+    0xc0,               // End Collection
+};
+
+static const ExpectedField eightbitdo_fields[] = {
+    HAT(8),
+    STICKS(16),
+    BUTTONS_12(64),
+    BUTTON(13, 64),
+    BUTTON(14, 64),
+    BUTTON(15, 64),
+};
+
+// The common DragonRise based generic gamepad (0079:0006), a joystick without report ids.
+// It lists Z twice, the second one is ignored.
+static const uint8_t generic_gamepad_descriptor[] = {
+    0x05, 0x01,         // Usage Page (Generic Desktop)
+    0x09, 0x04,         // Usage (Joystick)
+    0xa1, 0x01,         // Collection (Application)
+    0xa1, 0x02,         //   Collection (Logical)
+    0x75, 0x08,         //     Report Size (8)
+    0x95, 0x05,         //     Report Count (5)
+    0x15, 0x00,         //     Logical Minimum (0)
+    0x26, 0xff, 0x00,   //     Logical Maximum (255)
+    0x35, 0x00,         //     Physical Minimum (0)
+    0x46, 0xff, 0x00,   //     Physical Maximum (255)
+    0x09, 0x30,         //     Usage (X)
+    0x09, 0x31,         //     Usage (Y)
+    0x09, 0x32,         //     Usage (Z)
+    0x09, 0x32,         //     Usage (Z)
+    0x09, 0x35,         //     Usage (Rz)
+    0x81, 0x02,         //     Input (Data, Variable, Absolute)
+    0x75, 0x04,         //     Report Size (4)
+    0x95, 0x01,         //     Report Count (1)
+    0x25, 0x07,         //     Logical Maximum (7)
+    0x46, 0x3b, 0x01,   //     Physical Maximum (315)
+    0x65, 0x14,         //     Unit (Degrees)
+    0x09, 0x39,         //     Usage (Hat switch)
+    0x81, 0x42,         //     Input (Data, Variable, Absolute, Null State)
+    0x65, 0x00,         //     Unit (None)
+    0x75, 0x01,         //     Report Size (1)
+    0x95, 0x0c,         //     Report Count (12)
+    0x25, 0x01,         //     Logical Maximum (1)
+    0x45, 0x01,         //     Physical Maximum (1)
+    0x05, 0x09,         //     Usage Page (Button)
+    0x19, 0x01,         //     Usage Minimum (1)
+    0x29, 0x0c,         //     Usage Maximum (12)
+    0x81, 0x02,         //     Input (Data, Variable, Absolute)
+    0x06, 0x00, 0xff,   //     Usage Page (Vendor Defined 0xFF00)
+    0x75, 0x01,         //     Report Size (1)
+    0x95, 0x08,         //     Report Count (8)
+    0x25, 0x01,         //     Logical Maximum (1)
+    0x45, 0x01,         //     Physical Maximum (1)
+    0x09, 0x01,         //     Usage (0x01)
+    0x81, 0x02,         //     Input (Data, Variable, Absolute)
+    0xc0,               //   End Collection
+    0xa1, 0x02,         //   Collection (Logical)
+    0x75, 0x08,         //     Report Size (8)
+    0x95, 0x07,         //     Report Count (7)
+    0x46, 0xff, 0x00,   //     Physical Maximum (255)
+    0x26, 0xff, 0x00,   //     Logical Maximum (255)
+    0x09, 0x02,         //     Usage (0x02)
+    0x91, 0x02,         //     Output (Data, Variable, Absolute)
+    0xc0,               //   End Collection
+    0xc0,               // End Collection
+};
+
+static const ExpectedField generic_gamepad_fields[] = {
+    { GENERIC_TARGET_LEFT_STICK_X,  8,  0, 0, 255, },
+    { GENERIC_TARGET_LEFT_STICK_Y,  8,  8, 0, 255, },
+    { GENERIC_TARGET_RIGHT_STICK_X, 8, 16, 0, 255, },
+    { GENERIC_TARGET_RIGHT_STICK_Y, 8, 32, 0, 255, },
+    HAT(40),
+    BUTTONS_12(44),
+};
+
+// A keyboard has no joystick or gamepad collection and has to be rejected
+static const uint8_t keyboard_descriptor[] = {
+    0x05, 0x01,         // Usage Page (Generic Desktop)
+    0x09, 0x06,         // Usage (Keyboard)
+    0xa1, 0x01,         // Collection (Application)
+    0x05, 0x07,         //   Usage Page (Keyboard)
+    0x19, 0xe0,         //   Usage Minimum (0xe0)
+    0x29, 0xe7,         //   Usage Maximum (0xe7)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x25, 0x01,         //   Logical Maximum (1)
+    0x75, 0x01,         //   Report Size (1)
+    0x95, 0x08,         //   Report Count (8)
+    0x81, 0x02,         //   Input (Data, Variable, Absolute)
+    0xc0,               // End Collection
+};
+
+static void checkFields(const char* name, const GenericData* gdata, uint8_t report_id,
+    const ExpectedField* expected, uint32_t num_expected)
+{
+    CHECK_EQ(gdata->num_fields, num_expected);
+    if (gdata->num_fields != num_expected) {
+        fprintf(stderr, "%s: field count mismatch\n", name);
+        return;
+    }
+
+    for (uint32_t i = 0; i < num_expected; i++) {
+        const GenericField* field = &gdata->fields[i];
+        CHECK_EQ(field->report_id, report_id);
+        CHECK_EQ(field->target, expected[i].target);
+        CHECK_EQ(field->size, expected[i].size);
+        CHECK_EQ(field->offset, expected[i].offset);
+        CHECK_EQ(field->is_signed, 0);
+        CHECK_EQ(field->logical_min, expected[i].logical_min);
+        CHECK_EQ(field->logical_max, expected[i].logical_max);
+    }
+}
+
+static int compile(Controller* controller, const uint8_t* descriptor, uint16_t len)
+{
+    memset(controller, 0, sizeof(*controller));
+    return controllerInit_generic(controller, descriptor, len);
+}
+
+static void testDualshock4(void)
+{
+    Controller controller;
+    CHECK_EQ(compile(&controller, dualshock4_descriptor, sizeof(dualshock4_descriptor)), 0);
+    GenericData* gdata = controller.additionalData;
+    CHECK_EQ(gdata->has_report_ids, 1);
+    checkFields("dualshock 4", gdata, 1, dualshock4_fields, sizeof(dualshock4_fields) / sizeof(dualshock4_fields[0]));
+
+    // left stick fully right, dpad right, cross (button 2) and the ps button (button 13)
+    uint8_t report[10] = { 0x01, 0xff, 0x80, 0x80, 0x80, 0x22, 0x00, 0x01, 0x00, 0x00 };
+    controller.data(&controller, report, sizeof(report));
+    CHECK(controller.isReady);
+    CHECK_EQ(controller.reportBuffer.buttons, BTN(GENERIC_BUTTON_RIGHT) | BTN(GENERIC_BUTTON_2) | BTN(GENERIC_BUTTON_13));
+    CHECK(controller.reportBuffer.left_stick_x > 0);
+
+    // 8 is the null state of the hat
+    report[5] = 0x08;
+    controller.data(&controller, report, sizeof(report));
+    CHECK_EQ(controller.reportBuffer.buttons, BTN(GENERIC_BUTTON_13));
+
+    controller.deinit(&controller);
+}
+
+static void testEightBitDo(void)
+{
+    Controller controller;
+    CHECK_EQ(compile(&controller, eightbitdo_descriptor, sizeof(eightbitdo_descriptor)), 0);
+    GenericData* gdata = controller.additionalData;
+    CHECK_EQ(gdata->has_report_ids, 1);
+    checkFields("8bitdo", gdata, 3, eightbitdo_fields, sizeof(eightbitdo_fields) / sizeof(eightbitdo_fields[0]));
+
+    // hat down left, the padding nibble set, right stick fully left, button 1 and button 15
+    uint8_t report[10] = { 0x03, 0xf5, 0x80, 0x80, 0x00, 0x80, 0x00, 0x00, 0x01, 0x40 };
+    controller.data(&controller, report, sizeof(report));
+    CHECK_EQ(controller.reportBuffer.buttons,
+        BTN(GENERIC_BUTTON_DOWN) | BTN(GENERIC_BUTTON_LEFT) | BTN(GENERIC_BUTTON_1) | BTN(GENERIC_BUTTON_15));
+    CHECK(controller.reportBuffer.right_stick_x < 0);
+
+    // reports with other ids are ignored
+    report[0] = 0x04;
+    report[8] = 0x00;
+    controller.data(&controller, report, sizeof(report));
+    CHECK(controller.reportBuffer.buttons & BTN(GENERIC_BUTTON_1));
+
+    controller.deinit(&controller);
+}
+
+static void testGenericGamepad(void)
+{
+    Controller controller;
+    CHECK_EQ(compile(&controller, generic_gamepad_descriptor, sizeof(generic_gamepad_descriptor)), 0);
+    GenericData* gdata = controller.additionalData;
+    CHECK_EQ(gdata->has_report_ids, 0);
+    checkFields("generic gamepad", gdata, 0, generic_gamepad_fields,
+        sizeof(generic_gamepad_fields) / sizeof(generic_gamepad_fields[0]));
+
+    // hat up, button 12, the duplicate Z byte set to something which would move the right stick
+    uint8_t report[8] = { 0x80, 0x80, 0x80, 0xff, 0x80, 0x00, 0x80, 0x00 };
+    controller.data(&controller, report, sizeof(report));
+    CHECK_EQ(controller.reportBuffer.buttons, BTN(GENERIC_BUTTON_UP) | BTN(GENERIC_BUTTON_12));
+    CHECK_EQ(controller.reportBuffer.right_stick_x, controller.reportBuffer.left_stick_x);
+
+    // fields past the end of short reports are left alone
+    uint8_t short_report[5] = { 0x80, 0x80, 0x80, 0x80, 0x80 };
+    controller.data(&controller, short_report, sizeof(short_report));
+    CHECK_EQ(controller.reportBuffer.buttons, BTN(GENERIC_BUTTON_UP) | BTN(GENERIC_BUTTON_12));
+
+    controller.deinit(&controller);
+}
+
+static void testRejected(void)
+{
+    Controller controller;
+    CHECK(compile(&controller, keyboard_descriptor, sizeof(keyboard_descriptor)) != 0);
+
+    // truncated right after the prefix of the first input item
+    CHECK(compile(&controller, dualshock4_descriptor, 26) != 0);
+}
+
+int main(void)
+{
+    Configuration_Init();
+
+    testDualshock4();
+    testEightBitDo();
+    testGenericGamepad();
+    testRejected();
+
+    return TEST_RESULT();
+}
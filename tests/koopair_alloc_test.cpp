@@ -0,0 +1,145 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Counts the heap allocations of the per-frame input pipeline of Koopair.
+// Once the controllers are connected, updating the controller manager and the controller list must not allocate,
+// only connecting or disconnecting a controller is allowed to.
+
+#include "test.h"
+#include "host.h"
+
+#include <cstdlib>
+#include <new>
+
+#include "ControllerManager.hpp"
+#include "screens/ControllerListScreen.hpp"
+
+static bool countAllocations = false;
+static int numAllocations = 0;
+
+void* operator new(std::size_t size)
+{
+    if (countAllocations) {
+        numAllocations++;
+    }
+
+    void* ptr = std::malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t size) noexcept
+{
+    std::free(ptr);
+}
+
+// 60 Hz, so a few seconds of frames cover the controller information being polled every second
+static const OSTime frameTicks = OSSecondsToTicks(1) / 60;
+
+static KPADStatus proSample(uint32_t frame, uint32_t buttons)
+{
+    KPADStatus status{};
+    status.extensionType = WPAD_EXT_PRO_CONTROLLER;
+    status.pro.hold = buttons;
+    status.pro.leftStick = { (frame % 100) / 100.0f, 0.0f };
+    status.pro.rightStick = { 0.0f, -(frame % 50) / 50.0f };
+    return status;
+}
+
+// Runs frames like the main loop does while the controller list is shown, returns the allocations during them
+static int runFrames(ControllerListScreen& screen, uint32_t numFrames, uint32_t buttons)
+{
+    ControllerManager& manager = ControllerManager::Get();
+
+    numAllocations = 0;
+    for (uint32_t frame = 0; frame < numFrames; frame++) {
+        // KPAD buffers a varying amount of samples between frames
+        KPADStatus samples[3];
+        uint32_t numSamples = 1 + frame % 3;
+        for (uint32_t i = 0; i < numSamples; i++) {
+            samples[i] = proSample(frame + i, buttons);
+        }
+        Host_QueueKPADSamples(WPAD_CHAN_0, { samples, numSamples });
+        Host_QueueKPADSamples(WPAD_CHAN_2, { samples, 1 });
+
+        KPADStatus classic{};
+        classic.extensionType = WPAD_EXT_CLASSIC;
+        classic.classic.hold = frame % 2 ? WPAD_CLASSIC_BUTTON_DOWN : 0;
+        Host_QueueKPADSamples(WPAD_CHAN_1, { &classic, 1 });
+
+        Host_AdvanceTime(frameTicks);
+
+        countAllocations = true;
+        manager.Update();
+        bool running = screen.Update(manager.GetCombinedController(), 1.0f / 60);
+        countAllocations = false;
+
+        CHECK(running);
+    }
+
+    return numAllocations;
+}
+
+int main(void)
+{
+    ControllerManager& manager = ControllerManager::Get();
+    manager.Initialize();
+
+    VPADStatus vpad{};
+    Host_SetVPAD(&vpad);
+    Host_ConnectKPAD(WPAD_CHAN_0, WPAD_EXT_PRO_CONTROLLER, BLOOPAIR_CONTROLLER_DUALSENSE);
+    Host_ConnectKPAD(WPAD_CHAN_1, WPAD_EXT_CLASSIC, BLOOPAIR_CONTROLLER_INVALID);
+
+    ControllerListScreen screen;
+
+    // connecting builds the names
+    runFrames(screen, 2, 0);
+    CHECK_EQ(manager.GetConnectedKPADMask(), 0b11);
+    CHECK(manager.GetKPADController(WPAD_CHAN_0).GetName() == "DualSense (1)");
+    CHECK(manager.GetKPADController(WPAD_CHAN_1).GetName() == "Classic Controller (2)");
+
+    // holding buttons and moving the sticks for a few seconds
+    CHECK_EQ(runFrames(screen, 300, WPAD_PRO_BUTTON_X | WPAD_PRO_BUTTON_DOWN), 0);
+    CHECK(manager.GetCombinedController().GetButtonsHeld() & Controller::BUTTON_X);
+
+    // another controller connects, which may allocate once
+    Host_ConnectKPAD(WPAD_CHAN_2, WPAD_EXT_PRO_CONTROLLER, BLOOPAIR_CONTROLLER_SWITCH_PRO);
+    runFrames(screen, 2, 0);
+    CHECK_EQ(manager.GetConnectedKPADMask(), 0b111);
+    CHECK(manager.GetKPADController(WPAD_CHAN_2).GetName() == "Switch Pro Controller (3)");
+    CHECK_EQ(runFrames(screen, 300, WPAD_PRO_BUTTON_Y), 0);
+
+    // and disconnects again
+    Host_DisconnectKPAD(WPAD_CHAN_2);
+    CHECK_EQ(runFrames(screen, 300, 0), 0);
+    CHECK_EQ(manager.GetConnectedKPADMask(), 0b11);
+
+    // the GamePad goes away
+    Host_SetVPAD(nullptr);
+    CHECK_EQ(runFrames(screen, 60, 0), 0);
+
+    manager.Finalize();
+    return TEST_RESULT();
+}
@@ -0,0 +1,178 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Applies a DualSense calibration feature report and checks the calibrated motion values,
+// then sends the state with MotionPlus in the Classic Controller passthrough mode.
+
+#include "test.h"
+#include "host.h"
+
+#include <string.h>
+#include <controllers.h>
+#include <configuration.h>
+#include <utils.h>
+
+void controllerInit_dualsense(Controller* controller);
+
+static uint8_t sentReports[2][22];
+static uint32_t numSentReports;
+
+static void inputCallback(uint8_t handle, const uint8_t* data, uint16_t len)
+{
+    if (numSentReports < 2 && len == sizeof(sentReports[0])) {
+        memcpy(sentReports[numSentReports], data, len);
+    }
+    numSentReports++;
+}
+
+static void putLe16(uint8_t* p, int16_t value)
+{
+    p[0] = value & 0xff;
+    p[1] = (value >> 8) & 0xff;
+}
+
+static void buildCalibration(uint8_t* rep)
+{
+    memset(rep, 0, 41);
+    rep[0] = 0x05;
+
+    // 2000 units between turning at +500 and -500 dps on every gyro axis, pitch plus and minus first
+    for (int i = 0; i < 3; i++) {
+        putLe16(rep + 7 + i * 4, 1000);
+        putLe16(rep + 9 + i * 4, -1000);
+    }
+    putLe16(rep + 19, 500);
+    putLe16(rep + 21, 500);
+
+    // +1G at 8000, -1G at -8400 on every accelerometer axis
+    for (int i = 0; i < 3; i++) {
+        putLe16(rep + 23 + i * 4, 8000);
+        putLe16(rep + 25 + i * 4, -8400);
+    }
+
+    uint8_t seed = 0xa3;
+    uint32_t crc = ~crc32(crc32(0xffffffff, &seed, 1), rep, 37);
+    rep[37] = crc & 0xff;
+    rep[38] = (crc >> 8) & 0xff;
+    rep[39] = (crc >> 16) & 0xff;
+    rep[40] = (crc >> 24) & 0xff;
+}
+
+static void buildInput(uint8_t* rep, uint8_t leftStickX, uint8_t buttons, int16_t gyro, int16_t accel)
+{
+    memset(rep, 0, 0x4e);
+    rep[0] = 0x31;
+    rep[2] = leftStickX;
+    rep[3] = rep[4] = rep[5] = 0x80;
+    // no dpad direction
+    rep[9] = 0x08 | buttons;
+    for (int i = 0; i < 3; i++) {
+        putLe16(rep + 17 + i * 2, gyro);
+        putLe16(rep + 23 + i * 2, accel);
+    }
+}
+
+static void testCalibration(Controller* controller)
+{
+    uint8_t input[0x4e];
+
+    // until the calibration arrives the nominal 16 units per dps and 8192 per G are used
+    buildInput(input, 0x80, 0, 200, 8192);
+    controller->data(controller, input, sizeof(input));
+    CHECK_EQ(controller->motion.gyro[0], 200);
+    CHECK_EQ(controller->motion.accel[1], MOTION_ACCEL_RES_PER_G);
+
+    uint8_t calibration[41];
+    buildCalibration(calibration);
+
+    // a report with a broken crc is ignored
+    calibration[40] ^= 0xff;
+    controller->getReportResponse(controller, calibration, sizeof(calibration));
+    controller->data(controller, input, sizeof(input));
+    CHECK_EQ(controller->motion.gyro[0], 200);
+
+    calibration[40] ^= 0xff;
+    controller->getReportResponse(controller, calibration, sizeof(calibration));
+
+    // 200 units are 100 dps, 8000 is exactly 1G
+    buildInput(input, 0x80, 0, 200, 8000);
+    controller->data(controller, input, sizeof(input));
+    for (int i = 0; i < 3; i++) {
+        CHECK_EQ(controller->motion.gyro[i], 100 * MOTION_GYRO_RES_PER_DPS);
+        CHECK_EQ(controller->motion.accel[i], MOTION_ACCEL_RES_PER_G);
+    }
+
+    // the middle between +1G and -1G is the accelerometer bias
+    buildInput(input, 0x80, 0, 0, -200);
+    controller->data(controller, input, sizeof(input));
+    CHECK_EQ(controller->motion.accel[0], 0);
+}
+
+static void testClassicPassthrough(Controller* controller)
+{
+    uint8_t input[0x4e];
+
+    // left stick fully right, cross is mapped to B
+    buildInput(input, 0xff, 0x20, 0, 8000);
+    controller->data(controller, input, sizeof(input));
+
+    controller->dataReportingMode = WM_REPORT_ID_CORE_ACCEL_EXTENSION_REPORT;
+    controller->motionPlusMode = MPLS_MODE_CLASSIC_PASSTHROUGH;
+    numSentReports = 0;
+    sendControllerInput(controller);
+    sendControllerInput(controller);
+    CHECK_EQ(numSentReports, 2);
+
+    // the first report carries the Classic Controller, the buttons only show up there
+    const uint8_t* core = sentReports[0];
+    const uint8_t* ext = sentReports[0] + 6;
+    CHECK_EQ(core[0], WM_REPORT_ID_CORE_ACCEL_EXTENSION_REPORT);
+    CHECK_EQ(core[1] & 0x1f, 0);
+    CHECK_EQ(core[2] & 0x9f, 0);
+    CHECK_EQ(ext[5] & 0x3, 0);
+    CHECK_EQ(ext[5] & 0x40, 0);
+    CHECK_EQ(ext[5] & 0xb8, 0xb8);
+    CHECK_EQ(ext[0] & 0x3e, 0x3e);
+    CHECK_EQ(ext[1] & 0x3e, 0x20);
+    // d-pad up and left aren't pressed
+    CHECK_EQ(ext[0] & 0x1, 1);
+    CHECK_EQ(ext[1] & 0x1, 1);
+
+    // the second one is MotionPlus data with the extension connected
+    ext = sentReports[1] + 6;
+    CHECK_EQ(ext[5] & 0x3, 0x3);
+    // no rotation is 8192 in slow mode for yaw, roll and pitch
+    CHECK_EQ(ext[0] | ((ext[1] >> 2) << 8), 8192);
+    CHECK_EQ(ext[1] & 0x3, 0x3);
+}
+
+int main(void)
+{
+    Configuration_Init();
+    Host_SetCallbacks(NULL, inputCallback);
+
+    Controller controller;
+    memset(&controller, 0, sizeof(controller));
+    controllerInit_dualsense(&controller);
+
+    testCalibration(&controller);
+    testClassicPassthrough(&controller);
+
+    controller.deinit(&controller);
+
+    return TEST_RESULT();
+}
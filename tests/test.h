@@ -0,0 +1,44 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Minimal helpers shared by the host tests, every test is its own executable which fails with a non-zero exit code
+
+#include <stdio.h>
+
+static int test_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        long long _actual = (long long) (actual); \
+        long long _expected = (long long) (expected); \
+        if (_actual != _expected) { \
+            fprintf(stderr, "%s:%d: check failed: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, _actual, _expected); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define TEST_RESULT() (test_failures ? (fprintf(stderr, "%d checks failed\n", test_failures), 1) : 0)
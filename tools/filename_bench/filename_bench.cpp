@@ -0,0 +1,120 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Host benchmark of the configuration filename matching done on every directory scan.
+// Scans a typical configuration directory with the old std::regex matcher and with
+// Bloopair_ParseConfigFilename, and checks both accept the same names.
+//
+// usage: filename_bench [scans]
+
+#include "legacy_matcher.hpp"
+
+#include <bloopair/config.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// What the configuration directory looks like with a few controllers set up
+const std::vector<std::string> kDirectory = {
+    "Controller-DualSense.conf",
+    "Controller-DualShock-4.conf",
+    "Controller-Switch-Pro.conf",
+    "Controller-Switch-JoyCon-Dual.conf",
+    "Controller-Xbox-One.conf",
+    "Controller-A4AE12345678.conf",
+    "Controller-A4AE12345678.conf.bak",
+    "Controller-98B6E9ABCDEF.conf",
+    "Controller-001F32F0E1D2.conf",
+    "Controller-Unknown.conf",
+    "devices.json",
+    "bloopair.cache",
+    "debug.bpcap",
+};
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedUs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    int scans = argc > 1 ? atoi(argv[1]) : 10000;
+    if (scans <= 0) {
+        fprintf(stderr, "usage: %s [scans]\n", argv[0]);
+        return 1;
+    }
+
+    // Both need to agree before the numbers mean anything
+    for (const std::string& name : kDirectory) {
+        BloopairControllerType legacyType = BLOOPAIR_CONTROLLER_INVALID, type = BLOOPAIR_CONTROLLER_INVALID;
+        uint8_t legacyBda[6] = {}, bda[6] = {};
+        bool legacy = LegacyMatcher().Parse(name, legacyType, legacyBda);
+        bool current = Bloopair_ParseConfigFilename(name.c_str(), &type, bda);
+        if (legacy != current || legacyType != type || memcmp(legacyBda, bda, sizeof(bda)) != 0) {
+            fprintf(stderr, "matchers disagree on %s\n", name.c_str());
+            return 1;
+        }
+    }
+
+    int matches = 0;
+
+    // A scan builds the regex once and matches every entry, like Configuration::LoadAll did
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < scans; i++) {
+        LegacyMatcher matcher;
+        for (const std::string& name : kDirectory) {
+            BloopairControllerType type;
+            uint8_t bda[6];
+            matches += matcher.Parse(name, type, bda);
+        }
+    }
+    double legacyUs = ElapsedUs(start) / scans;
+
+    start = Clock::now();
+    for (int i = 0; i < scans; i++) {
+        LegacyMatcher matcher;
+        (void) matcher;
+    }
+    double constructUs = ElapsedUs(start) / scans;
+
+    start = Clock::now();
+    for (int i = 0; i < scans; i++) {
+        for (const std::string& name : kDirectory) {
+            BloopairControllerType type;
+            uint8_t bda[6];
+            matches += Bloopair_ParseConfigFilename(name.c_str(), &type, bda);
+        }
+    }
+    double currentUs = ElapsedUs(start) / scans;
+
+    printf("%zu entries, %d scans (%d matches)\n", kDirectory.size(), scans, matches);
+    printf("std::regex:                   %8.3f us per scan, %.3f us of it building the regex\n", legacyUs, constructUs);
+    printf("Bloopair_ParseConfigFilename: %8.3f us per scan\n", currentUs);
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "legacy_matcher.hpp"
+
+#include <map>
+#include <regex>
+
+namespace
+{
+
+// Copied from koopair/source/Configuration.cpp before the regex was removed
+const std::map<std::string, BloopairControllerType> bloopairControllerTypeValues = {
+    { "DualSense",              BLOOPAIR_CONTROLLER_DUALSENSE },
+    { "DualShock-3",            BLOOPAIR_CONTROLLER_DUALSHOCK3 },
+    { "DualShock-4",            BLOOPAIR_CONTROLLER_DUALSHOCK4 },
+    { "Switch-Generic",         BLOOPAIR_CONTROLLER_SWITCH_GENERIC },
+    { "Switch-JoyCon-Left",     BLOOPAIR_CONTROLLER_SWITCH_JOYCON_LEFT },
+    { "Switch-JoyCon-Right",    BLOOPAIR_CONTROLLER_SWITCH_JOYCON_RIGHT },
+    { "Switch-JoyCon-Dual",     BLOOPAIR_CONTROLLER_SWITCH_JOYCON_DUAL },
+    { "Switch-Pro",             BLOOPAIR_CONTROLLER_SWITCH_PRO },
+    { "Switch-N64",             BLOOPAIR_CONTROLLER_SWITCH_N64 },
+    { "Xbox-One",               BLOOPAIR_CONTROLLER_XBOX_ONE },
+    { "Generic-HID",            BLOOPAIR_CONTROLLER_GENERIC_HID },
+};
+
+bool HexToBDA(const std::string& hex, uint8_t* bda)
+{
+    // Need exactly 12 hex characters for a bda
+    if (hex.size() != 12) {
+        return false;
+    }
+
+    // Only support uppercase hex characters
+    auto char2int = ([](char in) -> int {
+        if(in >= '0' && in <= '9')
+            return in - '0';
+        if(in >= 'A' && in <= 'F')
+            return in - 'A' + 10;
+        return -1;
+    });
+
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        int hi = char2int(hex[i]);
+        int lo = char2int(hex[i + 1]);
+        if (hi == -1 || lo == -1) {
+            return false;
+        }
+
+        *(bda++) = hi << 4 | lo;
+    }
+
+    return true;
+}
+
+}
+
+struct LegacyMatcher::Impl {
+    std::regex regex{"^Controller-([A-Za-z0-9-]+)\\.conf$"};
+};
+
+LegacyMatcher::LegacyMatcher() : mImpl(new Impl)
+{
+}
+
+LegacyMatcher::~LegacyMatcher()
+{
+    delete mImpl;
+}
+
+bool LegacyMatcher::Parse(const std::string& filename, BloopairControllerType& outType, uint8_t* outBda) const
+{
+    std::smatch m;
+    if (!std::regex_search(filename, m, mImpl->regex)) {
+        return false;
+    }
+
+    outType = BLOOPAIR_CONTROLLER_INVALID;
+    if (bloopairControllerTypeValues.contains(m.str(1))) {
+        outType = bloopairControllerTypeValues.at(m.str(1));
+    } else if (!HexToBDA(m.str(1), outBda)) {
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,34 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <string>
+#include <bloopair/controllers/common.h>
+
+// The std::regex matcher Configuration::LoadAll and the loader used before Bloopair_ParseConfigFilename,
+// the regex is built once per directory scan like they did
+class LegacyMatcher {
+public:
+    LegacyMatcher();
+    ~LegacyMatcher();
+
+    bool Parse(const std::string& filename, BloopairControllerType& outType, uint8_t* outBda) const;
+
+private:
+    struct Impl;
+    Impl* mImpl;
+};
@@ -0,0 +1,27 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Only uses the old matcher, so the size of the program shows what it pulls in
+
+#include "legacy_matcher.hpp"
+
+int main(int argc, char** argv)
+{
+    BloopairControllerType type;
+    uint8_t bda[6];
+    return argc > 1 && LegacyMatcher().Parse(argv[1], type, bda);
+}
@@ -0,0 +1,130 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Host benchmark for the Koopair Gfx module, run with the SDL dummy video driver.
+// Draws the shapes of the controller test screen with moving sticks and reports the frame times,
+// once with only the changed parts redrawn like on the console, and once drawing every frame completely.
+// Text is left out, it goes through the same cached textures in every Gfx version.
+//
+// usage: gfx_bench [frames]
+
+#include "Gfx.hpp"
+
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+
+// Mirrors ControllerTestScreen::DrawStick
+void DrawStick(int x, int y, float stickX, float stickY, bool pressed)
+{
+    if (pressed) {
+        Gfx::DrawCircleFilled(x, y, 80, Gfx::COLOR_ERROR);
+    }
+
+    Gfx::DrawCircle(x, y, 80, 6, Gfx::COLOR_GRAY);
+    Gfx::DrawCircleFilled(x + stickX * 50.0f, y + stickY * -50.0f, 50, Gfx::COLOR_WHITE);
+}
+
+// The shapes ControllerTestScreen::Draw and the top and bottom bars of Screen draw
+void DrawFrame(uint32_t frame)
+{
+    const int centerX = Gfx::SCREEN_WIDTH / 2;
+    const int centerY = Gfx::SCREEN_HEIGHT / 2;
+
+    Gfx::Clear(Gfx::COLOR_BACKGROUND);
+
+    Gfx::DrawRectFilled(0, 0, Gfx::SCREEN_WIDTH, 75, Gfx::COLOR_BARS);
+    Gfx::DrawRectFilled(0, Gfx::SCREEN_HEIGHT - 75, Gfx::SCREEN_WIDTH, 75, Gfx::COLOR_BARS);
+
+    // one full stick rotation per second at 60 fps, the sticks get pressed every other second
+    float angle = frame * (2.0f * (float) M_PI / 60.0f);
+    bool pressed = (frame / 60) % 2;
+    DrawStick(centerX + 450, centerY - 50, std::cos(angle), std::sin(angle), pressed);
+    DrawStick(centerX - 450, centerY - 50, std::sin(angle), std::cos(angle), !pressed);
+
+    Gfx::DrawRectFilled(32, 835, 960, 160, Gfx::COLOR_ALT_BACKGROUND);
+    Gfx::DrawRectFilled(1024, 835, 400, 160, Gfx::COLOR_ALT_BACKGROUND);
+
+    // the highlighted list entry of the menu screens
+    Gfx::DrawRectRoundedFilled(1456, 835, 432, 160, 20, Gfx::COLOR_HIGHLIGHTED);
+}
+
+void Run(const char* name, uint32_t numFrames, bool invalidate)
+{
+    std::vector<double> times;
+    times.reserve(numFrames);
+
+    const double frequency = SDL_GetPerformanceFrequency();
+    for (uint32_t frame = 0; frame < numFrames; frame++) {
+        Uint64 start = SDL_GetPerformanceCounter();
+
+        if (invalidate) {
+            Gfx::Invalidate();
+        }
+
+        DrawFrame(frame);
+        Gfx::Render();
+
+        times.push_back((SDL_GetPerformanceCounter() - start) * 1000.0 / frequency);
+    }
+
+    // the first frame creates the textures, leave it out
+    std::sort(times.begin() + 1, times.end());
+    double total = 0.0;
+    for (size_t i = 1; i < times.size(); i++) {
+        total += times[i];
+    }
+
+    size_t count = times.size() - 1;
+    std::printf("%-8s first %7.3f ms  mean %7.3f ms  median %7.3f ms  p99 %7.3f ms\n", name, times[0],
+        total / count, times[1 + count / 2], times[1 + count * 99 / 100]);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    uint32_t numFrames = argc > 1 ? std::strtoul(argv[1], nullptr, 0) : 600;
+    if (numFrames < 2) {
+        std::fprintf(stderr, "need at least 2 frames\n");
+        return 1;
+    }
+
+    if (!SDL_getenv("SDL_VIDEODRIVER")) {
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    }
+
+    // Gfx asks for an accelerated renderer, naming the driver skips that check for the dummy window
+    SDL_SetHintWithPriority(SDL_HINT_RENDER_DRIVER, "software", SDL_HINT_DEFAULT);
+
+    if (!Gfx::Init()) {
+        std::fprintf(stderr, "Gfx::Init failed: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    Run("dirty", numFrames, false);
+    Run("full", numFrames, true);
+
+    Gfx::Shutdown();
+    return 0;
+}
@@ -0,0 +1,32 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+// Host replacement for the parts of wut Gfx.cpp uses
+
+#include <stdint.h>
+#include <fa-solid-900_ttf.h>
+
+#define OS_SHAREDDATATYPE_FONT_STANDARD 2
+
+// The system font only exists on the console, the benchmark doesn't draw text so any TrueType font does
+static inline int OSGetSharedData(int type, uint32_t unk, void** outData, uint32_t* outSize)
+{
+    *outData = (void*) fa_solid_900_ttf;
+    *outSize = fa_solid_900_ttf_size;
+    return 1;
+}
@@ -0,0 +1,688 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Generates the captures in corpus/ by running the IOS-PAD drivers against emulated controllers.
+// The emulated controllers build their reports byte by byte from the documented wire formats and
+// answer the requests the drivers send, the same way the IOS would record a real controller.
+// These are synthesized, so they catch changes in how the drivers behave but can't catch a driver
+// misunderstanding a controller, captures of real controllers can be added to the corpus for that.
+//
+// usage: corpusgen <output directory>
+
+#include "replay_common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <host.h>
+#include <controllers.h>
+#include <bt_api.h>
+
+// Captures start shortly before the 32-bit timestamps wrap around, so the replay has to handle that
+#define CAPTURE_BASE_TIMESTAMP 0xffff0000u
+
+// Length of every capture in milliseconds
+#define CAPTURE_DURATION 1000
+
+// Time it takes a controller to answer a request in milliseconds
+#define RESPONSE_DELAY 4
+
+#define MAX_DEVICES 2
+#define MAX_QUEUED_REPORTS 64
+
+enum {
+    EMU_A       = 1 << 0,
+    EMU_B       = 1 << 1,
+    EMU_X       = 1 << 2,
+    EMU_Y       = 1 << 3,
+    EMU_L       = 1 << 4,
+    EMU_R       = 1 << 5,
+    EMU_ZL      = 1 << 6,
+    EMU_ZR      = 1 << 7,
+    EMU_PLUS    = 1 << 8,
+    EMU_MINUS   = 1 << 9,
+    EMU_HOME    = 1 << 10,
+    EMU_CAPTURE = 1 << 11,
+    EMU_LSTICK  = 1 << 12,
+    EMU_RSTICK  = 1 << 13,
+    EMU_UP      = 1 << 14,
+    EMU_DOWN    = 1 << 15,
+    EMU_LEFT    = 1 << 16,
+    EMU_RIGHT   = 1 << 17,
+    EMU_SL      = 1 << 18,
+    EMU_SR      = 1 << 19,
+};
+
+// The input of an emulated controller from `time` on
+typedef struct {
+    uint32_t time;
+    uint32_t buttons;
+    // -100 to 100, up and right are positive
+    int8_t lx, ly, rx, ry;
+    // 0 to 100
+    uint8_t lt, rt;
+    // rotation around the vertical axis in degrees per second
+    int16_t yaw;
+} InputStep;
+
+typedef struct Device Device;
+
+struct Device {
+    uint8_t handle;
+    // controller type written to the connect record
+    uint8_t controllerType;
+    uint16_t vendor_id;
+    uint16_t product_id;
+    uint8_t bda[6];
+    uint32_t connectTime;
+    uint32_t reportPeriod;
+    const InputStep* script;
+
+    void (*sendReport)(Device* dev, const InputStep* input);
+    void (*receive)(Device* dev, uint8_t kind, uint8_t param, const uint8_t* data, uint16_t len);
+
+    uint8_t switchDevice;
+    // set once the driver switched to full reports, or enabled the controller at all for the DualShock 3
+    uint8_t fullReports;
+    uint8_t counter;
+    uint8_t connected;
+};
+
+typedef struct {
+    uint32_t time;
+    uint8_t handle;
+    uint16_t length;
+    uint8_t data[80];
+} QueuedReport;
+
+typedef struct {
+    const char* name;
+    Device devices[MAX_DEVICES];
+} Scenario;
+
+static FILE* captureFile;
+static uint32_t now;
+static Device* devices[MAX_DEVICES];
+static uint32_t numDevices;
+
+static QueuedReport queue[MAX_QUEUED_REPORTS];
+static uint32_t queueSize;
+
+// the same input for all controllers with a full set of buttons and sticks
+static const InputStep padScript[] = {
+    {   0, 0, },
+    { 200, EMU_A, },
+    { 260, 0, },
+    { 320, EMU_B | EMU_X, },
+    { 380, 0, },
+    { 440, 0, 100, 0, },
+    { 500, 0, -70, 70, },
+    { 560, EMU_ZR, 0, 0, 0, -100, 0, 100, 90, },
+    { 640, EMU_UP | EMU_L, 0, 0, 0, 0, 0, 0, -45, },
+    { 700, EMU_PLUS | EMU_MINUS, },
+    { 760, EMU_HOME, },
+    { 820, EMU_LSTICK | EMU_RSTICK | EMU_DOWN | EMU_RIGHT, 0, 0, 0, 0, 60, 30, },
+    { 900, 0, },
+    { CAPTURE_DURATION, },
+};
+
+// both Joy-Cons hold SL and SR to combine, followed by input on both halves
+static const InputStep joyconLeftScript[] = {
+    {   0, 0, },
+    { 200, EMU_SL | EMU_SR, },
+    { 300, 0, },
+    { 400, EMU_LEFT | EMU_ZL, },
+    { 460, 0, 0, 100, },
+    { 560, EMU_MINUS, },
+    { 620, 0, },
+    { CAPTURE_DURATION, },
+};
+
+static const InputStep joyconRightScript[] = {
+    {   0, 0, },
+    { 200, EMU_SL | EMU_SR, },
+    { 300, 0, },
+    { 400, EMU_A | EMU_ZR, },
+    { 460, 0, 0, 0, -100, 0, },
+    { 560, EMU_HOME, },
+    { 620, 0, },
+    { CAPTURE_DURATION, },
+};
+
+static const InputStep* currentInput(Device* dev)
+{
+    const InputStep* step = dev->script;
+    while (step[1].time <= now) {
+        step++;
+    }
+
+    return step;
+}
+
+static void deliverReport(uint8_t handle, const uint8_t* data, uint16_t length)
+{
+    // copy the report, the drivers may modify it
+    uint8_t buf[sizeof(queue[0].data)];
+    memcpy(buf, data, length);
+
+    Capture_WriteRecord(captureFile, CAPTURE_BASE_TIMESTAMP + now * 1000, handle, BLOOPAIR_CAPTURE_TYPE_INPUT, buf, length);
+    bta_hh_co_data(handle, buf, length, 0, 0, 0, NULL, 0);
+}
+
+static void queueReport(Device* dev, uint32_t delay, const uint8_t* data, uint16_t length)
+{
+    if (queueSize == MAX_QUEUED_REPORTS || length > sizeof(queue[0].data)) {
+        fprintf(stderr, "report queue overflow\n");
+        exit(1);
+    }
+
+    QueuedReport* report = &queue[queueSize++];
+    report->time = now + delay;
+    report->handle = dev->handle;
+    report->length = length;
+    memcpy(report->data, data, length);
+}
+
+static void deliverQueuedReports(void)
+{
+    // reports are delivered in the order they were queued
+    uint32_t remaining = 0;
+    for (uint32_t i = 0; i < queueSize; i++) {
+        if (queue[i].time <= now) {
+            deliverReport(queue[i].handle, queue[i].data, queue[i].length);
+        } else {
+            queue[remaining++] = queue[i];
+        }
+    }
+
+    queueSize = remaining;
+}
+
+static uint16_t scaleAxis(int8_t value, uint16_t center, uint16_t range)
+{
+    return center + value * range / 100;
+}
+
+// dpad as a hat switch, clockwise starting at up
+static uint8_t dpadHat(uint32_t buttons, uint8_t neutral, uint8_t first)
+{
+    static const uint8_t hats[16] = {
+        // index is up | down << 1 | left << 2 | right << 3
+        0xff, 0, 4, 0xff, 6, 7, 5, 0xff, 2, 1, 3, 0xff, 0xff, 0xff, 0xff, 0xff,
+    };
+
+    uint8_t hat = hats[(!!(buttons & EMU_UP)) | (!!(buttons & EMU_DOWN) << 1) |
+        (!!(buttons & EMU_LEFT) << 2) | (!!(buttons & EMU_RIGHT) << 3)];
+    return hat == 0xff ? neutral : hat + first;
+}
+
+static void putLe16(uint8_t* p, uint16_t value)
+{
+    p[0] = value;
+    p[1] = value >> 8;
+}
+
+// Nintendo Switch
+
+#define SWITCH_STICK_CENTER 0x800
+#define SWITCH_STICK_RANGE  0x600
+
+static uint8_t switchFlash[0x9000];
+
+static void initSwitchFlash(void)
+{
+    // unprogrammed flash reads as 0xff, which also leaves the user calibration empty
+    memset(switchFlash, 0xff, sizeof(switchFlash));
+
+    // factory stick calibration, the left stick stores max, center, min and the right one center, min, max
+    static const uint16_t left[6] = {
+        SWITCH_STICK_RANGE, SWITCH_STICK_RANGE, SWITCH_STICK_CENTER, SWITCH_STICK_CENTER, SWITCH_STICK_RANGE, SWITCH_STICK_RANGE,
+    };
+    static const uint16_t right[6] = {
+        SWITCH_STICK_CENTER, SWITCH_STICK_CENTER, SWITCH_STICK_RANGE, SWITCH_STICK_RANGE, SWITCH_STICK_RANGE, SWITCH_STICK_RANGE,
+    };
+    for (int i = 0; i < 3; i++) {
+        uint8_t* p = &switchFlash[0x603d + i * 3];
+        p[0] = left[i * 2];
+        p[1] = (left[i * 2] >> 8) | (left[i * 2 + 1] << 4);
+        p[2] = left[i * 2 + 1] >> 4;
+
+        p = &switchFlash[0x6046 + i * 3];
+        p[0] = right[i * 2];
+        p[1] = (right[i * 2] >> 8) | (right[i * 2 + 1] << 4);
+        p[2] = right[i * 2 + 1] >> 4;
+    }
+
+    // imu calibration: accel offset, accel 1G, gyro offset, gyro 936 dps, little endian
+    for (int i = 0; i < 3; i++) {
+        putLe16(&switchFlash[0x6020 + i * 2], 0);
+        putLe16(&switchFlash[0x6026 + i * 2], 16384);
+        putLe16(&switchFlash[0x602c + i * 2], 0);
+        putLe16(&switchFlash[0x6032 + i * 2], 13371);
+    }
+}
+
+static void switchPutStick(uint8_t* p, int8_t x, int8_t y)
+{
+    uint16_t rawX = scaleAxis(x, SWITCH_STICK_CENTER, SWITCH_STICK_RANGE);
+    uint16_t rawY = scaleAxis(y, SWITCH_STICK_CENTER, SWITCH_STICK_RANGE);
+    p[0] = rawX;
+    p[1] = (rawX >> 8) | (rawY << 4);
+    p[2] = rawY >> 4;
+}
+
+// the input part which all full reports share
+static void switchPutInput(Device* dev, uint8_t* rep, const InputStep* input)
+{
+    uint32_t b = input->buttons;
+    int isLeft = dev->switchDevice == 1;
+    int isRight = dev->switchDevice == 2;
+
+    rep[1] = dev->counter++;
+    // full battery, not charging, connected via bluetooth
+    rep[2] = 0x8e;
+
+    if (!isLeft) {
+        rep[3] = ((b & EMU_Y) ? 0x01 : 0) | ((b & EMU_X) ? 0x02 : 0) | ((b & EMU_B) ? 0x04 : 0) | ((b & EMU_A) ? 0x08 : 0) |
+            ((b & EMU_R) ? 0x40 : 0) | ((b & EMU_ZR) ? 0x80 : 0);
+        if (isRight) {
+            rep[3] |= ((b & EMU_SR) ? 0x10 : 0) | ((b & EMU_SL) ? 0x20 : 0);
+        }
+    }
+
+    rep[4] = ((b & EMU_MINUS) ? 0x01 : 0) | ((b & EMU_PLUS) ? 0x02 : 0) | ((b & EMU_RSTICK) ? 0x04 : 0) |
+        ((b & EMU_LSTICK) ? 0x08 : 0) | ((b & EMU_HOME) ? 0x10 : 0) | ((b & EMU_CAPTURE) ? 0x20 : 0);
+
+    if (!isRight) {
+        rep[5] = ((b & EMU_DOWN) ? 0x01 : 0) | ((b & EMU_UP) ? 0x02 : 0) | ((b & EMU_RIGHT) ? 0x04 : 0) | ((b & EMU_LEFT) ? 0x08 : 0) |
+            ((b & EMU_L) ? 0x40 : 0) | ((b & EMU_ZL) ? 0x80 : 0);
+        if (isLeft) {
+            rep[5] |= ((b & EMU_SR) ? 0x10 : 0) | ((b & EMU_SL) ? 0x20 : 0);
+        }
+    }
+
+    if (!isRight) {
+        switchPutStick(rep + 6, input->lx, input->ly);
+    }
+    if (!isLeft) {
+        switchPutStick(rep + 9, input->rx, input->ry);
+    }
+
+    rep[12] = 0x80;
+}
+
+static void switchSendReport(Device* dev, const InputStep* input)
+{
+    uint32_t b = input->buttons;
+
+    if (dev->fullReports) {
+        uint8_t rep[0x31] = { 0x30 };
+        switchPutInput(dev, rep, input);
+
+        // lying flat, 1G points up
+        int16_t gyro = input->yaw * 13371 / 936;
+        for (int i = 0; i < 3; i++) {
+            uint8_t* sample = rep + 13 + i * 12;
+            putLe16(sample + 4, 4096);
+            putLe16(sample + 10, gyro);
+        }
+
+        deliverReport(dev->handle, rep, sizeof(rep));
+        return;
+    }
+
+    uint8_t rep[12] = { 0x3f };
+    rep[1] = ((b & EMU_B) ? 0x01 : 0) | ((b & EMU_A) ? 0x02 : 0) | ((b & EMU_Y) ? 0x04 : 0) | ((b & EMU_X) ? 0x08 : 0) |
+        ((b & EMU_L) ? 0x10 : 0) | ((b & EMU_R) ? 0x20 : 0) | ((b & EMU_ZL) ? 0x40 : 0) | ((b & EMU_ZR) ? 0x80 : 0);
+    rep[2] = ((b & EMU_MINUS) ? 0x01 : 0) | ((b & EMU_PLUS) ? 0x02 : 0) | ((b & EMU_LSTICK) ? 0x04 : 0) |
+        ((b & EMU_RSTICK) ? 0x08 : 0) | ((b & EMU_HOME) ? 0x10 : 0) | ((b & EMU_CAPTURE) ? 0x20 : 0);
+    rep[3] = dpadHat(b, 8, 0);
+    putLe16(rep + 4, scaleAxis(input->lx, 0x8000, 0x7fff));
+    putLe16(rep + 6, scaleAxis(-input->ly, 0x8000, 0x7fff));
+    putLe16(rep + 8, scaleAxis(input->rx, 0x8000, 0x7fff));
+    putLe16(rep + 10, scaleAxis(-input->ry, 0x8000, 0x7fff));
+
+    deliverReport(dev->handle, rep, sizeof(rep));
+}
+
+static void switchReceive(Device* dev, uint8_t kind, uint8_t param, const uint8_t* data, uint16_t len)
+{
+    // only subcommands are answered, rumble reports don't have a response
+    if (kind != HOST_OUTPUT_DATA || data[0] != 0x01 || len < 11) {
+        return;
+    }
+
+    uint8_t command = data[10];
+    const uint8_t* args = data + 11;
+
+    uint8_t rep[0x31] = { 0x21 };
+    switchPutInput(dev, rep, currentInput(dev));
+    rep[13] = 0x80;
+    rep[14] = command;
+
+    switch (command) {
+    case 0x02: // device info
+        rep[13] = 0x82;
+        rep[15] = 0x04;
+        rep[16] = 0x21;
+        rep[17] = dev->switchDevice;
+        rep[18] = 0x02;
+        memcpy(rep + 19, dev->bda, 6);
+        rep[25] = 0x01;
+        rep[26] = 0x01;
+        break;
+    case 0x03: // input report mode
+        dev->fullReports = args[0] == 0x30;
+        break;
+    case 0x10: { // spi flash read
+        uint32_t address = args[0] | (args[1] << 8) | (args[2] << 16) | (args[3] << 24);
+        uint8_t size = args[4];
+        rep[13] = 0x90;
+        memcpy(rep + 15, args, 5);
+        if (size <= sizeof(rep) - 20 && address + size <= sizeof(switchFlash)) {
+            memcpy(rep + 20, switchFlash + address, size);
+        }
+        break;
+    }
+    }
+
+    queueReport(dev, RESPONSE_DELAY, rep, sizeof(rep));
+}
+
+// DualShock 3
+
+static void dualshock3SendReport(Device* dev, const InputStep* input)
+{
+    // the DualShock 3 only starts sending reports once it's enabled
+    if (!dev->fullReports) {
+        return;
+    }
+
+    uint32_t b = input->buttons;
+    uint8_t rep[0x31] = { 0x01 };
+    rep[2] = ((b & EMU_MINUS) ? 0x01 : 0) | ((b & EMU_LSTICK) ? 0x02 : 0) | ((b & EMU_RSTICK) ? 0x04 : 0) | ((b & EMU_PLUS) ? 0x08 : 0) |
+        ((b & EMU_UP) ? 0x10 : 0) | ((b & EMU_RIGHT) ? 0x20 : 0) | ((b & EMU_DOWN) ? 0x40 : 0) | ((b & EMU_LEFT) ? 0x80 : 0);
+    rep[3] = ((b & EMU_ZL) ? 0x01 : 0) | ((b & EMU_ZR) ? 0x02 : 0) | ((b & EMU_L) ? 0x04 : 0) | ((b & EMU_R) ? 0x08 : 0) |
+        ((b & EMU_X) ? 0x10 : 0) | ((b & EMU_A) ? 0x20 : 0) | ((b & EMU_B) ? 0x40 : 0) | ((b & EMU_Y) ? 0x80 : 0);
+    rep[4] = (b & EMU_HOME) ? 0x01 : 0;
+    rep[6] = scaleAxis(input->lx, 0x80, 0x7f);
+    rep[7] = scaleAxis(-input->ly, 0x80, 0x7f);
+    rep[8] = scaleAxis(input->rx, 0x80, 0x7f);
+    rep[9] = scaleAxis(-input->ry, 0x80, 0x7f);
+    rep[18] = input->lt * 255 / 100;
+    rep[19] = input->rt * 255 / 100;
+    // not charging, full battery, bluetooth
+    rep[29] = 0x03;
+    rep[30] = 0x05;
+    rep[31] = 0x16;
+
+    deliverReport(dev->handle, rep, sizeof(rep));
+}
+
+static void dualshock3Receive(Device* dev, uint8_t kind, uint8_t param, const uint8_t* data, uint16_t len)
+{
+    if (kind == HOST_OUTPUT_SET_REPORT && param == BTA_HH_RPTT_FEATURE) {
+        dev->fullReports = 1;
+    }
+}
+
+// DualShock 4 and DualSense
+
+static void sonyPutButtons(uint8_t* p, uint32_t b)
+{
+    p[0] = dpadHat(b, 8, 0) | ((b & EMU_Y) ? 0x10 : 0) | ((b & EMU_B) ? 0x20 : 0) | ((b & EMU_A) ? 0x40 : 0) | ((b & EMU_X) ? 0x80 : 0);
+    p[1] = ((b & EMU_L) ? 0x01 : 0) | ((b & EMU_R) ? 0x02 : 0) | ((b & EMU_ZL) ? 0x04 : 0) | ((b & EMU_ZR) ? 0x08 : 0) |
+        ((b & EMU_MINUS) ? 0x10 : 0) | ((b & EMU_PLUS) ? 0x20 : 0) | ((b & EMU_LSTICK) ? 0x40 : 0) | ((b & EMU_RSTICK) ? 0x80 : 0);
+    p[2] = ((b & EMU_HOME) ? 0x01 : 0) | ((b & EMU_CAPTURE) ? 0x02 : 0);
+}
+
+static void sonyPutSticks(uint8_t* p, const InputStep* input)
+{
+    p[0] = scaleAxis(input->lx, 0x80, 0x7f);
+    p[1] = scaleAxis(-input->ly, 0x80, 0x7f);
+    p[2] = scaleAxis(input->rx, 0x80, 0x7f);
+    p[3] = scaleAxis(-input->ry, 0x80, 0x7f);
+}
+
+static void sonyPutMotion(uint8_t* gyro, uint8_t* accel, const InputStep* input)
+{
+    // the nominal resolution is 16 per dps and 8192 per G, the y axis points up
+    putLe16(gyro + 2, input->yaw * 16);
+    putLe16(accel + 2, 8192);
+}
+
+static void dualshock4SendReport(Device* dev, const InputStep* input)
+{
+    // until the first output report the DualShock 4 only sends basic reports
+    if (!dev->fullReports) {
+        uint8_t rep[10] = { 0x01 };
+        sonyPutSticks(rep + 1, input);
+        sonyPutButtons(rep + 5, input->buttons);
+        rep[8] = input->lt * 255 / 100;
+        rep[9] = input->rt * 255 / 100;
+        deliverReport(dev->handle, rep, sizeof(rep));
+        return;
+    }
+
+    uint8_t rep[0x4e] = { 0x11, 0xc0 };
+    sonyPutSticks(rep + 3, input);
+    sonyPutButtons(rep + 7, input->buttons);
+    rep[9] |= (dev->counter++ << 2);
+    rep[10] = input->lt * 255 / 100;
+    rep[11] = input->rt * 255 / 100;
+    sonyPutMotion(rep + 15, rep + 21, input);
+    // cable disconnected, full battery
+    rep[32] = 0x09;
+
+    deliverReport(dev->handle, rep, sizeof(rep));
+}
+
+static void dualshock4Receive(Device* dev, uint8_t kind, uint8_t param, const uint8_t* data, uint16_t len)
+{
+    if (kind == HOST_OUTPUT_DATA && data[0] == 0x11) {
+        dev->fullReports = 1;
+    }
+}
+
+static void dualsenseSendReport(Device* dev, const InputStep* input)
+{
+    uint8_t rep[0x4e] = { 0x31 };
+    sonyPutSticks(rep + 2, input);
+    rep[6] = input->lt * 255 / 100;
+    rep[7] = input->rt * 255 / 100;
+    rep[8] = dev->counter++;
+    sonyPutButtons(rep + 9, input->buttons);
+    sonyPutMotion(rep + 17, rep + 23, input);
+    // discharging, full battery
+    rep[54] = 0x08;
+
+    deliverReport(dev->handle, rep, sizeof(rep));
+}
+
+// Xbox One
+
+static void xboxOneSendReport(Device* dev, const InputStep* input)
+{
+    // the battery is reported once after connecting
+    if (!dev->fullReports) {
+        // online, full battery
+        uint8_t battery[2] = { 0x04, 0x83 };
+        deliverReport(dev->handle, battery, sizeof(battery));
+        dev->fullReports = 1;
+    }
+
+    uint32_t b = input->buttons;
+    uint8_t rep[17] = { 0x01 };
+    putLe16(rep + 1, scaleAxis(input->lx, 0x8000, 0x7fff));
+    putLe16(rep + 3, scaleAxis(-input->ly, 0x8000, 0x7fff));
+    putLe16(rep + 5, scaleAxis(input->rx, 0x8000, 0x7fff));
+    putLe16(rep + 7, scaleAxis(-input->ry, 0x8000, 0x7fff));
+    putLe16(rep + 9, input->lt * 1023 / 100);
+    putLe16(rep + 11, input->rt * 1023 / 100);
+    rep[13] = dpadHat(b, 0, 1);
+    rep[14] = ((b & EMU_A) ? 0x01 : 0) | ((b & EMU_B) ? 0x02 : 0) | ((b & EMU_X) ? 0x08 : 0) | ((b & EMU_Y) ? 0x10 : 0) |
+        ((b & EMU_L) ? 0x40 : 0) | ((b & EMU_R) ? 0x80 : 0);
+    rep[15] = ((b & EMU_PLUS) ? 0x08 : 0) | ((b & EMU_HOME) ? 0x10 : 0) | ((b & EMU_LSTICK) ? 0x20 : 0) | ((b & EMU_RSTICK) ? 0x40 : 0);
+    rep[16] = (b & EMU_MINUS) ? 0x01 : 0;
+
+    deliverReport(dev->handle, rep, sizeof(rep));
+}
+
+#define SWITCH_DEVICE(dev, type, pid, period) \
+    .controllerType = type, .vendor_id = 0x057e, .product_id = pid, \
+    .reportPeriod = period, .sendReport = switchSendReport, .receive = switchReceive, .switchDevice = dev
+
+static const Scenario scenarios[] = {
+    { "switch_pro", {
+        { .handle = 0, .bda = { 0x98, 0xb6, 0xe9, 0x00, 0x00, 0x01 }, .script = padScript,
+            SWITCH_DEVICE(3, BLOOPAIR_CONTROLLER_SWITCH_PRO, 0x2009, 15) },
+    } },
+    { "joycon", {
+        { .handle = 0, .bda = { 0x98, 0xb6, 0xe9, 0x00, 0x00, 0x02 }, .script = joyconLeftScript,
+            SWITCH_DEVICE(1, BLOOPAIR_CONTROLLER_SWITCH_JOYCON_LEFT, 0x2006, 15) },
+        { .handle = 1, .bda = { 0x98, 0xb6, 0xe9, 0x00, 0x00, 0x03 }, .script = joyconRightScript, .connectTime = 20,
+            SWITCH_DEVICE(2, BLOOPAIR_CONTROLLER_SWITCH_JOYCON_RIGHT, 0x2007, 15) },
+    } },
+    { "switch_n64", {
+        { .handle = 0, .bda = { 0x98, 0xb6, 0xe9, 0x00, 0x00, 0x04 }, .script = padScript,
+            SWITCH_DEVICE(12, BLOOPAIR_CONTROLLER_SWITCH_N64, 0x2019, 15) },
+    } },
+    { "dualsense", {
+        { .handle = 0, .bda = { 0xa0, 0x5a, 0x5c, 0x00, 0x00, 0x01 }, .script = padScript,
+            .controllerType = BLOOPAIR_CONTROLLER_DUALSENSE, .vendor_id = 0x054c, .product_id = 0x0ce6,
+            .reportPeriod = 4, .sendReport = dualsenseSendReport },
+    } },
+    { "dualshock3", {
+        { .handle = 0, .bda = { 0x00, 0x26, 0x5c, 0x00, 0x00, 0x01 }, .script = padScript,
+            .controllerType = BLOOPAIR_CONTROLLER_DUALSHOCK3, .vendor_id = 0x054c, .product_id = 0x0268,
+            .reportPeriod = 10, .sendReport = dualshock3SendReport, .receive = dualshock3Receive },
+    } },
+    { "dualshock4", {
+        { .handle = 0, .bda = { 0x1c, 0x66, 0x6d, 0x00, 0x00, 0x01 }, .script = padScript,
+            .controllerType = BLOOPAIR_CONTROLLER_DUALSHOCK4, .vendor_id = 0x054c, .product_id = 0x09cc,
+            .reportPeriod = 8, .sendReport = dualshock4SendReport, .receive = dualshock4Receive },
+    } },
+    { "xbox_one", {
+        { .handle = 0, .bda = { 0x98, 0x7a, 0x14, 0x00, 0x00, 0x01 }, .script = padScript,
+            .controllerType = BLOOPAIR_CONTROLLER_XBOX_ONE, .vendor_id = 0x045e, .product_id = 0x02e0,
+            .reportPeriod = 9, .sendReport = xboxOneSendReport },
+    } },
+};
+
+static void outputCallback(uint8_t handle, uint8_t kind, uint8_t param, const uint8_t* data, uint16_t len)
+{
+    // the IOS only captures reports sent on the interrupt channel
+    if (kind == HOST_OUTPUT_DATA) {
+        Capture_WriteRecord(captureFile, CAPTURE_BASE_TIMESTAMP + now * 1000, handle, BLOOPAIR_CAPTURE_TYPE_OUTPUT, data, len);
+    }
+
+    for (uint32_t i = 0; i < numDevices; i++) {
+        if (devices[i]->handle == handle && devices[i]->receive) {
+            devices[i]->receive(devices[i], kind, param, data, len);
+        }
+    }
+}
+
+static int generate(const char* directory, const Scenario* scenario)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.bpcap", directory, scenario->name);
+
+    captureFile = fopen(path, "wb");
+    if (!captureFile) {
+        perror(path);
+        return -1;
+    }
+
+    Capture_WriteHeader(captureFile);
+
+    Device deviceStates[MAX_DEVICES];
+    memcpy(deviceStates, scenario->devices, sizeof(deviceStates));
+    numDevices = 0;
+    for (int i = 0; i < MAX_DEVICES; i++) {
+        if (deviceStates[i].script) {
+            devices[numDevices++] = &deviceStates[i];
+        }
+    }
+
+    queueSize = 0;
+
+    for (now = 0; now < CAPTURE_DURATION; now++) {
+        Host_SetTime(CAPTURE_BASE_TIMESTAMP + now * 1000);
+
+        // the report thread runs before anything else which happens at the same time, just like in the replay
+        if (now % (REPLAY_REPORT_INTERVAL / 1000) == 0) {
+            Replay_Tick();
+        }
+
+        for (uint32_t i = 0; i < numDevices; i++) {
+            Device* dev = devices[i];
+            if (now != dev->connectTime) {
+                continue;
+            }
+
+            dev->connected = 1;
+            if (Replay_Connect(dev->handle, dev->controllerType, dev->vendor_id, dev->product_id, dev->bda) != 0) {
+                fprintf(stderr, "%s: failed to connect handle %u\n", scenario->name, dev->handle);
+                fclose(captureFile);
+                return -1;
+            }
+
+            // the IOS records the connection after the driver was initialized
+            Capture_WriteConnect(captureFile, CAPTURE_BASE_TIMESTAMP + now * 1000, dev->handle, dev->controllerType,
+                dev->vendor_id, dev->product_id, dev->bda);
+        }
+
+        deliverQueuedReports();
+
+        for (uint32_t i = 0; i < numDevices; i++) {
+            Device* dev = devices[i];
+            if (dev->connected && (now - dev->connectTime) % dev->reportPeriod == 0) {
+                dev->sendReport(dev, currentInput(dev));
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < numDevices; i++) {
+        Capture_WriteRecord(captureFile, CAPTURE_BASE_TIMESTAMP + now * 1000, devices[i]->handle,
+            BLOOPAIR_CAPTURE_TYPE_DISCONNECT, NULL, 0);
+        Replay_Disconnect(devices[i]->handle);
+    }
+
+    fclose(captureFile);
+    printf("%s\n", path);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <output directory>\n", argv[0]);
+        return 1;
+    }
+
+    initSwitchFlash();
+    Host_SetCallbacks(outputCallback, NULL);
+    Replay_Init();
+
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        if (generate(argv[1], &scenarios[i]) != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
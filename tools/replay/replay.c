@@ -0,0 +1,359 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Host tool which feeds a capture through the IOS-PAD drivers and prints everything they send,
+// both to the controller and to padscore. Koopair records captures to wiiu/bloopair/captures/*.bpcap
+// with the "Record capture" setting, start the capture before connecting the controller so the
+// initialization is part of it.
+// Reports the drivers send to the controller are compared against the ones in the capture.
+//
+// Build with `make`, `make check` replays the corpus and compares it against the expected transcripts.
+//
+// usage: replay <capture>
+//        replay -b <iterations> <capture>    measures how long the drivers take for the capture
+
+#include "replay_common.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <host.h>
+#include <controllers.h>
+#include <bt_api.h>
+
+typedef struct {
+    uint16_t length;
+    uint8_t* data;
+} Report;
+
+typedef struct {
+    uint32_t count;
+    uint32_t capacity;
+    Report* reports;
+} ReportList;
+
+static CaptureRecord** records;
+static uint32_t numRecords;
+
+static int printTranscript;
+static uint32_t currentTime;
+
+static char lastLine[512];
+static uint32_t numRepeats;
+
+// reports sent to the controller, per handle
+static ReportList sentOutputs[BTA_HH_MAX_KNOWN];
+static ReportList capturedOutputs[BTA_HH_MAX_KNOWN];
+
+// allocations which stay around for as long as the IOS runs
+static uint32_t baseAllocations;
+
+static uint32_t numInputs;
+static uint32_t numTicks;
+
+static void addReport(ReportList* list, const uint8_t* data, uint16_t length)
+{
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 64;
+        list->reports = realloc(list->reports, list->capacity * sizeof(Report));
+    }
+
+    Report* report = &list->reports[list->count++];
+    report->length = length;
+    report->data = malloc(length);
+    memcpy(report->data, data, length);
+}
+
+static void clearReports(ReportList* list)
+{
+    for (uint32_t i = 0; i < list->count; i++) {
+        free(list->reports[i].data);
+    }
+
+    list->count = 0;
+}
+
+static void flushRepeats(void)
+{
+    if (numRepeats) {
+        printf("              (%u more times)\n", numRepeats);
+        numRepeats = 0;
+    }
+}
+
+// identical consecutive lines are collapsed, drivers send the same state to padscore most of the time
+static void printLine(const char* fmt, ...)
+{
+    char line[sizeof(lastLine)];
+
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+
+    if (strcmp(line, lastLine) == 0) {
+        numRepeats++;
+        return;
+    }
+
+    flushRepeats();
+    strcpy(lastLine, line);
+    printf("[%4u.%03u] %s\n", currentTime / 1000000, (currentTime / 1000) % 1000, line);
+}
+
+static void hexString(char* out, size_t size, const uint8_t* data, uint16_t length)
+{
+    size_t pos = 0;
+    for (uint16_t i = 0; i < length && pos + 4 < size; i++) {
+        pos += snprintf(out + pos, size - pos, i ? " %02x" : "%02x", data[i]);
+    }
+
+    if (length * 3 > size - 1) {
+        snprintf(out + pos, size - pos, "...");
+    }
+}
+
+static void outputCallback(uint8_t handle, uint8_t kind, uint8_t param, const uint8_t* data, uint16_t len)
+{
+    // only reports sent on the interrupt channel end up in captures
+    if (kind == HOST_OUTPUT_DATA) {
+        addReport(&sentOutputs[handle], data, len);
+    }
+
+    if (printTranscript) {
+        char hex[400];
+        hexString(hex, sizeof(hex), data, len);
+        if (kind == HOST_OUTPUT_DATA) {
+            printLine("%2u out  %s", handle, hex);
+        } else if (kind == HOST_OUTPUT_GET_REPORT) {
+            printLine("%2u get report %u  %s", handle, param, hex);
+        } else {
+            printLine("%2u set report %u  %s", handle, param, hex);
+        }
+    }
+}
+
+static void inputCallback(uint8_t handle, const uint8_t* data, uint16_t len)
+{
+    if (printTranscript) {
+        char hex[400];
+        hexString(hex, sizeof(hex), data, len);
+        printLine("%2u pad  %s", handle, hex);
+    }
+}
+
+static int loadCapture(const char* path)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    if (!Capture_ReadHeader(f)) {
+        fprintf(stderr, "%s: not a bloopair capture\n", path);
+        fclose(f);
+        return -1;
+    }
+
+    uint32_t capacity = 0;
+    CaptureRecord* record = malloc(sizeof(CaptureRecord));
+    while (Capture_ReadRecord(f, record)) {
+        if (numRecords == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            records = realloc(records, capacity * sizeof(CaptureRecord*));
+        }
+
+        // only keep the part of the record which is used
+        CaptureRecord* copy = malloc(offsetof(CaptureRecord, data) + record->length);
+        memcpy(copy, record, offsetof(CaptureRecord, data) + record->length);
+        records[numRecords++] = copy;
+    }
+
+    free(record);
+    fclose(f);
+    return 0;
+}
+
+static void tick(uint32_t time)
+{
+    currentTime = time;
+    Host_SetTime(time);
+    Replay_Tick();
+    numTicks++;
+}
+
+static void replay(void)
+{
+    if (!numRecords) {
+        return;
+    }
+
+    uint32_t start = records[0]->timestamp;
+    uint32_t nextTick = 0;
+
+    for (uint32_t i = 0; i < numRecords; i++) {
+        CaptureRecord* record = records[i];
+        // unsigned subtraction handles the 32-bit timestamp wrapping
+        uint32_t time = record->timestamp - start;
+
+        while (time >= nextTick) {
+            tick(nextTick);
+            nextTick += REPLAY_REPORT_INTERVAL;
+        }
+
+        currentTime = time;
+        Host_SetTime(time);
+
+        if (record->handle >= BTA_HH_MAX_KNOWN) {
+            continue;
+        }
+
+        switch (record->type) {
+        case BLOOPAIR_CAPTURE_TYPE_INPUT:
+            numInputs++;
+            bta_hh_co_data(record->handle, record->data, record->length, 0, 0, 0, NULL, 0);
+            break;
+        case BLOOPAIR_CAPTURE_TYPE_OUTPUT:
+            addReport(&capturedOutputs[record->handle], record->data, record->length);
+            break;
+        case BLOOPAIR_CAPTURE_TYPE_CONNECT: {
+            uint8_t type;
+            uint16_t vendor_id, product_id;
+            uint8_t bda[6];
+            Capture_ParseConnect(record, &type, &vendor_id, &product_id, bda);
+
+            int res = Replay_Connect(record->handle, type, vendor_id, product_id, bda);
+            if (printTranscript) {
+                printLine("%2u connect %s %04x:%04x %s", record->handle, Replay_ControllerTypeName(type),
+                    vendor_id, product_id, res == 0 ? "ok" : "failed");
+            }
+            break;
+        }
+        case BLOOPAIR_CAPTURE_TYPE_DISCONNECT:
+            Replay_Disconnect(record->handle);
+            if (printTranscript) {
+                printLine("%2u disconnect", record->handle);
+            }
+            break;
+        }
+    }
+
+    // let the drivers send what's left
+    tick(nextTick);
+
+    for (uint8_t handle = 0; handle < BTA_HH_MAX_KNOWN; handle++) {
+        Replay_Disconnect(handle);
+    }
+}
+
+static void printSummary(void)
+{
+    flushRepeats();
+
+    printf("\n%u input reports, %u report intervals\n", numInputs, numTicks);
+
+    for (uint8_t handle = 0; handle < BTA_HH_MAX_KNOWN; handle++) {
+        ReportList* sent = &sentOutputs[handle];
+        ReportList* captured = &capturedOutputs[handle];
+        if (!sent->count && !captured->count) {
+            continue;
+        }
+
+        uint32_t matching = 0;
+        while (matching < sent->count && matching < captured->count &&
+            sent->reports[matching].length == captured->reports[matching].length &&
+            memcmp(sent->reports[matching].data, captured->reports[matching].data, sent->reports[matching].length) == 0) {
+            matching++;
+        }
+
+        printf("handle %u: sent %u reports to the controller, the capture has %u, first %u match\n",
+            handle, sent->count, captured->count, matching);
+    }
+
+    uint32_t leaked = Host_GetAllocationCount() - baseAllocations;
+    if (leaked) {
+        printf("%u allocations weren't freed after disconnecting\n", leaked);
+    }
+}
+
+static uint64_t nanoTime(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void benchmark(uint32_t iterations)
+{
+    // the first run also caches the switch calibration, so all measured runs take the same path
+    replay();
+
+    numInputs = numTicks = 0;
+    uint64_t start = nanoTime();
+    for (uint32_t i = 0; i < iterations; i++) {
+        for (uint8_t handle = 0; handle < BTA_HH_MAX_KNOWN; handle++) {
+            clearReports(&sentOutputs[handle]);
+            clearReports(&capturedOutputs[handle]);
+        }
+
+        replay();
+    }
+    uint64_t elapsed = nanoTime() - start;
+
+    printf("%u iterations, %u input reports and %u report intervals in %.3f ms\n",
+        iterations, numInputs, numTicks, elapsed / 1000000.0);
+    printf("%.1f ns per input report and report interval\n", (double) elapsed / (numInputs + numTicks));
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t iterations = 0;
+    const char* path = NULL;
+
+    if (argc == 2) {
+        path = argv[1];
+    } else if (argc == 4 && strcmp(argv[1], "-b") == 0) {
+        iterations = strtoul(argv[2], NULL, 0);
+        path = argv[3];
+    }
+
+    if (!path || (argc == 4 && !iterations)) {
+        fprintf(stderr, "usage: %s [-b <iterations>] <capture>\n", argv[0]);
+        return 1;
+    }
+
+    if (loadCapture(path) != 0) {
+        return 1;
+    }
+
+    Host_SetCallbacks(outputCallback, inputCallback);
+    Replay_Init();
+    baseAllocations = Host_GetAllocationCount();
+
+    if (iterations) {
+        benchmark(iterations);
+        return 0;
+    }
+
+    printTranscript = 1;
+    replay();
+    printSummary();
+    return 0;
+}
@@ -0,0 +1,213 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "replay_common.h"
+
+#include <host.h>
+#include <main.h>
+#include <controllers.h>
+#include <info_store.h>
+#include <device_registry.h>
+#include <configuration.h>
+
+static uint32_t be32(const uint8_t* p)
+{
+    return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+}
+
+static uint16_t be16(const uint8_t* p)
+{
+    return (uint16_t) ((p[0] << 8) | p[1]);
+}
+
+static void putBe32(uint8_t* p, uint32_t value)
+{
+    p[0] = value >> 24;
+    p[1] = value >> 16;
+    p[2] = value >> 8;
+    p[3] = value;
+}
+
+static void putBe16(uint8_t* p, uint16_t value)
+{
+    p[0] = value >> 8;
+    p[1] = value;
+}
+
+int Capture_ReadHeader(FILE* f)
+{
+    uint8_t raw[sizeof(BloopairCaptureFileHeader)];
+    if (fread(raw, sizeof(raw), 1, f) != 1) {
+        return 0;
+    }
+
+    return be32(raw) == BLOOPAIR_CAPTURE_MAGIC && be16(raw + 4) == BLOOPAIR_CAPTURE_VERSION;
+}
+
+int Capture_ReadRecord(FILE* f, CaptureRecord* record)
+{
+    uint8_t raw[sizeof(BloopairCaptureRecordHeader)];
+    if (fread(raw, sizeof(raw), 1, f) != 1) {
+        return 0;
+    }
+
+    record->timestamp = be32(raw);
+    record->handle = raw[4];
+    record->type = raw[5];
+    record->length = be16(raw + 6);
+
+    // a truncated record at the end of the file is dropped, the capture might not have been stopped properly
+    return fread(record->data, 1, record->length, f) == record->length;
+}
+
+void Capture_WriteHeader(FILE* f)
+{
+    uint8_t raw[sizeof(BloopairCaptureFileHeader)] = { 0 };
+    putBe32(raw, BLOOPAIR_CAPTURE_MAGIC);
+    putBe16(raw + 4, BLOOPAIR_CAPTURE_VERSION);
+    fwrite(raw, sizeof(raw), 1, f);
+}
+
+void Capture_WriteRecord(FILE* f, uint32_t timestamp, uint8_t handle, uint8_t type, const void* data, uint16_t length)
+{
+    uint8_t raw[sizeof(BloopairCaptureRecordHeader)];
+    putBe32(raw, timestamp);
+    raw[4] = handle;
+    raw[5] = type;
+    putBe16(raw + 6, length);
+
+    fwrite(raw, sizeof(raw), 1, f);
+    fwrite(data, 1, length, f);
+}
+
+void Capture_WriteConnect(FILE* f, uint32_t timestamp, uint8_t handle, uint8_t controllerType,
+    uint16_t vendor_id, uint16_t product_id, const uint8_t* bda)
+{
+    uint8_t raw[sizeof(BloopairCaptureConnectInfo)];
+    raw[0] = controllerType;
+    raw[1] = 0;
+    putBe16(raw + 2, vendor_id);
+    putBe16(raw + 4, product_id);
+    memcpy(raw + 6, bda, 6);
+
+    Capture_WriteRecord(f, timestamp, handle, BLOOPAIR_CAPTURE_TYPE_CONNECT, raw, sizeof(raw));
+}
+
+void Capture_ParseConnect(const CaptureRecord* record, uint8_t* controllerType,
+    uint16_t* vendor_id, uint16_t* product_id, uint8_t* bda)
+{
+    *controllerType = record->data[0];
+    *vendor_id = be16(record->data + 2);
+    *product_id = be16(record->data + 4);
+    memcpy(bda, record->data + 6, 6);
+}
+
+static int isSwitchType(uint8_t type)
+{
+    return type >= BLOOPAIR_CONTROLLER_SWITCH_GENERIC && type <= BLOOPAIR_CONTROLLER_SWITCH_N64;
+}
+
+void Replay_Init(void)
+{
+    // initController does this on the first connect, the host version of the report thread never runs
+    initReportThread();
+    Configuration_Init();
+}
+
+int Replay_Connect(uint8_t handle, uint8_t controllerType, uint16_t vendor_id, uint16_t product_id, const uint8_t* bda)
+{
+    uint8_t address[6];
+    memcpy(address, bda, sizeof(address));
+
+    StoredInfo* info = store_get_device_info(address);
+    if (!info) {
+        info = store_allocate_device_info(address);
+        if (!info) {
+            return -1;
+        }
+    }
+
+    // pairing stores the magic, third-party switch controllers are only known by their name
+    BloopairDeviceEntry entry;
+    if (controllerType == BLOOPAIR_CONTROLLER_OFFICIAL) {
+        info->magic = MAGIC_OFFICIAL;
+    } else if (isSwitchType(controllerType) && DeviceRegistry_Find(vendor_id, product_id, &entry) != 0) {
+        info->magic = MAGIC_SWITCH;
+    } else {
+        info->magic = MAGIC_BLOOPAIR;
+    }
+    info->vendor_id = vendor_id;
+    info->product_id = product_id;
+
+    int res = initController(address, handle);
+    if (res != 0 || controllers[handle].type == BLOOPAIR_CONTROLLER_OFFICIAL) {
+        return res;
+    }
+
+    // padscore sets the player led and the reporting mode right after connecting
+    WMLEDReport led = { 0 };
+    led.report_id = WM_REPORT_ID_LED;
+    led.led_mask = 1 << (handle % 4);
+    Host_QueueSmdOutput(handle, &led, sizeof(led));
+
+    WMReportModeReport mode = { 0 };
+    mode.report_id = WM_REPORT_ID_REPORT_MODE;
+    mode.mode = WM_REPORT_ID_EXTENSION_DATA_REPORT;
+    Host_QueueSmdOutput(handle, &mode, sizeof(mode));
+
+    return 0;
+}
+
+void Replay_Disconnect(uint8_t handle)
+{
+    Controller* controller = &controllers[handle];
+    if (!controller->isInitialized) {
+        return;
+    }
+
+    if (controller->deinit) {
+        controller->deinit(controller);
+    }
+
+    controller->isInitialized = 0;
+}
+
+void Replay_Tick(void)
+{
+    processSmdMessages();
+    updateControllers();
+}
+
+const char* Replay_ControllerTypeName(uint8_t type)
+{
+    switch (type) {
+    case BLOOPAIR_CONTROLLER_OFFICIAL:              return "official";
+    case BLOOPAIR_CONTROLLER_DUALSENSE:             return "dualsense";
+    case BLOOPAIR_CONTROLLER_DUALSHOCK3:            return "dualshock 3";
+    case BLOOPAIR_CONTROLLER_DUALSHOCK4:            return "dualshock 4";
+    case BLOOPAIR_CONTROLLER_SWITCH_GENERIC:        return "switch generic";
+    case BLOOPAIR_CONTROLLER_SWITCH_JOYCON_LEFT:    return "joy-con left";
+    case BLOOPAIR_CONTROLLER_SWITCH_JOYCON_RIGHT:   return "joy-con right";
+    case BLOOPAIR_CONTROLLER_SWITCH_JOYCON_DUAL:    return "joy-con dual";
+    case BLOOPAIR_CONTROLLER_SWITCH_PRO:            return "switch pro";
+    case BLOOPAIR_CONTROLLER_SWITCH_N64:            return "switch n64";
+    case BLOOPAIR_CONTROLLER_XBOX_ONE:              return "xbox one";
+    case BLOOPAIR_CONTROLLER_GENERIC_HID:           return "generic hid";
+    }
+
+    return "unknown";
+}
@@ -0,0 +1,64 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <bloopair/capture.h>
+
+// Interval of the IOS-PAD report thread in microseconds
+#define REPLAY_REPORT_INTERVAL 10000
+
+typedef struct {
+    uint32_t timestamp;
+    uint8_t handle;
+    uint8_t type;
+    uint16_t length;
+    uint8_t data[0xffff];
+} CaptureRecord;
+
+// returns 0 if the file doesn't start with a supported capture header
+int Capture_ReadHeader(FILE* f);
+
+// returns 0 at the end of the file
+int Capture_ReadRecord(FILE* f, CaptureRecord* record);
+
+void Capture_WriteHeader(FILE* f);
+
+void Capture_WriteRecord(FILE* f, uint32_t timestamp, uint8_t handle, uint8_t type, const void* data, uint16_t length);
+
+void Capture_WriteConnect(FILE* f, uint32_t timestamp, uint8_t handle, uint8_t controllerType,
+    uint16_t vendor_id, uint16_t product_id, const uint8_t* bda);
+
+void Capture_ParseConnect(const CaptureRecord* record, uint8_t* controllerType,
+    uint16_t* vendor_id, uint16_t* product_id, uint8_t* bda);
+
+// Sets up what the IOS keeps for its whole lifetime, the report thread and the fallback configurations
+void Replay_Init(void);
+
+// Sets up the stored info for a device the way pairing would have and initializes its driver,
+// returns the result of initController
+int Replay_Connect(uint8_t handle, uint8_t controllerType, uint16_t vendor_id, uint16_t product_id, const uint8_t* bda);
+
+// Deinitializes the driver like a BTA_HH_CLOSE_EVT does
+void Replay_Disconnect(uint8_t handle);
+
+// One report thread interval, also handles everything padscore queued
+void Replay_Tick(void);
+
+const char* Replay_ControllerTypeName(uint8_t type);
@@ -0,0 +1,99 @@
+/*
+ *   Copyright (C) 2024 GaryOderNichts
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Host tool which turns a dump of BloopairTraceRecords into a readable timeline.
+// A dump is just the records returned by Bloopair_ReadTrace written back to back.
+// Koopair saves these to wiiu/bloopair/traces/*.bptrace with the "Record trace" setting.
+//
+// Build with: cc -O2 -I../../libbloopair/include -o tracedecode tracedecode.c
+
+#include <stdio.h>
+#include <stdint.h>
+#include <bloopair/trace.h>
+
+static uint32_t be32(const uint8_t* p)
+{
+    return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+}
+
+static uint16_t be16(const uint8_t* p)
+{
+    return (uint16_t) ((p[0] << 8) | p[1]);
+}
+
+static const char* eventName(uint8_t event)
+{
+    switch (event) {
+    case BLOOPAIR_TRACE_EVENT_SMD_OUTPUT:             return "smd output";
+    case BLOOPAIR_TRACE_EVENT_HH_EVENT:               return "hh event";
+    case BLOOPAIR_TRACE_EVENT_HH_OPEN:                return "hh open";
+    case BLOOPAIR_TRACE_EVENT_HH_CLOSE:               return "hh close";
+    case BLOOPAIR_TRACE_EVENT_HH_VC_UNPLUG:           return "hh vc unplug";
+    case BLOOPAIR_TRACE_EVENT_SWITCH_SUBCMD_RESPONSE: return "switch subcmd response";
+    case BLOOPAIR_TRACE_EVENT_SWITCH_SUBCMD_FAILED:   return "switch subcmd failed";
+    case BLOOPAIR_TRACE_EVENT_SWITCH_DEVICE_TYPE:     return "switch device type";
+    case BLOOPAIR_TRACE_EVENT_SWITCH_SPI_READ:        return "switch spi read";
+    case BLOOPAIR_TRACE_EVENT_SWITCH_SUBCMD_RETRY:    return "switch subcmd retry";
+    case BLOOPAIR_TRACE_EVENT_SWITCH_SUBCMD_TIMEOUT:  return "switch subcmd timeout";
+    }
+
+    return "unknown";
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <trace dump>\n", argv[0]);
+        return 1;
+    }
+
+    FILE* f = fopen(argv[1], "rb");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    uint8_t raw[sizeof(BloopairTraceRecord)];
+    uint32_t first = 0, prev = 0;
+    int haveFirst = 0;
+    while (fread(raw, sizeof(raw), 1, f) == 1) {
+        uint32_t timestamp = be32(raw);
+        uint8_t event = raw[4];
+        uint8_t handle = raw[5];
+        uint16_t arg0 = be16(raw + 6);
+        uint32_t arg1 = be32(raw + 8);
+
+        if (!haveFirst) {
+            first = prev = timestamp;
+            haveFirst = 1;
+        }
+
+        // unsigned subtraction handles the 32-bit timestamp wrapping
+        printf("%10u.%06u  +%8uus  ", (timestamp - first) / 1000000, (timestamp - first) % 1000000, timestamp - prev);
+        if (handle == 0xff) {
+            printf("   -  ");
+        } else {
+            printf("  %2u  ", handle);
+        }
+        printf("%-24s 0x%04x 0x%08x\n", eventName(event), arg0, arg1);
+
+        prev = timestamp;
+    }
+
+    fclose(f);
+    return 0;
+}